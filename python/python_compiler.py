@@ -825,7 +825,7 @@ class BytecodeGenerator(ast.NodeVisitor):
         dict_name = self.__get_random_name()
 
         self.__add_instr('new', 0, 0)
-        self.__add_instr('map', 0, 0)
+        self.__add_instr('map', 1, 0)
         self.__add_instr('sethndl', 0, 0)
         self.__add_instr('stobj2', self.__get_encoding_id(dict_name), 0)
 
@@ -876,7 +876,7 @@ class BytecodeGenerator(ast.NodeVisitor):
         random_name = self.__get_random_name()
 
         self.__add_instr('new', 0, 0)
-        self.__add_instr('ary', 0, 0)
+        self.__add_instr('ary', 1, 0)
         self.__add_instr('sethndl', 0, 0)
         self.__add_instr('stobj2', self.__get_encoding_id(random_name), 0)
 
@@ -898,7 +898,7 @@ class BytecodeGenerator(ast.NodeVisitor):
         random_name = self.__get_random_name()
 
         self.__add_instr('new', 0, 0)
-        self.__add_instr('ary', 0, 0)
+        self.__add_instr('ary', 1, 0)
         self.__add_instr('sethndl', 0, 0)
         self.__add_instr('stobj2', self.__get_encoding_id(random_name), 0)
 
@@ -37,6 +37,10 @@ namespace dyobj {
 const uint32_t COREVM_DEFAULT_HEAP_SIZE = 1024 * 1024 * 256;
 
 
+// Size of the segment of frozen objects of a heap: 16 MB.
+const uint32_t COREVM_FROZEN_SEGMENT_SIZE = 1024 * 1024 * 16;
+
+
 typedef uint32_t attr_key;
 
 
@@ -34,7 +34,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sneaker/libc/utils.h>
 
 #include <algorithm>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 
 
 namespace corevm {
@@ -56,12 +58,20 @@ public:
   typedef attr_map_type::iterator iterator;
   typedef attr_map_type::const_iterator const_iterator;
 
+  typedef std::unordered_map<dyobj_id_type, dyobj_id_type> ephemeron_map_type;
+
   dynamic_object();
 
   /* Dynamic objects should not be copyable. */
   dynamic_object(const dynamic_object&) = delete;
   dynamic_object& operator=(const dynamic_object&) = delete;
 
+  /**
+   * Takes over the identity and the content of another object, leaving it
+   * with no attributes. Used to relocate objects during heap compaction.
+   */
+  dynamic_object(dynamic_object&&);
+
   ~dynamic_object();
 
   bool operator==(const corevm::dyobj::dynamic_object<dynamic_object_manager>&);
@@ -85,12 +95,27 @@ public:
   void set_ntvhndl_key(corevm::dyobj::ntvhndl_key) noexcept;
   void clear_ntvhndl_key() noexcept;
 
+  /**
+   * Scalar native values are held inline instead of in the native types
+   * pool, as a runtime-defined type and the bits of the value. A type of 0
+   * means that the object holds no inline value.
+   */
+  uint8_t inline_ntvhndl_type() const noexcept;
+  uint64_t inline_ntvhndl_bits() const noexcept;
+  void set_inline_ntvhndl(uint8_t, uint64_t) noexcept;
+  void clear_inline_ntvhndl() noexcept;
+
   bool get_flag(char) const;
   void set_flag(char);
   void clear_flag(char);
 
   bool is_garbage_collectible() const noexcept;
 
+  /**
+   * Whether the object has been moved to the frozen segment of the heap.
+   */
+  bool is_frozen() const noexcept;
+
   uint32_t attr_count() const;
 
   bool hasattr(attr_key_type) const noexcept;
@@ -112,17 +137,76 @@ public:
   template<typename Function>
   void iterate(Function) noexcept;
 
+  /**
+   * Weak attributes refer to objects without keeping them alive, and are
+   * removed by the collection that reclaims the objects they refer to.
+   */
+  bool has_weak_refs() const noexcept;
+
+  uint32_t weakattr_count() const noexcept;
+
+  bool hasweakattr(attr_key_type) const noexcept;
+
+  void putweakattr(attr_key_type, dyobj_id_type) noexcept;
+
+  void delweakattr(attr_key_type)
+    throw(corevm::dyobj::object_attribute_not_found_error);
+
+  dyobj_id_type getweakattr(attr_key_type) const
+    throw(corevm::dyobj::object_attribute_not_found_error);
+
+  /**
+   * Ephemerons map key objects to value objects. A value is reachable through
+   * the ephemeron only while its key is reachable by other means, and the
+   * ephemeron is removed by the collection that reclaims its key.
+   */
+  uint32_t ephemeron_count() const noexcept;
+
+  bool hasephemeron(dyobj_id_type) const noexcept;
+
+  void putephemeron(dyobj_id_type, dyobj_id_type) noexcept;
+
+  void delephemeron(dyobj_id_type)
+    throw(corevm::dyobj::object_attribute_not_found_error);
+
+  dyobj_id_type getephemeron(dyobj_id_type) const
+    throw(corevm::dyobj::object_attribute_not_found_error);
+
+  /* Invokes the function with the key and the value of every ephemeron. */
+  template<typename Function>
+  void iterate_ephemerons(Function) noexcept;
+
+  /**
+   * Removes the weak attributes that refer to objects, and the ephemerons
+   * whose keys, satisfy the predicate. The function is invoked with the value
+   * of every ephemeron removed.
+   */
+  template<typename Predicate, typename Function>
+  void clear_weak_refs(Predicate, Function) noexcept;
+
   void copy_from(const dynamic_object<dynamic_object_manager>&);
 
 private:
   void check_flag_bit(char) const throw(corevm::dyobj::invalid_flag_bit_error);
 
+  /* Allocated on first use, as few objects hold weak references. */
+  struct weak_refs
+  {
+    attr_map_type attrs;
+    ephemeron_map_type ephemerons;
+  };
+
+  weak_refs& mutable_weak_refs() noexcept;
+
   dyobj_id_type m_id;
   corevm::dyobj::flag m_flags;
+  uint8_t m_inline_ntvhndl_type;
   attr_map_type m_attrs;
   dynamic_object_manager m_manager;
   corevm::dyobj::ntvhndl_key m_ntvhndl_key;
+  uint64_t m_inline_ntvhndl_bits;
   corevm::runtime::closure_ctx m_closure_ctx;
+  std::unique_ptr<weak_refs> m_weak_refs;
 };
 
 // -----------------------------------------------------------------------------
@@ -138,15 +222,37 @@ const int COREVM_DYNAMIC_OBJECT_ATTR_MAP_DEFAULT_SIZE = 16;
 template<class dynamic_object_manager>
 corevm::dyobj::dynamic_object<dynamic_object_manager>::dynamic_object():
   m_flags(COREVM_DYNAMIC_OBJECT_DEFAULT_FLAG_VALUE),
+  m_inline_ntvhndl_type(0),
   m_attrs(corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_map_type(
     COREVM_DYNAMIC_OBJECT_ATTR_MAP_DEFAULT_SIZE)
   ),
   m_manager(),
   m_ntvhndl_key(corevm::dyobj::NONESET_NTVHNDL_KEY),
+  m_inline_ntvhndl_bits(0),
   m_closure_ctx(runtime::closure_ctx {
     .compartment_id = runtime::NONESET_COMPARTMENT_ID,
     .closure_id = runtime::NONESET_CLOSURE_ID
-  })
+  }),
+  m_weak_refs()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+corevm::dyobj::dynamic_object<dynamic_object_manager>::dynamic_object(
+  dynamic_object<dynamic_object_manager>&& other)
+  :
+  m_id(other.m_id),
+  m_flags(other.m_flags),
+  m_inline_ntvhndl_type(other.m_inline_ntvhndl_type),
+  m_attrs(std::move(other.m_attrs)),
+  m_manager(other.m_manager),
+  m_ntvhndl_key(other.m_ntvhndl_key),
+  m_inline_ntvhndl_bits(other.m_inline_ntvhndl_bits),
+  m_closure_ctx(other.m_closure_ctx),
+  m_weak_refs(std::move(other.m_weak_refs))
 {
   // Do nothing here.
 }
@@ -282,6 +388,45 @@ corevm::dyobj::dynamic_object<dynamic_object_manager>::clear_ntvhndl_key() noexc
 
 // -----------------------------------------------------------------------------
 
+template<class dynamic_object_manager>
+uint8_t
+corevm::dyobj::dynamic_object<dynamic_object_manager>::inline_ntvhndl_type() const noexcept
+{
+  return m_inline_ntvhndl_type;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+uint64_t
+corevm::dyobj::dynamic_object<dynamic_object_manager>::inline_ntvhndl_bits() const noexcept
+{
+  return m_inline_ntvhndl_bits;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::set_inline_ntvhndl(
+  uint8_t type, uint64_t bits) noexcept
+{
+  m_inline_ntvhndl_type = type;
+  m_inline_ntvhndl_bits = bits;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::clear_inline_ntvhndl() noexcept
+{
+  m_inline_ntvhndl_type = 0;
+  m_inline_ntvhndl_bits = 0;
+}
+
+// -----------------------------------------------------------------------------
+
 template<class dynamic_object_manager>
 void
 corevm::dyobj::dynamic_object<dynamic_object_manager>::check_flag_bit(char bit) const
@@ -331,12 +476,22 @@ corevm::dyobj::dynamic_object<dynamic_object_manager>::is_garbage_collectible()
 {
   return (
     get_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE) == false &&
+    is_frozen() == false &&
     m_manager.garbage_collectible()
   );
 }
 
 // -----------------------------------------------------------------------------
 
+template<class dynamic_object_manager>
+bool
+corevm::dyobj::dynamic_object<dynamic_object_manager>::is_frozen() const noexcept
+{
+  return get_flag(corevm::dyobj::flags::DYOBJ_IS_FROZEN);
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename dynamic_object_manager>
 uint32_t
 corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_count() const
@@ -394,6 +549,7 @@ corevm::dyobj::dynamic_object<dynamic_object_manager>::putattr(
   corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_key_type attr_key,
   corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type obj_id) noexcept
 {
+  m_manager.on_putattr(m_id, obj_id);
   m_attrs[attr_key] = obj_id;
 }
 
@@ -452,6 +608,223 @@ corevm::dyobj::dynamic_object<dynamic_object_manager>::iterate(Function func) no
 
 // -----------------------------------------------------------------------------
 
+template<class dynamic_object_manager>
+typename corevm::dyobj::dynamic_object<dynamic_object_manager>::weak_refs&
+corevm::dyobj::dynamic_object<dynamic_object_manager>::mutable_weak_refs() noexcept
+{
+  if (!m_weak_refs)
+  {
+    m_weak_refs.reset(new weak_refs());
+  }
+
+  return *m_weak_refs;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+bool
+corevm::dyobj::dynamic_object<dynamic_object_manager>::has_weak_refs() const noexcept
+{
+  return m_weak_refs &&
+    (!m_weak_refs->attrs.empty() || !m_weak_refs->ephemerons.empty());
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+uint32_t
+corevm::dyobj::dynamic_object<dynamic_object_manager>::weakattr_count() const noexcept
+{
+  return m_weak_refs ? m_weak_refs->attrs.size() : 0;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+bool
+corevm::dyobj::dynamic_object<dynamic_object_manager>::hasweakattr(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_key_type attr_key) const noexcept
+{
+  return m_weak_refs && m_weak_refs->attrs.find(attr_key) != m_weak_refs->attrs.end();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::putweakattr(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_key_type attr_key,
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type obj_id) noexcept
+{
+  mutable_weak_refs().attrs[attr_key] = obj_id;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::delweakattr(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_key_type attr_key)
+  throw(corevm::dyobj::object_attribute_not_found_error)
+{
+  if (!m_weak_refs || m_weak_refs->attrs.erase(attr_key) != 1)
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(attr_key, id()));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+corevm::dyobj::dyobj_id
+corevm::dyobj::dynamic_object<dynamic_object_manager>::getweakattr(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::attr_key_type attr_key) const
+  throw(corevm::dyobj::object_attribute_not_found_error)
+{
+  if (!m_weak_refs)
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(attr_key, id()));
+  }
+
+  auto itr = m_weak_refs->attrs.find(attr_key);
+
+  if (itr == m_weak_refs->attrs.cend())
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(attr_key, id()));
+  }
+
+  return itr->second;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+uint32_t
+corevm::dyobj::dynamic_object<dynamic_object_manager>::ephemeron_count() const noexcept
+{
+  return m_weak_refs ? m_weak_refs->ephemerons.size() : 0;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+bool
+corevm::dyobj::dynamic_object<dynamic_object_manager>::hasephemeron(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type key) const noexcept
+{
+  return m_weak_refs &&
+    m_weak_refs->ephemerons.find(key) != m_weak_refs->ephemerons.end();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::putephemeron(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type key,
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type value) noexcept
+{
+  m_manager.on_putattr(m_id, value);
+  mutable_weak_refs().ephemerons[key] = value;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::delephemeron(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type key)
+  throw(corevm::dyobj::object_attribute_not_found_error)
+{
+  if (!m_weak_refs || m_weak_refs->ephemerons.erase(key) != 1)
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(
+      static_cast<attr_key_type>(key), id()));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+corevm::dyobj::dyobj_id
+corevm::dyobj::dynamic_object<dynamic_object_manager>::getephemeron(
+  corevm::dyobj::dynamic_object<dynamic_object_manager>::dyobj_id_type key) const
+  throw(corevm::dyobj::object_attribute_not_found_error)
+{
+  if (!m_weak_refs)
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(
+      static_cast<attr_key_type>(key), id()));
+  }
+
+  auto itr = m_weak_refs->ephemerons.find(key);
+
+  if (itr == m_weak_refs->ephemerons.cend())
+  {
+    THROW(corevm::dyobj::object_attribute_not_found_error(
+      static_cast<attr_key_type>(key), id()));
+  }
+
+  return itr->second;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+template<typename Function>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::iterate_ephemerons(
+  Function func) noexcept
+{
+  if (!m_weak_refs)
+  {
+    return;
+  }
+
+  for (const auto& ephemeron : m_weak_refs->ephemerons)
+  {
+    func(ephemeron.first, ephemeron.second);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager>
+template<typename Predicate, typename Function>
+void
+corevm::dyobj::dynamic_object<dynamic_object_manager>::clear_weak_refs(
+  Predicate pred, Function func) noexcept
+{
+  if (!m_weak_refs)
+  {
+    return;
+  }
+
+  auto& attrs = m_weak_refs->attrs;
+  for (auto itr = attrs.begin(); itr != attrs.end();)
+  {
+    itr = pred(itr->second) ? attrs.erase(itr) : std::next(itr);
+  }
+
+  auto& ephemerons = m_weak_refs->ephemerons;
+  for (auto itr = ephemerons.begin(); itr != ephemerons.end();)
+  {
+    if (pred(itr->first))
+    {
+      dyobj_id_type value = itr->second;
+      itr = ephemerons.erase(itr);
+      func(value);
+    }
+    else
+    {
+      ++itr;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 template <class dynamic_object_manager>
 void
 corevm::dyobj::dynamic_object<dynamic_object_manager>::copy_from(
@@ -461,7 +834,11 @@ corevm::dyobj::dynamic_object<dynamic_object_manager>::copy_from(
   m_flags = src.m_flags;
   m_attrs = src.m_attrs;
   m_ntvhndl_key = src.m_ntvhndl_key;
+  m_inline_ntvhndl_type = src.m_inline_ntvhndl_type;
+  m_inline_ntvhndl_bits = src.m_inline_ntvhndl_bits;
   m_closure_ctx = src.m_closure_ctx;
+  // Weak references are deliberately left out, as the copy is not known to
+  // the collector as a holder of weak references.
 }
 
 // -----------------------------------------------------------------------------
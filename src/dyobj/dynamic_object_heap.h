@@ -28,7 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "dyobj/dyobj_id.h"
 #include "dyobj/dynamic_object.h"
 #include "dyobj/errors.h"
+#include "dyobj/flags.h"
 #include "dyobj/heap_allocator.h"
+#include "memory/allocation_stats.h"
+#include "memory/allocation_trace.h"
 #include "memory/errors.h"
 #include "memory/object_container.h"
 #include "memory/sequential_allocation_scheme.h"
@@ -37,9 +40,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstdint>
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 
 namespace corevm {
@@ -48,7 +54,13 @@ namespace corevm {
 namespace dyobj {
 
 
-template<class dynamic_object_manager>
+/**
+ * Without a handle table, the ids of objects are derived from their
+ * addresses by `id_scheme`, which is chosen at compile time.
+ * See `corevm::dyobj::compressed_id_scheme` for 32-bit ids.
+ */
+template<class dynamic_object_manager,
+  class id_scheme=corevm::dyobj::default_id_scheme>
 class dynamic_object_heap
 {
 public:
@@ -58,12 +70,22 @@ public:
   using allocator_type = typename corevm::dyobj::heap_allocator<dynamic_object_type, corevm::memory::first_fit_allocation_scheme>;
   using dynamic_object_container_type = typename corevm::memory::object_container<dynamic_object_type, allocator_type>;
 
+  /* Frozen objects are never freed, so allocations resume where they left off. */
+  using frozen_allocator_type = typename corevm::dyobj::heap_allocator<dynamic_object_type, corevm::memory::next_fit_allocation_scheme>;
+  using frozen_object_container_type = typename corevm::memory::object_container<dynamic_object_type, frozen_allocator_type>;
+
   static_assert(
     std::numeric_limits<typename dynamic_object_container_type::size_type>::max() >=
     std::numeric_limits<corevm::dyobj::dyobj_id>::max(),
     "Dynamic object heap incompatibility"
   );
 
+  static_assert(
+    !id_scheme::requires_wide_ids ||
+    sizeof(corevm::dyobj::dyobj_id) >= sizeof(void*),
+    "Id scheme requires ids as wide as pointers"
+  );
+
   using reference           = typename dynamic_object_container_type::reference;
   using const_reference     = typename dynamic_object_container_type::const_reference;
   using pointer             = typename dynamic_object_container_type::pointer;
@@ -73,8 +95,25 @@ public:
   using size_type           = typename dynamic_object_container_type::size_type;
   using difference_type     = typename dynamic_object_container_type::difference_type;
 
+  enum flags : uint32_t
+  {
+    /**
+     * Ids index a table of object pointers instead of being the objects'
+     * addresses, which lets `compact()` move objects.
+     */
+    HEAP_USE_HANDLE_TABLE = 0x01,
+
+    /**
+     * Newly created objects are recorded in a nursery until the collector
+     * promotes them, so that minor collections only sweep young objects.
+     */
+    HEAP_GENERATIONAL = 0x02
+  };
+
   dynamic_object_heap();
   explicit dynamic_object_heap(uint64_t);
+  dynamic_object_heap(uint64_t, uint64_t, uint32_t);
+  dynamic_object_heap(uint64_t, uint64_t, uint32_t, uint32_t);
   ~dynamic_object_heap();
 
   /* Dynamic object heap should not be copyable. */
@@ -89,6 +128,96 @@ public:
 
   size_type active_size() const noexcept;
 
+  uint64_t committed_size() const noexcept;
+
+  /**
+   * Gives the pages spanned by free blocks back to the OS.
+   * Returns the number of bytes released.
+   */
+  uint64_t release_free_memory() noexcept;
+
+  /**
+   * Bytes freed since free memory was last released.
+   */
+  uint64_t reclaimable_size() const noexcept;
+
+  corevm::memory::allocation_stats stats() const noexcept;
+
+  void set_allocation_trace(corevm::memory::allocation_trace*) noexcept;
+
+  bool uses_handle_table() const noexcept;
+
+  /**
+   * Slides live objects towards the bottom of the heap so that free space
+   * becomes contiguous. Only has an effect with a handle table.
+   *
+   * Returns the number of objects moved.
+   */
+  size_type compact() noexcept;
+
+  bool generational() const noexcept;
+
+  /**
+   * Ids of the objects created since the nursery was last cleared, in the
+   * order of creation. Always empty unless the heap is generational.
+   *
+   * Erasing objects does not remove them from the nursery; collectors clear
+   * the nursery once they have swept it.
+   */
+  const std::vector<dynamic_object_id_type>& nursery() const noexcept;
+
+  void clear_nursery() noexcept;
+
+  /**
+   * Records that the object with the specified id holds weak references, so
+   * that collectors can clear them without visiting the whole heap.
+   */
+  void add_weak_ref_holder(dynamic_object_id_type);
+
+  size_type weak_ref_holder_count() const noexcept;
+
+  /**
+   * Invokes the function with every recorded holder that still holds weak
+   * references, and forgets the holders that no longer do. The function must
+   * not erase objects from the heap.
+   */
+  template<typename Function>
+  void iterate_weak_ref_holders(Function);
+
+  /**
+   * Records that the native handle of the object with the specified id holds
+   * object ids, so that reference counting collectors can trace them without
+   * visiting the whole heap.
+   */
+  void add_ntvhndl_holder(dynamic_object_id_type);
+
+  size_type ntvhndl_holder_count() const noexcept;
+
+  /**
+   * Invokes the function with every recorded holder that still has a native
+   * handle, and forgets the holders that no longer do. The function must not
+   * erase objects from the heap.
+   */
+  template<typename Function>
+  void iterate_ntvhndl_holders(Function);
+
+  /**
+   * Freezes the object with the specified id, which collectors then neither
+   * trace, sweep nor count. Callers must make sure that the object is
+   * immutable, and that it only refers to frozen objects.
+   *
+   * With a handle table, the object is moved out of the heap into a
+   * separate segment, so that it is no longer visited by iterating the heap.
+   * Otherwise, or once the segment is full, it is frozen in place.
+   */
+  void freeze(dynamic_object_id_type)
+    throw(corevm::dyobj::object_not_found_error);
+
+  /**
+   * Number of objects frozen, including the ones frozen in place.
+   */
+  size_type frozen_size() const noexcept;
+
   void erase(iterator);
 
   void erase(dynamic_object_id_type id);
@@ -99,80 +228,376 @@ public:
   iterator end() noexcept;
   const_iterator cend() const noexcept;
 
+  /**
+   * Iterator to the first object at or above the specified address, which
+   * need not be the address of an object on the heap.
+   */
+  iterator lower_bound(const dynamic_object_type*) noexcept;
+
   template<typename Function>
   void iterate(Function) noexcept;
 
   dynamic_object_type& at(const dynamic_object_id_type)
     throw(corevm::dyobj::object_not_found_error);
 
+  /**
+   * Returns the object with the specified id, or `nullptr` if there is none.
+   */
+  dynamic_object_type* find(const dynamic_object_id_type) noexcept;
+
   dynamic_object_id_type create_dyobj()
     throw(corevm::dyobj::object_creation_error);
 
 private:
+  dynamic_object_type* handle_to_ptr(dynamic_object_id_type) const noexcept;
+
+  void release_handle(dynamic_object_id_type) noexcept;
+
   dynamic_object_container_type m_container;
+  bool m_use_handle_table;
+  std::vector<dynamic_object_type*> m_handles;
+  std::vector<dynamic_object_id_type> m_free_handles;
+  bool m_generational;
+  std::vector<dynamic_object_id_type> m_nursery;
+  std::unordered_set<dynamic_object_id_type> m_weak_ref_holders;
+  std::unordered_set<dynamic_object_id_type> m_ntvhndl_holders;
+  std::unique_ptr<frozen_object_container_type> m_frozen_container;
+  size_type m_frozen_size;
 };
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_heap()
+template<class dynamic_object_manager, class id_scheme>
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_heap()
   :
-  m_container(COREVM_DEFAULT_HEAP_SIZE)
+  m_container(COREVM_DEFAULT_HEAP_SIZE),
+  m_use_handle_table(false),
+  m_handles(),
+  m_free_handles(),
+  m_generational(false),
+  m_nursery(),
+  m_weak_ref_holders(),
+  m_ntvhndl_holders(),
+  m_frozen_container(),
+  m_frozen_size(0)
 {
   // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_heap(
+template<class dynamic_object_manager, class id_scheme>
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_heap(
   uint64_t total_size)
   :
-  m_container(total_size)
+  m_container(total_size),
+  m_use_handle_table(false),
+  m_handles(),
+  m_free_handles(),
+  m_generational(false),
+  m_nursery(),
+  m_weak_ref_holders(),
+  m_ntvhndl_holders(),
+  m_frozen_container(),
+  m_frozen_size(0)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_heap(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
+  m_container(total_size, max_total_size, arena_flags),
+  m_use_handle_table(false),
+  m_handles(),
+  m_free_handles(),
+  m_generational(false),
+  m_nursery(),
+  m_weak_ref_holders(),
+  m_ntvhndl_holders(),
+  m_frozen_container(),
+  m_frozen_size(0)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_heap(
+  uint64_t total_size,
+  uint64_t max_total_size,
+  uint32_t arena_flags,
+  uint32_t heap_flags)
+  :
+  m_container(total_size, max_total_size, arena_flags),
+  m_use_handle_table(heap_flags & HEAP_USE_HANDLE_TABLE),
+  m_handles(),
+  m_free_handles(),
+  m_generational(heap_flags & HEAP_GENERATIONAL),
+  m_nursery(),
+  m_weak_ref_holders(),
+  m_ntvhndl_holders(),
+  m_frozen_container(),
+  m_frozen_size(0)
 {
   // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::~dynamic_object_heap()
+template<class dynamic_object_manager, class id_scheme>
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::~dynamic_object_heap()
 {
   // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::size_type
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::size() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size() const noexcept
 {
   return m_container.size();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::size_type
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::max_size() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::max_size() const noexcept
 {
   return m_container.max_size();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::size_type
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::total_size() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::total_size() const noexcept
 {
   return m_container.total_size();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::size_type
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::active_size() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+uint64_t
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::committed_size() const noexcept
+{
+  return m_container.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+uint64_t
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::release_free_memory() noexcept
+{
+  return m_container.release_free_memory();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+uint64_t
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::reclaimable_size() const noexcept
+{
+  return m_container.reclaimable_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+corevm::memory::allocation_stats
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::stats() const noexcept
+{
+  return m_container.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::set_allocation_trace(
+  corevm::memory::allocation_trace* trace) noexcept
+{
+  m_container.set_trace(trace);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+bool
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::uses_handle_table() const noexcept
+{
+  return m_use_handle_table;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::compact() noexcept
+{
+  if (!m_use_handle_table)
+  {
+    return 0;
+  }
+
+  return m_container.compact(
+    [this](dynamic_object_type* /* from */, dynamic_object_type* to) {
+      m_handles[to->id() - 1] = to;
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+bool
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::generational() const noexcept
+{
+  return m_generational;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+const std::vector<typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_id_type>&
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::nursery() const noexcept
+{
+  return m_nursery;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::clear_nursery() noexcept
+{
+  m_nursery.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::add_weak_ref_holder(
+  dynamic_object_id_type id)
+{
+  m_weak_ref_holders.insert(id);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::weak_ref_holder_count() const noexcept
+{
+  return m_weak_ref_holders.size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+template<typename Function>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterate_weak_ref_holders(
+  Function func)
+{
+  for (auto itr = m_weak_ref_holders.begin(); itr != m_weak_ref_holders.end();)
+  {
+    dynamic_object_type* obj = find(*itr);
+
+    if (obj == nullptr || !obj->has_weak_refs())
+    {
+      itr = m_weak_ref_holders.erase(itr);
+      continue;
+    }
+
+    func(*obj);
+    ++itr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::add_ntvhndl_holder(
+  dynamic_object_id_type id)
+{
+  m_ntvhndl_holders.insert(id);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::ntvhndl_holder_count() const noexcept
+{
+  return m_ntvhndl_holders.size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+template<typename Function>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterate_ntvhndl_holders(
+  Function func)
+{
+  for (auto itr = m_ntvhndl_holders.begin(); itr != m_ntvhndl_holders.end();)
+  {
+    dynamic_object_type* obj = find(*itr);
+
+    if (obj == nullptr ||
+        obj->ntvhndl_key() == corevm::dyobj::NONESET_NTVHNDL_KEY)
+    {
+      itr = m_ntvhndl_holders.erase(itr);
+      continue;
+    }
+
+    func(*obj);
+    ++itr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_type*
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::handle_to_ptr(
+  dynamic_object_id_type id) const noexcept
+{
+  if (id == 0 || id > m_handles.size())
+  {
+    return nullptr;
+  }
+
+  return m_handles[id - 1];
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::release_handle(
+  dynamic_object_id_type id) noexcept
+{
+  m_handles[id - 1] = nullptr;
+  m_free_handles.push_back(id);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::active_size() const noexcept
 {
   return std::count_if(
     cbegin(),
@@ -185,20 +610,97 @@ corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::active_size() const
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
+template<class dynamic_object_manager, class id_scheme>
+void
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::freeze(
+  dynamic_object_id_type id) throw(corevm::dyobj::object_not_found_error)
+{
+  dynamic_object_type& object = at(id);
+
+  if (object.is_frozen())
+  {
+    return;
+  }
+
+  object.set_flag(corevm::dyobj::flags::DYOBJ_IS_FROZEN);
+  ++m_frozen_size;
+
+  if (!m_use_handle_table)
+  {
+    return;
+  }
+
+  if (!m_frozen_container)
+  {
+    m_frozen_container.reset(
+      new frozen_object_container_type(COREVM_FROZEN_SEGMENT_SIZE));
+  }
+
+  dynamic_object_type* frozen_ptr = m_frozen_container->create(std::move(object));
+
+  if (frozen_ptr == nullptr)
+  {
+    return;
+  }
+
+  m_container.destroy(&object);
+  m_handles[id - 1] = frozen_ptr;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::size_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::frozen_size() const noexcept
+{
+  return m_frozen_size;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
 void
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::erase(iterator pos)
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::erase(iterator pos)
 {
+  if (pos != end())
+  {
+    m_weak_ref_holders.erase(pos->id());
+    m_ntvhndl_holders.erase(pos->id());
+
+    if (m_use_handle_table)
+    {
+      release_handle(pos->id());
+    }
+  }
+
   m_container.erase(pos);
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
+template<class dynamic_object_manager, class id_scheme>
 void
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::erase(dynamic_object_id_type id)
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::erase(dynamic_object_id_type id)
 {
-  void* raw_ptr = corevm::dyobj::obj_id_to_ptr(id);
+  m_weak_ref_holders.erase(id);
+  m_ntvhndl_holders.erase(id);
+
+  if (m_use_handle_table)
+  {
+    dynamic_object_type* ptr = handle_to_ptr(id);
+
+    if (ptr == nullptr)
+    {
+      THROW(corevm::memory::invalid_address_error(id));
+    }
+
+    m_container.destroy(ptr);
+    release_handle(id);
+
+    return;
+  }
+
+  void* raw_ptr = id_scheme::id_to_ptr(id, m_container.base_addr());
   dynamic_object_type* ptr = static_cast<dynamic_object_type*>(raw_ptr);
 
   ptr = m_container.at(ptr);
@@ -208,46 +710,56 @@ corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::erase(dynamic_object
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::iterator
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::begin() noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterator
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::begin() noexcept
 {
   return m_container.begin();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::const_iterator
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::cbegin() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::const_iterator
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::cbegin() const noexcept
 {
   return m_container.cbegin();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::iterator
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::end() noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterator
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::end() noexcept
 {
   return m_container.end();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::const_iterator
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::cend() const noexcept
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterator
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::lower_bound(
+  const dynamic_object_type* ptr) noexcept
+{
+  return m_container.lower_bound(ptr);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::const_iterator
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::cend() const noexcept
 {
   return m_container.cend();
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
+template<class dynamic_object_manager, class id_scheme>
 template<typename Function>
 void
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::iterate(Function func) noexcept
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::iterate(Function func) noexcept
 {
   std::for_each(
     begin(),
@@ -260,16 +772,13 @@ corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::iterate(Function fun
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_type&
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::at(
-  const corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_id_type id)
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_type&
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::at(
+  const corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_id_type id)
   throw(corevm::dyobj::object_not_found_error)
 {
-  void* raw_ptr = corevm::dyobj::obj_id_to_ptr(id);
-  dynamic_object_type* ptr = static_cast<dynamic_object_type*>(raw_ptr);
-
-  ptr = m_container[ptr];
+  dynamic_object_type* ptr = this->find(id);
 
   if (ptr == nullptr)
   {
@@ -281,9 +790,25 @@ corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::at(
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
-typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_id_type
-corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::create_dyobj()
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_type*
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::find(
+  const corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_id_type id) noexcept
+{
+  if (m_use_handle_table)
+  {
+    return handle_to_ptr(id);
+  }
+
+  void* raw_ptr = id_scheme::id_to_ptr(id, m_container.base_addr());
+  return m_container[static_cast<dynamic_object_type*>(raw_ptr)];
+}
+
+// -----------------------------------------------------------------------------
+
+template<class dynamic_object_manager, class id_scheme>
+typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_id_type
+corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::create_dyobj()
   throw(corevm::dyobj::object_creation_error)
 {
   auto obj_ptr = m_container.create();
@@ -293,20 +818,54 @@ corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::create_dyobj()
     THROW(corevm::dyobj::object_creation_error());
   }
 
-  auto id = corevm::dyobj::obj_ptr_to_id(obj_ptr);
+  dynamic_object_id_type id = 0;
+
+  if (m_use_handle_table)
+  {
+    if (m_free_handles.empty())
+    {
+      m_handles.push_back(obj_ptr);
+      id = m_handles.size();
+    }
+    else
+    {
+      id = m_free_handles.back();
+      m_free_handles.pop_back();
+      m_handles[id - 1] = obj_ptr;
+    }
+  }
+  else
+  {
+    const uint64_t base = m_container.base_addr();
+    const uint64_t end = static_cast<uint64_t>(
+      (uint8_t*)(obj_ptr + 1) - (uint8_t*)(0));
+
+    if (end - base > id_scheme::MAX_HEAP_SIZE)
+    {
+      m_container.destroy(obj_ptr);
+      THROW(corevm::dyobj::object_creation_error());
+    }
+
+    id = id_scheme::ptr_to_id(obj_ptr, base);
+  }
 
   obj_ptr->set_id(id);
 
+  if (m_generational)
+  {
+    m_nursery.push_back(id);
+  }
+
   return id;
 }
 
 // -----------------------------------------------------------------------------
 
-template<class dynamic_object_manager>
+template<class dynamic_object_manager, class id_scheme>
 std::ostream&
-operator<<(std::ostream& ost, const corevm::dyobj::dynamic_object_heap<dynamic_object_manager>& heap)
+operator<<(std::ostream& ost, const corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>& heap)
 {
-  using T = typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager>::dynamic_object_type;
+  using T = typename corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme>::dynamic_object_type;
 
   ost << "Dynamic object heap: ";
   ost << heap.size() << "/" << heap.max_size();
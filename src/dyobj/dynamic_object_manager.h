@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_DYNAMIC_OBJECT_MANAGER_H_
 #define COREVM_DYNAMIC_OBJECT_MANAGER_H_
 
+#include "dyobj_id.h"
+
 
 namespace corevm {
 
@@ -62,6 +64,13 @@ public:
    * Invoked when the associated object is exiting the containing scope.
    */
   virtual void on_exit() noexcept = 0;
+
+  /**
+   * Invoked when the object specified second is being set as an attribute of
+   * the associated object, whose id is specified first. Serves as the write
+   * barrier of incremental and generational collectors.
+   */
+  virtual void on_putattr(corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id) noexcept = 0;
 };
 
 
@@ -34,14 +34,35 @@ namespace corevm {
 namespace dyobj {
 
 
+/**
+ * Object ids are 64 bits wide by default. Defining `COREVM_COMPRESSED_REFS`
+ * at build time narrows them to 32 bits, which halves the space taken by
+ * every reference held in attributes, frames and stacks. Heaps then hand
+ * out compressed ids by default (see `compressed_id_scheme` below).
+ */
+#ifndef COREVM_COMPRESSED_REFS
+  #define COREVM_COMPRESSED_REFS 0
+#endif
+
+#if COREVM_COMPRESSED_REFS
+typedef uint32_t dyobj_id;
+
+
+const uint64_t DYOBJ_LIMIT = UINT_MAX;
+#else
 typedef uint64_t dyobj_id;
 
 
 const uint64_t DYOBJ_LIMIT = ULLONG_MAX;
+#endif
 
 
 // -----------------------------------------------------------------------------
 
+/**
+ * By default an object's id is its address. Heaps that use a handle table
+ * instead hand out ids that index the table, starting from 1.
+ */
 inline dyobj_id obj_ptr_to_id(void* ptr)
 {
   return static_cast<dyobj_id>( (uint8_t*)(ptr) - (uint8_t*)(0) );
@@ -56,6 +77,139 @@ inline void* obj_id_to_ptr(dyobj_id id)
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Id schemes translate between the addresses of objects and the ids that
+ * heaps hand out for them, given the base address of the heap.
+ *
+ * The address scheme uses the addresses themselves, so it needs ids that are
+ * as wide as pointers.
+ */
+struct address_id_scheme
+{
+  static const bool requires_wide_ids = true;
+
+  static const uint64_t MAX_HEAP_SIZE = ULLONG_MAX;
+
+  inline static dyobj_id ptr_to_id(void* ptr, uint64_t /* base */)
+  {
+    return obj_ptr_to_id(ptr);
+  }
+
+  inline static void* id_to_ptr(dyobj_id id, uint64_t /* base */)
+  {
+    return obj_id_to_ptr(id);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * The compressed scheme hands out offsets from the base of the heap, in units
+ * of the object alignment, plus one so that 0 is never a valid id. Ids fit
+ * in 31 bits for heaps of up to `MAX_HEAP_SIZE` bytes (16 GB), and are
+ * decoded with a shift and an add.
+ */
+struct compressed_id_scheme
+{
+  static const bool requires_wide_ids = false;
+
+  static const uint32_t ALIGNMENT_SHIFT = 3;
+
+  static const uint64_t MAX_HEAP_SIZE =
+    static_cast<uint64_t>(INT_MAX) << ALIGNMENT_SHIFT;
+
+  inline static dyobj_id ptr_to_id(void* ptr, uint64_t base)
+  {
+    const uint64_t offset =
+      static_cast<uint64_t>((uint8_t*)(ptr) - (uint8_t*)(0)) - base;
+    return static_cast<dyobj_id>((offset >> ALIGNMENT_SHIFT) + 1);
+  }
+
+  inline static void* id_to_ptr(dyobj_id id, uint64_t base)
+  {
+    const uint64_t offset =
+      (static_cast<uint64_t>(id) - 1) << ALIGNMENT_SHIFT;
+    return reinterpret_cast<void*>(base + offset);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Ids with the top bit set are immediate values instead of references to
+ * objects: small integers, booleans and None, which then need no object at
+ * all. The two bits below the top bit hold the kind of the value, and the
+ * remaining bits the value itself.
+ *
+ * The top bit is used, rather than the low bits, because ids handed out
+ * through a handle table or by the compressed scheme can be odd. Neither
+ * scheme, nor user space addresses, ever reach the top bit.
+ */
+enum immediate_kind : uint8_t
+{
+  IMMEDIATE_INT = 0,
+  IMMEDIATE_BOOL = 1,
+  IMMEDIATE_NONE = 2
+};
+
+// -----------------------------------------------------------------------------
+
+const uint32_t IMMEDIATE_VALUE_BITS = sizeof(dyobj_id) * CHAR_BIT - 3;
+
+const dyobj_id IMMEDIATE_BIT = static_cast<dyobj_id>(1) << (IMMEDIATE_VALUE_BITS + 2);
+
+const dyobj_id IMMEDIATE_VALUE_MASK = (static_cast<dyobj_id>(1) << IMMEDIATE_VALUE_BITS) - 1;
+
+const int64_t IMMEDIATE_INT_MAX = (static_cast<int64_t>(1) << (IMMEDIATE_VALUE_BITS - 1)) - 1;
+
+const int64_t IMMEDIATE_INT_MIN = -IMMEDIATE_INT_MAX - 1;
+
+// -----------------------------------------------------------------------------
+
+inline bool is_immediate(dyobj_id id)
+{
+  return (id & IMMEDIATE_BIT) != 0;
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Integers must be within `IMMEDIATE_INT_MIN` and `IMMEDIATE_INT_MAX`.
+ */
+inline dyobj_id make_immediate(immediate_kind kind, int64_t value)
+{
+  return IMMEDIATE_BIT |
+    (static_cast<dyobj_id>(kind) << IMMEDIATE_VALUE_BITS) |
+    (static_cast<dyobj_id>(value) & IMMEDIATE_VALUE_MASK);
+}
+
+// -----------------------------------------------------------------------------
+
+inline immediate_kind get_immediate_kind(dyobj_id id)
+{
+  return static_cast<immediate_kind>((id >> IMMEDIATE_VALUE_BITS) & 0x03);
+}
+
+// -----------------------------------------------------------------------------
+
+inline int64_t get_immediate_value(dyobj_id id)
+{
+  // Shifts the value to the top so that shifting it back extends its sign.
+  const uint32_t shift = 64 - IMMEDIATE_VALUE_BITS;
+  return static_cast<int64_t>(
+    static_cast<uint64_t>(id & IMMEDIATE_VALUE_MASK) << shift) >> shift;
+}
+
+// -----------------------------------------------------------------------------
+
+#if COREVM_COMPRESSED_REFS
+typedef compressed_id_scheme default_id_scheme;
+#else
+typedef address_id_scheme default_id_scheme;
+#endif
+
+// -----------------------------------------------------------------------------
+
 } /* end namespace dyobj */
 
 
@@ -53,6 +53,14 @@ enum flags : uint32_t
 
   DYOBJ_IS_IMMUTABLE,
 
+  /* ---------------- Bits that are managed by the runtime ------------------ */
+
+  /**
+   * Set on the objects moved to the frozen segment of the heap, which are
+   * neither traced, swept nor counted by the garbage collector.
+   */
+  DYOBJ_IS_FROZEN,
+
   /* ------------------------ Max value allowed ----------------------------- */
 
   DYOBJ_MAX_VALUE = 32,
@@ -71,6 +79,7 @@ DYOBJ_FLAG_VALUES_ARRAY {
   "DYOBJ_IS_INDELIBLE",
   "DYOBJ_IS_NON_CALLABLE",
   "DYOBJ_IS_IMMUTABLE",
+  "DYOBJ_IS_FROZEN",
 };
 
 // -----------------------------------------------------------------------------
@@ -57,6 +57,7 @@ public:
 
   heap_allocator();
   explicit heap_allocator(uint64_t);
+  heap_allocator(uint64_t, uint64_t, uint32_t);
   ~heap_allocator();
 
   heap_allocator(heap_allocator const&);
@@ -88,6 +89,17 @@ corevm::dyobj::heap_allocator<T, AllocationScheme>::heap_allocator(
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocationScheme>
+corevm::dyobj::heap_allocator<T, AllocationScheme>::heap_allocator(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
+  AllocationPolicyType(total_size, max_total_size, arena_flags)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocationScheme>
 corevm::dyobj::heap_allocator<T, AllocationScheme>::~heap_allocator()
 {
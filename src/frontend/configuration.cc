@@ -53,6 +53,69 @@ const std::string corevm::frontend::configuration::schema = \
       "},"
       "\"gc-interval\": {"
         "\"type\": \"integer\""
+      "},"
+      "\"max-heap-alloc-size\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"max-pool-alloc-size\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"arena-huge-pages\": {"
+        "\"type\": \"boolean\""
+      "},"
+      "\"arena-prefault\": {"
+        "\"type\": \"boolean\""
+      "},"
+      "\"alloc-stats-output\": {"
+        "\"type\": \"string\""
+      "},"
+      "\"alloc-trace-output\": {"
+        "\"type\": \"string\""
+      "},"
+      "\"heap-handle-table\": {"
+        "\"type\": \"boolean\""
+      "},"
+      "\"gc-slice-budget\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-slice-interval\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-stats-output\": {"
+        "\"type\": \"string\""
+      "},"
+      "\"gc-nursery-size\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-mark-threads\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-sweep-chunk-size\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-flag\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-allocation-interval\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-log-output\": {"
+        "\"type\": \"string\""
+      "},"
+      "\"gc-heap-growth-percent\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-min-threshold\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-target-cpu-percent\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"gc-pause-budget-us\": {"
+        "\"type\": \"integer\""
+      "},"
+      "\"max-native-payload-size\": {"
+        "\"type\": \"integer\""
       "}"
     "}"
   "}";
@@ -63,7 +126,28 @@ corevm::frontend::configuration::configuration()
   :
   m_heap_alloc_size(0),
   m_pool_alloc_size(0),
-  m_gc_interval(0)
+  m_gc_interval(0),
+  m_max_heap_alloc_size(0),
+  m_max_pool_alloc_size(0),
+  m_arena_huge_pages(false),
+  m_arena_prefault(false),
+  m_alloc_stats_output(),
+  m_alloc_trace_output(),
+  m_heap_handle_table(false),
+  m_gc_slice_budget(0),
+  m_gc_slice_interval(0),
+  m_gc_stats_output(),
+  m_gc_nursery_size(0),
+  m_gc_mark_threads(0),
+  m_gc_sweep_chunk_size(0),
+  m_gc_flag(0),
+  m_gc_allocation_interval(0),
+  m_gc_log_output(),
+  m_gc_heap_growth_percent(0),
+  m_gc_min_threshold(0),
+  m_gc_target_cpu_percent(0),
+  m_gc_pause_budget(0),
+  m_max_native_payload_size(0)
 {
 }
 
@@ -93,6 +177,174 @@ corevm::frontend::configuration::gc_interval() const
 
 // -----------------------------------------------------------------------------
 
+uint64_t
+corevm::frontend::configuration::max_heap_alloc_size() const
+{
+  return m_max_heap_alloc_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::frontend::configuration::max_pool_alloc_size() const
+{
+  return m_max_pool_alloc_size;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::frontend::configuration::arena_huge_pages() const
+{
+  return m_arena_huge_pages;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::frontend::configuration::arena_prefault() const
+{
+  return m_arena_prefault;
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string&
+corevm::frontend::configuration::alloc_stats_output() const
+{
+  return m_alloc_stats_output;
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string&
+corevm::frontend::configuration::alloc_trace_output() const
+{
+  return m_alloc_trace_output;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::frontend::configuration::heap_handle_table() const
+{
+  return m_heap_handle_table;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_slice_budget() const
+{
+  return m_gc_slice_budget;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_slice_interval() const
+{
+  return m_gc_slice_interval;
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string&
+corevm::frontend::configuration::gc_stats_output() const
+{
+  return m_gc_stats_output;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_nursery_size() const
+{
+  return m_gc_nursery_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_mark_threads() const
+{
+  return m_gc_mark_threads;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_sweep_chunk_size() const
+{
+  return m_gc_sweep_chunk_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_flag() const
+{
+  return m_gc_flag;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_allocation_interval() const
+{
+  return m_gc_allocation_interval;
+}
+
+// -----------------------------------------------------------------------------
+
+const std::string&
+corevm::frontend::configuration::gc_log_output() const
+{
+  return m_gc_log_output;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_heap_growth_percent() const
+{
+  return m_gc_heap_growth_percent;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::frontend::configuration::gc_min_threshold() const
+{
+  return m_gc_min_threshold;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_target_cpu_percent() const
+{
+  return m_gc_target_cpu_percent;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::frontend::configuration::gc_pause_budget() const
+{
+  return m_gc_pause_budget;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::frontend::configuration::max_native_payload_size() const
+{
+  return m_max_native_payload_size;
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::frontend::configuration::set_heap_alloc_size(uint64_t heap_alloc_size)
 {
@@ -117,6 +369,181 @@ corevm::frontend::configuration::set_gc_interval(uint32_t gc_interval)
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::frontend::configuration::set_max_heap_alloc_size(
+  uint64_t max_heap_alloc_size)
+{
+  m_max_heap_alloc_size = max_heap_alloc_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_max_pool_alloc_size(
+  uint64_t max_pool_alloc_size)
+{
+  m_max_pool_alloc_size = max_pool_alloc_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_arena_huge_pages(bool arena_huge_pages)
+{
+  m_arena_huge_pages = arena_huge_pages;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_arena_prefault(bool arena_prefault)
+{
+  m_arena_prefault = arena_prefault;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_alloc_stats_output(
+  const std::string& alloc_stats_output)
+{
+  m_alloc_stats_output = alloc_stats_output;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_alloc_trace_output(
+  const std::string& alloc_trace_output)
+{
+  m_alloc_trace_output = alloc_trace_output;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_heap_handle_table(bool heap_handle_table)
+{
+  m_heap_handle_table = heap_handle_table;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_slice_budget(uint32_t gc_slice_budget)
+{
+  m_gc_slice_budget = gc_slice_budget;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_slice_interval(uint32_t gc_slice_interval)
+{
+  m_gc_slice_interval = gc_slice_interval;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_stats_output(
+  const std::string& gc_stats_output)
+{
+  m_gc_stats_output = gc_stats_output;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_nursery_size(uint32_t gc_nursery_size)
+{
+  m_gc_nursery_size = gc_nursery_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_mark_threads(uint32_t gc_mark_threads)
+{
+  m_gc_mark_threads = gc_mark_threads;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_sweep_chunk_size(uint32_t gc_sweep_chunk_size)
+{
+  m_gc_sweep_chunk_size = gc_sweep_chunk_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_flag(uint32_t gc_flag)
+{
+  m_gc_flag = gc_flag;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_allocation_interval(uint32_t gc_allocation_interval)
+{
+  m_gc_allocation_interval = gc_allocation_interval;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_log_output(
+  const std::string& gc_log_output)
+{
+  m_gc_log_output = gc_log_output;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_heap_growth_percent(uint32_t gc_heap_growth_percent)
+{
+  m_gc_heap_growth_percent = gc_heap_growth_percent;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_min_threshold(uint64_t gc_min_threshold)
+{
+  m_gc_min_threshold = gc_min_threshold;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_target_cpu_percent(uint32_t gc_target_cpu_percent)
+{
+  m_gc_target_cpu_percent = gc_target_cpu_percent;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_gc_pause_budget(uint32_t gc_pause_budget)
+{
+  m_gc_pause_budget = gc_pause_budget;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::frontend::configuration::set_max_native_payload_size(
+  uint64_t max_native_payload_size)
+{
+  m_max_native_payload_size = max_native_payload_size;
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::frontend::configuration
 corevm::frontend::configuration::load_config(const std::string& path)
   throw(corevm::frontend::configuration_loading_error)
@@ -222,6 +649,181 @@ corevm::frontend::configuration::set_values(
       static_cast<uint32_t>(gc_interval_raw.int_value());
     configuration.set_gc_interval(gc_interval);
   }
+
+  // Max heap alloc size.
+  if (config_obj.find("max-heap-alloc-size") != config_obj.end())
+  {
+    JSON max_heap_alloc_size_raw = config_obj.at("max-heap-alloc-size");
+    uint64_t max_heap_alloc_size = \
+      static_cast<uint64_t>(max_heap_alloc_size_raw.int_value());
+    configuration.set_max_heap_alloc_size(max_heap_alloc_size);
+  }
+
+  // Max ntv hndl pool alloc size.
+  if (config_obj.find("max-pool-alloc-size") != config_obj.end())
+  {
+    JSON max_pool_alloc_size_raw = config_obj.at("max-pool-alloc-size");
+    uint64_t max_pool_alloc_size = \
+      static_cast<uint64_t>(max_pool_alloc_size_raw.int_value());
+    configuration.set_max_pool_alloc_size(max_pool_alloc_size);
+  }
+
+  // Arena transparent huge pages.
+  if (config_obj.find("arena-huge-pages") != config_obj.end())
+  {
+    JSON arena_huge_pages_raw = config_obj.at("arena-huge-pages");
+    configuration.set_arena_huge_pages(arena_huge_pages_raw.bool_value());
+  }
+
+  // Arena prefaulting.
+  if (config_obj.find("arena-prefault") != config_obj.end())
+  {
+    JSON arena_prefault_raw = config_obj.at("arena-prefault");
+    configuration.set_arena_prefault(arena_prefault_raw.bool_value());
+  }
+
+  // Allocation statistics output path.
+  if (config_obj.find("alloc-stats-output") != config_obj.end())
+  {
+    JSON alloc_stats_output_raw = config_obj.at("alloc-stats-output");
+    configuration.set_alloc_stats_output(alloc_stats_output_raw.string_value());
+  }
+
+  // Allocation trace output path prefix.
+  if (config_obj.find("alloc-trace-output") != config_obj.end())
+  {
+    JSON alloc_trace_output_raw = config_obj.at("alloc-trace-output");
+    configuration.set_alloc_trace_output(alloc_trace_output_raw.string_value());
+  }
+
+  // Handle table indirection for object ids.
+  if (config_obj.find("heap-handle-table") != config_obj.end())
+  {
+    JSON heap_handle_table_raw = config_obj.at("heap-handle-table");
+    configuration.set_heap_handle_table(heap_handle_table_raw.bool_value());
+  }
+
+  // Objects marked per incremental GC slice.
+  if (config_obj.find("gc-slice-budget") != config_obj.end())
+  {
+    JSON gc_slice_budget_raw = config_obj.at("gc-slice-budget");
+    uint32_t gc_slice_budget = \
+      static_cast<uint32_t>(gc_slice_budget_raw.int_value());
+    configuration.set_gc_slice_budget(gc_slice_budget);
+  }
+
+  // Instructions executed between incremental GC slices.
+  if (config_obj.find("gc-slice-interval") != config_obj.end())
+  {
+    JSON gc_slice_interval_raw = config_obj.at("gc-slice-interval");
+    uint32_t gc_slice_interval = \
+      static_cast<uint32_t>(gc_slice_interval_raw.int_value());
+    configuration.set_gc_slice_interval(gc_slice_interval);
+  }
+
+  // GC statistics output path.
+  if (config_obj.find("gc-stats-output") != config_obj.end())
+  {
+    JSON gc_stats_output_raw = config_obj.at("gc-stats-output");
+    configuration.set_gc_stats_output(gc_stats_output_raw.string_value());
+  }
+
+  // GC nursery size
+  if (config_obj.find("gc-nursery-size") != config_obj.end())
+  {
+    JSON gc_nursery_size_raw = config_obj.at("gc-nursery-size");
+    uint32_t gc_nursery_size = \
+      static_cast<uint32_t>(gc_nursery_size_raw.int_value());
+    configuration.set_gc_nursery_size(gc_nursery_size);
+  }
+
+  // GC mark threads
+  if (config_obj.find("gc-mark-threads") != config_obj.end())
+  {
+    JSON gc_mark_threads_raw = config_obj.at("gc-mark-threads");
+    uint32_t gc_mark_threads = \
+      static_cast<uint32_t>(gc_mark_threads_raw.int_value());
+    configuration.set_gc_mark_threads(gc_mark_threads);
+  }
+
+  // GC sweep chunk size
+  if (config_obj.find("gc-sweep-chunk-size") != config_obj.end())
+  {
+    JSON gc_sweep_chunk_size_raw = config_obj.at("gc-sweep-chunk-size");
+    uint32_t gc_sweep_chunk_size = \
+      static_cast<uint32_t>(gc_sweep_chunk_size_raw.int_value());
+    configuration.set_gc_sweep_chunk_size(gc_sweep_chunk_size);
+  }
+
+  // GC flag
+  if (config_obj.find("gc-flag") != config_obj.end())
+  {
+    JSON gc_flag_raw = config_obj.at("gc-flag");
+    uint32_t gc_flag = \
+      static_cast<uint32_t>(gc_flag_raw.int_value());
+    configuration.set_gc_flag(gc_flag);
+  }
+
+  // GC allocation interval
+  if (config_obj.find("gc-allocation-interval") != config_obj.end())
+  {
+    JSON gc_allocation_interval_raw = config_obj.at("gc-allocation-interval");
+    uint32_t gc_allocation_interval = \
+      static_cast<uint32_t>(gc_allocation_interval_raw.int_value());
+    configuration.set_gc_allocation_interval(gc_allocation_interval);
+  }
+
+  // GC log output
+  if (config_obj.find("gc-log-output") != config_obj.end())
+  {
+    JSON gc_log_output_raw = config_obj.at("gc-log-output");
+    configuration.set_gc_log_output(gc_log_output_raw.string_value());
+  }
+
+  // GC heap growth percent
+  if (config_obj.find("gc-heap-growth-percent") != config_obj.end())
+  {
+    JSON gc_heap_growth_percent_raw = config_obj.at("gc-heap-growth-percent");
+    uint32_t gc_heap_growth_percent = \
+      static_cast<uint32_t>(gc_heap_growth_percent_raw.int_value());
+    configuration.set_gc_heap_growth_percent(gc_heap_growth_percent);
+  }
+
+  // GC min threshold
+  if (config_obj.find("gc-min-threshold") != config_obj.end())
+  {
+    JSON gc_min_threshold_raw = config_obj.at("gc-min-threshold");
+    uint64_t gc_min_threshold = \
+      static_cast<uint64_t>(gc_min_threshold_raw.int_value());
+    configuration.set_gc_min_threshold(gc_min_threshold);
+  }
+
+  // GC target CPU percent
+  if (config_obj.find("gc-target-cpu-percent") != config_obj.end())
+  {
+    JSON gc_target_cpu_percent_raw = config_obj.at("gc-target-cpu-percent");
+    uint32_t gc_target_cpu_percent = \
+      static_cast<uint32_t>(gc_target_cpu_percent_raw.int_value());
+    configuration.set_gc_target_cpu_percent(gc_target_cpu_percent);
+  }
+
+  // GC pause budget
+  if (config_obj.find("gc-pause-budget-us") != config_obj.end())
+  {
+    JSON gc_pause_budget_raw = config_obj.at("gc-pause-budget-us");
+    uint32_t gc_pause_budget = \
+      static_cast<uint32_t>(gc_pause_budget_raw.int_value());
+    configuration.set_gc_pause_budget(gc_pause_budget);
+  }
+
+  // Max native payload size
+  if (config_obj.find("max-native-payload-size") != config_obj.end())
+  {
+    JSON max_native_payload_size_raw = config_obj.at("max-native-payload-size");
+    uint64_t max_native_payload_size = \
+      static_cast<uint64_t>(max_native_payload_size_raw.int_value());
+    configuration.set_max_native_payload_size(max_native_payload_size);
+  }
 }
 
 // -----------------------------------------------------------------------------
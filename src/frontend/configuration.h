@@ -56,6 +56,48 @@ public:
 
   uint32_t gc_interval() const;
 
+  uint64_t max_heap_alloc_size() const;
+
+  uint64_t max_pool_alloc_size() const;
+
+  bool arena_huge_pages() const;
+
+  bool arena_prefault() const;
+
+  const std::string& alloc_stats_output() const;
+
+  const std::string& alloc_trace_output() const;
+
+  bool heap_handle_table() const;
+
+  uint32_t gc_slice_budget() const;
+
+  uint32_t gc_slice_interval() const;
+
+  const std::string& gc_stats_output() const;
+
+  uint32_t gc_nursery_size() const;
+
+  uint32_t gc_mark_threads() const;
+
+  uint32_t gc_sweep_chunk_size() const;
+
+  uint32_t gc_flag() const;
+
+  uint32_t gc_allocation_interval() const;
+
+  const std::string& gc_log_output() const;
+
+  uint32_t gc_heap_growth_percent() const;
+
+  uint64_t gc_min_threshold() const;
+
+  uint32_t gc_target_cpu_percent() const;
+
+  uint32_t gc_pause_budget() const;
+
+  uint64_t max_native_payload_size() const;
+
   /* Value setters. */
   void set_heap_alloc_size(uint64_t);
 
@@ -63,12 +105,75 @@ public:
 
   void set_gc_interval(uint32_t);
 
+  void set_max_heap_alloc_size(uint64_t);
+
+  void set_max_pool_alloc_size(uint64_t);
+
+  void set_arena_huge_pages(bool);
+
+  void set_arena_prefault(bool);
+
+  void set_alloc_stats_output(const std::string&);
+
+  void set_alloc_trace_output(const std::string&);
+
+  void set_heap_handle_table(bool);
+
+  void set_gc_slice_budget(uint32_t);
+
+  void set_gc_slice_interval(uint32_t);
+
+  void set_gc_stats_output(const std::string&);
+
+  void set_gc_nursery_size(uint32_t);
+
+  void set_gc_mark_threads(uint32_t);
+
+  void set_gc_sweep_chunk_size(uint32_t);
+
+  void set_gc_flag(uint32_t);
+
+  void set_gc_allocation_interval(uint32_t);
+
+  void set_gc_log_output(const std::string&);
+
+  void set_gc_heap_growth_percent(uint32_t);
+
+  void set_gc_min_threshold(uint64_t);
+
+  void set_gc_target_cpu_percent(uint32_t);
+
+  void set_gc_pause_budget(uint32_t);
+
+  void set_max_native_payload_size(uint64_t);
+
 private:
   static void set_values(configuration&, const JSON&);
 
   uint64_t m_heap_alloc_size;
   uint64_t m_pool_alloc_size;
   uint32_t m_gc_interval;
+  uint64_t m_max_heap_alloc_size;
+  uint64_t m_max_pool_alloc_size;
+  bool m_arena_huge_pages;
+  bool m_arena_prefault;
+  std::string m_alloc_stats_output;
+  std::string m_alloc_trace_output;
+  bool m_heap_handle_table;
+  uint32_t m_gc_slice_budget;
+  uint32_t m_gc_slice_interval;
+  std::string m_gc_stats_output;
+  uint32_t m_gc_nursery_size;
+  uint32_t m_gc_mark_threads;
+  uint32_t m_gc_sweep_chunk_size;
+  uint32_t m_gc_flag;
+  uint32_t m_gc_allocation_interval;
+  std::string m_gc_log_output;
+  uint32_t m_gc_heap_growth_percent;
+  uint64_t m_gc_min_threshold;
+  uint32_t m_gc_target_cpu_percent;
+  uint32_t m_gc_pause_budget;
+  uint64_t m_max_native_payload_size;
 
 private:
   static const std::string schema;
@@ -28,7 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "corevm/macros.h"
 #include "dyobj/common.h"
 #include "dyobj/errors.h"
+#include "memory/allocation_trace.h"
+#include "memory/arena.h"
 #include "runtime/common.h"
+#include "runtime/gc_rule.h"
 #include "runtime/process.h"
 #include "runtime/process_runner.h"
 
@@ -37,6 +40,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cerrno>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -75,6 +79,76 @@ print_stack_trace()
 
 // -----------------------------------------------------------------------------
 
+static void
+dump_allocation_stats(
+  const corevm::runtime::process& process, const std::string& path)
+{
+  if (path.empty())
+  {
+    return;
+  }
+
+  std::ofstream fs(path);
+
+  if (!fs)
+  {
+    std::cerr << "Failed to write allocation stats to " << path << std::endl;
+    return;
+  }
+
+  process.dump_allocation_stats(fs);
+  fs << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+dump_gc_stats(
+  const corevm::runtime::process& process, const std::string& path)
+{
+  if (path.empty())
+  {
+    return;
+  }
+
+  std::ofstream fs(path);
+
+  if (!fs)
+  {
+    std::cerr << "Failed to write GC stats to " << path << std::endl;
+    return;
+  }
+
+  process.dump_gc_stats(fs);
+  fs << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+save_allocation_traces(
+  const corevm::memory::allocation_trace& heap_trace,
+  const corevm::memory::allocation_trace& ntvhndl_pool_trace,
+  const std::string& path)
+{
+  if (path.empty())
+  {
+    return;
+  }
+
+  try
+  {
+    heap_trace.save(path + ".heap");
+    ntvhndl_pool_trace.save(path + ".pool");
+  }
+  catch (const corevm::memory::allocation_trace_error& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::frontend::runner::runner(
   const std::string& path,
   corevm::frontend::configuration& configuration)
@@ -100,7 +174,104 @@ corevm::frontend::runner::run() const noexcept
   uint32_t gc_interval = m_configuration.gc_interval() ? \
     m_configuration.gc_interval() : corevm::runtime::COREVM_DEFAULT_GC_INTERVAL;
 
-  corevm::runtime::process process(heap_alloc_size, pool_alloc_size);
+  uint32_t gc_allocation_interval = m_configuration.gc_allocation_interval() ? \
+    m_configuration.gc_allocation_interval() :
+    corevm::runtime::COREVM_DEFAULT_GC_ALLOCATION_INTERVAL;
+
+  uint32_t gc_slice_interval = m_configuration.gc_slice_interval() ? \
+    m_configuration.gc_slice_interval() : corevm::runtime::COREVM_DEFAULT_GC_SLICE_INTERVAL;
+
+  uint32_t arena_flags = 0;
+
+  if (m_configuration.arena_huge_pages())
+  {
+    arena_flags |= corevm::memory::arena::ARENA_USE_HUGE_PAGES;
+  }
+
+  if (m_configuration.arena_prefault())
+  {
+    arena_flags |= corevm::memory::arena::ARENA_PREFAULT;
+  }
+
+  uint32_t heap_flags = 0;
+
+  if (m_configuration.heap_handle_table())
+  {
+    heap_flags |= corevm::runtime::process::dynamic_object_heap_type::HEAP_USE_HANDLE_TABLE;
+  }
+
+  if (m_configuration.gc_nursery_size())
+  {
+    heap_flags |= corevm::runtime::process::dynamic_object_heap_type::HEAP_GENERATIONAL;
+  }
+
+  corevm::memory::allocation_trace heap_trace;
+  corevm::memory::allocation_trace ntvhndl_pool_trace;
+
+  corevm::runtime::process process(
+    heap_alloc_size,
+    pool_alloc_size,
+    m_configuration.max_heap_alloc_size(),
+    m_configuration.max_pool_alloc_size(),
+    arena_flags,
+    heap_flags);
+
+  if (!m_configuration.alloc_trace_output().empty())
+  {
+    process.set_allocation_traces(&heap_trace, &ntvhndl_pool_trace);
+  }
+
+  std::ofstream gc_log;
+
+  if (!m_configuration.gc_log_output().empty())
+  {
+    gc_log.open(m_configuration.gc_log_output());
+
+    if (gc_log)
+    {
+      process.set_gc_log(&gc_log);
+    }
+    else
+    {
+      std::cerr << "Failed to write GC log to " << m_configuration.gc_log_output() << std::endl;
+    }
+  }
+
+  uint8_t gc_flag = static_cast<uint8_t>(m_configuration.gc_flag());
+
+  if (m_configuration.gc_heap_growth_percent())
+  {
+    corevm::runtime::gc_threshold_policy gc_threshold_policy;
+    gc_threshold_policy.set_growth_factor(
+      m_configuration.gc_heap_growth_percent() / 100.0);
+
+    if (m_configuration.gc_min_threshold())
+    {
+      gc_threshold_policy.set_min_threshold(m_configuration.gc_min_threshold());
+    }
+
+    gc_threshold_policy.set_target_cpu_fraction(
+      m_configuration.gc_target_cpu_percent() / 100.0);
+    gc_threshold_policy.set_pause_budget(
+      static_cast<uint64_t>(m_configuration.gc_pause_budget()) * 1000);
+
+    process.set_gc_threshold_policy(gc_threshold_policy);
+
+    gc_flag |= 1 << (corevm::runtime::gc_rule_meta::GC_ADAPTIVE - 1);
+  }
+
+  process.set_gc_flag(gc_flag);
+  process.set_gc_allocation_interval(gc_allocation_interval);
+  process.set_gc_slicing(m_configuration.gc_slice_budget(), gc_slice_interval);
+  process.set_gc_nursery_size(m_configuration.gc_nursery_size());
+  process.set_gc_mark_threads(m_configuration.gc_mark_threads());
+  process.set_gc_sweep_chunk_size(m_configuration.gc_sweep_chunk_size());
+
+  if (m_configuration.max_native_payload_size())
+  {
+    process.set_max_native_payload_size(
+      m_configuration.max_native_payload_size());
+  }
 
   try
   {
@@ -108,6 +279,13 @@ corevm::frontend::runner::run() const noexcept
 
     bool res = corevm::runtime::process_runner(process, gc_interval).start();
 
+    dump_allocation_stats(process, m_configuration.alloc_stats_output());
+
+    dump_gc_stats(process, m_configuration.gc_stats_output());
+
+    save_allocation_traces(
+      heap_trace, ntvhndl_pool_trace, m_configuration.alloc_trace_output());
+
     if (!res)
     {
       std::cerr << "Run failed: " << strerror(errno) << std::endl;
@@ -0,0 +1,89 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "garbage_collection_scheme.h"
+
+
+corevm::gc::garbage_collection_scheme::garbage_collection_scheme()
+  :
+  m_mark_thread_count(1),
+  m_ntvhndl_tracer()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::gc::garbage_collection_scheme::mark_thread_count() const noexcept
+{
+  return m_mark_thread_count;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::garbage_collection_scheme::set_mark_thread_count(
+  uint32_t mark_thread_count) noexcept
+{
+  m_mark_thread_count = mark_thread_count ? mark_thread_count : 1;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::garbage_collection_scheme::set_ntvhndl_tracer(
+  const ntvhndl_tracer_type& ntvhndl_tracer)
+{
+  m_ntvhndl_tracer = ntvhndl_tracer;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::garbage_collection_scheme::set_zero_count_table(
+  zero_count_table* /* zero_count_table */) noexcept
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::garbage_collection_scheme::root_set_type*
+corevm::gc::garbage_collection_scheme::dead_objects() const noexcept
+{
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::garbage_collection_scheme::trace_ntvhndl(
+  corevm::dyobj::ntvhndl_key ntvhndl_key, root_set_type& ids) const
+{
+  if (ntvhndl_key != corevm::dyobj::NONESET_NTVHNDL_KEY && m_ntvhndl_tracer)
+  {
+    m_ntvhndl_tracer(ntvhndl_key, ids);
+  }
+}
+
+// -----------------------------------------------------------------------------
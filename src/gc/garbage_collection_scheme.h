@@ -23,7 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_GARBAGE_COLLECTION_SCHEME_H_
 #define COREVM_GARBAGE_COLLECTION_SCHEME_H_
 
+#include "dyobj/common.h"
+#include "dyobj/dyobj_id.h"
+
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 
 namespace corevm {
@@ -32,7 +37,101 @@ namespace corevm {
 namespace gc {
 
 
-class garbage_collection_scheme {};
+class garbage_collection_scheme
+{
+public:
+  /**
+   * Ids of the objects directly referenced by the running process, from which
+   * tracing schemes start marking.
+   */
+  typedef std::vector<corevm::dyobj::dyobj_id> root_set_type;
+
+  /**
+   * Appends the ids of the objects referred to by the contents of the native
+   * handle of the given key to the given set.
+   */
+  typedef std::function<void(corevm::dyobj::ntvhndl_key, root_set_type&)> ntvhndl_tracer_type;
+
+  /**
+   * Progress carried across the slices of an incremental collection. Empty
+   * for schemes that always collect in a single slice.
+   */
+  class incremental_state
+  {
+    public:
+      /**
+       * Makes the state the target of the write barrier on the current
+       * thread.
+       */
+      void activate() noexcept
+      {
+        // Do nothing here.
+      }
+  };
+
+  /**
+   * Objects of the old generation that may refer to young objects, recorded
+   * between minor collections. Empty for schemes without generations.
+   */
+  class generational_state
+  {
+    public:
+      /**
+       * Makes the state the target of the write barrier on the current
+       * thread.
+       */
+      void activate() noexcept
+      {
+        // Do nothing here.
+      }
+  };
+
+  /**
+   * Objects that may have a reference count of zero, recorded between
+   * collections. Empty for schemes that do not count references.
+   */
+  class zero_count_table
+  {
+    public:
+      void insert(corevm::dyobj::dyobj_id) noexcept
+      {
+        // Do nothing here.
+      }
+  };
+
+  garbage_collection_scheme();
+
+  /**
+   * Number of threads that tracing schemes mark with. Defaults to 1.
+   */
+  uint32_t mark_thread_count() const noexcept;
+
+  void set_mark_thread_count(uint32_t) noexcept;
+
+  /**
+   * Sets the tracer through which tracing schemes reach the objects referred
+   * to by native handles.
+   */
+  void set_ntvhndl_tracer(const ntvhndl_tracer_type&);
+
+  /**
+   * Has no effect for schemes that do not count references.
+   */
+  void set_zero_count_table(zero_count_table*) noexcept;
+
+  /**
+   * Ids of the objects found dead by the last collection, for schemes that
+   * know them without visiting the whole heap, or `nullptr` if the heap has
+   * to be swept to find them.
+   */
+  const root_set_type* dead_objects() const noexcept;
+
+protected:
+  void trace_ntvhndl(corevm::dyobj::ntvhndl_key, root_set_type&) const;
+
+  uint32_t m_mark_thread_count;
+  ntvhndl_tracer_type m_ntvhndl_tracer;
+};
 
 
 } /* end namespace gc */
@@ -23,9 +23,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_GARBAGE_COLLECTOR_H_
 #define COREVM_GARBAGE_COLLECTOR_H_
 
+#include "gc_stats.h"
 #include "dyobj/dynamic_object_heap.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 
 namespace corevm {
@@ -49,39 +55,244 @@ public:
       virtual void operator()(const dynamic_object_type& obj) = 0;
   };
 
+  using root_set_type = typename garbage_collection_scheme::root_set_type;
+
+  using incremental_state_type = typename garbage_collection_scheme::incremental_state;
+
+  using generational_state_type = typename garbage_collection_scheme::generational_state;
+
+  using zero_count_table_type = typename garbage_collection_scheme::zero_count_table;
+
+  /**
+   * Progress of a lazy sweep: the garbage found by a collection is left on
+   * the heap, and reclaimed by `sweep` as the heap is walked in chunks from
+   * a cursor. Objects are told apart from garbage by the scheme, which does
+   * not change its mind as the process runs.
+   */
+  class sweep_state
+  {
+    public:
+      sweep_state();
+
+      /* Sweep states should not be copyable. */
+      sweep_state(const sweep_state&) = delete;
+      sweep_state& operator=(const sweep_state&) = delete;
+
+      bool pending() const noexcept;
+
+      /**
+       * Keeps an object created while garbage is left to sweep from being
+       * reclaimed with it.
+       */
+      void retain(dynamic_object_type&) const noexcept;
+
+    private:
+      friend class garbage_collector;
+
+      bool m_pending;
+
+      /* Address from which the heap is swept next. */
+      const dynamic_object_type* m_cursor;
+  };
+
   explicit garbage_collector(dynamic_object_heap_type&);
 
+  /**
+   * Makes collections sweep lazily: the garbage they find is left on the
+   * heap, to be reclaimed by `sweep` with the specified state. Every
+   * collection first reclaims the garbage left by the previous one.
+   */
+  void set_sweep_state(sweep_state*) noexcept;
+
+  /**
+   * Sets the number of threads that tracing schemes mark with.
+   */
+  void set_mark_thread_count(uint32_t) noexcept;
+
+  /**
+   * Makes collections add the time they spend marking and sweeping, and the
+   * number of objects they free, to the specified stats.
+   */
+  void set_cycle_stats(corevm::gc::cycle_stats*) noexcept;
+
+  /**
+   * Sets the tracer through which tracing schemes reach the objects referred
+   * to by native handles.
+   */
+  void set_ntvhndl_tracer(
+    const typename garbage_collection_scheme::ntvhndl_tracer_type&);
+
+  /**
+   * Makes reference counting schemes find the objects with a count of zero
+   * in the specified table.
+   */
+  void set_zero_count_table(zero_count_table_type*) noexcept;
+
   void gc() noexcept;
 
   void gc(callback*) noexcept;
 
+  /**
+   * Collects with the given set of root objects, in addition to the objects
+   * flagged as not garbage collectible.
+   */
+  void gc(callback*, const root_set_type&) noexcept;
+
+  /**
+   * Performs a slice of an incremental collection, tracing at most the
+   * specified number of objects. The heap is swept in the slice that
+   * completes marking. Returns whether the collection has completed.
+   */
+  bool gc_slice(
+    callback*, const root_set_type&, size_t, incremental_state_type&) noexcept;
+
+  /**
+   * Collects the nursery of a generational heap, and promotes the objects
+   * that survive. Performs a full collection instead if the scheme cannot
+   * collect the nursery on its own.
+   *
+   * Returns the number of objects promoted.
+   */
+  size_t minor_gc(
+    callback*, const root_set_type&, generational_state_type&) noexcept;
+
+  /**
+   * Visits at most the specified number of objects from the cursor of the
+   * lazy sweep, reclaiming the garbage among them, and returns the number of
+   * objects reclaimed. The heap is compacted once the sweep reaches its end.
+   */
+  size_t sweep(callback*, size_t) noexcept;
+
 protected:
+  /**
+   * Reclaims the objects the scheme found dead, or else sweeps the whole
+   * heap, unless it starts a lazy sweep from the bottom of the heap. Every
+   * object that survives is promoted.
+   */
   void free(callback* f=nullptr) noexcept;
 
+  /**
+   * Moves the surviving objects together when the heap supports it, unless
+   * garbage is left to sweep.
+   */
+  void compact() noexcept;
+
+  void add_mark_time(const std::chrono::steady_clock::time_point&) noexcept;
+
+  void add_sweep_time(const std::chrono::steady_clock::time_point&) noexcept;
+
+  void add_freed_object_count(size_t) noexcept;
+
   garbage_collection_scheme m_gc_scheme;
   dynamic_object_heap_type& m_heap;
+  sweep_state* m_sweep_state;
+  corevm::gc::cycle_stats* m_cycle_stats;
 };
 
 // -----------------------------------------------------------------------------
 
+template<class garbage_collection_scheme>
+corevm::gc::garbage_collector<garbage_collection_scheme>::sweep_state::sweep_state()
+  :
+  m_pending(false),
+  m_cursor(nullptr)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+bool
+corevm::gc::garbage_collector<garbage_collection_scheme>::sweep_state::pending() const noexcept
+{
+  return m_pending;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::sweep_state::retain(
+  dynamic_object_type& obj) const noexcept
+{
+  if (m_pending)
+  {
+    garbage_collection_scheme::retain(obj);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 template<class garbage_collection_scheme>
 corevm::gc::garbage_collector<garbage_collection_scheme>::garbage_collector(
   corevm::gc::garbage_collector<garbage_collection_scheme>::dynamic_object_heap_type& heap)
   :
   m_gc_scheme(),
-  m_heap(heap)
+  m_heap(heap),
+  m_sweep_state(nullptr),
+  m_cycle_stats(nullptr)
 {
   // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
 
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::set_sweep_state(
+  sweep_state* state) noexcept
+{
+  m_sweep_state = state;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::set_mark_thread_count(
+  uint32_t mark_thread_count) noexcept
+{
+  m_gc_scheme.set_mark_thread_count(mark_thread_count);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::set_cycle_stats(
+  corevm::gc::cycle_stats* cycle_stats) noexcept
+{
+  m_cycle_stats = cycle_stats;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::set_ntvhndl_tracer(
+  const typename garbage_collection_scheme::ntvhndl_tracer_type& ntvhndl_tracer)
+{
+  m_gc_scheme.set_ntvhndl_tracer(ntvhndl_tracer);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::set_zero_count_table(
+  zero_count_table_type* zero_count_table) noexcept
+{
+  m_gc_scheme.set_zero_count_table(zero_count_table);
+}
+
+// -----------------------------------------------------------------------------
+
 template<class garbage_collection_scheme>
 void
 corevm::gc::garbage_collector<garbage_collection_scheme>::gc() noexcept
 {
-  m_gc_scheme.gc(m_heap);
-  this->free();
+  this->gc(nullptr, root_set_type());
 }
 
 // -----------------------------------------------------------------------------
@@ -90,8 +301,167 @@ template<class garbage_collection_scheme>
 void
 corevm::gc::garbage_collector<garbage_collection_scheme>::gc(callback* f) noexcept
 {
-  m_gc_scheme.gc(m_heap);
+  this->gc(f, root_set_type());
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::gc(
+  callback* f, const root_set_type& roots) noexcept
+{
+  this->sweep(f, std::numeric_limits<size_t>::max());
+
+  auto start = std::chrono::steady_clock::now();
+  m_gc_scheme.gc(m_heap, roots);
+  this->add_mark_time(start);
+
   this->free(f);
+  this->compact();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+bool
+corevm::gc::garbage_collector<garbage_collection_scheme>::gc_slice(
+  callback* f, const root_set_type& roots, size_t budget,
+  incremental_state_type& state) noexcept
+{
+  this->sweep(f, std::numeric_limits<size_t>::max());
+
+  auto start = std::chrono::steady_clock::now();
+  bool marked = m_gc_scheme.gc_slice(m_heap, roots, budget, state);
+  this->add_mark_time(start);
+
+  if (!marked)
+  {
+    return false;
+  }
+
+  this->free(f);
+  this->compact();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+size_t
+corevm::gc::garbage_collector<garbage_collection_scheme>::minor_gc(
+  callback* f, const root_set_type& roots, generational_state_type& state) noexcept
+{
+  this->sweep(f, std::numeric_limits<size_t>::max());
+
+  auto start = std::chrono::steady_clock::now();
+  bool collectible = m_gc_scheme.minor_gc(m_heap, roots, state);
+  this->add_mark_time(start);
+
+  if (!collectible)
+  {
+    this->gc(f, roots);
+    return 0;
+  }
+
+  start = std::chrono::steady_clock::now();
+
+  size_t promoted = 0;
+  size_t freed = 0;
+
+  for (auto itr = m_heap.nursery().begin(); itr != m_heap.nursery().end(); ++itr)
+  {
+    dynamic_object_type* obj = m_heap.find(*itr);
+
+    if (obj == nullptr)
+    {
+      continue;
+    }
+
+    if (obj->is_garbage_collectible())
+    {
+      if (f)
+      {
+        (*f)(*obj);
+      }
+
+      m_heap.erase(*itr);
+      ++freed;
+    }
+    else
+    {
+      ++promoted;
+    }
+  }
+
+  m_heap.clear_nursery();
+
+  this->add_freed_object_count(freed);
+  this->add_sweep_time(start);
+
+  return promoted;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+size_t
+corevm::gc::garbage_collector<garbage_collection_scheme>::sweep(
+  callback* f, size_t budget) noexcept
+{
+  if (!m_sweep_state || !m_sweep_state->pending())
+  {
+    return 0;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  auto itr = m_heap.lower_bound(m_sweep_state->m_cursor);
+
+  size_t count = 0;
+  size_t freed = 0;
+
+  for (; count < budget && itr != m_heap.end(); ++count)
+  {
+    dynamic_object_type& obj = static_cast<dynamic_object_type&>(*itr);
+
+    // Erasing leaves the iterators to other objects valid.
+    ++itr;
+
+    if (!garbage_collection_scheme::is_garbage(obj))
+    {
+      continue;
+    }
+
+    if (f)
+    {
+      (*f)(obj);
+    }
+
+    m_heap.erase(obj.id());
+    ++freed;
+  }
+
+  if (itr == m_heap.end())
+  {
+    m_sweep_state->m_pending = false;
+    m_sweep_state->m_cursor = nullptr;
+  }
+  else
+  {
+    m_sweep_state->m_cursor = &static_cast<dynamic_object_type&>(*itr);
+  }
+
+  this->add_freed_object_count(freed);
+  this->add_sweep_time(start);
+
+  if (!m_sweep_state->m_pending)
+  {
+    this->compact();
+  }
+
+  return freed;
 }
 
 // -----------------------------------------------------------------------------
@@ -100,6 +470,62 @@ template<class garbage_collection_scheme>
 void
 corevm::gc::garbage_collector<garbage_collection_scheme>::free(callback* f) noexcept
 {
+  auto start = std::chrono::steady_clock::now();
+
+  if (m_sweep_state)
+  {
+    m_sweep_state->m_pending = m_heap.size() > 0;
+    m_sweep_state->m_cursor = nullptr;
+
+    m_heap.clear_nursery();
+
+    this->add_sweep_time(start);
+
+    return;
+  }
+
+  size_t freed = 0;
+
+  // Schemes that know which objects died spare the walk over the heap.
+  if (const root_set_type* dead_objects = m_gc_scheme.dead_objects())
+  {
+    std::vector<dynamic_object_type*> objects;
+    objects.reserve(dead_objects->size());
+
+    for (auto itr = dead_objects->begin(); itr != dead_objects->end(); ++itr)
+    {
+      dynamic_object_type* obj = m_heap.find(*itr);
+
+      if (obj)
+      {
+        objects.push_back(obj);
+      }
+    }
+
+    // The allocator frees blocks faster in address order, which is the order
+    // in which sweeping the heap would have freed them.
+    std::sort(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+
+    for (auto itr = objects.begin(); itr != objects.end(); ++itr)
+    {
+      if (f)
+      {
+        (*f)(**itr);
+      }
+
+      m_heap.erase((*itr)->id());
+      ++freed;
+    }
+
+    m_heap.clear_nursery();
+
+    this->add_freed_object_count(freed);
+    this->add_sweep_time(start);
+
+    return;
+  }
+
   auto remove_criterion = [](typename dynamic_object_heap_type::iterator itr) -> bool {
     dynamic_object_type& object = static_cast<dynamic_object_type&>(*itr);
     return object.is_garbage_collectible();
@@ -120,12 +546,77 @@ corevm::gc::garbage_collector<garbage_collection_scheme>::free(callback* f) noex
       ++itr_next;
       m_heap.erase(itr);
       itr = itr_next;
+      ++freed;
     }
     else
     {
       ++itr;
     }
   }
+
+  m_heap.clear_nursery();
+
+  this->add_freed_object_count(freed);
+  this->add_sweep_time(start);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::compact() noexcept
+{
+  if (m_sweep_state && m_sweep_state->pending())
+  {
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  m_heap.compact();
+  this->add_sweep_time(start);
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::add_mark_time(
+  const std::chrono::steady_clock::time_point& start) noexcept
+{
+  if (m_cycle_stats)
+  {
+    m_cycle_stats->mark_time += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::add_sweep_time(
+  const std::chrono::steady_clock::time_point& start) noexcept
+{
+  if (m_cycle_stats)
+  {
+    m_cycle_stats->sweep_time += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+void
+corevm::gc::garbage_collector<garbage_collection_scheme>::add_freed_object_count(
+  size_t count) noexcept
+{
+  if (m_cycle_stats)
+  {
+    m_cycle_stats->freed_object_count += count;
+  }
 }
 
 // -----------------------------------------------------------------------------
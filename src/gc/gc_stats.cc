@@ -0,0 +1,202 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "gc_stats.h"
+
+#include <cstdint>
+#include <ostream>
+
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::gc_stats::gc_stats()
+  :
+  m_cycle_count(0),
+  m_minor_cycle_count(0),
+  m_mark_time(0),
+  m_sweep_time(0),
+  m_freed_object_count(0),
+  m_freed_ntvhndl_count(0),
+  m_last_cycle()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::gc_stats::record_cycle(const corevm::gc::cycle_stats& cycle)
+{
+  if (cycle.minor)
+  {
+    ++m_minor_cycle_count;
+  }
+  else
+  {
+    ++m_cycle_count;
+  }
+
+  m_mark_time += cycle.mark_time;
+  m_sweep_time += cycle.sweep_time;
+  m_freed_object_count += cycle.freed_object_count;
+  m_freed_ntvhndl_count += cycle.freed_ntvhndl_count;
+
+  m_last_cycle = cycle;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::gc_stats::record_sweep(
+  uint64_t sweep_time, uint64_t freed_object_count, uint64_t freed_ntvhndl_count)
+{
+  m_sweep_time += sweep_time;
+  m_freed_object_count += freed_object_count;
+  m_freed_ntvhndl_count += freed_ntvhndl_count;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::cycle_count() const noexcept
+{
+  return m_cycle_count;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::minor_cycle_count() const noexcept
+{
+  return m_minor_cycle_count;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::mark_time() const noexcept
+{
+  return m_mark_time;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::sweep_time() const noexcept
+{
+  return m_sweep_time;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::freed_object_count() const noexcept
+{
+  return m_freed_object_count;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::gc_stats::freed_ntvhndl_count() const noexcept
+{
+  return m_freed_ntvhndl_count;
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::cycle_stats&
+corevm::gc::gc_stats::last_cycle() const noexcept
+{
+  return m_last_cycle;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::gc_stats::clear() noexcept
+{
+  m_cycle_count = 0;
+  m_minor_cycle_count = 0;
+  m_mark_time = 0;
+  m_sweep_time = 0;
+  m_freed_object_count = 0;
+  m_freed_ntvhndl_count = 0;
+  m_last_cycle = corevm::gc::cycle_stats();
+}
+
+// -----------------------------------------------------------------------------
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+std::ostream&
+operator<<(std::ostream& ost, const corevm::gc::cycle_stats& cycle)
+{
+  ost << "{";
+  ost << "\"minor\": " << (cycle.minor ? "true" : "false") << ", ";
+  ost << "\"start-ns\": " << cycle.start_time << ", ";
+  ost << "\"end-ns\": " << cycle.end_time << ", ";
+  ost << "\"slices\": " << cycle.slice_count << ", ";
+  ost << "\"mark-ns\": " << cycle.mark_time << ", ";
+  ost << "\"sweep-ns\": " << cycle.sweep_time << ", ";
+  ost << "\"freed-objects\": " << cycle.freed_object_count << ", ";
+  ost << "\"freed-ntvhndls\": " << cycle.freed_ntvhndl_count << ", ";
+  ost << "\"heap-size-before\": " << cycle.heap_size_before << ", ";
+  ost << "\"heap-size-after\": " << cycle.heap_size_after << ", ";
+  ost << "\"pool-size-before\": " << cycle.pool_size_before << ", ";
+  ost << "\"pool-size-after\": " << cycle.pool_size_after;
+  ost << "}";
+
+  return ost;
+}
+
+// -----------------------------------------------------------------------------
+
+std::ostream&
+operator<<(std::ostream& ost, const corevm::gc::gc_stats& stats)
+{
+  ost << "{";
+  ost << "\"count\": " << stats.cycle_count() << ", ";
+  ost << "\"minor-count\": " << stats.minor_cycle_count() << ", ";
+  ost << "\"mark-ns\": " << stats.mark_time() << ", ";
+  ost << "\"sweep-ns\": " << stats.sweep_time() << ", ";
+  ost << "\"freed-objects\": " << stats.freed_object_count() << ", ";
+  ost << "\"freed-ntvhndls\": " << stats.freed_ntvhndl_count() << ", ";
+  ost << "\"last\": " << stats.last_cycle();
+  ost << "}";
+
+  return ost;
+}
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_GC_STATS_H_
+#define COREVM_GC_STATS_H_
+
+#include <cstdint>
+#include <ostream>
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+/**
+ * What a garbage collection cycle did. Timestamps are taken from a steady
+ * clock, and times are measured in nanoseconds. Occupancies are numbers of
+ * objects and of native type handles.
+ */
+typedef struct cycle_stats
+{
+  bool minor;
+  uint64_t start_time;
+  uint64_t end_time;
+  uint32_t slice_count;
+  uint64_t mark_time;
+  uint64_t sweep_time;
+  uint64_t freed_object_count;
+  uint64_t freed_ntvhndl_count;
+  uint64_t heap_size_before;
+  uint64_t heap_size_after;
+  uint64_t pool_size_before;
+  uint64_t pool_size_after;
+} cycle_stats;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Writes the stats as a JSON object on a single line.
+ */
+std::ostream& operator<<(std::ostream&, const corevm::gc::cycle_stats&);
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Running totals of the garbage collection cycles of a process.
+ */
+class gc_stats
+{
+public:
+  gc_stats();
+
+  /**
+   * Adds a completed cycle to the totals.
+   */
+  void record_cycle(const corevm::gc::cycle_stats&);
+
+  /**
+   * Adds the time spent and the objects and native type handles freed by a
+   * lazy sweep that happened outside of any cycle.
+   */
+  void record_sweep(uint64_t, uint64_t, uint64_t);
+
+  uint64_t cycle_count() const noexcept;
+
+  uint64_t minor_cycle_count() const noexcept;
+
+  uint64_t mark_time() const noexcept;
+
+  uint64_t sweep_time() const noexcept;
+
+  uint64_t freed_object_count() const noexcept;
+
+  uint64_t freed_ntvhndl_count() const noexcept;
+
+  /**
+   * The last completed cycle, zeroed if there is none.
+   */
+  const corevm::gc::cycle_stats& last_cycle() const noexcept;
+
+  void clear() noexcept;
+
+private:
+  uint64_t m_cycle_count;
+  uint64_t m_minor_cycle_count;
+  uint64_t m_mark_time;
+  uint64_t m_sweep_time;
+  uint64_t m_freed_object_count;
+  uint64_t m_freed_ntvhndl_count;
+  corevm::gc::cycle_stats m_last_cycle;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Writes the totals and the last cycle as a JSON object.
+ */
+std::ostream& operator<<(std::ostream&, const corevm::gc::gc_stats&);
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_GC_STATS_H_ */
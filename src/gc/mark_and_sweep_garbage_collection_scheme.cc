@@ -22,24 +22,236 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include "mark_and_sweep_garbage_collection_scheme.h"
 
+#include "mark_worker_pool.h"
+#include "work_stealing_deque.h"
+#include "dyobj/flags.h"
+
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
 
 
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_manager::on_putattr(
+  corevm::dyobj::dyobj_id owner_id, corevm::dyobj::dyobj_id id) noexcept
+{
+  if (!marked())
+  {
+    return;
+  }
+
+  incremental_state* state = incremental_state::active();
+
+  if (state)
+  {
+    state->shade(id);
+  }
+
+  if (!m_remembered)
+  {
+    generational_state* generations = generational_state::active();
+
+    if (generations)
+    {
+      generations->remember(owner_id);
+      m_remembered = true;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+thread_local corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state*
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::s_active = nullptr;
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::incremental_state()
+  :
+  m_mark_stack(),
+  m_in_progress(false)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::~incremental_state()
+{
+  if (s_active == this)
+  {
+    s_active = nullptr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::in_progress() const noexcept
+{
+  return m_in_progress;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::activate() noexcept
+{
+  s_active = this;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::shade(
+  corevm::dyobj::dyobj_id id)
+{
+  m_mark_stack.push_back(id);
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state*
+corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state::active() noexcept
+{
+  return s_active && s_active->m_in_progress ? s_active : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+thread_local corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state*
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::s_active = nullptr;
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::generational_state()
+  :
+  m_remembered_set()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::~generational_state()
+{
+  if (s_active == this)
+  {
+    s_active = nullptr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::activate() noexcept
+{
+  s_active = this;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::remember(
+  corevm::dyobj::dyobj_id id)
+{
+  m_remembered_set.push_back(id);
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type&
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::remembered_set() const noexcept
+{
+  return m_remembered_set;
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state*
+corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state::active() noexcept
+{
+  return s_active;
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::gc::mark_and_sweep_garbage_collection_scheme::gc(
-  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap) const
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& roots) const
+{
+  root_set_type mark_stack;
+
+  this->begin_marking(heap, roots, mark_stack);
+  this->mark_all(heap, mark_stack);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::mark_and_sweep_garbage_collection_scheme::gc_slice(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& roots,
+  size_t budget,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::incremental_state& state) const
+{
+  if (!state.m_in_progress)
+  {
+    this->begin_marking(heap, roots, state.m_mark_stack);
+    state.m_in_progress = true;
+    state.activate();
+  }
+
+  if (!this->mark(heap, state.m_mark_stack, budget))
+  {
+    return false;
+  }
+
+  // The roots are not guarded by the write barrier, so they are marked again
+  // before the cycle completes.
+  state.m_mark_stack.insert(state.m_mark_stack.end(), roots.begin(), roots.end());
+  this->mark_all(heap, state.m_mark_stack);
+
+  // Ends the write barrier on every thread the state is activated on.
+  state.m_in_progress = false;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::begin_marking(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& roots,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack) const
 {
   using _dynamic_object_heap_type = typename
     corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type;
 
+  mark_stack.assign(roots.begin(), roots.end());
+
+  // Clear the marks left by the previous cycle, and gather the objects that
+  // are pinned by their flags.
   heap.iterate(
-    [this, &heap](
+    [this, &mark_stack](
       _dynamic_object_heap_type::dynamic_object_id_type id,
       _dynamic_object_heap_type::dynamic_object_type& object)
     {
+      object.manager().unmark();
+
       if (this->is_root_object(object))
       {
-        this->mark(heap, object);
+        mark_stack.push_back(id);
       }
     }
   );
@@ -47,40 +259,383 @@ corevm::gc::mark_and_sweep_garbage_collection_scheme::gc(
 
 // -----------------------------------------------------------------------------
 
+bool
+corevm::gc::mark_and_sweep_garbage_collection_scheme::is_garbage(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type& object) noexcept
+{
+  return object.is_garbage_collectible();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::retain(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type& object) noexcept
+{
+  object.manager().mark();
+}
+
+// -----------------------------------------------------------------------------
+
 bool
 corevm::gc::mark_and_sweep_garbage_collection_scheme::is_root_object(
   const corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type& object) const noexcept
 {
-  // TODO: [COREVM-62] Complete mark and sweep GC scheme implementation
-  return true;
+  return object.get_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE);
 }
 
 // -----------------------------------------------------------------------------
 
-void
+bool
 corevm::gc::mark_and_sweep_garbage_collection_scheme::mark(
   corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
-  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type& object) const
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack,
+  size_t budget) const
 {
   using _dynamic_object_type = typename
     corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
 
-  if (!object.is_garbage_collectible())
+  for (size_t i = 0; i < budget && !mark_stack.empty(); ++i)
   {
-    return;
+    corevm::dyobj::dyobj_id id = mark_stack.back();
+    mark_stack.pop_back();
+
+    if (corevm::dyobj::is_immediate(id))
+    {
+      continue;
+    }
+
+    _dynamic_object_type& object = heap.at(id);
+
+    // Frozen objects only refer to other frozen objects.
+    if (object.manager().marked() || object.is_frozen())
+    {
+      continue;
+    }
+
+    object.manager().mark();
+
+    object.iterate(
+      [&mark_stack](
+        _dynamic_object_type::attr_key_type attr_key,
+        _dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        mark_stack.push_back(dyobj_id);
+      }
+    );
+
+    this->trace_ntvhndl(object.ntvhndl_key(), mark_stack);
   }
 
-  object.manager().mark();
+  return mark_stack.empty();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::mark_all(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack) const
+{
+  // Tracing the value of an ephemeron whose key is reachable may make the
+  // keys of other ephemerons reachable, so this runs until nothing changes.
+  do
+  {
+    if (m_mark_thread_count > 1)
+    {
+      this->mark_parallel(heap, mark_stack);
+    }
+    else
+    {
+      this->mark(heap, mark_stack, std::numeric_limits<size_t>::max());
+    }
+
+    this->trace_ephemerons(heap, mark_stack);
+  }
+  while (!mark_stack.empty());
+
+  this->clear_weak_refs(heap);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::trace_ephemerons(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
+
+  heap.iterate_weak_ref_holders(
+    [&heap, &mark_stack](_dynamic_object_type& holder) {
+      if (!holder.manager().marked())
+      {
+        return;
+      }
+
+      holder.iterate_ephemerons(
+        [&heap, &mark_stack](
+          _dynamic_object_type::dyobj_id_type key,
+          _dynamic_object_type::dyobj_id_type value)
+        {
+          _dynamic_object_type* key_object = heap.find(key);
+          _dynamic_object_type* value_object = heap.find(value);
+
+          if (key_object && !key_object->is_garbage_collectible() &&
+              value_object && !value_object->manager().marked())
+          {
+            mark_stack.push_back(value);
+          }
+        }
+      );
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::clear_weak_refs(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
+
+  auto is_dead = [&heap](_dynamic_object_type::dyobj_id_type id) -> bool {
+    _dynamic_object_type* object = heap.find(id);
+    return object == nullptr || object->is_garbage_collectible();
+  };
+
+  heap.iterate_weak_ref_holders(
+    [&is_dead](_dynamic_object_type& holder) {
+      holder.clear_weak_refs(
+        is_dead, [](_dynamic_object_type::dyobj_id_type /* value */) {});
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::mark_parallel(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
+
+  const size_t thread_count = m_mark_thread_count;
+
+  using _deque_type =
+    corevm::gc::work_stealing_deque<corevm::dyobj::dyobj_id>;
+
+  std::vector<std::unique_ptr<_deque_type>> deques;
+
+  for (size_t i = 0; i < thread_count; ++i)
+  {
+    deques.emplace_back(new _deque_type());
+  }
+
+  // Pushing on behalf of the owners is safe here, since the workers have not
+  // started yet; starting them publishes the pushes.
+  for (size_t i = 0; i < mark_stack.size(); ++i)
+  {
+    deques[i % thread_count]->push(mark_stack[i]);
+  }
+
+  mark_stack.clear();
+
+  // Threads that have run out of objects to trace. Only threads that are not
+  // idle push objects, and only onto their own deques, so the deques are all
+  // empty once every thread is idle. A steal that loses a race to another
+  // thread fails even if objects remain, so idle threads keep rescanning the
+  // deques rather than leave early.
+  std::atomic<size_t> idle_count(0);
+  std::atomic<bool> aborted(false);
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  auto worker = [&](size_t index) {
+    _deque_type& own_deque = *deques[index];
+
+    auto next = [&](corevm::dyobj::dyobj_id* id) -> bool {
+      if (own_deque.pop(id))
+      {
+        return true;
+      }
+
+      for (size_t i = 1; i < thread_count; ++i)
+      {
+        if (deques[(index + i) % thread_count]->steal(id))
+        {
+          return true;
+        }
+      }
+
+      return false;
+    };
+
+    try
+    {
+      while (!aborted)
+      {
+        corevm::dyobj::dyobj_id id = 0;
+
+        if (!next(&id))
+        {
+          ++idle_count;
+
+          bool has_work = false;
+
+          while (!has_work && !aborted && idle_count < thread_count)
+          {
+            std::this_thread::yield();
+
+            for (size_t i = 0; i < thread_count && !has_work; ++i)
+            {
+              has_work = !deques[i]->empty();
+            }
+          }
+
+          if (!has_work)
+          {
+            return;
+          }
+
+          --idle_count;
+          continue;
+        }
+
+        if (corevm::dyobj::is_immediate(id))
+        {
+          continue;
+        }
+
+        _dynamic_object_type& object = heap.at(id);
+
+        if (object.is_frozen() || !object.manager().try_mark())
+        {
+          continue;
+        }
+
+        object.iterate(
+          [&own_deque](
+            _dynamic_object_type::attr_key_type attr_key,
+            _dynamic_object_type::dyobj_id_type dyobj_id)
+          {
+            own_deque.push(dyobj_id);
+          }
+        );
+
+        if (object.ntvhndl_key() != corevm::dyobj::NONESET_NTVHNDL_KEY)
+        {
+          root_set_type ids;
+          this->trace_ntvhndl(object.ntvhndl_key(), ids);
+
+          for (const auto& dyobj_id : ids)
+          {
+            own_deque.push(dyobj_id);
+          }
+        }
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+
+      if (!exception)
+      {
+        exception = std::current_exception();
+      }
+
+      aborted = true;
+    }
+  };
+
+  corevm::gc::mark_worker_pool::shared().run(thread_count, worker);
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::mark_and_sweep_garbage_collection_scheme::minor_gc(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& roots,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::generational_state& state) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
+
+  root_set_type mark_stack;
+
+  for (auto itr = heap.nursery().begin(); itr != heap.nursery().end(); ++itr)
+  {
+    _dynamic_object_type* object = heap.find(*itr);
+
+    if (object && this->is_root_object(*object))
+    {
+      mark_stack.push_back(*itr);
+    }
+  }
+
+  for (auto itr = roots.begin(); itr != roots.end(); ++itr)
+  {
+    this->push_young(heap.at(*itr), mark_stack);
+  }
+
+  // Entries of objects freed by a full collection since they were recorded
+  // are skipped, including ids that have since been reused.
+  for (auto itr = state.m_remembered_set.begin(); itr != state.m_remembered_set.end(); ++itr)
+  {
+    _dynamic_object_type* object = heap.find(*itr);
+
+    if (object && object->manager().remembered())
+    {
+      object->manager().set_remembered(false);
+      this->push_young(*object, mark_stack);
+    }
+  }
+
+  state.m_remembered_set.clear();
+
+  this->mark_all(heap, mark_stack);
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_and_sweep_garbage_collection_scheme::push_young(
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type& object,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme::root_set_type& mark_stack) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme::dynamic_object_type;
+
+  if (!object.manager().marked())
+  {
+    mark_stack.push_back(object.id());
+    return;
+  }
 
   object.iterate(
-    [this, &heap](
+    [&mark_stack](
       _dynamic_object_type::attr_key_type attr_key,
       _dynamic_object_type::dyobj_id_type dyobj_id)
     {
-      _dynamic_object_type& referenced_object = heap.at(dyobj_id);
-      this->mark(heap, referenced_object);
+      mark_stack.push_back(dyobj_id);
     }
   );
+
+  this->trace_ntvhndl(object.ntvhndl_key(), mark_stack);
 }
 
 // -----------------------------------------------------------------------------
@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "dyobj/dynamic_object_heap.h"
 #include "dyobj/dynamic_object_manager.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 
@@ -46,13 +48,21 @@ public:
     public:
       dynamic_object_manager()
         :
-        m_marked(false)
+        m_marked(false),
+        m_remembered(false)
+      {
+      }
+
+      dynamic_object_manager(const dynamic_object_manager& other)
+        :
+        m_marked(other.marked()),
+        m_remembered(other.m_remembered)
       {
       }
 
       virtual inline bool garbage_collectible() const noexcept
       {
-        return marked();
+        return !marked();
       }
 
       virtual inline void on_create() noexcept
@@ -80,33 +90,239 @@ public:
         // Do nothing here.
       }
 
+      virtual void on_putattr(
+        corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id) noexcept;
+
+      /*
+       * The mark bit is atomic so that threads marking in parallel agree on
+       * which of them traces each object. Marking does not publish any other
+       * data, so relaxed ordering is sufficient.
+       */
+
       virtual inline bool marked() const noexcept
       {
-        return m_marked;
+        return m_marked.load(std::memory_order_relaxed);
       }
 
       virtual inline void mark() noexcept
       {
-        m_marked = true;
+        m_marked.store(true, std::memory_order_relaxed);
       }
 
       virtual inline void unmark() noexcept
       {
-        m_marked = false;
+        m_marked.store(false, std::memory_order_relaxed);
+      }
+
+      /**
+       * Marks the object, and returns whether it was unmarked before.
+       */
+      virtual inline bool try_mark() noexcept
+      {
+        return !m_marked.exchange(true, std::memory_order_relaxed);
+      }
+
+      /**
+       * Whether the object is in the remembered set of the generational
+       * state.
+       */
+      virtual inline bool remembered() const noexcept
+      {
+        return m_remembered;
+      }
+
+      virtual inline void set_remembered(bool remembered) noexcept
+      {
+        m_remembered = remembered;
       }
 
     protected:
-      bool m_marked;
+      std::atomic<bool> m_marked;
+      bool m_remembered;
   } mark_and_sweep_dynamic_object_manager;
 
   using dynamic_object_type = typename corevm::dyobj::dynamic_object<mark_and_sweep_dynamic_object_manager>;
   using dynamic_object_heap_type = typename corevm::dyobj::dynamic_object_heap<mark_and_sweep_dynamic_object_manager>;
 
-  virtual void gc(dynamic_object_heap_type&) const;
+  /**
+   * Marking progress carried across the slices of an incremental collection.
+   *
+   * While marking is in progress, the state is the target of the write
+   * barrier of every thread it is activated on: setting an object as an
+   * attribute of an already marked object pushes it onto the mark stack.
+   * The threads of a process share its state, so a cycle that completes on
+   * one of them ends the barrier on all of them.
+   */
+  class incremental_state
+  {
+    public:
+      incremental_state();
+      ~incremental_state();
+
+      /* Incremental states should not be copyable. */
+      incremental_state(const incremental_state&) = delete;
+      incremental_state& operator=(const incremental_state&) = delete;
+
+      bool in_progress() const noexcept;
+
+      /**
+       * Makes the state the target of the write barrier on the current
+       * thread, whenever marking is in progress.
+       */
+      void activate() noexcept;
+
+      /**
+       * Ensures that the specified object is marked by the current cycle.
+       */
+      void shade(corevm::dyobj::dyobj_id);
+
+      /**
+       * The state activated on the current thread if its marking is in
+       * progress, or `nullptr` otherwise.
+       */
+      static incremental_state* active() noexcept;
+
+    private:
+      friend class mark_and_sweep_garbage_collection_scheme;
+
+      root_set_type m_mark_stack;
+      std::atomic<bool> m_in_progress;
+
+      static thread_local incremental_state* s_active;
+  };
+
+  /**
+   * Remembered set of generational collection.
+   *
+   * Objects stay marked once they survive a collection, and make up the old
+   * generation; the unmarked objects in the nursery of the heap are the young
+   * ones. Setting an attribute of an old object records it in the remembered
+   * set of the active state, since the object may now refer to a young one.
+   */
+  class generational_state
+  {
+    public:
+      generational_state();
+      ~generational_state();
+
+      /* Generational states should not be copyable. */
+      generational_state(const generational_state&) = delete;
+      generational_state& operator=(const generational_state&) = delete;
+
+      /**
+       * Makes the state the target of the write barrier on the current
+       * thread.
+       */
+      void activate() noexcept;
+
+      void remember(corevm::dyobj::dyobj_id);
+
+      const root_set_type& remembered_set() const noexcept;
+
+      /**
+       * The state targeted by the write barrier on the current thread, or
+       * `nullptr` if there is none.
+       */
+      static generational_state* active() noexcept;
+
+    private:
+      friend class mark_and_sweep_garbage_collection_scheme;
+
+      root_set_type m_remembered_set;
+
+      static thread_local generational_state* s_active;
+  };
+
+  /**
+   * Marks every object reachable from the given roots and from the objects
+   * flagged as not garbage collectible. Objects left unmarked are the ones
+   * swept by the collector, and the weak references to them are cleared.
+   * Ephemeron values are marked only if their keys are.
+   */
+  virtual void gc(dynamic_object_heap_type&, const root_set_type&) const;
+
+  /**
+   * Performs a slice of an incremental collection, tracing at most the
+   * specified number of objects. The first slice of a cycle clears the marks
+   * and pushes the roots. Once the mark stack drains, the roots are marked
+   * again to pick up the objects the process acquired in the meantime.
+   *
+   * Returns `true` when marking has completed and the heap can be swept.
+   */
+  virtual bool gc_slice(
+    dynamic_object_heap_type&, const root_set_type&, size_t, incremental_state&) const;
+
+  /**
+   * Marks the objects of the nursery that are reachable from the given roots
+   * and from the remembered set, without tracing through the old generation.
+   * Objects left unmarked in the nursery are the ones swept by the collector,
+   * and the marked ones are thereby promoted. Empties the remembered set.
+   *
+   * Must not be called while an incremental collection is in progress, since
+   * the old generation is then partly unmarked.
+   */
+  virtual bool minor_gc(
+    dynamic_object_heap_type&, const root_set_type&, generational_state&) const;
+
+  /**
+   * Whether the object was left unmarked by the last collection, and is
+   * therefore reclaimed by a lazy sweep.
+   */
+  static bool is_garbage(dynamic_object_type&) noexcept;
+
+  /**
+   * Marks an object created while the garbage of the last collection is
+   * swept lazily, so that the sweep leaves it alone. The object thereby
+   * belongs to the old generation.
+   */
+  static void retain(dynamic_object_type&) noexcept;
 
 protected:
   virtual bool is_root_object(const dynamic_object_type&) const noexcept;
-  virtual void mark(dynamic_object_heap_type&, dynamic_object_type&) const;
+
+  /**
+   * Clears the marks left by the previous cycle, and fills the mark stack
+   * with the roots.
+   */
+  void begin_marking(dynamic_object_heap_type&, const root_set_type&, root_set_type&) const;
+
+  /**
+   * Traces the object graph with an explicit mark stack, so that deep object
+   * graphs do not exhaust the native stack. Pops at most the specified
+   * number of objects, and returns whether the mark stack has drained.
+   */
+  virtual bool mark(dynamic_object_heap_type&, root_set_type&, size_t) const;
+
+  /**
+   * Drains the mark stack, with as many threads as configured, then clears
+   * the weak references to the objects left unmarked.
+   */
+  void mark_all(dynamic_object_heap_type&, root_set_type&) const;
+
+  /**
+   * Pushes the unmarked values of the ephemerons held by marked objects whose
+   * keys are marked.
+   */
+  void trace_ephemerons(dynamic_object_heap_type&, root_set_type&) const;
+
+  /**
+   * Removes the weak attributes that refer to unmarked objects, and the
+   * ephemerons whose keys are unmarked.
+   */
+  void clear_weak_refs(dynamic_object_heap_type&) const;
+
+  /**
+   * Traces the object graph with the configured number of threads. Each
+   * thread has its own deque of objects to trace, and steals from the
+   * others once its own has drained. Leaves the mark stack empty.
+   */
+  void mark_parallel(dynamic_object_heap_type&, root_set_type&) const;
+
+  /**
+   * Pushes the specified object onto the mark stack if it is young, or else
+   * the objects it refers to.
+   */
+  void push_young(dynamic_object_type&, root_set_type&) const;
 };
 
 
@@ -0,0 +1,206 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "mark_worker_pool.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_worker_pool&
+corevm::gc::mark_worker_pool::shared()
+{
+  static corevm::gc::mark_worker_pool pool;
+  return pool;
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_worker_pool::mark_worker_pool()
+  :
+  m_run_mutex(),
+  m_mutex(),
+  m_work_cond(),
+  m_done_cond(),
+  m_threads(),
+  m_task(nullptr),
+  m_task_count(0),
+  m_pending_count(0),
+  m_generation(0),
+  m_exception(),
+  m_stopped(false)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::mark_worker_pool::~mark_worker_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+
+  m_work_cond.notify_all();
+
+  for (auto itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+  {
+    itr->join();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_worker_pool::run(
+  size_t n, const std::function<void(size_t)>& task)
+{
+  if (n == 0)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Threads started here wait for the generation after the current one.
+    while (m_threads.size() < n - 1)
+    {
+      m_threads.emplace_back(&mark_worker_pool::work, this,
+        m_threads.size() + 1, m_generation);
+    }
+
+    m_task = &task;
+    m_task_count = n;
+    m_pending_count = n - 1;
+    m_exception = nullptr;
+    ++m_generation;
+  }
+
+  m_work_cond.notify_all();
+
+  std::exception_ptr exception;
+
+  try
+  {
+    task(0);
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_done_cond.wait(lock, [this]() { return m_pending_count == 0; });
+
+  m_task = nullptr;
+
+  if (!exception)
+  {
+    exception = m_exception;
+  }
+
+  m_exception = nullptr;
+
+  lock.unlock();
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::gc::mark_worker_pool::thread_count() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_threads.size();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::mark_worker_pool::work(size_t index, uint64_t generation)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true)
+  {
+    m_work_cond.wait(lock, [this, generation]() {
+      return m_stopped || m_generation != generation;
+    });
+
+    if (m_stopped)
+    {
+      return;
+    }
+
+    generation = m_generation;
+
+    // Runs of fewer tasks than there are threads leave the others idle.
+    if (index >= m_task_count)
+    {
+      continue;
+    }
+
+    const std::function<void(size_t)>& task = *m_task;
+
+    lock.unlock();
+
+    std::exception_ptr exception;
+
+    try
+    {
+      task(index);
+    }
+    catch (...)
+    {
+      exception = std::current_exception();
+    }
+
+    lock.lock();
+
+    if (exception && !m_exception)
+    {
+      m_exception = exception;
+    }
+
+    if (--m_pending_count == 0)
+    {
+      m_done_cond.notify_one();
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,103 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_MARK_WORKER_POOL_H_
+#define COREVM_MARK_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+/**
+ * Threads that run the tasks of parallel marks.
+ *
+ * Threads are started the first time a run needs them, and are then kept
+ * waiting for the next run until the pool is destroyed, so that a collection
+ * does not pay for creating and joining threads.
+ */
+class mark_worker_pool
+{
+public:
+  /**
+   * The pool shared by all collections of the process.
+   */
+  static corevm::gc::mark_worker_pool& shared();
+
+  mark_worker_pool();
+
+  ~mark_worker_pool();
+
+  /* Pools should not be copyable. */
+  mark_worker_pool(const mark_worker_pool&) = delete;
+  mark_worker_pool& operator=(const mark_worker_pool&) = delete;
+
+  /**
+   * Invokes the task with every index in [0, n) concurrently, and returns
+   * once all invocations have returned. Index 0 runs on the calling thread.
+   * Concurrent runs are serialized.
+   *
+   * If any invocation throws, one of the exceptions is rethrown after all
+   * invocations have returned.
+   */
+  void run(size_t n, const std::function<void(size_t)>& task);
+
+  /**
+   * Number of threads started so far.
+   */
+  size_t thread_count() const;
+
+private:
+  void work(size_t index, uint64_t generation);
+
+  std::mutex m_run_mutex;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_work_cond;
+  std::condition_variable m_done_cond;
+  std::vector<std::thread> m_threads;
+  const std::function<void(size_t)>* m_task;
+  size_t m_task_count;
+  size_t m_pending_count;
+  uint64_t m_generation;
+  std::exception_ptr m_exception;
+  bool m_stopped;
+};
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_MARK_WORKER_POOL_H_ */
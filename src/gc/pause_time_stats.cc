@@ -0,0 +1,204 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "pause_time_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+
+const size_t corevm::gc::pause_time_stats::SAMPLE_RESERVOIR_SIZE = 1024;
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::pause_time_stats::pause_time_stats()
+  :
+  m_samples(),
+  m_samples_sorted(true),
+  m_rand(),
+  m_histogram(),
+  m_count(0),
+  m_total(0),
+  m_max(0)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::pause_time_stats::record(uint64_t pause_time)
+{
+  ++m_count;
+
+  // Reservoir sampling: the n-th pause replaces a random sample with
+  // probability `SAMPLE_RESERVOIR_SIZE / n`.
+  if (m_samples.size() < SAMPLE_RESERVOIR_SIZE)
+  {
+    m_samples.push_back(pause_time);
+    m_samples_sorted = false;
+  }
+  else
+  {
+    std::uniform_int_distribution<size_t> distribution(0, m_count - 1);
+    size_t index = distribution(m_rand);
+
+    if (index < SAMPLE_RESERVOIR_SIZE)
+    {
+      m_samples[index] = pause_time;
+      m_samples_sorted = false;
+    }
+  }
+
+  size_t bucket = 0;
+  for (uint64_t us = pause_time / 1000; us; us >>= 1)
+  {
+    ++bucket;
+  }
+
+  if (m_histogram.size() <= bucket)
+  {
+    m_histogram.resize(bucket + 1, 0);
+  }
+
+  ++m_histogram[bucket];
+
+  m_total += pause_time;
+  m_max = std::max(m_max, pause_time);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::gc::pause_time_stats::count() const noexcept
+{
+  return m_count;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::pause_time_stats::total() const noexcept
+{
+  return m_total;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::pause_time_stats::max() const noexcept
+{
+  return m_max;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::gc::pause_time_stats::percentile(double p) const
+{
+  if (m_samples.empty())
+  {
+    return 0;
+  }
+
+  p = std::min(std::max(p, 0.0), 100.0);
+
+  if (!m_samples_sorted)
+  {
+    std::sort(m_samples.begin(), m_samples.end());
+    m_samples_sorted = true;
+  }
+
+  size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * m_samples.size()));
+  size_t index = rank > 0 ? rank - 1 : 0;
+
+  return m_samples[index];
+}
+
+// -----------------------------------------------------------------------------
+
+const std::vector<uint64_t>&
+corevm::gc::pause_time_stats::histogram() const noexcept
+{
+  return m_histogram;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::pause_time_stats::clear() noexcept
+{
+  m_samples.clear();
+  m_samples_sorted = true;
+  m_histogram.clear();
+  m_count = 0;
+  m_total = 0;
+  m_max = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+std::ostream&
+operator<<(std::ostream& ost, const corevm::gc::pause_time_stats& stats)
+{
+  ost << "{";
+  ost << "\"count\": " << stats.count() << ", ";
+  ost << "\"total-ns\": " << stats.total() << ", ";
+  ost << "\"p50-ns\": " << stats.percentile(50) << ", ";
+  ost << "\"p90-ns\": " << stats.percentile(90) << ", ";
+  ost << "\"p99-ns\": " << stats.percentile(99) << ", ";
+  ost << "\"max-ns\": " << stats.max() << ", ";
+
+  // Buckets are keyed by their exclusive upper bound, in microseconds.
+  ost << "\"histogram-us\": {";
+  for (size_t i = 0; i < stats.histogram().size(); ++i)
+  {
+    ost << (i ? ", " : "") << "\"" << (uint64_t(1) << i) << "\": " << stats.histogram()[i];
+  }
+  ost << "}";
+
+  ost << "}";
+
+  return ost;
+}
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+// -----------------------------------------------------------------------------
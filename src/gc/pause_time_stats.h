@@ -0,0 +1,103 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_PAUSE_TIME_STATS_H_
+#define COREVM_PAUSE_TIME_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+/**
+ * Records the durations of garbage collection pauses, in nanoseconds.
+ *
+ * Percentiles are computed from a fixed-size uniform sample of the recorded
+ * pauses, so memory use does not grow with the number of pauses. They are
+ * exact until more than `SAMPLE_RESERVOIR_SIZE` pauses have been recorded.
+ */
+class pause_time_stats
+{
+public:
+  static const size_t SAMPLE_RESERVOIR_SIZE;
+
+  pause_time_stats();
+
+  void record(uint64_t);
+
+  size_t count() const noexcept;
+
+  uint64_t total() const noexcept;
+
+  uint64_t max() const noexcept;
+
+  /**
+   * The pause time at the specified percentile, between 0 and 100, using the
+   * nearest-rank method. Returns 0 if no pause has been recorded.
+   */
+  uint64_t percentile(double) const;
+
+  /**
+   * Number of pauses per bucket. Bucket 0 counts the pauses shorter than a
+   * microsecond, and bucket n > 0 the pauses of [2^(n-1), 2^n) microseconds.
+   * Trailing empty buckets are omitted.
+   */
+  const std::vector<uint64_t>& histogram() const noexcept;
+
+  void clear() noexcept;
+
+private:
+  /* Sorted lazily, in place, by `percentile()`. */
+  mutable std::vector<uint64_t> m_samples;
+  mutable bool m_samples_sorted;
+  std::minstd_rand m_rand;
+  std::vector<uint64_t> m_histogram;
+  size_t m_count;
+  uint64_t m_total;
+  uint64_t m_max;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Writes the stats as a JSON object.
+ */
+std::ostream& operator<<(std::ostream&, const corevm::gc::pause_time_stats&);
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_PAUSE_TIME_STATS_H_ */
@@ -22,285 +22,734 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include "reference_count_garbage_collection_scheme.h"
 
-#include <sneaker/algorithm/tarjan.h>
+#include "dyobj/flags.h"
 
-#include <algorithm>
-#include <set>
-#include <unordered_map>
 
+namespace corevm {
 
-using sneaker::algorithm::tarjan;
+
+namespace gc {
+
+
+namespace internal {
+
+
+template<typename dynamic_object_type>
+bool
+is_pinned(const dynamic_object_type& object)
+{
+  return object.get_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE);
+}
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Invokes the function with every object counted as referenced by the
+ * specified one: its attributes and the values of its ephemerons. Immediate
+ * values are not objects, and are skipped.
+ */
+template<typename dynamic_object_type, typename Function>
 void
-corevm::gc::reference_count_garbage_collection_scheme::gc(
-  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap) const
+for_each_counted_ref(dynamic_object_type& object, Function func)
 {
-  using _dynamic_object_heap_type = typename
-    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type;
+  object.iterate(
+    [&func](
+      typename dynamic_object_type::attr_key_type /* attr_key */,
+      typename dynamic_object_type::dyobj_id_type dyobj_id)
+    {
+      if (!corevm::dyobj::is_immediate(dyobj_id))
+      {
+        func(dyobj_id);
+      }
+    }
+  );
 
-  using heap_iterator_type = typename \
-    corevm::gc::reference_count_garbage_collection_scheme::heap_iterator<_dynamic_object_heap_type>;
+  object.iterate_ephemerons(
+    [&func](
+      typename dynamic_object_type::dyobj_id_type /* key */,
+      typename dynamic_object_type::dyobj_id_type value)
+    {
+      if (!corevm::dyobj::is_immediate(value))
+      {
+        func(value);
+      }
+    }
+  );
+}
 
-  heap_iterator_type heap_iterator(heap, *this);
 
-  _dynamic_object_heap_type::size_type prev_active_size = heap.active_size();
+} /* end namespace internal */
 
-  while (true)
-  {
-    heap.iterate(heap_iterator);
 
-    this->remove_cycles(heap);
+} /* end namespace gc */
 
-    if (heap.active_size() == prev_active_size)
-    {
-      break;
-    }
 
-    prev_active_size = heap.active_size();
-  } /* end of `while (true)` */
+} /* end namespace corevm */
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::reference_count_garbage_collection_scheme::zero_count_table::zero_count_table()
+  :
+  m_ids(),
+  m_roots()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::zero_count_table::insert(
+  corevm::dyobj::dyobj_id id)
+{
+  m_ids.insert(id);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::gc::reference_count_garbage_collection_scheme::zero_count_table::size() const noexcept
+{
+  return m_ids.size();
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::gc::reference_count_garbage_collection_scheme::reference_count_garbage_collection_scheme()
+  :
+  garbage_collection_scheme(),
+  m_zero_count_table(nullptr),
+  m_dead_objects()
+{
+  // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
 
-template<typename dynamic_object_heap_type>
-struct object_ref_count_decrementor
+void
+corevm::gc::reference_count_garbage_collection_scheme::set_zero_count_table(
+  corevm::gc::reference_count_garbage_collection_scheme::zero_count_table* zero_count_table) noexcept
 {
-private:
-  using dynamic_object_type = typename dynamic_object_heap_type::dynamic_object_type;
+  m_zero_count_table = zero_count_table;
+}
+
+// -----------------------------------------------------------------------------
 
-public:
-  object_ref_count_decrementor(dynamic_object_heap_type& heap)
-    :
-    m_heap(heap)
+const corevm::gc::reference_count_garbage_collection_scheme::root_set_type*
+corevm::gc::reference_count_garbage_collection_scheme::dead_objects() const noexcept
+{
+  return &m_dead_objects;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::gc(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::reference_count_garbage_collection_scheme::root_set_type& roots) const
+{
+  using _dynamic_object_heap_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type;
+
+  object_list_type dead_objects;
+  object_list_type possible_roots;
+
+  m_dead_objects.clear();
+
+  // Ids held by native handles are not counted. Like the references held by
+  // the process, they keep their objects alive for as long as they are held.
+  // Only the objects recorded as holding such handles are traced.
+  if (m_ntvhndl_tracer)
+  {
+    root_set_type retained_roots(roots);
+
+    heap.iterate_ntvhndl_holders(
+      [this, &retained_roots](
+        _dynamic_object_heap_type::dynamic_object_type& object)
+      {
+        if (!object.is_frozen())
+        {
+          this->trace_ntvhndl(object.ntvhndl_key(), retained_roots);
+        }
+      }
+    );
+
+    this->update_roots(heap, retained_roots);
+  }
+  else
   {
+    this->update_roots(heap, roots);
   }
 
-  void operator()(
-    const typename dynamic_object_type::attr_key_type& attr_key,
-    const typename dynamic_object_type::dyobj_id_type& dyobj_id)
+  if (m_zero_count_table)
   {
-    dynamic_object_type& referenced_object = m_heap.at(dyobj_id);
-    referenced_object.manager().dec_ref_count();
+    std::unordered_set<corevm::dyobj::dyobj_id>& ids = m_zero_count_table->m_ids;
+
+    for (auto itr = ids.begin(); itr != ids.end();)
+    {
+      dynamic_object_type* object = heap.find(*itr);
+
+      if (object && this->classify(*object, dead_objects, possible_roots))
+      {
+        ++itr;
+      }
+      else
+      {
+        itr = ids.erase(itr);
+      }
+    }
+  }
+  else
+  {
+    heap.iterate(
+      [this, &dead_objects, &possible_roots](
+        _dynamic_object_heap_type::dynamic_object_id_type id,
+        _dynamic_object_heap_type::dynamic_object_type& object)
+      {
+        this->classify(object, dead_objects, possible_roots);
+      }
+    );
   }
 
-private:
-  dynamic_object_heap_type& m_heap;
-};
+  this->release(heap, dead_objects, possible_roots);
+  this->collect_cycles(heap, possible_roots);
+  this->clear_weak_refs(heap);
+}
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::gc::reference_count_garbage_collection_scheme::check_and_dec_ref_count(
+corevm::gc::reference_count_garbage_collection_scheme::update_roots(
   corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
-  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& object) const
+  const corevm::gc::reference_count_garbage_collection_scheme::root_set_type& roots) const
 {
   using _dynamic_object_heap_type = typename
     corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type;
 
-  if (!object.is_garbage_collectible())
+  const std::unordered_set<corevm::dyobj::dyobj_id> root_ids(roots.begin(), roots.end());
+
+  // An object that stops being referenced by the process loses a reference
+  // that was never counted.
+  auto unroot = [&root_ids](dynamic_object_type& object) -> bool {
+    if (!object.manager().rooted() || root_ids.count(object.id()))
+    {
+      return false;
+    }
+
+    object.manager().set_rooted(false);
+
+    if (object.manager().ref_count() > 0)
+    {
+      object.manager().set_buffered(true);
+    }
+
+    return true;
+  };
+
+  if (m_zero_count_table)
   {
-    return;
+    for (auto itr = m_zero_count_table->m_roots.begin();
+         itr != m_zero_count_table->m_roots.end(); ++itr)
+    {
+      dynamic_object_type* object = heap.find(*itr);
+
+      if (object && unroot(*object))
+      {
+        m_zero_count_table->insert(*itr);
+      }
+    }
+
+    m_zero_count_table->m_roots.clear();
   }
+  else
+  {
+    heap.iterate(
+      [&unroot](
+        _dynamic_object_heap_type::dynamic_object_id_type id,
+        _dynamic_object_heap_type::dynamic_object_type& object)
+      {
+        unroot(object);
+      }
+    );
+  }
+
+  for (auto itr = root_ids.begin(); itr != root_ids.end(); ++itr)
+  {
+    dynamic_object_type* object = heap.find(*itr);
+
+    if (object)
+    {
+      object->manager().set_rooted(true);
 
-  object_ref_count_decrementor<_dynamic_object_heap_type> decrementor(heap);
-  object.iterate(decrementor);
+      if (m_zero_count_table)
+      {
+        m_zero_count_table->m_roots.push_back(*itr);
+      }
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
 
-template<typename dynamic_object_heap_type>
-struct cycled_object_reference_decrementor
+bool
+corevm::gc::reference_count_garbage_collection_scheme::classify(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& object,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& dead_objects,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& possible_roots) const
 {
-private:
-  using dynamic_object_type = typename dynamic_object_heap_type::dynamic_object_type;
-
-public:
-  cycled_object_reference_decrementor(
-    dynamic_object_heap_type& heap,
-    dynamic_object_type& object)
-    :
-    m_heap(heap),
-    m_object(object)
+  // Frozen objects are never reclaimed.
+  if (object.is_frozen())
   {
+    return false;
   }
 
-  void operator()(
-    const typename dynamic_object_type::attr_key_type& attr_key,
-    const typename dynamic_object_type::dyobj_id_type& dyobj_id)
+  // Objects referenced by the process are reconsidered once they no longer
+  // are.
+  if (object.manager().rooted())
   {
-    dynamic_object_type& referenced_object = m_heap.at(dyobj_id);
+    return true;
+  }
 
-    auto ref_count1 = m_object.manager().ref_count();
-    auto ref_count2 = referenced_object.manager().ref_count();
+  if (corevm::gc::internal::is_pinned(object))
+  {
+    return object.manager().ref_count() == 0;
+  }
 
-    if (referenced_object.has_ref(m_object.id()) && ref_count1 == 1 && ref_count2 == 1)
-    {
-      m_object.manager().dec_ref_count();
-      referenced_object.manager().dec_ref_count();
-    }
+  if (object.manager().ref_count() == 0)
+  {
+    dead_objects.push_back(&object);
+  }
+  else if (object.manager().buffered())
+  {
+    possible_roots.push_back(&object);
   }
 
-private:
-  dynamic_object_heap_type& m_heap;
-  dynamic_object_type& m_object;
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::reference_count_garbage_collection_scheme::gc_slice(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  const corevm::gc::reference_count_garbage_collection_scheme::root_set_type& roots,
+  size_t /* budget */,
+  corevm::gc::reference_count_garbage_collection_scheme::incremental_state& /* state */) const
+{
+  this->gc(heap, roots);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::reference_count_garbage_collection_scheme::minor_gc(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& /* heap */,
+  const corevm::gc::reference_count_garbage_collection_scheme::root_set_type& /* roots */,
+  corevm::gc::reference_count_garbage_collection_scheme::generational_state& /* state */) const
+{
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::gc::reference_count_garbage_collection_scheme::is_garbage(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& object) noexcept
+{
+  return object.manager().dead();
+}
 
-}; /* end of `cycled_object_reference_decrementor` */
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::retain(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& /* object */) noexcept
+{
+  // Do nothing here.
+}
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::gc::reference_count_garbage_collection_scheme::resolve_self_reference_cycles(
+corevm::gc::reference_count_garbage_collection_scheme::release(
   corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
-  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& object) const
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& dead_objects,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& possible_roots) const
 {
-  using _dynamic_object_heap_type = typename
-    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type;
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  while (!dead_objects.empty())
+  {
+    _dynamic_object_type* object = dead_objects.back();
+    dead_objects.pop_back();
 
-  cycled_object_reference_decrementor<_dynamic_object_heap_type> decrementor(heap, object);
-  object.iterate(decrementor);
+    this->set_dead(*object);
+
+    corevm::gc::internal::for_each_counted_ref(
+      *object,
+      [this, &heap, &dead_objects, &possible_roots](
+        _dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        this->release_ref(heap, dyobj_id, dead_objects, possible_roots);
+      }
+    );
+  }
 }
 
 // -----------------------------------------------------------------------------
 
-template<typename dynamic_object_heap_type>
-struct object_graph_builder
+void
+corevm::gc::reference_count_garbage_collection_scheme::release_ref(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::dyobj::dyobj_id dyobj_id,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& dead_objects,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& possible_roots) const
 {
-public:
-  using dynamic_object_type = typename dynamic_object_heap_type::dynamic_object_type;
-  using dyobj_id_type = typename dynamic_object_type::dyobj_id_type;
-  using vertex_type = typename tarjan<dyobj_id_type>::vertex;
-  using vertices_map_type = typename std::unordered_map<dyobj_id_type, vertex_type>;
-  using neighbor_set_type = typename std::set<dyobj_id_type>;
-
-public:
-  object_graph_builder(
-    vertices_map_type& vertices_map,
-    neighbor_set_type& non_garbage_collectible_neighbors)
-    :
-    m_non_garbage_collectible_neighbors(non_garbage_collectible_neighbors),
-    m_vertices_map(vertices_map)
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  if (corevm::dyobj::is_immediate(dyobj_id))
   {
+    return;
   }
 
-  void operator()(dyobj_id_type id, dynamic_object_type& object)
+  _dynamic_object_type& referenced_object = heap.at(dyobj_id);
+
+  if (referenced_object.manager().ref_count() == 0 || referenced_object.is_frozen())
   {
-    if (object.get_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE))
-    {
-      object.iterate(
-        [&](
-          const typename dynamic_object_type::attr_key_type& attr_key,
-          const typename dynamic_object_type::dyobj_id_type& neighbor_id)
-        {
-          m_non_garbage_collectible_neighbors.insert(neighbor_id);
-        }
-      );
+    return;
+  }
+
+  bool buffered = referenced_object.manager().buffered();
+  bool retained = referenced_object.manager().rooted() ||
+    corevm::gc::internal::is_pinned(referenced_object);
 
-      return;
+  referenced_object.manager().dec_ref_count();
+
+  if (referenced_object.manager().ref_count() == 0)
+  {
+    if (!retained)
+    {
+      dead_objects.push_back(&referenced_object);
+    }
+    else if (m_zero_count_table)
+    {
+      m_zero_count_table->insert(dyobj_id);
     }
+  }
+  else if (!buffered && !retained)
+  {
+    possible_roots.push_back(&referenced_object);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::clear_weak_refs(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  auto is_dead = [&heap](_dynamic_object_type::dyobj_id_type id) -> bool {
+    _dynamic_object_type* object = heap.find(id);
+    return object == nullptr || object->is_garbage_collectible();
+  };
+
+  object_list_type dead_objects;
+  object_list_type possible_roots;
 
-    vertex_type& vertex = get_vertex(id);
+  // Releasing the value of an ephemeron may kill the keys of others, so this
+  // runs until no more ephemerons are removed.
+  bool removed = true;
 
-    object.iterate(
-      [&](
-        const typename dynamic_object_type::attr_key_type& attr_key,
-        const typename dynamic_object_type::dyobj_id_type& neighbor_id)
+  while (removed)
+  {
+    removed = false;
+
+    heap.iterate_weak_ref_holders(
+      [this, &heap, &is_dead, &removed, &dead_objects, &possible_roots](
+        _dynamic_object_type& holder)
       {
-        vertex_type& neighbor_vertex = get_vertex(neighbor_id);
+        // The references held by dead holders have been released already.
+        if (holder.is_garbage_collectible())
+        {
+          return;
+        }
 
-        vertex.dependencies().push_back(&neighbor_vertex);
+        holder.clear_weak_refs(
+          is_dead,
+          [this, &heap, &removed, &dead_objects, &possible_roots](
+            _dynamic_object_type::dyobj_id_type value)
+          {
+            removed = true;
+            this->release_ref(heap, value, dead_objects, possible_roots);
+          }
+        );
       }
     );
+
+    this->release(heap, dead_objects, possible_roots);
+    this->collect_cycles(heap, possible_roots);
+    possible_roots.clear();
   }
+}
+
+// -----------------------------------------------------------------------------
 
-private:
-  vertex_type& get_vertex(const dyobj_id_type& id)
+void
+corevm::gc::reference_count_garbage_collection_scheme::collect_cycles(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::reference_count_garbage_collection_scheme::object_list_type& possible_roots) const
+{
+  skipped_decrement_table skipped_decrements;
+
+  // Possible roots that died in the meantime are reclaimed as they are.
+  for (auto itr = possible_roots.begin(); itr != possible_roots.end(); ++itr)
   {
-    auto itr = m_vertices_map.find(id);
+    dynamic_object_type& object = **itr;
 
-    if (itr == m_vertices_map.end())
+    if (object.manager().ref_count() > 0)
     {
-      m_vertices_map[id] = vertex_type(id);
+      this->mark_gray(heap, object, skipped_decrements);
     }
+  }
 
-    return m_vertices_map.at(id);
-  };
-
-  neighbor_set_type& m_non_garbage_collectible_neighbors;
-  vertices_map_type& m_vertices_map;
+  for (auto itr = possible_roots.begin(); itr != possible_roots.end(); ++itr)
+  {
+    this->scan(heap, **itr, skipped_decrements);
+  }
 
-}; /* end of `object_graph_builder` */
+  // Objects left white have a count of zero, and are swept along with the
+  // other dead objects. Trial decrements on the references from white
+  // objects to live ones are left in place, since those references die with
+  // the cycle.
+  for (auto itr = possible_roots.begin(); itr != possible_roots.end(); ++itr)
+  {
+    this->collect_white(heap, **itr);
+    (*itr)->manager().set_buffered(false);
+  }
+}
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::gc::reference_count_garbage_collection_scheme::remove_cycles(
-  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap) const
+corevm::gc::reference_count_garbage_collection_scheme::collect_white(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& root) const
 {
-  using _dynamic_object_heap_type = typename
-    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type;
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  if (root.manager().get_color() != dynamic_object_manager::WHITE ||
+      root.manager().dead())
+  {
+    return;
+  }
 
-  typedef object_graph_builder<_dynamic_object_heap_type> object_graph_builder_type;
+  this->set_dead(root);
 
-  using vertex_type = typename object_graph_builder_type::vertex_type;
-  using dyobj_id_type = typename object_graph_builder_type::dyobj_id_type;
-  using vertices_map_type = typename object_graph_builder_type::vertices_map_type;
-  using neighbor_set_type = typename object_graph_builder_type::neighbor_set_type;
+  object_list_type stack { &root };
 
-  vertices_map_type vertices_map;
-  neighbor_set_type non_garbage_collectible_neighbors;
+  while (!stack.empty())
+  {
+    _dynamic_object_type* object = stack.back();
+    stack.pop_back();
 
-  object_graph_builder_type builder(
-    vertices_map, non_garbage_collectible_neighbors);
+    corevm::gc::internal::for_each_counted_ref(
+      *object,
+      [this, &heap, &stack](_dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        _dynamic_object_type& referenced_object = heap.at(dyobj_id);
+        auto& manager = referenced_object.manager();
 
-  heap.iterate(builder);
+        if (manager.get_color() == dynamic_object_manager::WHITE &&
+            !manager.dead() && !referenced_object.is_frozen())
+        {
+          this->set_dead(referenced_object);
+          stack.push_back(&referenced_object);
+        }
+      }
+    );
+  }
+}
 
-  std::list<vertex_type*> vertices;
+// -----------------------------------------------------------------------------
 
-  for (auto itr = vertices_map.begin(); itr != vertices_map.end(); ++itr)
+void
+corevm::gc::reference_count_garbage_collection_scheme::set_dead(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& object) const
+{
+  object.manager().set_dead();
+  m_dead_objects.push_back(object.id());
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::mark_gray(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& root,
+  corevm::gc::reference_count_garbage_collection_scheme::skipped_decrement_table& skipped_decrements) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  if (root.manager().get_color() == dynamic_object_manager::GRAY)
   {
-    vertex_type* vertex_ptr = static_cast<vertex_type*>(&itr->second);
-    vertices.push_back(vertex_ptr);
+    return;
   }
 
-  tarjan<dyobj_id_type> algo;
-  auto components = algo.get_components(vertices);
+  root.manager().set_color(dynamic_object_manager::GRAY);
 
-  std::list<std::list<dyobj_id_type>> cycles = components.cycles();
+  object_list_type stack { &root };
 
-  for (auto itr = cycles.begin(); itr != cycles.end(); ++itr)
+  while (!stack.empty())
   {
-    std::list<dyobj_id_type> cycle = static_cast<std::list<dyobj_id_type>>(*itr);
+    _dynamic_object_type* object = stack.back();
+    stack.pop_back();
 
-    std::set<dyobj_id_type> cycle_set;
+    corevm::gc::internal::for_each_counted_ref(
+      *object,
+      [&heap, &stack, &skipped_decrements](_dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        _dynamic_object_type& referenced_object = heap.at(dyobj_id);
+        auto& manager = referenced_object.manager();
 
-    for (auto itr_ = cycle.begin(); itr_ != cycle.end(); ++itr_)
-    {
-      dyobj_id_type id = static_cast<dyobj_id_type>(*itr_);
-      cycle_set.insert(id);
-    }
+        // Frozen objects are not counted, and cannot be part of a cycle
+        // with objects that are not frozen.
+        if (referenced_object.is_frozen())
+        {
+          return;
+        }
 
-    std::set<dyobj_id_type> intersect;
-    std::set_intersection(
-      non_garbage_collectible_neighbors.begin(),
-      non_garbage_collectible_neighbors.end(),
-      cycle_set.begin(),
-      cycle_set.end(),
-      std::inserter(intersect, intersect.begin())
+        if (manager.ref_count() > 0)
+        {
+          manager.set_ref_count(manager.ref_count() - 1);
+        }
+        else
+        {
+          ++skipped_decrements[dyobj_id];
+        }
+
+        if (manager.get_color() != dynamic_object_manager::GRAY)
+        {
+          manager.set_color(dynamic_object_manager::GRAY);
+          stack.push_back(&referenced_object);
+        }
+      }
     );
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::scan(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& root,
+  corevm::gc::reference_count_garbage_collection_scheme::skipped_decrement_table& skipped_decrements) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
 
-    if (!intersect.empty())
+  object_list_type stack { &root };
+
+  while (!stack.empty())
+  {
+    _dynamic_object_type* object = stack.back();
+    stack.pop_back();
+
+    if (object->manager().get_color() != dynamic_object_manager::GRAY)
     {
       continue;
     }
 
-    for (auto itr_ = cycle.begin(); itr_ != cycle.end(); ++itr_)
+    // Objects still referenced from outside of the traced subgraph, either by
+    // other objects or by the process, and objects pinned by their flags,
+    // keep everything they reach alive.
+    if (object->manager().ref_count() > 0 ||
+        object->manager().rooted() ||
+        corevm::gc::internal::is_pinned(*object))
     {
-      dyobj_id_type id = static_cast<dyobj_id_type>(*itr_);
-      auto& obj = heap.at(id);
-      obj.manager().dec_ref_count();
+      this->scan_black(heap, *object, skipped_decrements);
+      continue;
     }
+
+    object->manager().set_color(dynamic_object_manager::WHITE);
+
+    corevm::gc::internal::for_each_counted_ref(
+      *object,
+      [&heap, &stack](_dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        _dynamic_object_type& referenced_object = heap.at(dyobj_id);
+
+        if (!referenced_object.is_frozen())
+        {
+          stack.push_back(&referenced_object);
+        }
+      }
+    );
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::gc::reference_count_garbage_collection_scheme::scan_black(
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_heap_type& heap,
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type& root,
+  corevm::gc::reference_count_garbage_collection_scheme::skipped_decrement_table& skipped_decrements) const
+{
+  using _dynamic_object_type = typename
+    corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_type;
+
+  root.manager().set_color(dynamic_object_manager::BLACK);
+
+  object_list_type stack { &root };
+
+  while (!stack.empty())
+  {
+    _dynamic_object_type* object = stack.back();
+    stack.pop_back();
+
+    corevm::gc::internal::for_each_counted_ref(
+      *object,
+      [&heap, &stack, &skipped_decrements](_dynamic_object_type::dyobj_id_type dyobj_id)
+      {
+        _dynamic_object_type& referenced_object = heap.at(dyobj_id);
+        auto& manager = referenced_object.manager();
+
+        if (referenced_object.is_frozen())
+        {
+          return;
+        }
+
+        // Only the decrements that were applied are given back.
+        auto skipped = skipped_decrements.find(dyobj_id);
+
+        if (skipped != skipped_decrements.end())
+        {
+          if (--skipped->second == 0)
+          {
+            skipped_decrements.erase(skipped);
+          }
+        }
+        else
+        {
+          manager.set_ref_count(manager.ref_count() + 1);
+        }
+
+        if (manager.get_color() != dynamic_object_manager::BLACK)
+        {
+          manager.set_color(dynamic_object_manager::BLACK);
+          stack.push_back(&referenced_object);
+        }
+      }
+    );
   }
 }
 
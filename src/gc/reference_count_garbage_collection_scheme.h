@@ -30,7 +30,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "dyobj/dynamic_object_heap.h"
 #include "dyobj/dynamic_object_manager.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 
 namespace corevm {
@@ -39,26 +43,56 @@ namespace corevm {
 namespace gc {
 
 
+/**
+ * Deferred reference counting (Deutsch and Bobrow, 1976), with garbage cycles
+ * reclaimed by trial deletion over the objects that may be the roots of such
+ * cycles (Bacon and Rajan, 2001).
+ *
+ * Only references between objects are counted. References held by the
+ * process, from frames, the object stack and invocation contexts, are not, so
+ * an object whose count is zero may still be in use. Such objects are
+ * recorded in a zero count table, and reconciled against the roots at
+ * collection time.
+ *
+ * An object becomes a possible root of a garbage cycle when it is created,
+ * when its count is decremented to a nonzero value, or when it stops being
+ * referenced by the process. Only the subgraphs reachable from possible
+ * roots are traced for cycles.
+ */
 class reference_count_garbage_collection_scheme : public garbage_collection_scheme
 {
 public:
   typedef class dynamic_object_manager : public corevm::dyobj::dynamic_object_manager
   {
     public:
+      /* Colors of objects during cycle collection. */
+      enum color : uint8_t
+      {
+        BLACK = 0,  /* In use. */
+        GRAY,       /* Possible member of a garbage cycle. */
+        WHITE       /* Member of a garbage cycle. */
+      };
+
       dynamic_object_manager()
         :
-        m_count(0)
+        m_count(0),
+        m_color(BLACK),
+        m_buffered(true),
+        m_rooted(false),
+        m_dead(false)
       {
       }
 
       virtual inline bool garbage_collectible() const noexcept
       {
-        return m_count == 0;
+        return m_count == 0 && !m_rooted;
       }
 
+      /* References held by the process are not counted. */
+
       virtual inline void on_create() noexcept
       {
-        this->inc_ref_count();
+        // Do nothing here.
       }
 
       virtual inline void on_setattr() noexcept
@@ -73,12 +107,18 @@ public:
 
       virtual inline void on_delete() noexcept
       {
-        this->dec_ref_count();
+        // Do nothing here.
       }
 
       virtual inline void on_exit() noexcept
       {
-        this->dec_ref_count();
+        // Do nothing here.
+      }
+
+      virtual inline void on_putattr(
+        corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id) noexcept
+      {
+        // Do nothing here.
       }
 
       virtual inline uint64_t ref_count() const noexcept
@@ -86,6 +126,11 @@ public:
         return m_count;
       }
 
+      virtual inline void set_ref_count(uint64_t count) noexcept
+      {
+        m_count = count;
+      }
+
       virtual inline void inc_ref_count() noexcept
       {
         ++m_count;
@@ -96,51 +141,230 @@ public:
         if (m_count > 0)
         {
           --m_count;
+
+          // Whatever still refers to this object may be a garbage cycle.
+          if (m_count > 0)
+          {
+            m_buffered = true;
+          }
         }
       }
 
+      virtual inline color get_color() const noexcept
+      {
+        return m_color;
+      }
+
+      virtual inline void set_color(color color_) noexcept
+      {
+        m_color = color_;
+      }
+
+      /**
+       * Whether the object is a possible root of a garbage cycle.
+       */
+      virtual inline bool buffered() const noexcept
+      {
+        return m_buffered;
+      }
+
+      virtual inline void set_buffered(bool buffered) noexcept
+      {
+        m_buffered = buffered;
+      }
+
+      /**
+       * Whether the object was referenced by the process as of the last
+       * collection.
+       */
+      virtual inline bool rooted() const noexcept
+      {
+        return m_rooted;
+      }
+
+      virtual inline void set_rooted(bool rooted) noexcept
+      {
+        m_rooted = rooted;
+      }
+
+      /**
+       * Whether a collection has found the object to be garbage. Unlike a
+       * count of zero, this does not change as the process runs.
+       */
+      virtual inline bool dead() const noexcept
+      {
+        return m_dead;
+      }
+
+      virtual inline void set_dead() noexcept
+      {
+        m_dead = true;
+      }
+
     protected:
       uint64_t m_count;
+      color m_color;
+      bool m_buffered;
+      bool m_rooted;
+      bool m_dead;
   } reference_count_dynamic_object_manager;
 
   using dynamic_object_type = typename corevm::dyobj::dynamic_object<reference_count_dynamic_object_manager>;
   using dynamic_object_heap_type = typename corevm::dyobj::dynamic_object_heap<reference_count_dynamic_object_manager>;
 
-  virtual void gc(dynamic_object_heap_type&) const;
-
-  template<typename dynamic_object_heap_type>
-  class heap_iterator
+  /**
+   * Objects that may have a count of zero, recorded between collections: the
+   * objects created, and the ones that lost a reference. Objects that are
+   * still referenced by the process stay in the table.
+   */
+  class zero_count_table
   {
     public:
-      explicit heap_iterator(
-        dynamic_object_heap_type& heap,
-        const corevm::gc::reference_count_garbage_collection_scheme& scheme)
-        :
-        m_heap(heap),
-        m_scheme(scheme)
-      {
-      }
+      zero_count_table();
 
-      void operator()(
-        typename dynamic_object_heap_type::dynamic_object_id_type id,
-        typename dynamic_object_heap_type::dynamic_object_type& object)
-      {
-        m_scheme.check_and_dec_ref_count(m_heap, object);
-        m_scheme.resolve_self_reference_cycles(m_heap, object);
-      }
+      /* Zero count tables should not be copyable. */
+      zero_count_table(const zero_count_table&) = delete;
+      zero_count_table& operator=(const zero_count_table&) = delete;
+
+      void insert(corevm::dyobj::dyobj_id);
+
+      size_t size() const noexcept;
 
     private:
-      dynamic_object_heap_type& m_heap;
-      const corevm::gc::reference_count_garbage_collection_scheme& m_scheme;
+      friend class reference_count_garbage_collection_scheme;
+
+      std::unordered_set<corevm::dyobj::dyobj_id> m_ids;
+
+      /* Objects referenced by the process as of the last collection. */
+      root_set_type m_roots;
   };
 
-  friend class heap_iterator<dynamic_object_heap_type>;
+  reference_count_garbage_collection_scheme();
+
+  /**
+   * Makes collections find the objects with a count of zero in the specified
+   * table, rather than by visiting the whole heap.
+   */
+  void set_zero_count_table(zero_count_table*) noexcept;
+
+  /**
+   * Ids of the objects flagged as dead by the last collection, which the
+   * collector reclaims without sweeping the heap.
+   */
+  const root_set_type* dead_objects() const noexcept;
+
+  /**
+   * Reclaims the objects with a count of zero that are not among the given
+   * roots, then the garbage cycles among the possible roots, and clears the
+   * weak references to the reclaimed objects.
+   *
+   * Weak attributes are not counted. Ephemeron values are counted as
+   * attributes are, until the collection that reclaims their keys; a value
+   * that refers back to its own key therefore keeps both alive.
+   */
+  virtual void gc(dynamic_object_heap_type&, const root_set_type&) const;
+
+  /**
+   * Reference counting does not collect incrementally. Performs a complete
+   * collection and returns `true`.
+   */
+  virtual bool gc_slice(
+    dynamic_object_heap_type&, const root_set_type&, size_t, incremental_state&) const;
+
+  /**
+   * Counts of old objects may depend on young ones, so the nursery cannot be
+   * swept on its own. Returns `false` to have a full collection performed
+   * instead.
+   */
+  virtual bool minor_gc(
+    dynamic_object_heap_type&, const root_set_type&, generational_state&) const;
+
+  /**
+   * Whether the object was found dead by a collection, and is therefore
+   * reclaimed by a lazy sweep.
+   */
+  static bool is_garbage(dynamic_object_type&) noexcept;
+
+  /**
+   * Objects created since the last collection are never found dead by it,
+   * so this does nothing.
+   */
+  static void retain(dynamic_object_type&) noexcept;
 
 protected:
-  void check_and_dec_ref_count(dynamic_object_heap_type&, dynamic_object_type&) const;
-
-  void resolve_self_reference_cycles(dynamic_object_heap_type&, dynamic_object_type&) const;
-  void remove_cycles(dynamic_object_heap_type&) const;
+  typedef std::vector<dynamic_object_type*> object_list_type;
+
+  /**
+   * Flags the specified dead objects as dead and drops the references they
+   * hold, and in turn those held by every object whose count drops to zero
+   * as a result, unless it is rooted.
+   * Objects whose count is decremented to a nonzero value are added to the
+   * possible roots.
+   */
+  void release(dynamic_object_heap_type&, object_list_type&, object_list_type&) const;
+
+  /**
+   * Drops one counted reference to the object with the specified id, and
+   * sorts the object into the dead objects or the possible roots as
+   * `release()` does.
+   */
+  void release_ref(
+    dynamic_object_heap_type&, corevm::dyobj::dyobj_id, object_list_type&, object_list_type&) const;
+
+  /**
+   * Removes the weak attributes that refer to dead objects, and the
+   * ephemerons whose keys are dead, releasing the references held by the
+   * latter to their values.
+   */
+  void clear_weak_refs(dynamic_object_heap_type&) const;
+
+  /**
+   * Trial deletion over the subgraphs reachable from the possible roots.
+   * Members of garbage cycles are left with a count of zero, and are flagged
+   * as dead.
+   */
+  void collect_cycles(dynamic_object_heap_type&, object_list_type&) const;
+
+  /**
+   * Flags the white objects reachable from the specified one through white
+   * objects as dead.
+   */
+  void collect_white(dynamic_object_heap_type&, dynamic_object_type&) const;
+
+  /**
+   * Flags the specified object as dead, and records it in the dead objects.
+   */
+  void set_dead(dynamic_object_type&) const;
+
+  /**
+   * Trial decrements that `mark_gray()` could not apply to objects whose
+   * count was already zero, by object. `scan_black()` cancels these before
+   * restoring counts, so that it gives back exactly what was taken.
+   */
+  typedef std::unordered_map<corevm::dyobj::dyobj_id, uint64_t> skipped_decrement_table;
+
+  void mark_gray(
+    dynamic_object_heap_type&, dynamic_object_type&, skipped_decrement_table&) const;
+  void scan(
+    dynamic_object_heap_type&, dynamic_object_type&, skipped_decrement_table&) const;
+  void scan_black(
+    dynamic_object_heap_type&, dynamic_object_type&, skipped_decrement_table&) const;
+
+  /**
+   * Flags the given roots as rooted, and clears the flag of the objects that
+   * are no longer referenced by the process. The latter become possible roots
+   * of garbage cycles.
+   */
+  void update_roots(dynamic_object_heap_type&, const root_set_type&) const;
+
+  /**
+   * Sorts the specified object into the dead objects or the possible roots.
+   * Returns whether the object has to stay in the zero count table.
+   */
+  bool classify(dynamic_object_type&, object_list_type&, object_list_type&) const;
+
+  zero_count_table* m_zero_count_table;
+  mutable root_set_type m_dead_objects;
 };
 
 
@@ -0,0 +1,303 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_WORK_STEALING_DEQUE_H_
+#define COREVM_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+namespace corevm {
+
+
+namespace gc {
+
+
+/**
+ * A lock-free Chase-Lev work-stealing deque.
+ *
+ * A single owning thread pushes and pops at the bottom, and any other thread
+ * may steal from the top. The buffer doubles when full; the buffers it
+ * outgrows are kept until the deque is destroyed, since thieves may still be
+ * reading from them.
+ *
+ * Uses the memory orderings of Le, Pop, Cohen and Zappa Nardelli, "Correct
+ * and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013.
+ */
+template<typename T>
+class work_stealing_deque
+{
+public:
+  static_assert(std::is_trivially_copyable<T>::value,
+    "Elements must be trivially copyable");
+
+  explicit work_stealing_deque(size_t capacity=64);
+
+  /* Deques should not be copyable. */
+  work_stealing_deque(const work_stealing_deque&) = delete;
+  work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+  /**
+   * Pushes an element at the bottom. Owning thread only.
+   */
+  void push(T);
+
+  /**
+   * Pops the element at the bottom. Owning thread only.
+   * Returns `false` if the deque is empty.
+   */
+  bool pop(T*);
+
+  /**
+   * Takes the element at the top. May be called from any thread.
+   * Returns `false` if the deque is empty, or if another thread took the
+   * element first.
+   */
+  bool steal(T*);
+
+  /**
+   * Whether the deque looked empty at some point during the call.
+   */
+  bool empty() const;
+
+private:
+  class buffer
+  {
+  public:
+    explicit buffer(size_t capacity);
+
+    size_t capacity() const;
+
+    T get(int64_t) const;
+
+    void put(int64_t, T);
+
+  private:
+    const size_t m_mask;
+    std::unique_ptr<std::atomic<T>[]> m_elements;
+  };
+
+  buffer* grow(buffer*, int64_t top, int64_t bottom);
+
+  std::atomic<int64_t> m_top;
+  std::atomic<int64_t> m_bottom;
+  std::atomic<buffer*> m_buffer;
+  std::vector<std::unique_ptr<buffer>> m_buffers;
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::gc::work_stealing_deque<T>::buffer::buffer(size_t capacity)
+  :
+  m_mask(capacity - 1),
+  m_elements(new std::atomic<T>[capacity])
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+size_t
+corevm::gc::work_stealing_deque<T>::buffer::capacity() const
+{
+  return m_mask + 1;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+T
+corevm::gc::work_stealing_deque<T>::buffer::get(int64_t i) const
+{
+  return m_elements[static_cast<size_t>(i) & m_mask].load(
+    std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+void
+corevm::gc::work_stealing_deque<T>::buffer::put(int64_t i, T value)
+{
+  m_elements[static_cast<size_t>(i) & m_mask].store(
+    value, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::gc::work_stealing_deque<T>::work_stealing_deque(size_t capacity)
+  :
+  m_top(0),
+  m_bottom(0),
+  m_buffer(nullptr),
+  m_buffers()
+{
+  // Round the capacity up to a power of two.
+  size_t actual_capacity = 1;
+
+  while (actual_capacity < capacity)
+  {
+    actual_capacity <<= 1;
+  }
+
+  m_buffers.emplace_back(new buffer(actual_capacity));
+  m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+typename corevm::gc::work_stealing_deque<T>::buffer*
+corevm::gc::work_stealing_deque<T>::grow(
+  typename corevm::gc::work_stealing_deque<T>::buffer* old_buffer,
+  int64_t top, int64_t bottom)
+{
+  m_buffers.emplace_back(new buffer(old_buffer->capacity() * 2));
+  buffer* new_buffer = m_buffers.back().get();
+
+  for (int64_t i = top; i < bottom; ++i)
+  {
+    new_buffer->put(i, old_buffer->get(i));
+  }
+
+  m_buffer.store(new_buffer, std::memory_order_release);
+
+  return new_buffer;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+void
+corevm::gc::work_stealing_deque<T>::push(T value)
+{
+  const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+  const int64_t top = m_top.load(std::memory_order_acquire);
+  buffer* current_buffer = m_buffer.load(std::memory_order_relaxed);
+
+  if (bottom - top > static_cast<int64_t>(current_buffer->capacity()) - 1)
+  {
+    current_buffer = grow(current_buffer, top, bottom);
+  }
+
+  current_buffer->put(bottom, value);
+
+  std::atomic_thread_fence(std::memory_order_release);
+  m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+bool
+corevm::gc::work_stealing_deque<T>::pop(T* value)
+{
+  const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+  buffer* current_buffer = m_buffer.load(std::memory_order_relaxed);
+
+  m_bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  int64_t top = m_top.load(std::memory_order_relaxed);
+
+  if (top > bottom)
+  {
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  *value = current_buffer->get(bottom);
+
+  if (top < bottom)
+  {
+    return true;
+  }
+
+  // Last element; race the thieves for it.
+  const bool won = m_top.compare_exchange_strong(top, top + 1,
+    std::memory_order_seq_cst, std::memory_order_relaxed);
+
+  m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+  return won;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+bool
+corevm::gc::work_stealing_deque<T>::steal(T* value)
+{
+  int64_t top = m_top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+  if (top >= bottom)
+  {
+    return false;
+  }
+
+  // Acquire rather than consume, which compilers promote to acquire anyway.
+  buffer* current_buffer = m_buffer.load(std::memory_order_acquire);
+  const T candidate = current_buffer->get(top);
+
+  if (!m_top.compare_exchange_strong(top, top + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed))
+  {
+    return false;
+  }
+
+  *value = candidate;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+bool
+corevm::gc::work_stealing_deque<T>::empty() const
+{
+  const int64_t top = m_top.load(std::memory_order_acquire);
+  const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+  return top >= bottom;
+}
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace gc */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_WORK_STEALING_DEQUE_H_ */
@@ -27,18 +27,29 @@ RUNTIME=runtime
 FRONTEND=frontend
 COREVM_DIR=corevm
 
+SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/allocation_stats.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/allocation_trace.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/arena.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/payload_allocator.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/sequential_allocation_scheme.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(MEMORY)/size_class_allocator.cc
 
 SOURCES += $(TOP_DIR)/$(SRC)/$(DYOBJ)/flags.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(DYOBJ)/util.cc
 
+SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/garbage_collection_scheme.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/gc_stats.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/mark_and_sweep_garbage_collection_scheme.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/mark_worker_pool.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/pause_time_stats.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(GC)/reference_count_garbage_collection_scheme.cc
 
 SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/interfaces.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/native_array.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/native_map.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/native_string.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/number_format.cc
+SOURCES += $(TOP_DIR)/$(SRC)/$(TYPES)/string_intern_table.cc
 
 SOURCES += $(TOP_DIR)/$(SRC)/$(RUNTIME)/closure.cc
 SOURCES += $(TOP_DIR)/$(SRC)/$(RUNTIME)/compartment.cc
@@ -51,6 +51,7 @@ public:
   using propagate_on_container_move_assignment = typename sneaker::allocator::standard_alloc_policy<T>::propagate_on_container_move_assignment;
 
   inline explicit allocation_policy(uint64_t);
+  inline allocation_policy(uint64_t, uint64_t, uint32_t);
   inline explicit allocation_policy(allocation_policy const&);
   inline ~allocation_policy();
 
@@ -69,6 +70,22 @@ public:
    */
   inline uint64_t max_size() const;
 
+  inline uint64_t committed_size() const;
+
+  /**
+   * Gives the pages spanned by free blocks back to the OS.
+   */
+  inline uint64_t release_free_memory();
+
+  inline uint64_t reclaimable_size() const;
+
+  inline corevm::memory::allocation_stats stats() const;
+
+  inline void set_trace(corevm::memory::allocation_trace*);
+
+  template<typename Function>
+  inline bool compact(Function);
+
 protected:
   corevm::memory::allocator<AllocationScheme> m_allocator;
 };
@@ -98,6 +115,17 @@ corevm::memory::allocation_policy<T, AllocationScheme>::allocation_policy(
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocationScheme>
+corevm::memory::allocation_policy<T, AllocationScheme>::allocation_policy(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
+  m_allocator(total_size, max_total_size, arena_flags)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocationScheme>
 corevm::memory::allocation_policy<T, AllocationScheme>::allocation_policy(
   allocation_policy const& other)
@@ -172,6 +200,62 @@ corevm::memory::allocation_policy<T, AllocationScheme>::max_size() const
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocationScheme>
+uint64_t
+corevm::memory::allocation_policy<T, AllocationScheme>::committed_size() const
+{
+  return m_allocator.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocationScheme>
+uint64_t
+corevm::memory::allocation_policy<T, AllocationScheme>::release_free_memory()
+{
+  return m_allocator.release_free_memory();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocationScheme>
+uint64_t
+corevm::memory::allocation_policy<T, AllocationScheme>::reclaimable_size() const
+{
+  return m_allocator.reclaimable_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocationScheme>
+corevm::memory::allocation_stats
+corevm::memory::allocation_policy<T, AllocationScheme>::stats() const
+{
+  return m_allocator.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocationScheme>
+void
+corevm::memory::allocation_policy<T, AllocationScheme>::set_trace(
+  corevm::memory::allocation_trace* trace)
+{
+  m_allocator.set_trace(trace);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocationScheme>
+template<typename Function>
+bool
+corevm::memory::allocation_policy<T, AllocationScheme>::compact(Function func)
+{
+  return m_allocator.compact(func);
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocationScheme>
 inline
 bool operator==(
@@ -0,0 +1,77 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "allocation_stats.h"
+
+#include <cstdint>
+#include <ostream>
+
+
+// -----------------------------------------------------------------------------
+
+double
+corevm::memory::allocation_stats::fragmentation_ratio() const
+{
+  if (free_size == 0)
+  {
+    return 0;
+  }
+
+  return 1.0 - static_cast<double>(largest_free_block_size) / free_size;
+}
+
+// -----------------------------------------------------------------------------
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+std::ostream&
+operator<<(std::ostream& ost, const corevm::memory::allocation_stats& stats)
+{
+  ost << "{";
+  ost << "\"alloc-count\": " << stats.alloc_count << ", ";
+  ost << "\"free-count\": " << stats.free_count << ", ";
+  ost << "\"allocated-size\": " << stats.allocated_size << ", ";
+  ost << "\"peak-allocated-size\": " << stats.peak_allocated_size << ", ";
+  ost << "\"free-block-count\": " << stats.free_block_count << ", ";
+  ost << "\"free-size\": " << stats.free_size << ", ";
+  ost << "\"largest-free-block-size\": " << stats.largest_free_block_size << ", ";
+  ost << "\"fragmentation-ratio\": " << stats.fragmentation_ratio() << ", ";
+  ost << "\"find-fit-time-ns\": " << stats.find_fit_time << ", ";
+  ost << "\"combine-free-blocks-time-ns\": " << stats.combine_free_blocks_time;
+  ost << "}";
+
+  return ost;
+}
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,87 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_ALLOCATION_STATS_H_
+#define COREVM_ALLOCATION_STATS_H_
+
+#include <cstdint>
+#include <ostream>
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+/**
+ * Allocation schemes only time their searches for free blocks and their
+ * merges of free blocks when `COREVM_ALLOCATION_TIMING` is defined to a
+ * nonzero value at build time, as timing takes two clock reads per
+ * allocation and per deallocation. The time counters stay at 0 otherwise.
+ */
+#ifndef COREVM_ALLOCATION_TIMING
+  #define COREVM_ALLOCATION_TIMING 0
+#endif
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Counters describing the activity and the layout of an allocation scheme.
+ * Times are measured in nanoseconds.
+ */
+typedef struct allocation_stats
+{
+  uint64_t alloc_count;
+  uint64_t free_count;
+  uint64_t allocated_size;
+  uint64_t peak_allocated_size;
+  uint64_t free_block_count;
+  uint64_t free_size;
+  uint64_t largest_free_block_size;
+  uint64_t find_fit_time;
+  uint64_t combine_free_blocks_time;
+
+  /**
+   * External fragmentation, as the portion of free space that lies outside
+   * of the largest free block. Ranges from 0 (no fragmentation) to 1.
+   */
+  double fragmentation_ratio() const;
+} allocation_stats;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Writes the stats as a JSON object.
+ */
+std::ostream& operator<<(std::ostream&, const corevm::memory::allocation_stats&);
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_ALLOCATION_STATS_H_ */
@@ -0,0 +1,455 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "allocation_trace.h"
+
+#include "corevm/macros.h"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <ios>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+
+const char ALLOCATION_TRACE_MAGIC[4] = { 'C', 'V', 'A', 'T' };
+
+const uint32_t ALLOCATION_TRACE_VERSION = 1;
+
+// -----------------------------------------------------------------------------
+
+typedef corevm::memory::allocation_trace _MyType;
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::allocation_trace::allocation_trace()
+  :
+  m_start(std::chrono::steady_clock::now()),
+  m_records(),
+  m_mutex()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::record(
+  record_type type, uint64_t size, uint64_t offset)
+{
+  uint64_t timestamp = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - m_start).count());
+
+  allocation_trace_record record { type, size, offset, timestamp };
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_records.push_back(record);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::append(const allocation_trace_record& record)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_records.push_back(record);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::memory::allocation_trace::size() const
+{
+  return m_records.size();
+}
+
+// -----------------------------------------------------------------------------
+
+_MyType::const_iterator
+corevm::memory::allocation_trace::cbegin() const
+{
+  return m_records.cbegin();
+}
+
+// -----------------------------------------------------------------------------
+
+_MyType::const_iterator
+corevm::memory::allocation_trace::cend() const
+{
+  return m_records.cend();
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::memory::allocation_trace_record&
+corevm::memory::allocation_trace::operator[](size_t i) const
+{
+  return m_records[i];
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_records.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+static void
+write_value(std::ofstream& fs, const T& value)
+{
+  fs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+static void
+read_value(std::ifstream& fs, T* value)
+{
+  fs.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::save(const std::string& path) const
+  throw(corevm::memory::allocation_trace_error)
+{
+  std::ofstream fs(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+  if (!fs)
+  {
+    THROW(corevm::memory::allocation_trace_error(
+      str(boost::format("Error writing allocation trace %s") % path)));
+  }
+
+  fs.write(ALLOCATION_TRACE_MAGIC, sizeof(ALLOCATION_TRACE_MAGIC));
+  write_value(fs, ALLOCATION_TRACE_VERSION);
+  write_value(fs, static_cast<uint64_t>(m_records.size()));
+
+  for (auto itr = m_records.cbegin(); itr != m_records.cend(); ++itr)
+  {
+    write_value(fs, itr->type);
+    write_value(fs, itr->size);
+    write_value(fs, itr->offset);
+    write_value(fs, itr->timestamp);
+  }
+
+  if (!fs)
+  {
+    THROW(corevm::memory::allocation_trace_error(
+      str(boost::format("Error writing allocation trace %s") % path)));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::load(const std::string& path)
+  throw(corevm::memory::allocation_trace_error)
+{
+  std::ifstream fs(path, std::ios::binary | std::ios::in);
+
+  if (!fs)
+  {
+    THROW(corevm::memory::allocation_trace_error(
+      str(boost::format("Error reading allocation trace %s") % path)));
+  }
+
+  char magic[sizeof(ALLOCATION_TRACE_MAGIC)];
+  uint32_t version = 0;
+  uint64_t count = 0;
+
+  fs.read(magic, sizeof(magic));
+  read_value(fs, &version);
+  read_value(fs, &count);
+
+  if (!fs ||
+      !std::equal(magic, magic + sizeof(magic), ALLOCATION_TRACE_MAGIC) ||
+      version != ALLOCATION_TRACE_VERSION)
+  {
+    THROW(corevm::memory::allocation_trace_error(
+      str(boost::format("Invalid allocation trace %s") % path)));
+  }
+
+  std::vector<allocation_trace_record> records;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    allocation_trace_record record;
+
+    read_value(fs, &record.type);
+    read_value(fs, &record.size);
+    read_value(fs, &record.offset);
+    read_value(fs, &record.timestamp);
+
+    if (!fs)
+    {
+      THROW(corevm::memory::allocation_trace_error(
+        str(boost::format("Truncated allocation trace %s") % path)));
+    }
+
+    records.push_back(record);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_records.swap(records);
+}
+
+// -----------------------------------------------------------------------------
+
+namespace {
+
+
+/**
+ * Helper for the synthetic generators. Offsets are unique ids rather than
+ * real addresses, which is all a replay needs.
+ */
+class trace_generator
+{
+public:
+  trace_generator(corevm::memory::allocation_trace& trace,
+    uint64_t min_size, uint64_t max_size, uint32_t seed)
+    :
+    m_trace(trace),
+    m_engine(seed),
+    m_size_distribution(min_size, std::max(min_size, max_size)),
+    m_next_offset(0),
+    m_timestamp(0),
+    m_sizes()
+  {
+  }
+
+  uint64_t allocate()
+  {
+    uint64_t offset = m_next_offset++;
+    uint64_t size = m_size_distribution(m_engine);
+
+    m_sizes.push_back(size);
+
+    append(corevm::memory::allocation_trace::ALLOCATE, size, offset);
+
+    return offset;
+  }
+
+  void deallocate(uint64_t offset)
+  {
+    append(corevm::memory::allocation_trace::DEALLOCATE, m_sizes[offset], offset);
+  }
+
+  uint64_t random(uint64_t bound)
+  {
+    return std::uniform_int_distribution<uint64_t>(0, bound - 1)(m_engine);
+  }
+
+private:
+  void append(uint8_t type, uint64_t size, uint64_t offset)
+  {
+    corevm::memory::allocation_trace_record record {
+      type, size, offset, m_timestamp++ };
+
+    m_trace.append(record);
+  }
+
+  corevm::memory::allocation_trace& m_trace;
+  std::mt19937 m_engine;
+  std::uniform_int_distribution<uint64_t> m_size_distribution;
+  uint64_t m_next_offset;
+  uint64_t m_timestamp;
+  std::vector<uint64_t> m_sizes;
+};
+
+// -----------------------------------------------------------------------------
+
+void
+free_one_randomly(trace_generator& generator, std::vector<uint64_t>& live)
+{
+  size_t i = generator.random(live.size());
+  generator.deallocate(live[i]);
+  live[i] = live.back();
+  live.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+free_randomly(trace_generator& generator, std::vector<uint64_t>& live)
+{
+  while (!live.empty())
+  {
+    free_one_randomly(generator, live);
+  }
+}
+
+
+} /* anonymous namespace */
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::generate_steady_state(
+  allocation_trace& trace,
+  uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed)
+{
+  const size_t LIVE_SET_SIZE = 256;
+
+  trace_generator generator(trace, min_size, max_size, seed);
+  std::vector<uint64_t> live;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    if (live.size() >= LIVE_SET_SIZE)
+    {
+      free_one_randomly(generator, live);
+    }
+
+    live.push_back(generator.allocate());
+  }
+
+  free_randomly(generator, live);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::generate_bursty(
+  allocation_trace& trace,
+  uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed)
+{
+  const uint64_t MAX_BURST_SIZE = 1024;
+
+  /* One out of this many objects in each burst survives it. */
+  const uint64_t SURVIVOR_RATIO = 10;
+
+  trace_generator generator(trace, min_size, max_size, seed);
+  std::vector<uint64_t> survivors;
+
+  uint64_t allocated = 0;
+
+  while (allocated < count)
+  {
+    uint64_t burst_size = std::min(
+      count - allocated, generator.random(MAX_BURST_SIZE) + 1);
+
+    std::vector<uint64_t> burst;
+
+    for (uint64_t i = 0; i < burst_size; ++i)
+    {
+      burst.push_back(generator.allocate());
+    }
+
+    allocated += burst_size;
+
+    for (auto itr = burst.begin(); itr != burst.end(); ++itr)
+    {
+      if (generator.random(SURVIVOR_RATIO) == 0)
+      {
+        survivors.push_back(*itr);
+      }
+      else
+      {
+        generator.deallocate(*itr);
+      }
+    }
+  }
+
+  free_randomly(generator, survivors);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::allocation_trace::generate_lifetime_mix(
+  allocation_trace& trace,
+  uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed)
+{
+  /* One out of this many objects lives until the end. */
+  const uint64_t LONG_LIVED_RATIO = 20;
+
+  const uint64_t MAX_SHORT_LIFETIME = 64;
+
+  trace_generator generator(trace, min_size, max_size, seed);
+  std::vector<uint64_t> long_lived;
+
+  /* Short-lived objects paired with the step at which they die. */
+  std::deque<std::pair<uint64_t, uint64_t>> short_lived;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    uint64_t offset = generator.allocate();
+
+    if (generator.random(LONG_LIVED_RATIO) == 0)
+    {
+      long_lived.push_back(offset);
+    }
+    else
+    {
+      uint64_t death = i + generator.random(MAX_SHORT_LIFETIME) + 1;
+
+      auto itr = std::upper_bound(
+        short_lived.begin(),
+        short_lived.end(),
+        death,
+        [](uint64_t value, const std::pair<uint64_t, uint64_t>& entry) -> bool {
+          return value < entry.second;
+        }
+      );
+
+      short_lived.insert(itr, std::make_pair(offset, death));
+    }
+
+    while (!short_lived.empty() && short_lived.front().second <= i)
+    {
+      generator.deallocate(short_lived.front().first);
+      short_lived.pop_front();
+    }
+  }
+
+  while (!short_lived.empty())
+  {
+    generator.deallocate(short_lived.front().first);
+    short_lived.pop_front();
+  }
+
+  free_randomly(generator, long_lived);
+}
+
+// -----------------------------------------------------------------------------
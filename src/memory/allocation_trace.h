@@ -0,0 +1,155 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_ALLOCATION_TRACE_H_
+#define COREVM_ALLOCATION_TRACE_H_
+
+#include "corevm/errors.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+class allocation_trace_error : public corevm::runtime_error
+{
+public:
+  explicit allocation_trace_error(const std::string& what_arg):
+    corevm::runtime_error(what_arg)
+  {
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+typedef struct allocation_trace_record
+{
+  uint8_t type;
+  uint64_t size;
+  uint64_t offset;
+  uint64_t timestamp;
+} allocation_trace_record;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * An ordered log of the allocations and deallocations seen by an allocator.
+ *
+ * Offsets are relative to the base of the allocator that produced the trace,
+ * and are only used to pair a deallocation with its allocation. Timestamps
+ * are in nanoseconds since the trace was created.
+ *
+ * Traces are stored in a compact binary format: a header holding a magic
+ * number, a version and the record count, followed by fixed-size records.
+ */
+class allocation_trace
+{
+public:
+  enum record_type : uint8_t
+  {
+    ALLOCATE = 0x01,
+    DEALLOCATE = 0x02
+  };
+
+  using const_iterator = typename std::vector<allocation_trace_record>::const_iterator;
+
+  allocation_trace();
+
+  /* Traces should not be copyable. */
+  allocation_trace(const allocation_trace&) = delete;
+  allocation_trace& operator=(const allocation_trace&) = delete;
+
+  /**
+   * Appends a record stamped with the current time. Thread-safe.
+   */
+  void record(record_type, uint64_t size, uint64_t offset);
+
+  void append(const allocation_trace_record&);
+
+  size_t size() const;
+
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+  const allocation_trace_record& operator[](size_t) const;
+
+  void clear();
+
+  void save(const std::string&) const
+    throw(corevm::memory::allocation_trace_error);
+
+  /**
+   * Replaces the content of this trace with the one stored in the file.
+   */
+  void load(const std::string&)
+    throw(corevm::memory::allocation_trace_error);
+
+  /* Synthetic trace generators.
+   *
+   * Each one produces `count` allocations with sizes uniformly distributed
+   * between `min_size` and `max_size`, and frees everything by the end.
+   */
+
+  /**
+   * Keeps a roughly constant number of live objects, freeing a random one
+   * for every new allocation.
+   */
+  static void generate_steady_state(allocation_trace&,
+    uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed);
+
+  /**
+   * Allocates in bursts, most of which die right after the burst.
+   */
+  static void generate_bursty(allocation_trace&,
+    uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed);
+
+  /**
+   * Mixes a small portion of objects that live until the end with many
+   * short-lived ones.
+   */
+  static void generate_lifetime_mix(allocation_trace&,
+    uint64_t count, uint64_t min_size, uint64_t max_size, uint32_t seed);
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+  std::vector<allocation_trace_record> m_records;
+  std::mutex m_mutex;
+};
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_ALLOCATION_TRACE_H_ */
@@ -23,6 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_MEMORY_ALLOCATOR_H_
 #define COREVM_MEMORY_ALLOCATOR_H_
 
+#include "allocation_stats.h"
+#include "allocation_trace.h"
+#include "arena.h"
 #include "corevm/macros.h"
 
 #include <cstddef>
@@ -40,11 +43,21 @@ namespace corevm {
 namespace memory {
 
 
+/**
+ * Hands out memory from an `arena` according to an allocation scheme.
+ *
+ * The allocator starts out managing `total_size` bytes, but reserves address
+ * space for up to `max_total_size` bytes, and grows into it in chunks of
+ * `COREVM_DEFAULT_ARENA_GROW_CHUNK_SIZE` bytes when the allocation scheme runs
+ * out of space. Only the pages that have actually been handed out are
+ * committed.
+ */
 template<class allocation_scheme>
 class allocator
 {
 public:
-  explicit allocator(uint64_t);
+  explicit allocator(uint64_t total_size, uint64_t max_total_size=0,
+    uint32_t arena_flags=0);
 
   ~allocator();
 
@@ -61,31 +74,71 @@ public:
 
   uint64_t total_size() const noexcept;
 
+  uint64_t max_total_size() const noexcept;
+
+  uint64_t committed_size() const noexcept;
+
+  /**
+   * Gives the pages spanned by free blocks back to the OS.
+   * Returns the number of bytes released.
+   */
+  uint64_t release_free_memory() noexcept;
+
+  /**
+   * Bytes freed since `release_free_memory()` was last called, counted from
+   * the peak allocated size since then. An upper bound of what releasing
+   * free memory again would give back.
+   */
+  uint64_t reclaimable_size() const noexcept;
+
+  corevm::memory::allocation_stats stats() const noexcept;
+
+  /**
+   * Records every subsequent allocation and deallocation into the specified
+   * trace, which must outlive the allocator. Pass `nullptr` to stop.
+   */
+  void set_trace(corevm::memory::allocation_trace*) noexcept;
+
+  /**
+   * Slides all allocated blocks to the bottom of the heap. `Function` is
+   * invoked with the old address, the new address and the size of every
+   * block that moves, and is responsible for moving its content.
+   *
+   * Returns `false` if the allocation scheme does not support compaction.
+   */
+  template<typename Function>
+  bool compact(Function) noexcept;
+
 private:
+  bool grow(size_t) noexcept;
+
   uint64_t m_total_size;
+  uint64_t m_max_total_size;
   uint64_t m_allocated_size;
+  uint64_t m_peak_allocated_size_since_release;
+  corevm::memory::arena m_arena;
   void* m_heap;
   allocation_scheme m_allocation_scheme;
+  corevm::memory::allocation_trace* m_trace;
 };
 
 
 // -----------------------------------------------------------------------------
 
 template<class allocation_scheme>
-corevm::memory::allocator<allocation_scheme>::allocator(uint64_t total_size):
+corevm::memory::allocator<allocation_scheme>::allocator(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
   m_total_size(total_size),
+  m_max_total_size(max_total_size > total_size ? max_total_size : total_size),
   m_allocated_size(0),
-  m_heap(nullptr),
-  m_allocation_scheme(allocation_scheme(m_total_size))
+  m_peak_allocated_size_since_release(0),
+  m_arena(m_max_total_size, arena_flags),
+  m_heap(m_arena.base()),
+  m_allocation_scheme(allocation_scheme(m_total_size)),
+  m_trace(nullptr)
 {
-  void* mem = malloc(m_total_size);
-
-  if (!mem)
-  {
-    THROW(std::bad_alloc());
-  }
-
-  m_heap = mem;
+  // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
@@ -93,11 +146,7 @@ corevm::memory::allocator<allocation_scheme>::allocator(uint64_t total_size):
 template<class allocation_scheme>
 corevm::memory::allocator<allocation_scheme>::~allocator()
 {
-  if (m_heap)
-  {
-    free(m_heap);
-    m_heap = nullptr;
-  }
+  // Do nothing here.
 }
 
 // -----------------------------------------------------------------------------
@@ -120,13 +169,66 @@ corevm::memory::allocator<allocation_scheme>::total_size() const noexcept
 
 // -----------------------------------------------------------------------------
 
+template<class allocation_scheme>
+uint64_t
+corevm::memory::allocator<allocation_scheme>::max_total_size() const noexcept
+{
+  return m_max_total_size;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+uint64_t
+corevm::memory::allocator<allocation_scheme>::committed_size() const noexcept
+{
+  return m_arena.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+corevm::memory::allocation_stats
+corevm::memory::allocator<allocation_scheme>::stats() const noexcept
+{
+  return m_allocation_scheme.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+void
+corevm::memory::allocator<allocation_scheme>::set_trace(
+  corevm::memory::allocation_trace* trace) noexcept
+{
+  m_trace = trace;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+template<typename Function>
+bool
+corevm::memory::allocator<allocation_scheme>::compact(Function func) noexcept
+{
+  uint8_t* base = static_cast<uint8_t*>(m_heap);
+
+  return m_allocation_scheme.compact(
+    [base, &func](uint64_t from, uint64_t to, uint64_t size) {
+      func(base + from, base + to, static_cast<size_t>(size));
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
 template<class allocation_scheme>
 void*
 corevm::memory::allocator<allocation_scheme>::allocate(size_t size) noexcept
 {
   void* ptr = nullptr;
 
-  if (size > m_total_size)
+  if (size > m_max_total_size)
   {
     return ptr;
   }
@@ -138,15 +240,37 @@ corevm::memory::allocator<allocation_scheme>::allocate(size_t size) noexcept
 
   ssize_t offset = m_allocation_scheme.malloc(size);
 
+  if (offset < 0 && this->grow(size))
+  {
+    offset = m_allocation_scheme.malloc(size);
+  }
+
+  if (offset >= 0 && !m_arena.commit(static_cast<uint64_t>(offset) + size))
+  {
+    m_allocation_scheme.free(static_cast<size_t>(offset));
+    offset = -1;
+  }
+
   if (offset >= 0)
   {
     uint8_t* base = static_cast<uint8_t*>(m_heap);
-    ptr = base + static_cast<uint32_t>(offset);
+    ptr = base + static_cast<uint64_t>(offset);
     m_allocated_size += static_cast<uint64_t>(size);
 
+    if (m_allocated_size > m_peak_allocated_size_since_release)
+    {
+      m_peak_allocated_size_since_release = m_allocated_size;
+    }
+
 #if __DEBUG__
     ASSERT(m_allocated_size <= m_total_size);
 #endif
+
+    if (m_trace)
+    {
+      m_trace->record(corevm::memory::allocation_trace::ALLOCATE,
+        size, static_cast<uint64_t>(offset));
+    }
   }
 
   return ptr;
@@ -180,6 +304,12 @@ corevm::memory::allocator<allocation_scheme>::deallocate(void* ptr) noexcept
     ASSERT(m_allocated_size <= m_total_size);
 #endif
 
+    if (m_trace)
+    {
+      m_trace->record(corevm::memory::allocation_trace::DEALLOCATE,
+        static_cast<uint64_t>(size), offset);
+    }
+
     res = 1;
   }
 
@@ -188,6 +318,66 @@ corevm::memory::allocator<allocation_scheme>::deallocate(void* ptr) noexcept
 
 // -----------------------------------------------------------------------------
 
+template<class allocation_scheme>
+bool
+corevm::memory::allocator<allocation_scheme>::grow(size_t size) noexcept
+{
+  uint64_t available_size = m_max_total_size - m_total_size;
+
+  uint64_t grow_size = COREVM_DEFAULT_ARENA_GROW_CHUNK_SIZE;
+
+  while (grow_size < size)
+  {
+    grow_size += COREVM_DEFAULT_ARENA_GROW_CHUNK_SIZE;
+  }
+
+  if (grow_size > available_size)
+  {
+    grow_size = available_size;
+  }
+
+  if (grow_size == 0 || !m_allocation_scheme.grow(grow_size))
+  {
+    return false;
+  }
+
+  m_total_size += grow_size;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+uint64_t
+corevm::memory::allocator<allocation_scheme>::release_free_memory() noexcept
+{
+  uint64_t released_size = 0;
+
+  for (auto itr = m_allocation_scheme.cbegin(); itr != m_allocation_scheme.cend(); ++itr)
+  {
+    if (itr->actual_size == 0)
+    {
+      released_size += m_arena.release(itr->offset, itr->size);
+    }
+  }
+
+  m_peak_allocated_size_since_release = m_allocated_size;
+
+  return released_size;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+uint64_t
+corevm::memory::allocator<allocation_scheme>::reclaimable_size() const noexcept
+{
+  return m_peak_allocated_size_since_release - m_allocated_size;
+}
+
+// -----------------------------------------------------------------------------
+
 template<class allocation_scheme>
 void
 corevm::memory::allocator<allocation_scheme>::debug_print() const noexcept
@@ -0,0 +1,218 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "arena.h"
+
+#include "corevm/macros.h"
+
+#include <cstdint>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+  #define MAP_ANONYMOUS MAP_ANON
+#endif
+
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+round_up(uint64_t value, uint64_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+round_down(uint64_t value, uint64_t alignment)
+{
+  return value / alignment * alignment;
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::arena::arena(uint64_t reserved_size, uint32_t flags)
+  :
+  m_reserved_size(round_up(reserved_size ? reserved_size : 1, page_size())),
+  m_committed_size(0),
+  m_flags(flags),
+  m_base(nullptr)
+{
+  void* mem = mmap(
+    nullptr,
+    m_reserved_size,
+    PROT_NONE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+    -1,
+    0
+  );
+
+  if (mem == MAP_FAILED)
+  {
+    THROW(std::bad_alloc());
+  }
+
+  m_base = mem;
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::arena::~arena()
+{
+  if (m_base)
+  {
+    munmap(m_base, m_reserved_size);
+    m_base = nullptr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void*
+corevm::memory::arena::base() const noexcept
+{
+  return m_base;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::arena::reserved_size() const noexcept
+{
+  return m_reserved_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::arena::committed_size() const noexcept
+{
+  return m_committed_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t
+corevm::memory::arena::flags() const noexcept
+{
+  return m_flags;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::arena::commit(uint64_t size) noexcept
+{
+  if (size <= m_committed_size)
+  {
+    return true;
+  }
+
+  if (size > m_reserved_size)
+  {
+    return false;
+  }
+
+  uint64_t committed_size = round_up(size, COREVM_DEFAULT_ARENA_COMMIT_CHUNK_SIZE);
+
+  if (committed_size > m_reserved_size)
+  {
+    committed_size = m_reserved_size;
+  }
+
+  uint8_t* start = static_cast<uint8_t*>(m_base) + m_committed_size;
+  size_t length = static_cast<size_t>(committed_size - m_committed_size);
+
+  if (mprotect(start, length, PROT_READ | PROT_WRITE) != 0)
+  {
+    return false;
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (m_flags & ARENA_USE_HUGE_PAGES)
+  {
+    // Only advisory; falls back to regular pages if THP is unavailable.
+    madvise(start, length, MADV_HUGEPAGE);
+  }
+#endif
+
+  if (m_flags & ARENA_PREFAULT)
+  {
+    const uint64_t page = page_size();
+
+    for (uint64_t i = 0; i < length; i += page)
+    {
+      static_cast<volatile uint8_t*>(start)[i] = 0;
+    }
+  }
+
+  m_committed_size = committed_size;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::arena::release(uint64_t offset, uint64_t size) noexcept
+{
+  const uint64_t page = page_size();
+
+  uint64_t end = offset + size;
+
+  if (end > m_committed_size)
+  {
+    end = m_committed_size;
+  }
+
+  uint64_t start = round_up(offset, page);
+  end = round_down(end, page);
+
+  if (end <= start)
+  {
+    return 0;
+  }
+
+  uint8_t* addr = static_cast<uint8_t*>(m_base) + start;
+
+  if (madvise(addr, static_cast<size_t>(end - start), MADV_DONTNEED) != 0)
+  {
+    return 0;
+  }
+
+  return end - start;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::arena::page_size() noexcept
+{
+  static const uint64_t size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// -----------------------------------------------------------------------------
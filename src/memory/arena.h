@@ -0,0 +1,114 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_ARENA_H_
+#define COREVM_ARENA_H_
+
+#include <cstdint>
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+/**
+ * Granularity at which reserved address space is committed.
+ */
+const uint64_t COREVM_DEFAULT_ARENA_COMMIT_CHUNK_SIZE = 1024 * 1024 * 2;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Granularity at which allocators grow past their initial size.
+ */
+const uint64_t COREVM_DEFAULT_ARENA_GROW_CHUNK_SIZE = 1024 * 1024 * 16;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * A contiguous range of virtual address space backed by anonymous mappings.
+ *
+ * The whole range is reserved up front without any access rights, so that
+ * addresses handed out from it never move. Pages are committed on demand in
+ * chunks as the high-water mark advances, and can be handed back to the OS
+ * with `release()` while staying mapped.
+ */
+class arena
+{
+public:
+  enum flags : uint32_t
+  {
+    /* Advise the kernel to back the arena with transparent huge pages. */
+    ARENA_USE_HUGE_PAGES = 0x01,
+
+    /* Touch pages as soon as they are committed. */
+    ARENA_PREFAULT = 0x02
+  };
+
+  explicit arena(uint64_t, uint32_t flags=0);
+
+  ~arena();
+
+  /* Arenas should not be copyable. */
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  void* base() const noexcept;
+
+  uint64_t reserved_size() const noexcept;
+
+  uint64_t committed_size() const noexcept;
+
+  uint32_t flags() const noexcept;
+
+  /**
+   * Makes sure the first `size` bytes of the arena are readable and writable.
+   * Returns `false` if the request exceeds the reservation or the commit fails.
+   */
+  bool commit(uint64_t size) noexcept;
+
+  /**
+   * Gives the whole pages within the specified range back to the OS.
+   * Released pages remain accessible and read back as zeros.
+   * Returns the number of bytes released.
+   */
+  uint64_t release(uint64_t offset, uint64_t size) noexcept;
+
+  static uint64_t page_size() noexcept;
+
+private:
+  uint64_t m_reserved_size;
+  uint64_t m_committed_size;
+  uint32_t m_flags;
+  void* m_base;
+};
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_ARENA_H_ */
@@ -23,13 +23,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_OBJECT_CONTAINER_H_
 #define COREVM_OBJECT_CONTAINER_H_
 
+#include "allocation_stats.h"
+#include "allocation_trace.h"
 #include "errors.h"
 #include "corevm/macros.h"
 
 #include <cstdint>
 #include <iterator>
+#include <new>
 #include <ostream>
 #include <set>
+#include <utility>
 
 
 #define PTR_TO_INT(p) (uint8_t*)( (p) ) - (uint8_t*)(NULL)
@@ -218,6 +222,7 @@ public:
   };
 
   explicit object_container(uint64_t);
+  object_container(uint64_t, uint64_t, uint32_t);
 
   /* Object containers should not be copyable. */
   object_container(const object_container&) = delete;
@@ -229,14 +234,41 @@ public:
   const_iterator cbegin() const;
   const_iterator cend() const;
 
+  /**
+   * Iterator to the first object at or above the specified address. Objects
+   * are iterated in the order of their addresses.
+   */
+  iterator lower_bound(const_pointer);
+
   size_type size() const;
 
   size_type max_size() const;
 
   size_type total_size() const;
 
+  uint64_t committed_size() const;
+
+  /**
+   * Address of the start of the space that objects are allocated in.
+   * It does not change over the lifetime of the container.
+   */
+  uint64_t base_addr() const;
+
+  uint64_t release_free_memory();
+
+  uint64_t reclaimable_size() const;
+
+  corevm::memory::allocation_stats stats() const;
+
+  void set_trace(corevm::memory::allocation_trace*);
+
   pointer create();
 
+  /**
+   * Creates an object by moving the content of the specified one.
+   */
+  pointer create(T&&);
+
   pointer operator[](pointer);
   const_pointer operator[](const_pointer) const;
 
@@ -249,6 +281,18 @@ public:
 
   void erase(const_iterator&);
 
+  /**
+   * Slides objects to the bottom of the allocator's space, keeping their
+   * order, so that free space ends up at the top. Objects are relocated with
+   * their move constructor, and `Function` is invoked with the old and the
+   * new address of each moved object.
+   *
+   * Returns the number of objects moved, which is 0 if the allocator does
+   * not support compaction.
+   */
+  template<typename Function>
+  size_type compact(Function);
+
 private:
   bool check_ptr(pointer) const;
 
@@ -269,6 +313,17 @@ corevm::memory::object_container<T, AllocatorType>::object_container(
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocatorType>
+corevm::memory::object_container<T, AllocatorType>::object_container(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
+  m_allocator(total_size, max_total_size, arena_flags)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocatorType>
 typename corevm::memory::object_container<T, AllocatorType>::iterator
 corevm::memory::object_container<T, AllocatorType>::begin()
@@ -305,6 +360,15 @@ corevm::memory::object_container<T, AllocatorType>::cend() const
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocatorType>
+typename corevm::memory::object_container<T, AllocatorType>::iterator
+corevm::memory::object_container<T, AllocatorType>::lower_bound(const_pointer p)
+{
+  return iterator(*this, m_addrs.lower_bound(const_cast<pointer>(p)));
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocatorType>
 typename corevm::memory::object_container<T, AllocatorType>::size_type
 corevm::memory::object_container<T, AllocatorType>::size() const
@@ -332,6 +396,61 @@ corevm::memory::object_container<T, AllocatorType>::total_size() const
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocatorType>
+uint64_t
+corevm::memory::object_container<T, AllocatorType>::committed_size() const
+{
+  return m_allocator.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocatorType>
+uint64_t
+corevm::memory::object_container<T, AllocatorType>::base_addr() const
+{
+  return m_allocator.base_addr();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocatorType>
+uint64_t
+corevm::memory::object_container<T, AllocatorType>::release_free_memory()
+{
+  return m_allocator.release_free_memory();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocatorType>
+uint64_t
+corevm::memory::object_container<T, AllocatorType>::reclaimable_size() const
+{
+  return m_allocator.reclaimable_size();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocatorType>
+corevm::memory::allocation_stats
+corevm::memory::object_container<T, AllocatorType>::stats() const
+{
+  return m_allocator.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename AllocatorType>
+void
+corevm::memory::object_container<T, AllocatorType>::set_trace(
+  corevm::memory::allocation_trace* trace)
+{
+  m_allocator.set_trace(trace);
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocatorType>
 typename corevm::memory::object_container<T, AllocatorType>::pointer
 corevm::memory::object_container<T, AllocatorType>::create()
@@ -352,6 +471,26 @@ corevm::memory::object_container<T, AllocatorType>::create()
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocatorType>
+typename corevm::memory::object_container<T, AllocatorType>::pointer
+corevm::memory::object_container<T, AllocatorType>::create(T&& other)
+{
+  pointer p = m_allocator.allocate(1, 0);
+
+  if (!p)
+  {
+    return nullptr;
+  }
+
+  ::new (static_cast<void*>(p)) T(std::move(other));
+
+  m_addrs.insert(p);
+
+  return p;
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocatorType>
 bool
 corevm::memory::object_container<T, AllocatorType>::check_ptr(pointer p) const
@@ -465,6 +604,49 @@ corevm::memory::object_container<T, AllocatorType>::erase(const_iterator& itr)
 
 // -----------------------------------------------------------------------------
 
+template<typename T, typename AllocatorType>
+template<typename Function>
+typename corevm::memory::object_container<T, AllocatorType>::size_type
+corevm::memory::object_container<T, AllocatorType>::compact(Function on_move)
+{
+  size_type moved_count = 0;
+
+  m_allocator.compact(
+    [this, &on_move, &moved_count](void* from, void* to, size_t size) {
+#if __DEBUG__
+      ASSERT(size == sizeof(T));
+#endif
+
+      pointer p = static_cast<pointer>(from);
+      pointer q = static_cast<pointer>(to);
+
+      if (static_cast<uint8_t*>(to) + sizeof(T) <= static_cast<uint8_t*>(from))
+      {
+        ::new (static_cast<void*>(q)) T(std::move(*p));
+        m_allocator.destroy(p);
+      }
+      else
+      {
+        // The old and new locations overlap, so move through a temporary.
+        T tmp(std::move(*p));
+        m_allocator.destroy(p);
+        ::new (static_cast<void*>(q)) T(std::move(tmp));
+      }
+
+      m_addrs.erase(p);
+      m_addrs.insert(q);
+
+      on_move(p, q);
+
+      ++moved_count;
+    }
+  );
+
+  return moved_count;
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename T, typename AllocatorType>
 std::ostream&
 operator<<(
@@ -0,0 +1,42 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "payload_allocator.h"
+
+#include "size_class_allocator.h"
+
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::size_class_allocator&
+corevm::memory::payload_heap()
+{
+  // Intentionally never destroyed, since payloads owned by objects with static
+  // storage duration may be released after it would have been.
+  static corevm::memory::size_class_allocator* heap = \
+    new corevm::memory::size_class_allocator(
+      corevm::memory::COREVM_DEFAULT_PAYLOAD_ARENA_SIZE);
+
+  return *heap;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_PAYLOAD_ALLOCATOR_H_
+#define COREVM_PAYLOAD_ALLOCATOR_H_
+
+#include "size_class_allocator.h"
+#include "corevm/macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+/**
+ * Reserved size of the arena backing the payloads of native strings, arrays
+ * and maps.
+ */
+const uint64_t COREVM_DEFAULT_PAYLOAD_ARENA_SIZE = 1024 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * The size-classed allocator shared by the payloads of all native types.
+ */
+corevm::memory::size_class_allocator& payload_heap();
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Standard-conforming allocator for payload buffers of native types, drawing
+ * from `payload_heap()`.
+ */
+template<typename T>
+class payload_allocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<typename U>
+  struct rebind
+  {
+    typedef payload_allocator<U> other;
+  };
+
+  payload_allocator() noexcept
+  {
+  }
+
+  template<typename U>
+  payload_allocator(const payload_allocator<U>&) noexcept
+  {
+  }
+
+  pointer allocate(size_type n, const void* = 0)
+  {
+    void* ptr = corevm::memory::payload_heap().allocate(n * sizeof(T));
+
+    if (!ptr)
+    {
+      THROW(std::bad_alloc());
+    }
+
+    return static_cast<pointer>(ptr);
+  }
+
+  void deallocate(pointer p, size_type n) noexcept
+  {
+    corevm::memory::payload_heap().deallocate(p, n * sizeof(T));
+  }
+
+  template<typename U, typename... Args>
+  void construct(U* p, Args&&... args)
+  {
+    ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template<typename U>
+  void destroy(U* p)
+  {
+    p->~U();
+  }
+
+  size_type max_size() const noexcept
+  {
+    return static_cast<size_type>(-1) / sizeof(T);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename U>
+inline
+bool operator==(const payload_allocator<T>&, const payload_allocator<U>&)
+{
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T, typename U>
+inline
+bool operator!=(const payload_allocator<T>&, const payload_allocator<U>&)
+{
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Payload allocator of native containers that also carries whether the
+ * container's elements are ids of dynamic objects. Containers copy, move and
+ * swap their allocators along with their contents, so the mark always stays
+ * with the elements it describes.
+ */
+template<typename T>
+class object_ref_allocator : public payload_allocator<T>
+{
+public:
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  template<typename U>
+  struct rebind
+  {
+    typedef object_ref_allocator<U> other;
+  };
+
+  object_ref_allocator() noexcept
+    :
+    m_contains_object_refs(false)
+  {
+  }
+
+  explicit object_ref_allocator(bool contains_object_refs) noexcept
+    :
+    m_contains_object_refs(contains_object_refs)
+  {
+  }
+
+  template<typename U>
+  object_ref_allocator(const object_ref_allocator<U>& other) noexcept
+    :
+    m_contains_object_refs(other.contains_object_refs())
+  {
+  }
+
+  bool contains_object_refs() const noexcept
+  {
+    return m_contains_object_refs;
+  }
+
+private:
+  bool m_contains_object_refs;
+};
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_PAYLOAD_ALLOCATOR_H_ */
@@ -26,7 +26,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sneaker/libc/utils.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -44,12 +46,102 @@ typedef corevm::memory::sequential_block_descriptor block_descriptor_type;
 corevm::memory::sequential_allocation_scheme::sequential_allocation_scheme(
   size_t total_size)
   :
-  m_total_size(total_size)
+  m_total_size(total_size),
+  m_stats()
 {
 }
 
 // -----------------------------------------------------------------------------
 
+#if COREVM_ALLOCATION_TIMING
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+#endif
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::allocation_stats
+corevm::memory::sequential_allocation_scheme::stats() const noexcept
+{
+  corevm::memory::allocation_stats stats = m_stats;
+
+  stats.free_block_count = 0;
+  stats.free_size = 0;
+  stats.largest_free_block_size = 0;
+
+  for (auto itr = cbegin(); itr != cend(); ++itr)
+  {
+    if (itr->actual_size == 0)
+    {
+      ++stats.free_block_count;
+      stats.free_size += itr->size;
+      stats.largest_free_block_size = std::max(stats.largest_free_block_size, itr->size);
+    }
+  }
+
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+
+iterator_type
+corevm::memory::sequential_allocation_scheme::timed_find_fit(size_t size) noexcept
+{
+#if COREVM_ALLOCATION_TIMING
+  auto start = std::chrono::steady_clock::now();
+
+  iterator_type itr = this->find_fit(size);
+
+  m_stats.find_fit_time += elapsed_time(start);
+
+  return itr;
+#else
+  return this->find_fit(size);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::sequential_allocation_scheme::timed_combine_free_blocks() noexcept
+{
+#if COREVM_ALLOCATION_TIMING
+  auto start = std::chrono::steady_clock::now();
+
+  this->combine_free_blocks();
+
+  m_stats.combine_free_blocks_time += elapsed_time(start);
+#else
+  this->combine_free_blocks();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::sequential_allocation_scheme::record_malloc(size_t size) noexcept
+{
+  ++m_stats.alloc_count;
+  m_stats.allocated_size += size;
+  m_stats.peak_allocated_size = std::max(m_stats.peak_allocated_size, m_stats.allocated_size);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::sequential_allocation_scheme::record_free(size_t size) noexcept
+{
+  ++m_stats.free_count;
+  m_stats.allocated_size -= size;
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::memory::sequential_allocation_scheme::debug_print(uint32_t base) const noexcept
 {
@@ -154,31 +246,95 @@ corevm::memory::sequential_allocation_scheme::combine_free_blocks() noexcept
 
   while (itr != this->end())
   {
-    iterator_type current = itr;
-    iterator_type next = ++itr;
+    iterator_type next = itr;
+    ++next;
 
-    if (next != this->end())
+    if (next == this->end())
     {
-      block_descriptor_type current_block = static_cast<block_descriptor_type>(*current);
-      block_descriptor_type next_block = static_cast<block_descriptor_type>(*next);
+      break;
+    }
 
-      if (current_block.actual_size == 0 && next_block.actual_size == 0)
-      {
-        current_block.size += next_block.size;
-        next_block.size = 0;
-        *current = current_block;
-        *next = next_block;
-      }
+    if (itr->actual_size == 0 && next->actual_size == 0)
+    {
+      // Absorb the next block and look at its successor.
+      itr->size += next->size;
+      this->m_blocks.erase(next);
+    }
+    else
+    {
+      itr = next;
     }
   }
+}
 
-  std::remove_if(
-    this->begin(),
-    this->end(),
-    [](const block_descriptor_type& block) -> bool {
-      return block.actual_size == 0 && block.size == 0;
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::sequential_allocation_scheme::grow(size_t size) noexcept
+{
+  if (size == 0)
+  {
+    return false;
+  }
+
+  block_descriptor_type descriptor {
+    .size = size,
+    .actual_size = 0,
+    .offset = m_total_size,
+    .flags = 0
+  };
+
+  this->m_blocks.push_back(descriptor);
+  m_total_size += size;
+
+  this->combine_free_blocks();
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::sequential_allocation_scheme::compact(
+  const std::function<void(uint64_t, uint64_t, uint64_t)>& move) noexcept
+{
+  std::list<sequential_block_descriptor> blocks;
+  uint64_t next_offset = 0;
+
+  for (auto itr = this->begin(); itr != this->end(); ++itr)
+  {
+    block_descriptor_type block = static_cast<block_descriptor_type>(*itr);
+
+    if (block.actual_size == 0)
+    {
+      continue;
     }
-  );
+
+    if (block.offset != next_offset)
+    {
+      move(block.offset, next_offset, block.actual_size);
+      block.offset = next_offset;
+    }
+
+    next_offset += block.size;
+    blocks.push_back(block);
+  }
+
+  if (next_offset < m_total_size)
+  {
+    block_descriptor_type descriptor {
+      .size = m_total_size - next_offset,
+      .actual_size = 0,
+      .offset = next_offset,
+      .flags = 0
+    };
+
+    blocks.push_back(descriptor);
+  }
+
+  m_blocks.swap(blocks);
+
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -189,7 +345,7 @@ corevm::memory::sequential_allocation_scheme::malloc(size_t size) noexcept
   ssize_t res = -1;
   iterator_type itr;
 
-  itr = this->find_fit(size);
+  itr = this->timed_find_fit(size);
 
   if (itr != this->end())
   {
@@ -197,6 +353,8 @@ corevm::memory::sequential_allocation_scheme::malloc(size_t size) noexcept
     block_found.actual_size = size;
     *itr = block_found;
 
+    this->record_malloc(size);
+
     if (block_found.size > size)
     {
       this->split(itr, block_found.size - size, static_cast<uint64_t>(block_found.offset + size));
@@ -236,7 +394,9 @@ corevm::memory::sequential_allocation_scheme::free(size_t offset) noexcept
     block_found.actual_size = 0;
     *itr = block_found;
 
-    this->combine_free_blocks();
+    this->record_free(static_cast<size_t>(size_freed));
+
+    this->timed_combine_free_blocks();
   }
 
   return size_freed;
@@ -293,34 +453,17 @@ corevm::memory::best_fit_allocation_scheme::best_fit_allocation_scheme(
 iterator_type
 corevm::memory::best_fit_allocation_scheme::find_fit(size_t size) noexcept
 {
-  iterator_type itr = std::min_element(
-    this->begin(),
-    this->end(),
-    [size](block_descriptor_type block_a, block_descriptor_type block_b) -> bool {
-      if (block_a.actual_size != 0)
-      {
-        return false;
-      }
+  iterator_type itr = this->end();
 
-      if (block_b.actual_size != 0)
+  for (auto block_itr = this->begin(); block_itr != this->end(); ++block_itr)
+  {
+    if (block_itr->actual_size == 0 && block_itr->size >= size)
+    {
+      if (itr == this->end() || block_itr->size < itr->size)
       {
-        return true;
+        itr = block_itr;
       }
-
-      return block_a.size <= block_b.size && block_a.size >= size;
     }
-  );
-
-  if (itr == this->end())
-  {
-    return itr;
-  }
-
-  block_descriptor_type block_found = static_cast<block_descriptor_type>(*itr);
-
-  if (! (block_found.actual_size == 0 && block_found.size >= size) )
-  {
-    itr = this->end();
   }
 
   return itr;
@@ -347,32 +490,20 @@ corevm::memory::worst_fit_allocation_scheme::worst_fit_allocation_scheme(
 iterator_type
 corevm::memory::worst_fit_allocation_scheme::find_fit(size_t size) noexcept
 {
-  iterator_type itr = std::max_element(
-    this->begin(),
-    this->end(),
-    [size](block_descriptor_type block_a, block_descriptor_type block_b) -> bool {
-      if (block_b.actual_size != 0)
-      {
-        return false;
-      }
+  iterator_type itr = this->end();
 
-      if (block_a.actual_size != 0)
+  for (auto block_itr = this->begin(); block_itr != this->end(); ++block_itr)
+  {
+    if (block_itr->actual_size == 0)
+    {
+      if (itr == this->end() || block_itr->size > itr->size)
       {
-        return true;
+        itr = block_itr;
       }
-
-      return block_a.size <= block_b.size && block_a.size >= size;
     }
-  );
-
-  if (itr == this->end())
-  {
-    return itr;
   }
 
-  block_descriptor_type block_found = static_cast<block_descriptor_type>(*itr);
-
-  if (! (block_found.actual_size == 0 && block_found.size >= size) )
+  if (itr != this->end() && itr->size < size)
   {
     itr = this->end();
   }
@@ -429,6 +560,53 @@ corevm::memory::next_fit_allocation_scheme::find_fit(size_t size) noexcept
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::memory::next_fit_allocation_scheme::combine_free_blocks() noexcept
+{
+  /*
+   * Combining blocks may erase the block `m_last_itr` points to, so remember
+   * its offset and resume from the block that covers it afterwards.
+   */
+  if (this->m_last_itr == this->end())
+  {
+    sequential_allocation_scheme::combine_free_blocks();
+    return;
+  }
+
+  uint64_t last_offset = this->m_last_itr->offset;
+
+  sequential_allocation_scheme::combine_free_blocks();
+
+  this->m_last_itr = std::find_if(
+    this->begin(),
+    this->end(),
+    [last_offset](const block_descriptor_type& block) -> bool {
+      return block.offset <= last_offset && last_offset < block.offset + block.size;
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::next_fit_allocation_scheme::compact(
+  const std::function<void(uint64_t, uint64_t, uint64_t)>& move) noexcept
+{
+  sequential_allocation_scheme::compact(move);
+
+  // Resume searching from the free space on top.
+  this->m_last_itr = this->end();
+
+  if (!this->m_blocks.empty())
+  {
+    this->m_last_itr = --this->end();
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
 
 /* ---------------- corevm::memory::buddy_allocation_scheme ----------------- */
 
@@ -453,6 +631,26 @@ corevm::memory::buddy_allocation_scheme::buddy_allocation_scheme(
 
 // -----------------------------------------------------------------------------
 
+bool
+corevm::memory::buddy_allocation_scheme::grow(size_t) noexcept
+{
+  // Blocks are carved out by halving the initial block, so the managed space
+  // cannot be extended without breaking the buddy invariants.
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::buddy_allocation_scheme::compact(
+  const std::function<void(uint64_t, uint64_t, uint64_t)>&) noexcept
+{
+  // Buddy blocks have to stay aligned to their sizes.
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
 block_descriptor_type
 corevm::memory::buddy_allocation_scheme::default_block() const noexcept
 {
@@ -471,7 +669,7 @@ corevm::memory::buddy_allocation_scheme::malloc(size_t size) noexcept
   ssize_t res = -1;
   iterator_type itr;
 
-  itr = this->find_fit(size);
+  itr = this->timed_find_fit(size);
 
   if (itr != this->end())
   {
@@ -479,6 +677,8 @@ corevm::memory::buddy_allocation_scheme::malloc(size_t size) noexcept
     block_found.actual_size = size;
     *itr = block_found;
 
+    this->record_malloc(size);
+
     res = static_cast<ssize_t>(block_found.offset);
 
     *itr = block_found;
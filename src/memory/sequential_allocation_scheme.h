@@ -24,8 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_SEQUENTIAL_ALLOCATION_SCHEME_H_
 
 #include "allocation_scheme.h"
+#include "allocation_stats.h"
 
 #include <cstdint>
+#include <functional>
 #include <list>
 
 
@@ -62,16 +64,45 @@ public:
   virtual ssize_t malloc(size_t) noexcept;
   virtual ssize_t free(size_t) noexcept;
 
+  /**
+   * Extends the managed space by the specified number of bytes, appended as a
+   * free block at the end. Returns `false` if the scheme cannot grow.
+   */
+  virtual bool grow(size_t) noexcept;
+
+  /**
+   * Slides all used blocks, in order, to the bottom of the managed space and
+   * leaves a single free block on top. The callback is invoked with the old
+   * offset, the new offset and the size of every block that moves, so that
+   * the caller can move the content. Returns `false` if the scheme cannot
+   * be compacted.
+   */
+  virtual bool compact(
+    const std::function<void(uint64_t, uint64_t, uint64_t)>&) noexcept;
+
   void debug_print(uint32_t) const noexcept;
 
+  corevm::memory::allocation_stats stats() const noexcept;
+
 protected:
   virtual sequential_block_descriptor default_block() const noexcept;
   virtual iterator find_fit(size_t) noexcept = 0;
   virtual void split(iterator, size_t, uint64_t) noexcept;
   virtual void combine_free_blocks() noexcept;
 
+  /**
+   * Wrappers around the methods above that account for the time spent, if
+   * `COREVM_ALLOCATION_TIMING` is enabled.
+   */
+  iterator timed_find_fit(size_t) noexcept;
+  void timed_combine_free_blocks() noexcept;
+
+  void record_malloc(size_t) noexcept;
+  void record_free(size_t) noexcept;
+
   size_t m_total_size;
   std::list<sequential_block_descriptor> m_blocks;
+  corevm::memory::allocation_stats m_stats;
 };
 
 // -----------------------------------------------------------------------------
@@ -114,8 +145,12 @@ class next_fit_allocation_scheme : public corevm::memory::sequential_allocation_
 public:
   explicit next_fit_allocation_scheme(size_t total_size);
 
+  virtual bool compact(
+    const std::function<void(uint64_t, uint64_t, uint64_t)>&) noexcept;
+
 protected:
   virtual iterator find_fit(size_t) noexcept;
+  virtual void combine_free_blocks() noexcept;
 
   iterator m_last_itr;
 };
@@ -128,6 +163,9 @@ public:
   explicit buddy_allocation_scheme(size_t total_size);
 
   virtual ssize_t malloc(size_t) noexcept;
+  virtual bool grow(size_t) noexcept;
+  virtual bool compact(
+    const std::function<void(uint64_t, uint64_t, uint64_t)>&) noexcept;
 protected:
   virtual sequential_block_descriptor default_block() const noexcept;
   virtual iterator find_fit(size_t) noexcept;
@@ -0,0 +1,340 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "size_class_allocator.h"
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <sys/mman.h>
+
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+  #define MAP_ANONYMOUS MAP_ANON
+#endif
+
+
+// -----------------------------------------------------------------------------
+
+const size_t corevm::memory::size_class_allocator::MIN_BLOCK_SIZE = 16;
+
+// -----------------------------------------------------------------------------
+
+const size_t corevm::memory::size_class_allocator::MAX_BLOCK_SIZE = \
+  corevm::memory::size_class_allocator::MIN_BLOCK_SIZE << (SIZE_CLASS_COUNT - 1);
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::size_class_allocator::size_class_allocator(
+  uint64_t reserved_size, uint32_t arena_flags)
+  :
+  m_arena(reserved_size, arena_flags),
+  m_arena_offset(0),
+  m_free_lists(),
+  m_released_blocks(),
+  m_allocated_size(0),
+  m_used_size(0),
+  m_mutex()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::size_class_allocator::~size_class_allocator()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::memory::size_class_allocator::size_class(size_t size) noexcept
+{
+  size_t index = 0;
+  size_t block_size = MIN_BLOCK_SIZE;
+
+  while (block_size < size)
+  {
+    block_size <<= 1;
+    ++index;
+  }
+
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::memory::size_class_allocator::block_size(size_t size) noexcept
+{
+  if (size > MAX_BLOCK_SIZE)
+  {
+    const uint64_t page_size = corevm::memory::arena::page_size();
+    return (size + page_size - 1) / page_size * page_size;
+  }
+
+  return MIN_BLOCK_SIZE << size_class(size);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::memory::size_class_allocator::owns(void* ptr) const noexcept
+{
+  uint8_t* base = static_cast<uint8_t*>(m_arena.base());
+  uint8_t* ptr_ = static_cast<uint8_t*>(ptr);
+
+  return ptr_ >= base && ptr_ < base + m_arena.reserved_size();
+}
+
+// -----------------------------------------------------------------------------
+
+void*
+corevm::memory::size_class_allocator::allocate(size_t size) noexcept
+{
+  if (!(size > 0))
+  {
+    size = 1;
+  }
+
+  const size_t actual_size = block_size(size);
+
+  void* ptr = nullptr;
+
+  if (size > MAX_BLOCK_SIZE)
+  {
+    ptr = mmap(
+      nullptr, actual_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (ptr == MAP_FAILED)
+    {
+      return nullptr;
+    }
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    free_block*& free_list = m_free_lists[size_class(size)];
+    std::vector<void*>& released_blocks = m_released_blocks[size_class(size)];
+
+    if (free_list)
+    {
+      ptr = free_list;
+      free_list = free_list->next;
+    }
+    else if (!released_blocks.empty())
+    {
+      ptr = released_blocks.back();
+      released_blocks.pop_back();
+    }
+    else
+    {
+      ptr = carve(actual_size);
+    }
+  }
+
+  if (!ptr)
+  {
+    // The arena is exhausted; fall back to the global heap.
+    ptr = ::operator new(actual_size, std::nothrow);
+
+    if (!ptr)
+    {
+      return nullptr;
+    }
+  }
+
+  m_allocated_size += size;
+  m_used_size += actual_size;
+
+  return ptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void*
+corevm::memory::size_class_allocator::carve(size_t actual_size) noexcept
+{
+  uint64_t offset = m_arena_offset;
+  const uint64_t page_size = corevm::memory::arena::page_size();
+
+  // Blocks of a page or more start on a page boundary.
+  if (actual_size >= page_size)
+  {
+    offset = (offset + page_size - 1) / page_size * page_size;
+  }
+
+  if (!m_arena.commit(offset + actual_size))
+  {
+    return nullptr;
+  }
+
+  uint8_t* base = static_cast<uint8_t*>(m_arena.base());
+
+  // The gap left by the alignment is handed to the free lists of the smaller
+  // size classes.
+  while (m_arena_offset < offset)
+  {
+    size_t i = SIZE_CLASS_COUNT - 1;
+
+    while ((MIN_BLOCK_SIZE << i) > offset - m_arena_offset)
+    {
+      --i;
+    }
+
+    free_block* block = reinterpret_cast<free_block*>(base + m_arena_offset);
+    block->next = m_free_lists[i];
+    m_free_lists[i] = block;
+
+    m_arena_offset += MIN_BLOCK_SIZE << i;
+  }
+
+  m_arena_offset = offset + actual_size;
+
+  return base + offset;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::memory::size_class_allocator::deallocate(void* ptr, size_t size) noexcept
+{
+  if (ptr == nullptr)
+  {
+    return;
+  }
+
+  if (!(size > 0))
+  {
+    size = 1;
+  }
+
+  const size_t actual_size = block_size(size);
+
+  if (size > MAX_BLOCK_SIZE)
+  {
+    munmap(ptr, actual_size);
+  }
+  else if (owns(ptr))
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    free_block* block = static_cast<free_block*>(ptr);
+    block->next = m_free_lists[size_class(size)];
+    m_free_lists[size_class(size)] = block;
+  }
+  else
+  {
+    ::operator delete(ptr);
+  }
+
+  m_allocated_size -= size;
+  m_used_size -= actual_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::size_class_allocator::allocated_size() const noexcept
+{
+  return m_allocated_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::size_class_allocator::used_size() const noexcept
+{
+  return m_used_size;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::size_class_allocator::reserved_size() const noexcept
+{
+  return m_arena.reserved_size();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::memory::size_class_allocator::release_free_memory() noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  uint64_t released_size = 0;
+  uint8_t* base = static_cast<uint8_t*>(m_arena.base());
+
+  for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+  {
+    const size_t class_block_size = MIN_BLOCK_SIZE << i;
+
+    // Blocks smaller than a page never span a whole page.
+    if (class_block_size < corevm::memory::arena::page_size())
+    {
+      continue;
+    }
+
+    size_t block_count = 0;
+
+    for (free_block* block = m_free_lists[i]; block; block = block->next)
+    {
+      ++block_count;
+    }
+
+    // Released blocks are tracked outside of their pages, and the blocks of
+    // a class stay on its free list if they cannot be.
+    try
+    {
+      m_released_blocks[i].reserve(m_released_blocks[i].size() + block_count);
+    }
+    catch (const std::bad_alloc&)
+    {
+      continue;
+    }
+
+    free_block* block = m_free_lists[i];
+    m_free_lists[i] = nullptr;
+
+    while (block)
+    {
+      // Read the link before the page holding it is released.
+      free_block* next = block->next;
+
+      uint64_t offset = static_cast<uint64_t>(reinterpret_cast<uint8_t*>(block) - base);
+
+      released_size += m_arena.release(offset, class_block_size);
+      m_released_blocks[i].push_back(block);
+
+      block = next;
+    }
+  }
+
+  return released_size;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_SIZE_CLASS_ALLOCATOR_H_
+#define COREVM_SIZE_CLASS_ALLOCATOR_H_
+
+#include "arena.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+namespace corevm {
+
+
+namespace memory {
+
+
+/**
+ * Allocates variable-sized buffers out of an `arena`, segregated into
+ * power-of-two size classes.
+ *
+ * Each size class keeps a free list of blocks carved from the arena on demand.
+ * Blocks of a page or more are page-aligned, so that their pages can be given
+ * back to the OS while they are free.
+ * Requests larger than the largest size class are mapped individually, and
+ * requests that no longer fit in the arena fall back to the global heap.
+ */
+class size_class_allocator
+{
+public:
+  explicit size_class_allocator(uint64_t, uint32_t arena_flags=0);
+
+  ~size_class_allocator();
+
+  /* Size class allocators should not be copyable. */
+  size_class_allocator(const size_class_allocator&) = delete;
+  size_class_allocator& operator=(const size_class_allocator&) = delete;
+
+  void* allocate(size_t) noexcept;
+
+  /**
+   * Returns a buffer to the allocator. The size must be the same as the one
+   * the buffer was allocated with.
+   */
+  void deallocate(void*, size_t) noexcept;
+
+  /**
+   * The number of bytes requested by buffers currently in use.
+   */
+  uint64_t allocated_size() const noexcept;
+
+  /**
+   * The number of bytes of memory held on behalf of buffers currently in use,
+   * including the rounding to size classes.
+   */
+  uint64_t used_size() const noexcept;
+
+  /**
+   * The number of bytes reserved for size-classed buffers.
+   */
+  uint64_t reserved_size() const noexcept;
+
+  /**
+   * Gives the pages of free blocks of a page or more back to the OS.
+   * Returns the number of bytes released.
+   */
+  uint64_t release_free_memory() noexcept;
+
+  static size_t block_size(size_t) noexcept;
+
+  static const size_t MIN_BLOCK_SIZE;
+  static const size_t MAX_BLOCK_SIZE;
+
+private:
+  struct free_block
+  {
+    free_block* next;
+  };
+
+  static const size_t SIZE_CLASS_COUNT = 13;
+
+  static size_t size_class(size_t) noexcept;
+
+  bool owns(void*) const noexcept;
+
+  void* carve(size_t) noexcept;
+
+  corevm::memory::arena m_arena;
+  uint64_t m_arena_offset;
+  free_block* m_free_lists[SIZE_CLASS_COUNT];
+
+  /**
+   * Free blocks whose pages have been released. They are kept apart from the
+   * free lists, whose links would live in the released pages.
+   */
+  std::vector<void*> m_released_blocks[SIZE_CLASS_COUNT];
+  std::atomic<uint64_t> m_allocated_size;
+  std::atomic<uint64_t> m_used_size;
+  std::mutex m_mutex;
+};
+
+
+} /* end namespace memory */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_SIZE_CLASS_ALLOCATOR_H_ */
@@ -37,6 +37,15 @@ namespace runtime {
 const uint32_t COREVM_DEFAULT_GC_INTERVAL = 10;
 
 
+// Default number of objects created between checks of the GC rules by the
+// executing thread.
+const uint32_t COREVM_DEFAULT_GC_ALLOCATION_INTERVAL = 1000;
+
+
+// Default number of instructions executed between incremental GC slices.
+const uint32_t COREVM_DEFAULT_GC_SLICE_INTERVAL = 1000;
+
+
 typedef int32_t instr_addr;
 
 
@@ -74,6 +83,14 @@ typedef std::unordered_map<uint64_t, std::string> encoding_map;
 const uint64_t COREVM_DEFAULT_NATIVE_TYPES_POOL_SIZE = 1024 * 1024 * 128;
 
 
+// Default limit of the native payload size of a process: 128 MB.
+const uint64_t COREVM_DEFAULT_NATIVE_PAYLOAD_SIZE_LIMIT = 1024 * 1024 * 128;
+
+
+// Bytes a heap or pool frees before its free pages are given back: 4 MB.
+const uint64_t COREVM_RELEASE_FREE_MEMORY_THRESHOLD = 1024 * 1024 * 4;
+
+
 // Default number of stacks to unwind on failures.
 const size_t COREVM_DEFAULT_STACK_UNWIND_COUNT = 5;
 
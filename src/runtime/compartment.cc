@@ -52,6 +52,7 @@ corevm::runtime::compartment::set_encoding_map(
 {
   m_encoding_map.clear();
   m_encoding_map.insert(encoding_map.begin(), encoding_map.end());
+  m_interned_strings.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -91,6 +92,39 @@ corevm::runtime::compartment::get_encoding_string(
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::runtime::compartment::intern_encoding_strings(
+  corevm::types::string_intern_table& table)
+{
+  m_interned_strings.clear();
+
+  for (auto itr = m_encoding_map.begin(); itr != m_encoding_map.end(); ++itr)
+  {
+    m_interned_strings.insert(std::make_pair(itr->first,
+      table.intern(corevm::types::native_string(itr->second))));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::compartment::get_interned_string(
+  uint64_t key, corevm::types::string* str) const
+{
+  auto itr = m_interned_strings.find(key);
+
+  if (itr == m_interned_strings.end())
+  {
+    return false;
+  }
+
+  *str = itr->second;
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
 size_t
 corevm::runtime::compartment::closure_count() const
 {
@@ -26,9 +26,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "closure.h"
 #include "common.h"
 #include "errors.h"
+#include "types/string_intern_table.h"
+#include "types/types.h"
 
 #include <ostream>
 #include <string>
+#include <unordered_map>
 
 
 namespace corevm {
@@ -51,6 +54,18 @@ public:
 
   void get_encoding_string(uint64_t, std::string*) const;
 
+  /**
+   * Interns every encoding string in the specified table, so that string
+   * literals can be created without copying and hashing them.
+   */
+  void intern_encoding_strings(corevm::types::string_intern_table&);
+
+  /**
+   * Sets the string to the interned encoding string of the specified key.
+   * Returns `false` if the encoding string has not been interned.
+   */
+  bool get_interned_string(uint64_t, corevm::types::string*) const;
+
   size_t closure_count() const;
 
   const corevm::runtime::closure
@@ -70,6 +85,7 @@ public:
 private:
   const std::string m_path;
   corevm::runtime::encoding_map m_encoding_map;
+  std::unordered_map<uint64_t, corevm::types::string> m_interned_strings;
   corevm::runtime::closure_table m_closure_table;
 };
 
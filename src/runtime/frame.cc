@@ -96,7 +96,7 @@ void
 corevm::runtime::frame::push_eval_stack(
   corevm::types::native_type_handle& operand)
 {
-  m_eval_stack.push(operand);
+  m_eval_stack.push_back(operand);
 }
 
 // -----------------------------------------------------------------------------
@@ -110,8 +110,8 @@ corevm::runtime::frame::pop_eval_stack()
     THROW(corevm::runtime::evaluation_stack_empty_error());
   }
 
-  corevm::types::native_type_handle operand = m_eval_stack.top();
-  m_eval_stack.pop();
+  corevm::types::native_type_handle operand = m_eval_stack.back();
+  m_eval_stack.pop_back();
   return operand;
 }
 
@@ -126,7 +126,7 @@ corevm::runtime::frame::top_eval_stack()
     THROW(corevm::runtime::evaluation_stack_empty_error());
   }
 
-  return m_eval_stack.top();
+  return m_eval_stack.back();
 }
 
 // -----------------------------------------------------------------------------
@@ -252,6 +252,25 @@ corevm::runtime::frame::get_invisible_objs() const
 
 // -----------------------------------------------------------------------------
 
+std::list<corevm::dyobj::dyobj_id>
+corevm::runtime::frame::get_eval_stack_objs() const
+{
+  std::list<corevm::dyobj::dyobj_id> ids;
+
+  for (const auto& handle : m_eval_stack)
+  {
+    corevm::types::for_each_object_ref(handle,
+      [&ids](corevm::types::native_array_element_type id) {
+        ids.push_back(static_cast<corevm::dyobj::dyobj_id>(id));
+      }
+    );
+  }
+
+  return ids;
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::runtime::closure_ctx
 corevm::runtime::frame::closure_ctx() const
 {
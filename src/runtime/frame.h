@@ -31,7 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cstdint>
 #include <list>
-#include <stack>
+#include <vector>
 
 
 namespace corevm {
@@ -96,6 +96,12 @@ public:
 
   std::list<corevm::dyobj::dyobj_id> get_invisible_objs() const;
 
+  /**
+   * Returns the ids held by the arrays and maps on the evaluation stack that
+   * are marked as containing object references.
+   */
+  std::list<corevm::dyobj::dyobj_id> get_eval_stack_objs() const;
+
   corevm::runtime::closure_ctx closure_ctx() const;
 
   corevm::dyobj::dyobj_id exc_obj() const;
@@ -109,7 +115,7 @@ protected:
   corevm::runtime::instr_addr m_return_addr;
   std::unordered_map<corevm::runtime::variable_key, corevm::dyobj::dyobj_id> m_visible_vars;
   std::unordered_map<corevm::runtime::variable_key, corevm::dyobj::dyobj_id> m_invisible_vars;
-  std::stack<corevm::types::native_type_handle> m_eval_stack;
+  std::vector<corevm::types::native_type_handle> m_eval_stack;
   corevm::dyobj::dyobj_id m_exc_obj;
 };
 
@@ -23,7 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "gc_rule.h"
 
 #include "process.h"
+#include "gc/gc_stats.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 
 
@@ -36,6 +39,18 @@ const double corevm::runtime::gc_rule_by_ntvhndl_pool_size::DEFAULT_CUTOFF = 0.7
 
 // -----------------------------------------------------------------------------
 
+const double corevm::runtime::gc_rule_by_native_payload_size::DEFAULT_CUTOFF = 0.75f;
+
+// -----------------------------------------------------------------------------
+
+const double corevm::runtime::gc_threshold_policy::DEFAULT_GROWTH_FACTOR = 2.0;
+
+// -----------------------------------------------------------------------------
+
+const uint64_t corevm::runtime::gc_threshold_policy::DEFAULT_MIN_THRESHOLD = 4096;
+
+// -----------------------------------------------------------------------------
+
 const std::unordered_map<corevm::runtime::gc_bitfield_t, corevm::runtime::gc_rule_wrapper>
 corevm::runtime::gc_rule_meta::gc_rule_map {
   {
@@ -55,6 +70,18 @@ corevm::runtime::gc_rule_meta::gc_rule_map {
     {
       .gc_rule=std::make_shared<corevm::runtime::gc_rule_by_ntvhndl_pool_size>()
     }
+  },
+  {
+    corevm::runtime::gc_rule_meta::gc_bitfields::GC_BY_NTV_PAYLOAD_SIZE,
+    {
+      .gc_rule=std::make_shared<corevm::runtime::gc_rule_by_native_payload_size>()
+    }
+  },
+  {
+    corevm::runtime::gc_rule_meta::gc_bitfields::GC_ADAPTIVE,
+    {
+      .gc_rule=std::make_shared<corevm::runtime::gc_rule_adaptive>()
+    }
   }
 };
 
@@ -99,3 +126,120 @@ corevm::runtime::gc_rule_by_ntvhndl_pool_size::should_gc(
 }
 
 // -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::gc_rule_by_native_payload_size::should_gc(
+  const corevm::runtime::process& process) const
+{
+  return process.native_payload_size() > (
+    process.max_native_payload_size() * corevm::runtime::gc_rule_by_native_payload_size::DEFAULT_CUTOFF
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::gc_rule_adaptive::should_gc(
+  const corevm::runtime::process& process) const
+{
+  return process.heap_size() > process.gc_threshold();
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::runtime::gc_threshold_policy::gc_threshold_policy()
+  :
+  m_growth_factor(DEFAULT_GROWTH_FACTOR),
+  m_min_threshold(DEFAULT_MIN_THRESHOLD),
+  m_target_cpu_fraction(0),
+  m_pause_budget(0),
+  m_threshold(DEFAULT_MIN_THRESHOLD),
+  m_last_cycle_end_time(0)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::gc_threshold_policy::threshold() const noexcept
+{
+  return m_threshold;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::gc_threshold_policy::update(
+  const corevm::gc::cycle_stats& cycle) noexcept
+{
+  double threshold = cycle.heap_size_after * m_growth_factor;
+
+  uint64_t gc_time = cycle.mark_time + cycle.sweep_time;
+
+  // Collecting less often makes each collection find more garbage for the
+  // same work.
+  if (m_target_cpu_fraction > 0 && m_last_cycle_end_time &&
+      cycle.end_time > m_last_cycle_end_time)
+  {
+    double cpu_fraction =
+      static_cast<double>(gc_time) / (cycle.end_time - m_last_cycle_end_time);
+
+    if (cpu_fraction > m_target_cpu_fraction)
+    {
+      threshold *= cpu_fraction / m_target_cpu_fraction;
+    }
+  }
+
+  // The work of a collection grows with the heap it starts from.
+  uint64_t pause = gc_time / std::max<uint32_t>(cycle.slice_count, 1);
+
+  if (m_pause_budget && pause > m_pause_budget)
+  {
+    threshold = std::min(
+      threshold,
+      static_cast<double>(cycle.heap_size_before) * m_pause_budget / pause);
+  }
+
+  m_threshold = std::max(m_min_threshold, static_cast<uint64_t>(threshold));
+  m_last_cycle_end_time = cycle.end_time;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::gc_threshold_policy::set_growth_factor(double growth_factor) noexcept
+{
+  m_growth_factor = growth_factor;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::gc_threshold_policy::set_min_threshold(uint64_t min_threshold) noexcept
+{
+  m_min_threshold = min_threshold;
+
+  // Before the first cycle, the minimum is the threshold.
+  m_threshold = m_last_cycle_end_time ?
+    std::max(m_threshold, m_min_threshold) : m_min_threshold;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::gc_threshold_policy::set_target_cpu_fraction(
+  double target_cpu_fraction) noexcept
+{
+  m_target_cpu_fraction = target_cpu_fraction;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::gc_threshold_policy::set_pause_budget(uint64_t pause_budget) noexcept
+{
+  m_pause_budget = pause_budget;
+}
+
+// -----------------------------------------------------------------------------
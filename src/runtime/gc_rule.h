@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_GC_RULE_H_
 
 #include "common.h"
+#include "gc/gc_stats.h"
 
 #include <cstdint>
 #include <memory>
@@ -77,6 +78,28 @@ public:
 
 // -----------------------------------------------------------------------------
 
+class gc_rule_by_native_payload_size : public gc_rule
+{
+public:
+  virtual bool should_gc(const corevm::runtime::process& process) const;
+
+  static const double DEFAULT_CUTOFF;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Collects once the heap holds more objects than the threshold set by the
+ * process's `gc_threshold_policy`.
+ */
+class gc_rule_adaptive : public gc_rule
+{
+public:
+  virtual bool should_gc(const corevm::runtime::process& process) const;
+};
+
+// -----------------------------------------------------------------------------
+
 typedef struct gc_rule_wrapper
 {
   const std::shared_ptr<corevm::runtime::gc_rule> gc_rule;
@@ -91,6 +114,8 @@ public:
     GC_ALWAYS = 1,
     GC_BY_HEAP_SIZE = 2,
     GC_BY_NTV_POOLSIZE = 3,
+    GC_BY_NTV_PAYLOAD_SIZE = 4,
+    GC_ADAPTIVE = 5,
   };
 
   static const corevm::runtime::gc_rule* get_gc_rule(gc_bitfields bit);
@@ -101,6 +126,56 @@ private:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Sets the number of objects that triggers the next collection from the
+ * number of objects that survived the previous one, times a growth factor.
+ *
+ * The threshold can further be bounded by a target fraction of the time
+ * spent collecting, which raises it when collections take too much of the
+ * time between them, and by a pause budget, which lowers it when the work
+ * of a collection slice exceeds the budget.
+ */
+class gc_threshold_policy
+{
+public:
+  gc_threshold_policy();
+
+  uint64_t threshold() const noexcept;
+
+  /**
+   * Recomputes the threshold after a completed full collection cycle.
+   */
+  void update(const corevm::gc::cycle_stats&) noexcept;
+
+  void set_growth_factor(double) noexcept;
+
+  void set_min_threshold(uint64_t) noexcept;
+
+  /**
+   * A fraction of 0 leaves the time spent collecting unbounded.
+   */
+  void set_target_cpu_fraction(double) noexcept;
+
+  /**
+   * A budget of 0, in nanoseconds, leaves pauses unbounded.
+   */
+  void set_pause_budget(uint64_t) noexcept;
+
+  static const double DEFAULT_GROWTH_FACTOR;
+
+  static const uint64_t DEFAULT_MIN_THRESHOLD;
+
+private:
+  double m_growth_factor;
+  uint64_t m_min_threshold;
+  double m_target_cpu_fraction;
+  uint64_t m_pause_budget;
+  uint64_t m_threshold;
+  uint64_t m_last_cycle_end_time;
+};
+
+// -----------------------------------------------------------------------------
+
 
 } /* end namespace runtime */
 
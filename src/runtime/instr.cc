@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "corevm/macros.h"
 #include "dyobj/util.h"
 #include "types/interfaces.h"
+#include "types/number_format.h"
 #include "types/types.h"
 
 #include <algorithm>
@@ -160,6 +161,15 @@ corevm::runtime::instr_handler_meta::instr_set[INSTR_CODE_MAX] {
   /* SETFLDEL  */    { .num_oprd=1, .str="setfldel",  .handler=std::make_shared<corevm::runtime::instr_handler_setfldel>()  },
   /* SETFLCALL */    { .num_oprd=1, .str="setflcall", .handler=std::make_shared<corevm::runtime::instr_handler_setflcall>() },
   /* SETFLMUTE */    { .num_oprd=1, .str="setflmute", .handler=std::make_shared<corevm::runtime::instr_handler_setflmute>() },
+  /* GETATTRW  */    { .num_oprd=1, .str="getattrw",  .handler=std::make_shared<corevm::runtime::instr_handler_getattrw>()  },
+  /* SETATTRW  */    { .num_oprd=1, .str="setattrw",  .handler=std::make_shared<corevm::runtime::instr_handler_setattrw>()  },
+  /* DELATTRW  */    { .num_oprd=1, .str="delattrw",  .handler=std::make_shared<corevm::runtime::instr_handler_delattrw>()  },
+  /* GETEPH    */    { .num_oprd=0, .str="geteph",    .handler=std::make_shared<corevm::runtime::instr_handler_geteph>()    },
+  /* SETEPH    */    { .num_oprd=0, .str="seteph",    .handler=std::make_shared<corevm::runtime::instr_handler_seteph>()    },
+  /* DELEPH    */    { .num_oprd=0, .str="deleph",    .handler=std::make_shared<corevm::runtime::instr_handler_deleph>()    },
+  /* FREEZE    */    { .num_oprd=0, .str="freeze",    .handler=std::make_shared<corevm::runtime::instr_handler_freeze>()    },
+  /* NEWIMM    */    { .num_oprd=0, .str="newimm",    .handler=std::make_shared<corevm::runtime::instr_handler_newimm>()    },
+  /* NEWNONE   */    { .num_oprd=0, .str="newnone",   .handler=std::make_shared<corevm::runtime::instr_handler_newnone>()   },
 
   /* -------------------------- Control instructions ------------------------ */
 
@@ -234,8 +244,8 @@ corevm::runtime::instr_handler_meta::instr_set[INSTR_CODE_MAX] {
   /* DEC1     */     { .num_oprd=1, .str="dec1",      .handler=std::make_shared<corevm::runtime::instr_handler_dec1>()      },
   /* DEC2     */     { .num_oprd=1, .str="dec2",      .handler=std::make_shared<corevm::runtime::instr_handler_dec2>()      },
   /* STR      */     { .num_oprd=1, .str="str",       .handler=std::make_shared<corevm::runtime::instr_handler_str>()       },
-  /* ARY      */     { .num_oprd=0, .str="ary",       .handler=std::make_shared<corevm::runtime::instr_handler_ary>()       },
-  /* MAP      */     { .num_oprd=0, .str="map",       .handler=std::make_shared<corevm::runtime::instr_handler_map>()       },
+  /* ARY      */     { .num_oprd=1, .str="ary",       .handler=std::make_shared<corevm::runtime::instr_handler_ary>()       },
+  /* MAP      */     { .num_oprd=1, .str="map",       .handler=std::make_shared<corevm::runtime::instr_handler_map>()       },
 
   /* ----------------- Native type conversion instructions ------------------ */
 
@@ -278,6 +288,7 @@ corevm::runtime::instr_handler_meta::instr_set[INSTR_CODE_MAX] {
   /* STRFND2  */     { .num_oprd=0, .str="strfnd2",   .handler=std::make_shared<corevm::runtime::instr_handler_strfnd2>()   },
   /* STRRFND  */     { .num_oprd=0, .str="strrfnd",   .handler=std::make_shared<corevm::runtime::instr_handler_strrfnd>()   },
   /* STRRFND2 */     { .num_oprd=0, .str="strrfnd2",  .handler=std::make_shared<corevm::runtime::instr_handler_strrfnd2>()  },
+  /* STRINTRN */     { .num_oprd=0, .str="strintrn",  .handler=std::make_shared<corevm::runtime::instr_handler_strintrn>()  },
 
   /* --------------------- Array type instructions -------------------------- */
 
@@ -387,16 +398,23 @@ corevm::runtime::instr_handler::execute_native_floating_type_creation_instr(
 {
   corevm::runtime::frame& frame = process.top_frame();
 
-  std::stringstream oprd2_ss;
-  oprd2_ss << instr.oprd2;
-  std::string oprd2_str = oprd2_ss.str();
+  char buf[corevm::types::MAX_INTEGER_LENGTH * 2 + 1];
 
-  std::reverse(oprd2_str.begin(), oprd2_str.end());
+  size_t length = corevm::types::format_integer(
+    static_cast<uint64_t>(instr.oprd1), buf);
 
-  std::stringstream ss;
-  ss << instr.oprd1 << "." << oprd2_str;
+  buf[length++] = '.';
 
-  corevm::types::native_type_handle hndl = NativeType(stod(ss.str()));
+  size_t oprd2_length = corevm::types::format_integer(
+    static_cast<uint64_t>(instr.oprd2), buf + length);
+
+  std::reverse(buf + length, buf + length + oprd2_length);
+  length += oprd2_length;
+
+  double value = 0;
+  corevm::types::parse_decimal(buf, length, value);
+
+  corevm::types::native_type_handle hndl = NativeType(value);
 
   frame.push_eval_stack(hndl);
 }
@@ -410,7 +428,10 @@ corevm::runtime::instr_handler::execute_native_complex_type_creation_instr(
 {
   corevm::runtime::frame& frame = process.top_frame();
 
-  corevm::types::native_type_handle hndl = NativeType();
+  NativeType value;
+  value.value.set_contains_object_refs(static_cast<bool>(instr.oprd1));
+
+  corevm::types::native_type_handle hndl = value;
 
   frame.push_eval_stack(hndl);
 }
@@ -626,6 +647,7 @@ corevm::runtime::instr_handler_delattr::execute(
   corevm::dyobj::dyobj_id attr_id = obj.getattr(attr_key);
   auto &attr_obj = corevm::runtime::process::adapter(process).help_get_dyobj(attr_id);
   attr_obj.manager().on_delattr();
+  corevm::runtime::process::adapter(process).help_release_dyobj(attr_id);
   obj.delattr(attr_key);
 
   process.push_stack(id);
@@ -729,16 +751,19 @@ corevm::runtime::instr_handler_gethndl::execute(
 {
   corevm::runtime::frame& frame = process.top_frame();
   corevm::dyobj::dyobj_id id = process.top_stack();
-  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
-
-  corevm::dyobj::ntvhndl_key ntvhndl_key = obj.ntvhndl_key();
 
-  if (ntvhndl_key == corevm::dyobj::NONESET_NTVHNDL_KEY)
+  if (corevm::dyobj::is_immediate(id))
   {
-    THROW(corevm::runtime::native_type_handle_not_found_error());
+    corevm::types::native_type_handle hndl =
+      corevm::runtime::process::get_immediate_ntvhndl(id);
+
+    frame.push_eval_stack(hndl);
+    return;
   }
 
-  corevm::types::native_type_handle& hndl = process.get_ntvhndl(ntvhndl_key);
+  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
+
+  corevm::types::native_type_handle hndl = process.get_ntvhndl(obj);
 
   frame.push_eval_stack(hndl);
 }
@@ -754,20 +779,36 @@ corevm::runtime::instr_handler_sethndl::execute(
   corevm::types::native_type_handle hndl = frame.pop_eval_stack();
 
   corevm::dyobj::dyobj_id id = process.top_stack();
-  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
 
-  corevm::dyobj::ntvhndl_key key = obj.ntvhndl_key();
-
-  if (key == corevm::dyobj::NONESET_NTVHNDL_KEY)
+  // Immediates share a single box, which must not change.
+  if (corevm::dyobj::is_immediate(id))
   {
-    corevm::dyobj::ntvhndl_key new_ntvhndl_key = process.insert_ntvhndl(hndl);
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immediate object 0x%08x") % id)));
+  }
+
+  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
 
-    obj.set_ntvhndl_key(new_ntvhndl_key);
+  if (obj.is_frozen())
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate frozen object 0x%08x") % id)));
   }
-  else
+
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
   {
-    process.get_ntvhndl(key) = hndl;
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % id)));
   }
+
+  process.set_ntvhndl(obj, hndl);
+
+  // Write barrier for the objects the handle refers to.
+  corevm::types::for_each_object_ref(hndl,
+    [&obj, id](corevm::types::native_array_element_type element) {
+      obj.manager().on_putattr(id, static_cast<corevm::dyobj::dyobj_id>(element));
+    }
+  );
 }
 
 // -----------------------------------------------------------------------------
@@ -777,17 +818,28 @@ corevm::runtime::instr_handler_clrhndl::execute(
   const corevm::runtime::instr& instr, corevm::runtime::process& process)
 {
   corevm::dyobj::dyobj_id id = process.top_stack();
+
+  if (corevm::dyobj::is_immediate(id))
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immediate object 0x%08x") % id)));
+  }
+
   auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
 
-  corevm::dyobj::ntvhndl_key ntvhndl_key = obj.ntvhndl_key();
+  if (obj.is_frozen())
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate frozen object 0x%08x") % id)));
+  }
 
-  if (ntvhndl_key == corevm::dyobj::NONESET_NTVHNDL_KEY)
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
   {
-    THROW(corevm::runtime::native_type_handle_deletion_error());
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % id)));
   }
 
-  process.erase_ntvhndl(ntvhndl_key);
-  obj.clear_ntvhndl_key();
+  process.clear_ntvhndl(obj);
 }
 
 // -----------------------------------------------------------------------------
@@ -1099,12 +1151,214 @@ corevm::runtime::instr_handler_setflmute::execute(
   }
   else
   {
+    if (corevm::dyobj::is_immediate(id))
+    {
+      THROW(corevm::runtime::invalid_operation_error(
+        str(format("cannot mutate immediate object 0x%08x") % id)));
+    }
+
+    // Frozen objects only stay safe from collection as long as they do not
+    // change.
+    if (obj.is_frozen())
+    {
+      THROW(corevm::runtime::invalid_operation_error(
+        str(format("cannot mutate frozen object 0x%08x") % id)));
+    }
+
     obj.clear_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE);
   }
 }
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::runtime::instr_handler_getattrw::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  uint64_t str_key = static_cast<uint64_t>(instr.oprd1);
+  corevm::dyobj::attr_key attr_key = get_attr_key_from_current_compartment(
+    process, str_key);
+
+  corevm::dyobj::dyobj_id id = process.pop_stack();
+  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
+  corevm::dyobj::dyobj_id attr_id = obj.getweakattr(attr_key);
+
+  process.push_stack(attr_id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_setattrw::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  uint64_t str_key = static_cast<uint64_t>(instr.oprd1);
+  corevm::dyobj::attr_key attr_key = get_attr_key_from_current_compartment(
+    process, str_key);
+
+  corevm::dyobj::dyobj_id attr_id = process.pop_stack();
+  corevm::dyobj::dyobj_id target_id = process.pop_stack();
+
+  corevm::runtime::process::adapter adapter(process);
+  auto &obj = adapter.help_get_dyobj(target_id);
+
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % target_id)));
+  }
+
+  // Weak attributes are neither counted nor traced.
+  obj.putweakattr(attr_key, attr_id);
+  adapter.help_add_weak_ref_holder(target_id);
+
+  process.push_stack(target_id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_delattrw::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::dyobj::attr_key attr_key = static_cast<corevm::dyobj::attr_key>(instr.oprd1);
+
+  corevm::dyobj::dyobj_id id = process.pop_stack();
+  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
+
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % id)));
+  }
+
+  obj.delweakattr(attr_key);
+
+  process.push_stack(id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_geteph::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::dyobj::dyobj_id key_id = process.pop_stack();
+  corevm::dyobj::dyobj_id id = process.pop_stack();
+
+  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
+  corevm::dyobj::dyobj_id value_id = obj.getephemeron(key_id);
+
+  process.push_stack(value_id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_seteph::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::dyobj::dyobj_id value_id = process.pop_stack();
+  corevm::dyobj::dyobj_id key_id = process.pop_stack();
+  corevm::dyobj::dyobj_id target_id = process.pop_stack();
+
+  corevm::runtime::process::adapter adapter(process);
+  auto &obj = adapter.help_get_dyobj(target_id);
+
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % target_id)));
+  }
+
+  // The value replaced loses the reference held by the ephemeron.
+  if (obj.hasephemeron(key_id))
+  {
+    corevm::dyobj::dyobj_id old_value_id = obj.getephemeron(key_id);
+    adapter.help_get_dyobj(old_value_id).manager().on_delattr();
+    adapter.help_release_dyobj(old_value_id);
+  }
+
+  auto &value_obj = adapter.help_get_dyobj(value_id);
+  obj.putephemeron(key_id, value_id);
+  value_obj.manager().on_setattr();
+  adapter.help_add_weak_ref_holder(target_id);
+
+  process.push_stack(target_id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_deleph::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::dyobj::dyobj_id key_id = process.pop_stack();
+  corevm::dyobj::dyobj_id id = process.pop_stack();
+
+  corevm::runtime::process::adapter adapter(process);
+  auto &obj = adapter.help_get_dyobj(id);
+
+  if (obj.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE))
+  {
+    THROW(corevm::runtime::invalid_operation_error(
+      str(format("cannot mutate immutable object 0x%08x") % id)));
+  }
+
+  corevm::dyobj::dyobj_id value_id = obj.getephemeron(key_id);
+  adapter.help_get_dyobj(value_id).manager().on_delattr();
+  adapter.help_release_dyobj(value_id);
+  obj.delephemeron(key_id);
+
+  process.push_stack(id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_freeze::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  process.freeze(process.top_stack());
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_newimm::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::runtime::frame& frame = process.top_frame();
+  corevm::types::native_type_handle hndl = frame.pop_eval_stack();
+
+  corevm::dyobj::dyobj_id id = corevm::runtime::process::make_immediate(hndl);
+
+  if (id == 0)
+  {
+    id = corevm::runtime::process::adapter(process).help_create_dyobj();
+    auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
+    obj.manager().on_create();
+
+    process.set_ntvhndl(obj, hndl);
+  }
+
+  process.push_stack(id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::instr_handler_newnone::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::dyobj::dyobj_id id = corevm::dyobj::make_immediate(
+    corevm::dyobj::IMMEDIATE_NONE, 0);
+
+  process.push_stack(id);
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::runtime::instr_handler_pinvk::execute(
   const corevm::runtime::instr& instr, corevm::runtime::process& process)
@@ -1529,6 +1783,7 @@ corevm::runtime::instr_handler_getargs::execute(
   corevm::runtime::frame& frame = process.top_frame();
   corevm::runtime::invocation_ctx& invk_ctx = process.top_invocation_ctx();
   corevm::types::native_array array;
+  array.set_contains_object_refs(true);
 
   while (invk_ctx.has_params())
   {
@@ -1549,6 +1804,7 @@ corevm::runtime::instr_handler_getkwargs::execute(
   corevm::runtime::frame& frame = process.top_frame();
   corevm::runtime::invocation_ctx& invk_ctx = process.top_invocation_ctx();
   corevm::types::native_map map;
+  map.set_contains_object_refs(true);
 
   std::list<corevm::runtime::variable_key> params = invk_ctx.param_value_pair_keys();
 
@@ -1580,6 +1836,8 @@ corevm::runtime::instr_handler_debug::execute(
   const corevm::runtime::instr& instr, corevm::runtime::process& process)
 {
   std::cout << process << std::endl;
+  process.dump_allocation_stats(std::cout);
+  std::cout << std::endl;
 }
 
 // -----------------------------------------------------------------------------
@@ -1589,16 +1847,19 @@ corevm::runtime::instr_handler_print::execute(
   const corevm::runtime::instr& instr, corevm::runtime::process& process)
 {
   corevm::dyobj::dyobj_id id = process.top_stack();
-  auto &obj = corevm::runtime::process::adapter(process).help_get_dyobj(id);
 
-  corevm::dyobj::ntvhndl_key ntvhndl_key = obj.ntvhndl_key();
-
-  if (ntvhndl_key == corevm::dyobj::NONESET_NTVHNDL_KEY)
+  if (corevm::dyobj::is_immediate(id) &&
+      corevm::dyobj::get_immediate_kind(id) == corevm::dyobj::IMMEDIATE_NONE)
   {
-    THROW(corevm::runtime::native_type_handle_not_found_error());
+    std::cout << "None" << std::endl;
+    return;
   }
 
-  corevm::types::native_type_handle& hndl = process.get_ntvhndl(ntvhndl_key);
+  corevm::types::native_type_handle hndl = corevm::dyobj::is_immediate(id) ?
+    corevm::runtime::process::get_immediate_ntvhndl(id) :
+    process.get_ntvhndl(
+      corevm::runtime::process::adapter(process).help_get_dyobj(id));
+
   corevm::types::native_type_handle result;
   corevm::types::interface_to_str(hndl, result);
 
@@ -2076,7 +2337,7 @@ corevm::runtime::instr_handler_str::execute(
   // String type is different than other complex types.
   corevm::runtime::frame& frame = process.top_frame();
 
-  std::string str;
+  corevm::types::string str;
 
   if (instr.oprd1 > 0)
   {
@@ -2092,10 +2353,15 @@ corevm::runtime::instr_handler_str::execute(
       THROW(corevm::runtime::compartment_not_found_error(compartment_id));
     }
 
-    str = compartment->get_encoding_string(encoding_key);
+    // String literals are interned when their compartment is inserted.
+    if (!compartment->get_interned_string(encoding_key, &str))
+    {
+      str = process.intern_string(corevm::types::native_string(
+        compartment->get_encoding_string(encoding_key)));
+    }
   }
 
-  corevm::types::native_type_handle hndl = corevm::types::string(str);
+  corevm::types::native_type_handle hndl = str;
 
   frame.push_eval_stack(hndl);
 }
@@ -2561,6 +2827,31 @@ corevm::runtime::instr_handler_strrfnd2::execute(
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::runtime::instr_handler_strintrn::execute(
+  const corevm::runtime::instr& instr, corevm::runtime::process& process)
+{
+  corevm::runtime::frame& frame = process.top_frame();
+
+  corevm::types::native_type_handle oprd = frame.pop_eval_stack();
+
+  const corevm::types::string* str = boost::get<corevm::types::string>(&oprd);
+
+  if (str && str->intern_key)
+  {
+    frame.push_eval_stack(oprd);
+    return;
+  }
+
+  corevm::types::native_type_handle result = process.intern_string(str ?
+    str->value() :
+    corevm::types::get_value_from_handle<corevm::types::native_string>(oprd));
+
+  frame.push_eval_stack(result);
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::runtime::instr_handler_arylen::execute(
   const corevm::runtime::instr& instr, corevm::runtime::process& process)
@@ -239,6 +239,75 @@ enum instr_enum : uint32_t
    */
   SETFLMUTE,
 
+  /**
+   * <getattrw, attr, _>
+   * Pop the object at the top of the stack, get its weak attribute and push
+   * it onto the stack. Fails if the attribute has been cleared by the
+   * garbage collector.
+   */
+  GETATTRW,
+
+  /**
+   * <setattrw, attr, _>
+   * Pop the object at the top of the stack as the attribute, pop the next
+   * object as the target, and sets the attribute on the target as a weak
+   * reference, which does not keep the attribute alive.
+   */
+  SETATTRW,
+
+  /**
+   * <delattrw, attr, _>
+   * Pop the object at the top of the stack, and deletes its weak attribute
+   * and push it back onto the stack.
+   */
+  DELATTRW,
+
+  /**
+   * <geteph, _, _>
+   * Pop the object at the top of the stack as the key, pop the next object as
+   * the table, and push the value of the ephemeron of the key in the table.
+   */
+  GETEPH,
+
+  /**
+   * <seteph, _, _>
+   * Pop the object at the top of the stack as the value, pop the next object
+   * as the key, and sets the ephemeron from the key to the value on the next
+   * object on the stack. The value is kept alive only while the key is.
+   */
+  SETEPH,
+
+  /**
+   * <deleph, _, _>
+   * Pop the object at the top of the stack as the key, and deletes the
+   * ephemeron of the key in the next object on the stack.
+   */
+  DELEPH,
+
+  /**
+   * <freeze, _, _>
+   * Freezes the object on top of the stack along with every object it
+   * reaches, all of which must be immutable. Frozen objects are neither
+   * traced, swept nor counted by the garbage collector.
+   */
+  FREEZE,
+
+  /**
+   * <newimm, _, _>
+   * Pops the native handle on top of the eval stack, and pushes an immediate
+   * value holding it onto the stack if it is a boolean or a small `int64`
+   * integer. Otherwise creates an object holding the handle and pushes it.
+   * Immediate values are only given an object when an instruction needs one.
+   * The Python compiler does not emit this instruction.
+   */
+  NEWIMM,
+
+  /**
+   * <newnone, _, _>
+   * Pushes the immediate None value onto the stack.
+   */
+  NEWNONE,
+
 
   /* ------------------------ Control instructions -------------------------- */
 
@@ -407,7 +476,7 @@ enum instr_enum : uint32_t
   /**
    * <print, _, _>
    * Converts the native type handle associated with the object on top of the
-   * stack into a native string, and prints it to std output.
+   * stack into a native string as `2str` does, and prints it to std output.
    */
   PRINT,
 
@@ -664,14 +733,20 @@ enum instr_enum : uint32_t
   STR,
 
   /**
-   * <ary, _, _>
+   * <ary, #, _>
    * Creates an instance of type `array` and place it on top of eval stack.
+   * A non-zero operand marks the array's elements as ids of objects, which
+   * the garbage collector then traces. A zero operand, as emitted before the
+   * operand existed, leaves it unmarked.
    */
   ARY,
 
   /**
-   * <map, _, _>
+   * <map, #, _>
    * Creates an instance of type `map` and place it on top of eval stack.
+   * A non-zero operand marks the map's values as ids of objects, which
+   * the garbage collector then traces. A zero operand, as emitted before the
+   * operand existed, leaves it unmarked.
    */
   MAP,
 
@@ -745,7 +820,9 @@ enum instr_enum : uint32_t
 
   /**
    * <2str, _, _>
-   * Converts the element on top of the eval stack to type `string`.
+   * Converts the element on top of the eval stack to type `string`. Integers
+   * are written in decimal, and decimals with the fewest digits that read
+   * back as the same value.
    */
   TOSTR,
 
@@ -898,6 +975,14 @@ enum instr_enum : uint32_t
    */
   STRRFND2,
 
+  /**
+   * <strintrn, _, _>
+   * Pops the top element on the eval stack, and pushes the equal string
+   * from the process's string intern table back onto the eval stack.
+   * Interned strings carry their hash and are compared by identity first.
+   */
+  STRINTRN,
+
   /* ----------------------- Array type instructions ------------------------ */
 
   /**
@@ -1342,6 +1427,78 @@ public:
 
 // -----------------------------------------------------------------------------
 
+class instr_handler_getattrw : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_setattrw : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_delattrw : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_geteph : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_seteph : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_deleph : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_freeze : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_newimm : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
+class instr_handler_newnone : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
 
 /* ------------------------ Control instructions ---------------------------- */
 
@@ -2142,6 +2299,14 @@ public:
 
 // -----------------------------------------------------------------------------
 
+class instr_handler_strintrn : public instr_handler
+{
+public:
+  virtual void execute(const corevm::runtime::instr&, corevm::runtime::process&);
+};
+
+// -----------------------------------------------------------------------------
+
 
 /* ----------------------- Array type instructions -------------------------- */
 
@@ -25,7 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "utils.h"
 #include "corevm/macros.h"
 
+#include <algorithm>
 #include <ostream>
+#include <vector>
 
 
 namespace {
@@ -39,7 +41,8 @@ typedef corevm::runtime::native_types_pool _MyType;
 
 corevm::runtime::native_types_pool::native_types_pool()
   :
-  m_container(COREVM_DEFAULT_NATIVE_TYPES_POOL_SIZE)
+  m_container(COREVM_DEFAULT_NATIVE_TYPES_POOL_SIZE),
+  m_payload_size(0)
 {
   // Do nothing here.
 }
@@ -48,7 +51,19 @@ corevm::runtime::native_types_pool::native_types_pool()
 
 corevm::runtime::native_types_pool::native_types_pool(uint64_t total_size)
   :
-  m_container(total_size)
+  m_container(total_size),
+  m_payload_size(0)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::runtime::native_types_pool::native_types_pool(
+  uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+  :
+  m_container(total_size, max_total_size, arena_flags),
+  m_payload_size(0)
 {
   // Do nothing here.
 }
@@ -79,6 +94,55 @@ corevm::runtime::native_types_pool::total_size() const
 
 // -----------------------------------------------------------------------------
 
+uint64_t
+corevm::runtime::native_types_pool::committed_size() const
+{
+  return m_container.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::native_types_pool::release_free_memory()
+{
+  return m_container.release_free_memory();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::native_types_pool::reclaimable_size() const
+{
+  return m_container.reclaimable_size();
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::allocation_stats
+corevm::runtime::native_types_pool::stats() const
+{
+  return m_container.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::native_types_pool::payload_size() const
+{
+  return m_payload_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::native_types_pool::set_allocation_trace(
+  corevm::memory::allocation_trace* trace)
+{
+  m_container.set_trace(trace);
+}
+
+// -----------------------------------------------------------------------------
+
 _MyType::reference
 corevm::runtime::native_types_pool::at(const corevm::dyobj::ntvhndl_key& key)
   throw(corevm::runtime::native_type_handle_not_found_error)
@@ -98,6 +162,20 @@ corevm::runtime::native_types_pool::at(const corevm::dyobj::ntvhndl_key& key)
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::runtime::native_types_pool::assign(
+  const corevm::dyobj::ntvhndl_key& key, const value_type& hndl)
+  throw(corevm::runtime::native_type_handle_not_found_error)
+{
+  reference hndl_ = at(key);
+
+  m_payload_size -= corevm::types::payload_size(hndl_);
+  hndl_ = hndl;
+  m_payload_size += corevm::types::payload_size(hndl_);
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::dyobj::ntvhndl_key
 corevm::runtime::native_types_pool::create()
   throw(corevm::runtime::native_type_handle_insertion_error)
@@ -129,11 +207,39 @@ corevm::runtime::native_types_pool::erase(const corevm::dyobj::ntvhndl_key& key)
     THROW(corevm::runtime::native_type_handle_not_found_error());
   }
 
+  m_payload_size -= corevm::types::payload_size(*ptr);
   m_container.destroy(ptr);
 }
 
 // -----------------------------------------------------------------------------
 
+_MyType::size_type
+corevm::runtime::native_types_pool::erase(
+  std::vector<corevm::dyobj::ntvhndl_key>& keys)
+{
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  size_type count = 0;
+
+  for (auto itr = keys.begin(); itr != keys.end(); ++itr)
+  {
+    void* raw_ptr = corevm::runtime::ntvhndl_key_to_ptr(*itr);
+    _MyType::pointer ptr = m_container[static_cast<_MyType::pointer>(raw_ptr)];
+
+    if (ptr)
+    {
+      m_payload_size -= corevm::types::payload_size(*ptr);
+      m_container.destroy(ptr);
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+
 namespace corevm {
 
 
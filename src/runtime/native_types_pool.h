@@ -26,6 +26,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common.h"
 #include "errors.h"
 #include "dyobj/common.h"
+#include "memory/allocation_stats.h"
+#include "memory/allocation_trace.h"
 #include "memory/allocator.h"
 #include "memory/allocation_policy.h"
 #include "memory/object_container.h"
@@ -39,6 +41,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include <ostream>
 #include <type_traits>
+#include <vector>
 
 
 namespace corevm {
@@ -75,6 +78,12 @@ public:
         AllocationPolicyType(total_size)
       {
       }
+
+      allocator(uint64_t total_size, uint64_t max_total_size, uint32_t arena_flags)
+        :
+        AllocationPolicyType(total_size, max_total_size, arena_flags)
+      {
+      }
   };
 
   typedef allocator<value_type> allocator_type;
@@ -94,6 +103,7 @@ public:
 
   native_types_pool();
   explicit native_types_pool(uint64_t);
+  native_types_pool(uint64_t, uint64_t, uint32_t);
 
   /* Native type pools should not be copyable. */
   native_types_pool(const native_types_pool&) = delete;
@@ -105,19 +115,58 @@ public:
 
   size_type total_size() const;
 
+  uint64_t committed_size() const;
+
+  /**
+   * Gives the pages spanned by free blocks back to the OS.
+   * Returns the number of bytes released.
+   */
+  uint64_t release_free_memory();
+
+  /**
+   * Bytes freed since free memory was last released.
+   */
+  uint64_t reclaimable_size() const;
+
+  corevm::memory::allocation_stats stats() const;
+
+  /**
+   * The approximate number of bytes held by the payloads of the native
+   * strings, arrays and maps in this pool. Kept as a running total by
+   * `assign()` and `erase()`, so this is constant time.
+   */
+  uint64_t payload_size() const;
+
+  void set_allocation_trace(corevm::memory::allocation_trace*);
+
+  /**
+   * Handles must be replaced through `assign()` rather than through the
+   * returned reference, or the payload size total goes stale.
+   */
   reference at(const corevm::dyobj::ntvhndl_key&)
     throw(corevm::runtime::native_type_handle_not_found_error);
 
+  void assign(const corevm::dyobj::ntvhndl_key&, const value_type&)
+    throw(corevm::runtime::native_type_handle_not_found_error);
+
   corevm::dyobj::ntvhndl_key create()
     throw(corevm::runtime::native_type_handle_insertion_error);
 
   void erase(const corevm::dyobj::ntvhndl_key&)
     throw(corevm::runtime::native_type_handle_not_found_error);
 
+  /**
+   * Erases the handles of the specified keys in one pass, in address order.
+   * Keys may repeat, and keys that are not in the pool are skipped.
+   * Returns the number of handles erased.
+   */
+  size_type erase(std::vector<corevm::dyobj::ntvhndl_key>&);
+
   friend std::ostream& operator<<(std::ostream&, const corevm::runtime::native_types_pool&);
 
 private:
   container_type m_container;
+  uint64_t m_payload_size;
 };
 
 // -----------------------------------------------------------------------------
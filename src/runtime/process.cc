@@ -33,19 +33,30 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "vector.h"
 #include "corevm/macros.h"
 #include "dyobj/common.h"
+#include "dyobj/dyobj_id.h"
 #include "dyobj/dynamic_object_heap.h"
+#include "dyobj/flags.h"
 #include "gc/garbage_collector.h"
 #include "gc/garbage_collection_scheme.h"
 
+#include <boost/variant/get.hpp>
+
 #include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cstdint>
+#include <limits>
 #include <iterator>
 #include <list>
 #include <ostream>
+#include <sstream>
 #include <stack>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <setjmp.h>
 
@@ -64,6 +75,16 @@ using _GarbageCollectorType = typename corevm::gc::garbage_collector<
 
 // -----------------------------------------------------------------------------
 
+uint64_t
+steady_time()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// -----------------------------------------------------------------------------
+
 class ntvhndl_collector_gc_callback : public _GarbageCollectorType::callback
 {
 private:
@@ -72,16 +93,20 @@ private:
 public:
   virtual void operator()(const dynamic_object_type& obj)
   {
-    this->m_list.push_back(obj.ntvhndl_key());
+    // Objects holding scalars inline have nothing in the pool.
+    if (obj.ntvhndl_key() != corevm::dyobj::NONESET_NTVHNDL_KEY)
+    {
+      this->m_list.push_back(obj.ntvhndl_key());
+    }
   }
 
-  const std::list<corevm::dyobj::ntvhndl_key>& list() const
+  std::vector<corevm::dyobj::ntvhndl_key>& list()
   {
     return m_list;
   }
 
 private:
-  std::list<corevm::dyobj::ntvhndl_key> m_list;
+  std::vector<corevm::dyobj::ntvhndl_key> m_list;
 };
 
 // -----------------------------------------------------------------------------
@@ -101,7 +126,18 @@ private:
 corevm::dyobj::dyobj_id
 corevm::runtime::process::adapter::help_create_dyobj()
 {
-  return m_process.m_dynamic_object_heap.create_dyobj();
+  if (m_process.m_gc_sweep_state.pending())
+  {
+    m_process.sweep(m_process.m_gc_sweep_chunk_size);
+  }
+
+  ++m_process.m_allocation_count_since_gc_check;
+
+  corevm::dyobj::dyobj_id id = m_process.m_dynamic_object_heap.create_dyobj();
+  m_process.m_gc_zero_count_table.insert(id);
+  m_process.m_gc_sweep_state.retain(m_process.m_dynamic_object_heap.at(id));
+
+  return id;
 }
 
 // -----------------------------------------------------------------------------
@@ -109,14 +145,40 @@ corevm::runtime::process::adapter::help_create_dyobj()
 corevm::runtime::process::dynamic_object_type&
 corevm::runtime::process::adapter::help_get_dyobj(corevm::dyobj::dyobj_id id)
 {
+  if (corevm::dyobj::is_immediate(id))
+  {
+    return m_process.box_immediate(id);
+  }
+
   return m_process.m_dynamic_object_heap.at(id);
 }
 
 // -----------------------------------------------------------------------------
 
+void
+corevm::runtime::process::adapter::help_release_dyobj(corevm::dyobj::dyobj_id id)
+{
+  m_process.m_gc_zero_count_table.insert(id);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::adapter::help_add_weak_ref_holder(corevm::dyobj::dyobj_id id)
+{
+  m_process.m_dynamic_object_heap.add_weak_ref_holder(id);
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::runtime::process::process()
   :
-  m_pause_exec(false),
+  m_safepoint_requested(false),
+  m_parked(false),
+  m_executing(false),
+  m_exec_thread(),
+  m_safepoint_mutex(),
+  m_safepoint_cond(),
   m_gc_flag(0),
   m_pc(NONESET_INSTR_ADDR),
   m_dynamic_object_heap(),
@@ -125,7 +187,32 @@ corevm::runtime::process::process()
   m_invocation_ctx_stack(),
   m_ntvhndl_pool(),
   m_sig_instr_map(),
-  m_compartments()
+  m_compartments(),
+  m_gc_state(),
+  m_gc_slice_budget(0),
+  m_gc_slice_interval(0),
+  m_instr_count_since_gc_slice(0),
+  m_gc_pending(false),
+  m_gc_pause_stats(),
+  m_gc_generations(),
+  m_gc_zero_count_table(),
+  m_gc_nursery_size(0),
+  m_gc_nursery_count(0),
+  m_gc_promoted_count(0),
+  m_gc_minor_pause_stats(),
+  m_gc_mark_threads(1),
+  m_gc_sweep_state(),
+  m_gc_sweep_chunk_size(0),
+  m_gc_allocation_interval(0),
+  m_allocation_count_since_gc_check(0),
+  m_gc_cycle(),
+  m_gc_stats(),
+  m_gc_log(nullptr),
+  m_gc_threshold_policy(),
+  m_immediate_boxes(),
+  m_string_intern_table(),
+  m_max_native_payload_size(
+    corevm::runtime::COREVM_DEFAULT_NATIVE_PAYLOAD_SIZE_LIMIT)
 {
   // Do nothing here.
 }
@@ -135,7 +222,12 @@ corevm::runtime::process::process()
 corevm::runtime::process::process(
   uint64_t heap_alloc_size, uint64_t pool_alloc_size)
   :
-  m_pause_exec(false),
+  m_safepoint_requested(false),
+  m_parked(false),
+  m_executing(false),
+  m_exec_thread(),
+  m_safepoint_mutex(),
+  m_safepoint_cond(),
   m_gc_flag(0),
   m_pc(NONESET_INSTR_ADDR),
   m_dynamic_object_heap(heap_alloc_size),
@@ -144,7 +236,87 @@ corevm::runtime::process::process(
   m_invocation_ctx_stack(),
   m_ntvhndl_pool(pool_alloc_size),
   m_sig_instr_map(),
-  m_compartments()
+  m_compartments(),
+  m_gc_state(),
+  m_gc_slice_budget(0),
+  m_gc_slice_interval(0),
+  m_instr_count_since_gc_slice(0),
+  m_gc_pending(false),
+  m_gc_pause_stats(),
+  m_gc_generations(),
+  m_gc_zero_count_table(),
+  m_gc_nursery_size(0),
+  m_gc_nursery_count(0),
+  m_gc_promoted_count(0),
+  m_gc_minor_pause_stats(),
+  m_gc_mark_threads(1),
+  m_gc_sweep_state(),
+  m_gc_sweep_chunk_size(0),
+  m_gc_allocation_interval(0),
+  m_allocation_count_since_gc_check(0),
+  m_gc_cycle(),
+  m_gc_stats(),
+  m_gc_log(nullptr),
+  m_gc_threshold_policy(),
+  m_immediate_boxes(),
+  m_string_intern_table(),
+  m_max_native_payload_size(
+    corevm::runtime::COREVM_DEFAULT_NATIVE_PAYLOAD_SIZE_LIMIT)
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::runtime::process::process(
+  uint64_t heap_alloc_size,
+  uint64_t pool_alloc_size,
+  uint64_t max_heap_alloc_size,
+  uint64_t max_pool_alloc_size,
+  uint32_t arena_flags,
+  uint32_t heap_flags)
+  :
+  m_safepoint_requested(false),
+  m_parked(false),
+  m_executing(false),
+  m_exec_thread(),
+  m_safepoint_mutex(),
+  m_safepoint_cond(),
+  m_gc_flag(0),
+  m_pc(NONESET_INSTR_ADDR),
+  m_dynamic_object_heap(
+    heap_alloc_size, max_heap_alloc_size, arena_flags, heap_flags),
+  m_dyobj_stack(),
+  m_call_stack(),
+  m_invocation_ctx_stack(),
+  m_ntvhndl_pool(pool_alloc_size, max_pool_alloc_size, arena_flags),
+  m_sig_instr_map(),
+  m_compartments(),
+  m_gc_state(),
+  m_gc_slice_budget(0),
+  m_gc_slice_interval(0),
+  m_instr_count_since_gc_slice(0),
+  m_gc_pending(false),
+  m_gc_pause_stats(),
+  m_gc_generations(),
+  m_gc_zero_count_table(),
+  m_gc_nursery_size(0),
+  m_gc_nursery_count(0),
+  m_gc_promoted_count(0),
+  m_gc_minor_pause_stats(),
+  m_gc_mark_threads(1),
+  m_gc_sweep_state(),
+  m_gc_sweep_chunk_size(0),
+  m_gc_allocation_interval(0),
+  m_allocation_count_since_gc_check(0),
+  m_gc_cycle(),
+  m_gc_stats(),
+  m_gc_log(nullptr),
+  m_gc_threshold_policy(),
+  m_immediate_boxes(),
+  m_string_intern_table(),
+  m_max_native_payload_size(
+    corevm::runtime::COREVM_DEFAULT_NATIVE_PAYLOAD_SIZE_LIMIT)
 {
   // Do nothing here.
 }
@@ -192,26 +364,8 @@ corevm::runtime::process::pop_frame() throw(corevm::runtime::frame_not_found_err
 {
   corevm::runtime::frame& frame = this->top_frame();
 
-  std::list<corevm::dyobj::dyobj_id> visible_objs = frame.get_visible_objs();
-  std::list<corevm::dyobj::dyobj_id> invisible_objs = frame.get_invisible_objs();
-
-  std::for_each(
-    visible_objs.begin(),
-    visible_objs.end(),
-    [this](corevm::dyobj::dyobj_id id) {
-      auto &obj = corevm::runtime::process::adapter(*this).help_get_dyobj(id);
-      obj.manager().on_exit();
-    }
-  );
-
-  std::for_each(
-    invisible_objs.begin(),
-    invisible_objs.end(),
-    [this](corevm::dyobj::dyobj_id id) {
-      auto &obj = corevm::runtime::process::adapter(*this).help_get_dyobj(id);
-      obj.manager().on_exit();
-    }
-  );
+  // References held by the variables of the frame are not counted, so they
+  // are not visited here.
 
   set_pc(frame.return_addr());
 
@@ -411,6 +565,85 @@ corevm::runtime::process::max_ntvhndl_pool_size() const
 
 // -----------------------------------------------------------------------------
 
+uint64_t
+corevm::runtime::process::heap_committed_size() const
+{
+  return m_dynamic_object_heap.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::process::ntvhndl_pool_committed_size() const
+{
+  return m_ntvhndl_pool.committed_size();
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::allocation_stats
+corevm::runtime::process::heap_stats() const
+{
+  return m_dynamic_object_heap.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::memory::allocation_stats
+corevm::runtime::process::ntvhndl_pool_stats() const
+{
+  return m_ntvhndl_pool.stats();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::dump_allocation_stats(std::ostream& ost) const
+{
+  ost << "{";
+  ost << "\"heap\": " << heap_stats() << ", ";
+  ost << "\"native-types-pool\": " << ntvhndl_pool_stats();
+  ost << "}";
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_allocation_traces(
+  corevm::memory::allocation_trace* heap_trace,
+  corevm::memory::allocation_trace* ntvhndl_pool_trace)
+{
+  m_dynamic_object_heap.set_allocation_trace(heap_trace);
+  m_ntvhndl_pool.set_allocation_trace(ntvhndl_pool_trace);
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::process::native_payload_size() const
+{
+  return m_ntvhndl_pool.payload_size();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::process::max_native_payload_size() const
+{
+  return m_max_native_payload_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_max_native_payload_size(
+  uint64_t max_native_payload_size)
+{
+  m_max_native_payload_size = max_native_payload_size;
+}
+
+// -----------------------------------------------------------------------------
+
 bool
 corevm::runtime::process::has_ntvhndl(corevm::dyobj::ntvhndl_key& key)
 {
@@ -443,8 +676,7 @@ corevm::runtime::process::insert_ntvhndl(corevm::types::native_type_handle& hndl
 {
   auto key = m_ntvhndl_pool.create();
 
-  corevm::types::native_type_handle& hndl_ = m_ntvhndl_pool.at(key);
-  hndl_ = hndl;
+  m_ntvhndl_pool.assign(key, hndl);
 
   return key;
 }
@@ -472,188 +704,969 @@ corevm::runtime::process::erase_ntvhndl(corevm::dyobj::ntvhndl_key key)
 
 // -----------------------------------------------------------------------------
 
-const corevm::runtime::instr_handler*
-corevm::runtime::process::get_instr_handler(corevm::runtime::instr_code code)
-{
-  corevm::runtime::instr_info instr_info = \
-    corevm::runtime::instr_handler_meta::get(code);
-
-  return instr_info.handler.get();
-}
-
-// -----------------------------------------------------------------------------
-
-void
-corevm::runtime::process::pause_exec()
+bool
+corevm::runtime::process::has_ntvhndl(const dynamic_object_type& obj) const
 {
-  m_pause_exec = true;
+  return obj.inline_ntvhndl_type() != 0 ||
+    obj.ntvhndl_key() != corevm::dyobj::NONESET_NTVHNDL_KEY;
 }
 
 // -----------------------------------------------------------------------------
 
-void
-corevm::runtime::process::resume_exec()
+corevm::types::native_type_handle
+corevm::runtime::process::get_ntvhndl(const dynamic_object_type& obj)
+  throw(corevm::runtime::native_type_handle_not_found_error)
 {
-  m_pause_exec = false;
-}
+  if (obj.inline_ntvhndl_type() != 0)
+  {
+    return corevm::types::unpack_scalar_handle(
+      obj.inline_ntvhndl_type(), obj.inline_ntvhndl_bits());
+  }
 
-// -----------------------------------------------------------------------------
+  if (obj.ntvhndl_key() == corevm::dyobj::NONESET_NTVHNDL_KEY)
+  {
+    THROW(corevm::runtime::native_type_handle_not_found_error());
+  }
 
-bool
-corevm::runtime::process::is_valid_pc() const
-{
-  return m_pc != NONESET_INSTR_ADDR && (m_pc >= 0 && m_pc < m_instrs.size());
+  return m_ntvhndl_pool.at(obj.ntvhndl_key());
 }
 
 // -----------------------------------------------------------------------------
 
-bool
-corevm::runtime::process::can_execute()
+void
+corevm::runtime::process::set_ntvhndl(
+  dynamic_object_type& obj, corevm::types::native_type_handle& hndl)
+  throw(corevm::runtime::native_type_handle_insertion_error)
 {
-  return is_valid_pc();
-}
+  uint64_t bits = 0;
+  uint8_t type = corevm::types::pack_scalar_handle(hndl, bits);
 
-// -----------------------------------------------------------------------------
+  corevm::dyobj::ntvhndl_key key = obj.ntvhndl_key();
 
-bool
-corevm::runtime::process::pre_start()
-{
-  corevm::runtime::closure closure;
-  if (m_compartments.empty())
+  if (type != 0)
   {
-    return false;
+    if (key != corevm::dyobj::NONESET_NTVHNDL_KEY)
+    {
+      this->erase_ntvhndl(key);
+      obj.clear_ntvhndl_key();
+    }
+
+    obj.set_inline_ntvhndl(type, bits);
+    return;
   }
 
-  bool res = m_compartments.front().get_starting_closure(&closure);
+  obj.clear_inline_ntvhndl();
 
-  // If we found the starting compartment and closure, create a frame with the
-  // closure context, and loads and vector into the process.
-  if (res)
+  if (key == corevm::dyobj::NONESET_NTVHNDL_KEY)
   {
-    corevm::runtime::closure_ctx ctx {
-      .compartment_id = 0,
-      .closure_id = closure.id
-    };
-
-    append_vector(closure.vector);
-
-    emplace_frame(ctx, m_pc);
-
-    emplace_invocation_ctx(ctx);
-
-    m_pc = 0;
+    obj.set_ntvhndl_key(this->insert_ntvhndl(hndl));
+  }
+  else
+  {
+    m_ntvhndl_pool.assign(key, hndl);
   }
 
-  return res;
+  // Lets reference counting trace the held ids without visiting the heap.
+  if (corevm::types::holds_object_refs(hndl))
+  {
+    m_dynamic_object_heap.add_ntvhndl_holder(obj.id());
+  }
 }
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::runtime::process::start()
+corevm::runtime::process::clear_ntvhndl(dynamic_object_type& obj)
+  throw(corevm::runtime::native_type_handle_deletion_error)
 {
-  if (!pre_start())
+  if (obj.inline_ntvhndl_type() != 0)
   {
+    obj.clear_inline_ntvhndl();
     return;
   }
 
-  while (can_execute())
+  corevm::dyobj::ntvhndl_key key = obj.ntvhndl_key();
+
+  if (key == corevm::dyobj::NONESET_NTVHNDL_KEY)
   {
-    while (m_pause_exec) {}
+    THROW(corevm::runtime::native_type_handle_deletion_error());
+  }
 
-    const corevm::runtime::instr& instr = m_instrs[m_pc];
+  this->erase_ntvhndl(key);
+  obj.clear_ntvhndl_key();
+}
 
-    corevm::runtime::instr_handler* handler =
-      const_cast<corevm::runtime::instr_handler*>(this->get_instr_handler(instr.code));
+// -----------------------------------------------------------------------------
 
-    sigsetjmp(corevm::runtime::sighandler_registrar::get_sigjmp_env(), 1);
+corevm::dyobj::dyobj_id
+corevm::runtime::process::make_immediate(
+  const corevm::types::native_type_handle& hndl)
+{
+  if (const corevm::types::boolean* value = boost::get<corevm::types::boolean>(&hndl))
+  {
+    return corevm::dyobj::make_immediate(
+      corevm::dyobj::IMMEDIATE_BOOL, static_cast<int64_t>(value->value));
+  }
 
-    if (!corevm::runtime::sighandler_registrar::is_sig_raised())
-    {
-      handler->execute(instr, *this);
-    }
-    else
+  if (const corevm::types::int64* value = boost::get<corevm::types::int64>(&hndl))
+  {
+    if (value->value >= corevm::dyobj::IMMEDIATE_INT_MIN &&
+        value->value <= corevm::dyobj::IMMEDIATE_INT_MAX)
     {
-      if (!this->can_execute())
-      {
-        break;
-      }
+      return corevm::dyobj::make_immediate(
+        corevm::dyobj::IMMEDIATE_INT, value->value);
     }
+  }
 
-    corevm::runtime::sighandler_registrar::clear_sig_raised();
+  return 0;
+}
 
-    ++m_pc;
+// -----------------------------------------------------------------------------
 
-  } /* end `while (can_execute())` */
+corevm::types::native_type_handle
+corevm::runtime::process::get_immediate_ntvhndl(corevm::dyobj::dyobj_id id)
+  throw(corevm::runtime::native_type_handle_not_found_error)
+{
+  switch (corevm::dyobj::get_immediate_kind(id))
+  {
+    case corevm::dyobj::IMMEDIATE_INT:
+      return corevm::types::int64(corevm::dyobj::get_immediate_value(id));
+    case corevm::dyobj::IMMEDIATE_BOOL:
+      return corevm::types::boolean(corevm::dyobj::get_immediate_value(id) != 0);
+    default:
+      THROW(corevm::runtime::native_type_handle_not_found_error());
+  }
 }
 
 // -----------------------------------------------------------------------------
 
-void
-corevm::runtime::process::maybe_gc()
+corevm::runtime::process::dynamic_object_type&
+corevm::runtime::process::box_immediate(corevm::dyobj::dyobj_id id)
 {
-  if (!(this->should_gc()))
+  auto itr = m_immediate_boxes.find(id);
+
+  if (itr != m_immediate_boxes.end())
   {
-    return;
+    return m_dynamic_object_heap.at(itr->second);
   }
 
-  do_gc();
-};
+  corevm::dyobj::dyobj_id box_id = m_dynamic_object_heap.create_dyobj();
+  dynamic_object_type& box = m_dynamic_object_heap.at(box_id);
+
+  if (corevm::dyobj::get_immediate_kind(id) != corevm::dyobj::IMMEDIATE_NONE)
+  {
+    corevm::types::native_type_handle hndl = get_immediate_ntvhndl(id);
+    this->set_ntvhndl(box, hndl);
+  }
+
+  box.set_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE);
+  box.set_flag(corevm::dyobj::flags::DYOBJ_IS_INDELIBLE);
+  box.set_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE);
+
+  m_immediate_boxes[id] = box_id;
+
+  return box;
+}
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::runtime::process::do_gc()
+corevm::runtime::process::release_immediate_boxes()
 {
-  this->pause_exec();
-
-  corevm::gc::garbage_collector<garbage_collection_scheme> garbage_collector(
-    m_dynamic_object_heap);
-
-  corevm::runtime::internal::ntvhndl_collector_gc_callback callback;
-  garbage_collector.gc(&callback);
+  // Box ids are never handed out, so nothing refers to the boxes.
+  for (auto itr = m_immediate_boxes.begin(); itr != m_immediate_boxes.end(); ++itr)
+  {
+    dynamic_object_type* box = m_dynamic_object_heap.find(itr->second);
 
-  std::for_each(
-    callback.list().begin(),
-    callback.list().end(),
-    [&](corevm::dyobj::ntvhndl_key key) {
-      this->erase_ntvhndl(key);
+    if (box)
+    {
+      this->erase_ntvhndl(box->ntvhndl_key());
+      m_dynamic_object_heap.erase(itr->second);
     }
-  );
+  }
 
-  this->resume_exec();
+  m_immediate_boxes.clear();
 }
 
 // -----------------------------------------------------------------------------
 
-const corevm::runtime::instr_addr
-corevm::runtime::process::pc() const
+const corevm::runtime::instr_handler*
+corevm::runtime::process::get_instr_handler(corevm::runtime::instr_code code)
 {
-  return m_pc;
+  corevm::runtime::instr_info instr_info = \
+    corevm::runtime::instr_handler_meta::get(code);
+
+  return instr_info.handler.get();
 }
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::runtime::process::set_pc(const corevm::runtime::instr_addr addr)
-  throw(corevm::runtime::invalid_instr_addr_error)
+corevm::runtime::process::pause_exec()
 {
-  if ( addr != corevm::runtime::NONESET_INSTR_ADDR &&
-      (addr < 0 || addr >= m_instrs.size()) )
+  // The executing thread only runs its own code between instructions, where
+  // it is already at a safepoint.
+  if (m_exec_thread == std::this_thread::get_id())
   {
-    THROW(corevm::runtime::invalid_instr_addr_error());
+    return;
   }
 
-  m_pc = addr;
+  std::unique_lock<std::mutex> lock(m_safepoint_mutex);
+
+  // Wait for the world stopped by another thread to be resumed.
+  m_safepoint_cond.wait(lock, [this]() { return !m_safepoint_requested; });
+
+  m_safepoint_requested = true;
+
+  m_safepoint_cond.wait(lock, [this]() { return m_parked || !m_executing; });
 }
 
 // -----------------------------------------------------------------------------
 
 void
-corevm::runtime::process::append_vector(const corevm::runtime::vector& vector)
+corevm::runtime::process::resume_exec()
 {
-  // Inserts the vector at the very end of the instr array.
-  // (This is different than `process::insert_vector`.
+  if (m_exec_thread == std::this_thread::get_id())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_safepoint_mutex);
+    m_safepoint_requested = false;
+  }
+
+  m_safepoint_cond.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::attach_exec_thread()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_safepoint_mutex);
+    m_executing = true;
+  }
+
+  m_exec_thread = std::this_thread::get_id();
+
+  if (m_safepoint_requested)
+  {
+    this->safepoint();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::detach_exec_thread()
+{
+  m_exec_thread = std::thread::id();
+
+  {
+    std::lock_guard<std::mutex> lock(m_safepoint_mutex);
+    m_executing = false;
+  }
+
+  m_safepoint_cond.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::safepoint()
+{
+  std::unique_lock<std::mutex> lock(m_safepoint_mutex);
+
+  m_parked = true;
+  m_safepoint_cond.notify_all();
+
+  m_safepoint_cond.wait(lock, [this]() { return !m_safepoint_requested; });
+
+  m_parked = false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::process::is_valid_pc() const
+{
+  return m_pc != NONESET_INSTR_ADDR && (m_pc >= 0 && m_pc < m_instrs.size());
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::process::can_execute()
+{
+  return is_valid_pc();
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::process::pre_start()
+{
+  corevm::runtime::closure closure;
+  if (m_compartments.empty())
+  {
+    return false;
+  }
+
+  bool res = m_compartments.front().get_starting_closure(&closure);
+
+  // If we found the starting compartment and closure, create a frame with the
+  // closure context, and loads and vector into the process.
+  if (res)
+  {
+    corevm::runtime::closure_ctx ctx {
+      .compartment_id = 0,
+      .closure_id = closure.id
+    };
+
+    append_vector(closure.vector);
+
+    emplace_frame(ctx, m_pc);
+
+    emplace_invocation_ctx(ctx);
+
+    m_pc = 0;
+  }
+
+  return res;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::start()
+{
+  this->attach_exec_thread();
+
+  try
+  {
+    if (pre_start())
+    {
+      this->run();
+    }
+  }
+  catch (...)
+  {
+    this->detach_exec_thread();
+    throw;
+  }
+
+  this->detach_exec_thread();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::run()
+{
+  m_gc_state.activate();
+  m_gc_generations.activate();
+
+  while (can_execute())
+  {
+    if (m_safepoint_requested)
+    {
+      this->safepoint();
+    }
+
+    const corevm::runtime::instr& instr = m_instrs[m_pc];
+
+    corevm::runtime::instr_handler* handler =
+      const_cast<corevm::runtime::instr_handler*>(this->get_instr_handler(instr.code));
+
+    sigsetjmp(corevm::runtime::sighandler_registrar::get_sigjmp_env(), 1);
+
+    if (!corevm::runtime::sighandler_registrar::is_sig_raised())
+    {
+      handler->execute(instr, *this);
+    }
+    else
+    {
+      if (!this->can_execute())
+      {
+        break;
+      }
+    }
+
+    corevm::runtime::sighandler_registrar::clear_sig_raised();
+
+    ++m_pc;
+
+    if (m_gc_pending && ++m_instr_count_since_gc_slice >= m_gc_slice_interval)
+    {
+      m_instr_count_since_gc_slice = 0;
+
+      if (this->collect(m_gc_slice_budget))
+      {
+        m_gc_pending = false;
+      }
+    }
+
+    // Minor collections rely on the old generation staying marked, so they
+    // wait for the full collection in progress to complete.
+    if (m_gc_nursery_size && !m_gc_pending &&
+        m_dynamic_object_heap.nursery().size() >= m_gc_nursery_size)
+    {
+      this->do_minor_gc();
+    }
+
+    if (m_gc_allocation_interval &&
+        m_allocation_count_since_gc_check >= m_gc_allocation_interval)
+    {
+      m_allocation_count_since_gc_check = 0;
+      this->maybe_gc();
+    }
+
+  } /* end `while (can_execute())` */
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::maybe_gc()
+{
+  if (!m_gc_flag)
+  {
+    return;
+  }
+
+  // The rules inspect the heap, so they are checked with the world stopped.
+  this->pause_exec();
+
+  if (this->should_gc())
+  {
+    if (m_gc_slice_budget)
+    {
+      m_gc_pending = true;
+    }
+    else
+    {
+      this->collect(std::numeric_limits<size_t>::max());
+      m_gc_pending = false;
+    }
+  }
+
+  this->resume_exec();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_flag(uint8_t gc_flag)
+{
+  m_gc_flag = gc_flag;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_allocation_interval(uint32_t interval)
+{
+  m_gc_allocation_interval = interval;
+  m_allocation_count_since_gc_check = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_threshold_policy(
+  const corevm::runtime::gc_threshold_policy& policy)
+{
+  m_gc_threshold_policy = policy;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+corevm::runtime::process::gc_threshold() const
+{
+  return m_gc_threshold_policy.threshold();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::do_gc()
+{
+  this->pause_exec();
+
+  this->collect(std::numeric_limits<size_t>::max());
+  m_gc_pending = false;
+
+  this->resume_exec();
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::process::collect(size_t budget)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  // An incremental cycle spans all the slices up to the one that completes.
+  if (!m_gc_cycle.slice_count)
+  {
+    this->begin_gc_cycle(m_gc_cycle);
+  }
+
+  ++m_gc_cycle.slice_count;
+
+  corevm::gc::garbage_collector<garbage_collection_scheme> garbage_collector(
+    m_dynamic_object_heap);
+  garbage_collector.set_mark_thread_count(m_gc_mark_threads);
+  garbage_collector.set_sweep_state(this->sweep_state());
+  garbage_collector.set_cycle_stats(&m_gc_cycle);
+  garbage_collector.set_zero_count_table(&m_gc_zero_count_table);
+  garbage_collector.set_ntvhndl_tracer(
+    [this](corevm::dyobj::ntvhndl_key key,
+      garbage_collection_scheme::root_set_type& ids) {
+      this->trace_ntvhndl(key, ids);
+    }
+  );
+
+  garbage_collection_scheme::root_set_type roots;
+  this->get_gc_roots(roots);
+
+  corevm::runtime::internal::ntvhndl_collector_gc_callback callback;
+  bool completed = garbage_collector.gc_slice(&callback, roots, budget, m_gc_state);
+
+  // The slice may have reclaimed garbage left by the previous collection.
+  m_gc_cycle.freed_ntvhndl_count += m_ntvhndl_pool.erase(callback.list());
+
+  if (completed)
+  {
+    this->release_immediate_boxes();
+  }
+
+  if (completed && !m_gc_sweep_state.pending())
+  {
+    this->release_free_memory();
+  }
+
+  m_gc_pause_stats.record(
+    static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+
+  if (completed)
+  {
+    this->end_gc_cycle(m_gc_cycle);
+    m_gc_cycle = corevm::gc::cycle_stats();
+  }
+
+  return completed;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::sweep(size_t budget)
+{
+  corevm::gc::cycle_stats stats = corevm::gc::cycle_stats();
+
+  corevm::gc::garbage_collector<garbage_collection_scheme> garbage_collector(
+    m_dynamic_object_heap);
+  garbage_collector.set_sweep_state(&m_gc_sweep_state);
+  garbage_collector.set_cycle_stats(&stats);
+
+  corevm::runtime::internal::ntvhndl_collector_gc_callback callback;
+  garbage_collector.sweep(&callback, budget);
+
+  m_gc_stats.record_sweep(
+    stats.sweep_time,
+    stats.freed_object_count,
+    m_ntvhndl_pool.erase(callback.list()));
+
+  if (!m_gc_sweep_state.pending())
+  {
+    this->release_free_memory();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::runtime::process::sweep_state_type*
+corevm::runtime::process::sweep_state()
+{
+  // Garbage left by an earlier collection is reclaimed even if lazy sweeping
+  // has been disabled since.
+  if (m_gc_sweep_chunk_size || m_gc_sweep_state.pending())
+  {
+    return &m_gc_sweep_state;
+  }
+
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::release_free_memory()
+{
+  // Hand the pages of freed blocks back to the OS, once enough has been
+  // freed to be worth the system calls and the page faults that follow.
+  // The payload heap is shared between processes, so it is left alone.
+  if (m_dynamic_object_heap.reclaimable_size() >=
+      corevm::runtime::COREVM_RELEASE_FREE_MEMORY_THRESHOLD)
+  {
+    m_dynamic_object_heap.release_free_memory();
+  }
+
+  if (m_ntvhndl_pool.reclaimable_size() >=
+      corevm::runtime::COREVM_RELEASE_FREE_MEMORY_THRESHOLD)
+  {
+    m_ntvhndl_pool.release_free_memory();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::begin_gc_cycle(corevm::gc::cycle_stats& cycle) const
+{
+  cycle.start_time = corevm::runtime::internal::steady_time();
+  cycle.heap_size_before = this->heap_size();
+  cycle.pool_size_before = this->ntvhndl_pool_size();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::end_gc_cycle(corevm::gc::cycle_stats& cycle)
+{
+  cycle.end_time = corevm::runtime::internal::steady_time();
+  cycle.heap_size_after = this->heap_size();
+  cycle.pool_size_after = this->ntvhndl_pool_size();
+
+  m_gc_stats.record_cycle(cycle);
+
+  if (!cycle.minor)
+  {
+    m_gc_threshold_policy.update(cycle);
+  }
+
+  if (m_gc_log)
+  {
+    *m_gc_log << cycle << std::endl;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_sweep_chunk_size(uint32_t sweep_chunk_size)
+{
+  m_gc_sweep_chunk_size = sweep_chunk_size;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+corevm::runtime::process::has_pending_sweep() const
+{
+  return m_gc_sweep_state.pending();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_slicing(
+  uint32_t slice_budget, uint32_t slice_interval)
+{
+  m_gc_slice_budget = slice_budget;
+  m_gc_slice_interval = slice_interval;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::do_minor_gc()
+{
+  auto start = std::chrono::steady_clock::now();
+
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.minor = true;
+  cycle.slice_count = 1;
+  this->begin_gc_cycle(cycle);
+
+  corevm::gc::garbage_collector<garbage_collection_scheme> garbage_collector(
+    m_dynamic_object_heap);
+  garbage_collector.set_mark_thread_count(m_gc_mark_threads);
+  garbage_collector.set_sweep_state(this->sweep_state());
+  garbage_collector.set_cycle_stats(&cycle);
+  garbage_collector.set_zero_count_table(&m_gc_zero_count_table);
+  garbage_collector.set_ntvhndl_tracer(
+    [this](corevm::dyobj::ntvhndl_key key,
+      garbage_collection_scheme::root_set_type& ids) {
+      this->trace_ntvhndl(key, ids);
+    }
+  );
+
+  garbage_collection_scheme::root_set_type roots;
+  this->get_gc_roots(roots);
+
+  size_t nursery_count = m_dynamic_object_heap.nursery().size();
+
+  corevm::runtime::internal::ntvhndl_collector_gc_callback callback;
+  size_t promoted_count = garbage_collector.minor_gc(&callback, roots, m_gc_generations);
+
+  cycle.freed_ntvhndl_count += m_ntvhndl_pool.erase(callback.list());
+
+  m_gc_nursery_count += nursery_count;
+  m_gc_promoted_count += promoted_count;
+
+  m_gc_minor_pause_stats.record(
+    static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+
+  this->end_gc_cycle(cycle);
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_nursery_size(uint32_t nursery_size)
+{
+  m_gc_nursery_size = nursery_size;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_mark_threads(uint32_t mark_threads)
+{
+  m_gc_mark_threads = mark_threads;
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::gc_stats&
+corevm::runtime::process::gc_stats() const
+{
+  return m_gc_stats;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_gc_log(std::ostream* gc_log)
+{
+  m_gc_log = gc_log;
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::pause_time_stats&
+corevm::runtime::process::gc_pause_stats() const
+{
+  return m_gc_pause_stats;
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::gc::pause_time_stats&
+corevm::runtime::process::gc_minor_pause_stats() const
+{
+  return m_gc_minor_pause_stats;
+}
+
+// -----------------------------------------------------------------------------
+
+double
+corevm::runtime::process::gc_promotion_rate() const
+{
+  if (m_gc_nursery_count == 0)
+  {
+    return 0;
+  }
+
+  return static_cast<double>(m_gc_promoted_count) / m_gc_nursery_count;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::dump_gc_stats(std::ostream& ost) const
+{
+  ost << "{";
+  ost << "\"pauses\": " << m_gc_pause_stats << ", ";
+  ost << "\"minor-pauses\": " << m_gc_minor_pause_stats << ", ";
+  ost << "\"promoted\": " << m_gc_promoted_count << ", ";
+  ost << "\"promotion-rate\": " << gc_promotion_rate() << ", ";
+  ost << "\"cycles\": " << m_gc_stats;
+  ost << "}";
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::get_gc_roots(
+  garbage_collection_scheme::root_set_type& roots) const
+{
+  for (auto itr = m_call_stack.begin(); itr != m_call_stack.end(); ++itr)
+  {
+    const corevm::runtime::frame& frame = *itr;
+
+    const std::list<corevm::dyobj::dyobj_id> visible_objs = frame.get_visible_objs();
+    roots.insert(roots.end(), visible_objs.begin(), visible_objs.end());
+
+    const std::list<corevm::dyobj::dyobj_id> invisible_objs = frame.get_invisible_objs();
+    roots.insert(roots.end(), invisible_objs.begin(), invisible_objs.end());
+
+    const std::list<corevm::dyobj::dyobj_id> eval_stack_objs = frame.get_eval_stack_objs();
+    roots.insert(roots.end(), eval_stack_objs.begin(), eval_stack_objs.end());
+
+    if (frame.exc_obj())
+    {
+      roots.push_back(frame.exc_obj());
+    }
+  }
+
+  roots.insert(roots.end(), m_dyobj_stack.begin(), m_dyobj_stack.end());
+
+  for (auto itr = m_invocation_ctx_stack.begin();
+       itr != m_invocation_ctx_stack.end(); ++itr)
+  {
+    const corevm::runtime::invocation_ctx& invk_ctx = *itr;
+
+    roots.insert(
+      roots.end(), invk_ctx.params_list().begin(), invk_ctx.params_list().end());
+
+    const corevm::runtime::param_value_map_type& param_value_map =
+      invk_ctx.param_value_map();
+
+    for (auto param_itr = param_value_map.begin();
+         param_itr != param_value_map.end(); ++param_itr)
+    {
+      roots.push_back(param_itr->second);
+    }
+  }
+
+  // Signal handlers are kept as instruction vectors and do not reference any
+  // objects.
+
+  // Immediate values are not objects.
+  roots.erase(
+    std::remove_if(roots.begin(), roots.end(), corevm::dyobj::is_immediate),
+    roots.end());
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::freeze(corevm::dyobj::dyobj_id id)
+{
+  // Every object is checked before any is frozen, so that a failure leaves
+  // the heap untouched.
+  std::vector<corevm::dyobj::dyobj_id> ids;
+  std::unordered_set<corevm::dyobj::dyobj_id> visited;
+
+  garbage_collection_scheme::root_set_type stack { id };
+
+  while (!stack.empty())
+  {
+    corevm::dyobj::dyobj_id current_id = stack.back();
+    stack.pop_back();
+
+    if (corevm::dyobj::is_immediate(current_id) ||
+        !visited.insert(current_id).second)
+    {
+      continue;
+    }
+
+    dynamic_object_type& object = m_dynamic_object_heap.at(current_id);
+
+    if (object.is_frozen())
+    {
+      continue;
+    }
+
+    if (!object.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE) ||
+        object.has_weak_refs())
+    {
+      THROW(corevm::runtime::invalid_operation_error(
+        "Cannot freeze mutable object"));
+    }
+
+    ids.push_back(current_id);
+
+    object.iterate(
+      [&stack](
+        dynamic_object_type::attr_key_type /* attr_key */,
+        dynamic_object_type::dyobj_id_type attr_id)
+      {
+        stack.push_back(attr_id);
+      }
+    );
+
+    if (object.ntvhndl_key() != corevm::dyobj::NONESET_NTVHNDL_KEY)
+    {
+      this->trace_ntvhndl(object.ntvhndl_key(), stack);
+    }
+  }
+
+  for (auto itr = ids.begin(); itr != ids.end(); ++itr)
+  {
+    m_dynamic_object_heap.freeze(*itr);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::trace_ntvhndl(
+  corevm::dyobj::ntvhndl_key ntvhndl_key,
+  garbage_collection_scheme::root_set_type& ids)
+{
+  corevm::types::for_each_object_ref(m_ntvhndl_pool.at(ntvhndl_key),
+    [&ids](corevm::types::native_array_element_type element) {
+      corevm::dyobj::dyobj_id id = static_cast<corevm::dyobj::dyobj_id>(element);
+
+      if (!corevm::dyobj::is_immediate(id))
+      {
+        ids.push_back(id);
+      }
+    }
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+const corevm::runtime::instr_addr
+corevm::runtime::process::pc() const
+{
+  return m_pc;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::set_pc(const corevm::runtime::instr_addr addr)
+  throw(corevm::runtime::invalid_instr_addr_error)
+{
+  if ( addr != corevm::runtime::NONESET_INSTR_ADDR &&
+      (addr < 0 || addr >= m_instrs.size()) )
+  {
+    THROW(corevm::runtime::invalid_instr_addr_error());
+  }
+
+  m_pc = addr;
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::runtime::process::append_vector(const corevm::runtime::vector& vector)
+{
+  // Inserts the vector at the very end of the instr array.
+  // (This is different than `process::insert_vector`.
   //
   // NOTE: Please update `process_unittest::TestAppendVector` if the
   // behavior here changes.
@@ -700,9 +1713,10 @@ corevm::runtime::process::get_frame_by_closure_ctx(
 bool
 corevm::runtime::process::should_gc() const
 {
-  size_t flag_size = sizeof(m_gc_flag) * sizeof(char);
+  size_t flag_size = sizeof(m_gc_flag) * CHAR_BIT;
 
-  for (int i = 0; i < flag_size; ++i)
+  // Bits are numbered from 1, after `gc_rule_meta::gc_bitfields`.
+  for (size_t i = 1; i <= flag_size; ++i)
   {
     bool bit_set = is_bit_set(m_gc_flag, i);
 
@@ -764,6 +1778,8 @@ corevm::runtime::process::insert_compartment(
   const corevm::runtime::compartment& compartment)
 {
   m_compartments.push_back(compartment);
+  m_compartments.back().intern_encoding_strings(m_string_intern_table);
+
   return static_cast<corevm::runtime::compartment_id>(m_compartments.size() - 1);
 }
 
@@ -781,6 +1797,22 @@ corevm::runtime::process::get_compartment(
 
 // -----------------------------------------------------------------------------
 
+corevm::types::string
+corevm::runtime::process::intern_string(const corevm::types::native_string& str)
+{
+  return m_string_intern_table.intern(str);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::runtime::process::interned_string_count() const
+{
+  return m_string_intern_table.size();
+}
+
+// -----------------------------------------------------------------------------
+
 void
 corevm::runtime::process::reset()
 {
@@ -968,6 +2000,9 @@ std::ostream& operator<<(
   ost << "Max heap size: " << process.max_heap_size() << std::endl;
   ost << "Native types pool size: " << process.ntvhndl_pool_size() << std::endl;
   ost << "Max native types pool size: " << process.max_ntvhndl_pool_size() << std::endl;
+  ost << "Heap committed size: " << process.heap_committed_size() << " bytes" << std::endl;
+  ost << "Native types pool committed size: " << process.ntvhndl_pool_committed_size() << " bytes" << std::endl;
+  ost << "Native payload size: " << process.native_payload_size() << " bytes" << std::endl;
   ost << "Compartments: " << process.m_compartments.size() << std::endl;
   ost << std::endl;
 
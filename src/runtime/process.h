@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common.h"
 #include "errors.h"
 #include "frame.h"
+#include "gc_rule.h"
 #include "instr.h"
 #include "invocation_ctx.h"
 #include "native_types_pool.h"
@@ -37,17 +38,41 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "dyobj/common.h"
 #include "dyobj/dynamic_object_heap.h"
 #include "gc/garbage_collector.h"
+#include "gc/gc_stats.h"
+#include "gc/mark_and_sweep_garbage_collection_scheme.h"
+#include "gc/pause_time_stats.h"
 #include "gc/reference_count_garbage_collection_scheme.h"
+#include "memory/allocation_stats.h"
+#include "memory/allocation_trace.h"
+#include "types/string_intern_table.h"
+#include "types/types.h"
 
+#include <atomic>
 #include <climits>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <mutex>
 #include <ostream>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 
+/**
+ * The garbage collection scheme of processes is chosen at build time, by
+ * defining `COREVM_GC_SCHEME` to one of the values below. Reference counting
+ * is used by default.
+ */
+#define COREVM_GC_SCHEME_REFERENCE_COUNT 1
+#define COREVM_GC_SCHEME_MARK_AND_SWEEP 2
+
+#ifndef COREVM_GC_SCHEME
+  #define COREVM_GC_SCHEME COREVM_GC_SCHEME_REFERENCE_COUNT
+#endif
+
+
 namespace corevm {
 
 
@@ -72,9 +97,14 @@ namespace runtime {
 class process
 {
 public:
+#if COREVM_GC_SCHEME == COREVM_GC_SCHEME_MARK_AND_SWEEP
+  typedef corevm::gc::mark_and_sweep_garbage_collection_scheme garbage_collection_scheme;
+#else
   typedef corevm::gc::reference_count_garbage_collection_scheme garbage_collection_scheme;
+#endif
   using dynamic_object_type = typename corevm::dyobj::dynamic_object<garbage_collection_scheme::dynamic_object_manager>;
   using dynamic_object_heap_type = typename corevm::dyobj::dynamic_object_heap<garbage_collection_scheme::dynamic_object_manager>;
+  using sweep_state_type = typename corevm::gc::garbage_collector<garbage_collection_scheme>::sweep_state;
   typedef corevm::runtime::native_types_pool native_types_pool_type;
 
   class adapter
@@ -89,6 +119,18 @@ public:
 
       dynamic_object_type& help_get_dyobj(corevm::dyobj::dyobj_id id);
 
+      /**
+       * Records that the specified object has lost a reference, so that the
+       * next collection reconsiders it.
+       */
+      void help_release_dyobj(corevm::dyobj::dyobj_id id);
+
+      /**
+       * Records that the specified object holds weak references, so that
+       * collections clear them.
+       */
+      void help_add_weak_ref_holder(corevm::dyobj::dyobj_id id);
+
     private:
       corevm::runtime::process& m_process;
   };
@@ -98,6 +140,7 @@ public:
 public:
   process();
   explicit process(uint64_t, uint64_t);
+  process(uint64_t, uint64_t, uint64_t, uint64_t, uint32_t, uint32_t);
   ~process();
 
   /* Processes should not be copyable. */
@@ -153,6 +196,36 @@ public:
   void erase_ntvhndl(corevm::dyobj::ntvhndl_key)
     throw(corevm::runtime::native_type_handle_deletion_error);
 
+  /**
+   * Native handles of objects. Scalar values are held inline by the objects
+   * themselves, and only strings, arrays and maps go to the native types pool.
+   */
+  bool has_ntvhndl(const dynamic_object_type&) const;
+
+  corevm::types::native_type_handle get_ntvhndl(const dynamic_object_type&)
+    throw(corevm::runtime::native_type_handle_not_found_error);
+
+  void set_ntvhndl(dynamic_object_type&, corevm::types::native_type_handle&)
+    throw(corevm::runtime::native_type_handle_insertion_error);
+
+  void clear_ntvhndl(dynamic_object_type&)
+    throw(corevm::runtime::native_type_handle_deletion_error);
+
+  /**
+   * Returns the immediate id holding the specified handle, or 0 if the handle
+   * cannot be held immediately. Only booleans, and `int64` integers within
+   * the range of immediate integers, can be.
+   */
+  static corevm::dyobj::dyobj_id make_immediate(
+    const corevm::types::native_type_handle&);
+
+  /**
+   * Native handle of the specified immediate id. None has no handle.
+   */
+  static corevm::types::native_type_handle get_immediate_ntvhndl(
+    corevm::dyobj::dyobj_id)
+    throw(corevm::runtime::native_type_handle_not_found_error);
+
   const corevm::runtime::instr_addr pc() const;
 
   void set_pc(const corevm::runtime::instr_addr)
@@ -165,14 +238,136 @@ public:
   bool get_frame_by_closure_ctx(
     corevm::runtime::closure_ctx&, corevm::runtime::frame**);
 
+  /**
+   * Executes the program on the calling thread, which parks between
+   * instructions whenever another thread calls `pause_exec()`.
+   */
   void start();
 
+  /**
+   * Collects garbage if any of the GC rules apply. With incremental GC
+   * enabled, the collection is carried out in slices by the executing
+   * thread instead.
+   */
   void maybe_gc();
 
+  /**
+   * Sets the bits of the GC rules checked by `maybe_gc()`. The n-th lowest
+   * bit enables the rule numbered n in `gc_rule_meta::gc_bitfields`.
+   */
+  void set_gc_flag(uint8_t);
+
+  /**
+   * Makes the executing thread check the GC rules every time the specified
+   * number of objects have been created. An interval of 0 leaves the checks
+   * to the GC thread.
+   */
+  void set_gc_allocation_interval(uint32_t);
+
+  /**
+   * Sets the policy that moves the threshold of the adaptive GC rule after
+   * every full collection.
+   */
+  void set_gc_threshold_policy(const corevm::runtime::gc_threshold_policy&);
+
+  /**
+   * The number of objects above which the adaptive GC rule applies.
+   */
+  uint64_t gc_threshold() const;
+
+  /**
+   * Performs a complete collection, finishing the incremental one in progress
+   * if there is any.
+   */
   void do_gc();
 
+  /**
+   * Enables incremental GC, tracing at most the specified number of objects
+   * per slice, with a slice every specified number of instructions. A budget
+   * of 0 disables incremental GC.
+   */
+  void set_gc_slicing(uint32_t, uint32_t);
+
+  /**
+   * Collects the nursery of a generational heap, promoting the objects that
+   * survive.
+   */
+  void do_minor_gc();
+
+  /**
+   * Freezes the object with the specified id along with every object it
+   * reaches, which collections then neither trace, sweep nor count. All of
+   * those objects must be immutable, and must not hold weak references.
+   */
+  void freeze(corevm::dyobj::dyobj_id);
+
+  /**
+   * Enables generational GC on a generational heap, with a minor collection
+   * each time the nursery holds the specified number of objects. A size of
+   * 0 disables generational GC.
+   */
+  void set_gc_nursery_size(uint32_t);
+
+  /**
+   * Sets the number of threads that mark objects during collections.
+   */
+  void set_gc_mark_threads(uint32_t);
+
+  /**
+   * Enables lazy sweeping: collections leave their garbage on the heap, and
+   * every object creation first sweeps the specified number of objects,
+   * reclaiming the garbage among them. A size of 0 sweeps before collections
+   * return.
+   */
+  void set_gc_sweep_chunk_size(uint32_t);
+
+  /**
+   * Whether garbage found by a collection is left to sweep.
+   */
+  bool has_pending_sweep() const;
+
+  const corevm::gc::pause_time_stats& gc_pause_stats() const;
+
+  const corevm::gc::pause_time_stats& gc_minor_pause_stats() const;
+
+  /**
+   * Totals of the collection cycles completed so far, and the last of them.
+   */
+  const corevm::gc::gc_stats& gc_stats() const;
+
+  /**
+   * Writes the stats of every collection cycle, as one JSON object per line,
+   * to the specified stream when the cycle completes. Can be `nullptr`.
+   */
+  void set_gc_log(std::ostream*);
+
+  /**
+   * The ratio of the objects that survived their minor collection to all the
+   * objects examined by minor collections.
+   */
+  double gc_promotion_rate() const;
+
+  /**
+   * Writes the GC statistics as a JSON object.
+   */
+  void dump_gc_stats(std::ostream&) const;
+
+  /**
+   * Gathers the ids of the objects directly referenced by the process: the
+   * variables, the exception object and the marked arrays and maps on the
+   * evaluation stack of every frame, the object stack, and the arguments of
+   * every pending invocation.
+   */
+  void get_gc_roots(garbage_collection_scheme::root_set_type&) const;
+
   bool can_execute();
 
+  /**
+   * Requests a safepoint and blocks until the executing thread has parked at
+   * it between two instructions, or returns right away if no thread is
+   * executing. The world stays stopped until `resume_exec()`. Pausing from
+   * the executing thread itself is a no-op.
+   */
   void pause_exec();
 
   void resume_exec();
@@ -193,12 +388,56 @@ public:
 
   native_types_pool_type::size_type max_ntvhndl_pool_size() const;
 
+  uint64_t heap_committed_size() const;
+
+  uint64_t ntvhndl_pool_committed_size() const;
+
+  corevm::memory::allocation_stats heap_stats() const;
+
+  corevm::memory::allocation_stats ntvhndl_pool_stats() const;
+
+  /**
+   * Writes the allocation statistics of the object heap and the native types
+   * pool as a JSON object.
+   */
+  void dump_allocation_stats(std::ostream&) const;
+
+  /**
+   * Records the allocations of the object heap and the native types pool
+   * into the specified traces. Either can be `nullptr`.
+   */
+  void set_allocation_traces(
+    corevm::memory::allocation_trace*, corevm::memory::allocation_trace*);
+
+  /**
+   * The approximate number of bytes held by the payloads of the native
+   * strings, arrays and maps in this process's native types pool.
+   */
+  uint64_t native_payload_size() const;
+
+  /**
+   * The native payload size a process is expected to stay within.
+   * Defaults to `COREVM_DEFAULT_NATIVE_PAYLOAD_SIZE_LIMIT`.
+   */
+  uint64_t max_native_payload_size() const;
+
+  void set_max_native_payload_size(uint64_t);
+
   corevm::runtime::compartment_id insert_compartment(
     const corevm::runtime::compartment&);
 
   void get_compartment(
     corevm::runtime::compartment_id, corevm::runtime::compartment**);
 
+  /**
+   * Returns the string equal to the specified one in the process's string
+   * intern table. Interned strings carry their hash, and are compared by
+   * their keys in the table first.
+   */
+  corevm::types::string intern_string(const corevm::types::native_string&);
+
+  size_t interned_string_count() const;
+
   void reset();
 
   /**
@@ -237,9 +476,87 @@ private:
 
   bool pre_start();
 
+  /**
+   * Registers the calling thread as the executing thread, parking it first if
+   * the world is stopped.
+   */
+  void attach_exec_thread();
+
+  void detach_exec_thread();
+
+  /**
+   * Executes instructions until the program counter leaves the vector.
+   */
+  void run();
+
+  /**
+   * Parks the executing thread until the pending safepoint is released.
+   */
+  void safepoint();
+
   bool should_gc() const;
 
-  bool m_pause_exec;
+  /**
+   * Performs a slice of a collection, and returns whether it completed.
+   */
+  bool collect(size_t);
+
+  /**
+   * Sweeps at most the specified number of objects from where lazy
+   * sweeping left off.
+   */
+  void sweep(size_t);
+
+  /**
+   * The state collections sweep lazily into, or `nullptr` to sweep before
+   * they return.
+   */
+  sweep_state_type* sweep_state();
+
+  /**
+   * Gives the free pages of the object heap and the native types pool back
+   * to the OS, for each of them that has freed at least
+   * `COREVM_RELEASE_FREE_MEMORY_THRESHOLD` bytes since it last did.
+   */
+  void release_free_memory();
+
+  /**
+   * Appends the ids held by the native handle of the specified key to the
+   * specified set, if the handle is a marked array or map.
+   */
+  void trace_ntvhndl(
+    corevm::dyobj::ntvhndl_key, garbage_collection_scheme::root_set_type&);
+
+  /**
+   * Returns the object that stands for the specified immediate id wherever
+   * an object is required, creating it on first use. Boxes are immutable and
+   * indelible, so that they can be shared until the end of the collection
+   * cycle, which releases them.
+   */
+  dynamic_object_type& box_immediate(corevm::dyobj::dyobj_id);
+
+  /**
+   * Erases the boxes of immediate values. Must not be called while marking
+   * is in progress.
+   */
+  void release_immediate_boxes();
+
+  /**
+   * Starts recording a cycle in the specified stats.
+   */
+  void begin_gc_cycle(corevm::gc::cycle_stats&) const;
+
+  /**
+   * Adds a completed cycle to the GC stats, and logs it.
+   */
+  void end_gc_cycle(corevm::gc::cycle_stats&);
+
+  std::atomic<bool> m_safepoint_requested;
+  bool m_parked;
+  bool m_executing;
+  std::atomic<std::thread::id> m_exec_thread;
+  std::mutex m_safepoint_mutex;
+  std::condition_variable m_safepoint_cond;
   uint8_t m_gc_flag;
   corevm::runtime::instr_addr m_pc;
   corevm::runtime::vector m_instrs;
@@ -250,6 +567,30 @@ private:
   native_types_pool_type m_ntvhndl_pool;
   std::unordered_map<sig_atomic_t, corevm::runtime::vector> m_sig_instr_map;
   std::vector<corevm::runtime::compartment> m_compartments;
+  garbage_collection_scheme::incremental_state m_gc_state;
+  uint32_t m_gc_slice_budget;
+  uint32_t m_gc_slice_interval;
+  uint32_t m_instr_count_since_gc_slice;
+  std::atomic<bool> m_gc_pending;
+  corevm::gc::pause_time_stats m_gc_pause_stats;
+  garbage_collection_scheme::generational_state m_gc_generations;
+  garbage_collection_scheme::zero_count_table m_gc_zero_count_table;
+  uint32_t m_gc_nursery_size;
+  uint64_t m_gc_nursery_count;
+  uint64_t m_gc_promoted_count;
+  corevm::gc::pause_time_stats m_gc_minor_pause_stats;
+  uint32_t m_gc_mark_threads;
+  sweep_state_type m_gc_sweep_state;
+  uint32_t m_gc_sweep_chunk_size;
+  uint32_t m_gc_allocation_interval;
+  uint32_t m_allocation_count_since_gc_check;
+  corevm::gc::cycle_stats m_gc_cycle;
+  corevm::gc::gc_stats m_gc_stats;
+  std::ostream* m_gc_log;
+  corevm::runtime::gc_threshold_policy m_gc_threshold_policy;
+  std::unordered_map<corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id> m_immediate_boxes;
+  corevm::types::string_intern_table m_string_intern_table;
+  uint64_t m_max_native_payload_size;
 
   static_assert(
     std::numeric_limits<corevm::runtime::vector::size_type>::max() >=
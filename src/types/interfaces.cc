@@ -390,7 +390,10 @@ void corevm::types::interface_to_dec2(
 void corevm::types::interface_to_str(
   native_type_handle& operand, native_type_handle& result)
 {
-  __interface_apply_conversion<corevm::types::string>(operand, result);
+  operand = corevm::types::string(
+    boost::apply_visitor(corevm::types::native_type_str_visitor(), operand));
+
+  result = operand;
 }
 
 // -----------------------------------------------------------------------------
@@ -444,13 +447,37 @@ void corevm::types::interface_compute_hash_value(
 /* -------------------------- STRING OPERATIONS ----------------------------- */
 
 
+// -----------------------------------------------------------------------------
+
+/**
+ * Operations that only read a container refer to the one held by the handle
+ * when it is of the expected type, instead of copying it out through a
+ * visitor. Other handles are converted into the specified storage.
+ */
+template<typename T>
+inline const typename T::value_type& __interface_value_ref(
+  native_type_handle& operand, typename T::value_type& storage)
+{
+  const typename T::value_type* value =
+    corevm::types::get_value_ptr_from_handle<T>(operand);
+
+  if (value)
+  {
+    return *value;
+  }
+
+  storage = corevm::types::get_value_from_handle<typename T::value_type>(operand);
+  return storage;
+}
+
 // -----------------------------------------------------------------------------
 
 void corevm::types::interface_string_get_size(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_string string_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_string>(operand);
+  corevm::types::native_string storage;
+  const corevm::types::native_string& string_value =
+    __interface_value_ref<corevm::types::string>(operand, storage);
 
   corevm::types::int32 size = string_value.size();
   result = size;
@@ -475,8 +502,9 @@ void corevm::types::interface_string_at(
   native_type_handle& operand, native_type_handle& index,
   native_type_handle& result)
 {
-  corevm::types::native_string string_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_string>(operand);
+  corevm::types::native_string storage;
+  const corevm::types::native_string& string_value =
+    __interface_value_ref<corevm::types::string>(operand, storage);
   int32_t index_value = corevm::types::get_value_from_handle<int32_t>(index);
 
   char char_value = string_value.at(index_value);
@@ -755,8 +783,9 @@ void corevm::types::interface_string_rfind2(
 void corevm::types::interface_array_size(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_array array_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_array>(operand);
+  corevm::types::native_array storage;
+  const corevm::types::native_array& array_value =
+    __interface_value_ref<corevm::types::array>(operand, storage);
 
   corevm::types::int32 size = array_value.size();
   result = size;
@@ -767,8 +796,9 @@ void corevm::types::interface_array_size(
 void corevm::types::interface_array_empty(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_array array_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_array>(operand);
+  corevm::types::native_array storage;
+  const corevm::types::native_array& array_value =
+    __interface_value_ref<corevm::types::array>(operand, storage);
 
   corevm::types::boolean empty = array_value.empty();
   result = empty;
@@ -780,8 +810,9 @@ void corevm::types::interface_array_at(
   native_type_handle& operand, native_type_handle& index,
   native_type_handle& result)
 {
-  corevm::types::native_array array_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_array>(operand);
+  corevm::types::native_array storage;
+  const corevm::types::native_array& array_value =
+    __interface_value_ref<corevm::types::array>(operand, storage);
 
   size_t index_value = corevm::types::get_value_from_handle<size_t>(index);
 
@@ -794,8 +825,9 @@ void corevm::types::interface_array_at(
 void corevm::types::interface_array_front(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_array array_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_array>(operand);
+  corevm::types::native_array storage;
+  const corevm::types::native_array& array_value =
+    __interface_value_ref<corevm::types::array>(operand, storage);
 
   corevm::types::uint64 result_value = array_value.front();
   result = result_value;
@@ -806,8 +838,9 @@ void corevm::types::interface_array_front(
 void corevm::types::interface_array_back(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_array array_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_array>(operand);
+  corevm::types::native_array storage;
+  const corevm::types::native_array& array_value =
+    __interface_value_ref<corevm::types::array>(operand, storage);
 
   corevm::types::uint64 result_value = array_value.back();
   result = result_value;
@@ -898,8 +931,9 @@ void corevm::types::interface_array_merge(
 void corevm::types::interface_map_size(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_map map_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_map>(operand);
+  corevm::types::native_map storage;
+  const corevm::types::native_map& map_value =
+    __interface_value_ref<corevm::types::map>(operand, storage);
 
   corevm::types::uint32 result_value = map_value.size();
   result = result_value;
@@ -910,8 +944,9 @@ void corevm::types::interface_map_size(
 void corevm::types::interface_map_empty(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_map map_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_map>(operand);
+  corevm::types::native_map storage;
+  const corevm::types::native_map& map_value =
+    __interface_value_ref<corevm::types::map>(operand, storage);
 
   corevm::types::boolean result_value = map_value.empty();
   result = result_value;
@@ -1003,8 +1038,9 @@ void corevm::types::interface_map_swap(
 void corevm::types::interface_map_keys(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_map map_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_map>(operand);
+  corevm::types::native_map storage;
+  const corevm::types::native_map& map_value =
+    __interface_value_ref<corevm::types::map>(operand, storage);
 
   corevm::types::native_array array_value;
 
@@ -1027,10 +1063,12 @@ void corevm::types::interface_map_keys(
 void corevm::types::interface_map_vals(
   native_type_handle& operand, native_type_handle& result)
 {
-  corevm::types::native_map map_value = \
-    corevm::types::get_value_from_handle<corevm::types::native_map>(operand);
+  corevm::types::native_map storage;
+  const corevm::types::native_map& map_value =
+    __interface_value_ref<corevm::types::map>(operand, storage);
 
   corevm::types::native_array array_value;
+  array_value.set_contains_object_refs(map_value.contains_object_refs());
 
   for (auto itr = map_value.begin(); itr != map_value.end(); ++itr)
   {
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cstdint>
 #include <stdexcept>
+#include <utility>
 
 
 corevm::types::native_array::native_array()
@@ -47,7 +48,7 @@ corevm::types::native_array::native_array(const native_array_base& other)
 
 corevm::types::native_array::native_array(native_array_base&& other)
   :
-  native_array_base(other)
+  native_array_base(std::move(other))
 {
 }
 
@@ -250,3 +251,21 @@ corevm::types::native_array::at(size_type n) const
 }
 
 // -----------------------------------------------------------------------------
+
+bool
+corevm::types::native_array::contains_object_refs() const noexcept
+{
+  return get_allocator().contains_object_refs();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::types::native_array::set_contains_object_refs(bool value) noexcept
+{
+  // The mark lives in the allocator, which is only replaced wholesale; the
+  // elements move over without being copied.
+  native_array_base::operator=(native_array_base(std::move(*this), allocator_type(value)));
+}
+
+// -----------------------------------------------------------------------------
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_NATIVE_ARRAY_H_
 
 #include "errors.h"
+#include "memory/payload_allocator.h"
 
 #include <cstdint>
 #include <stdexcept>
@@ -39,7 +40,8 @@ namespace types {
 typedef uint64_t native_array_element_type;
 
 
-using native_array_base = typename std::vector<native_array_element_type>;
+using native_array_base = typename std::vector<
+  native_array_element_type, corevm::memory::object_ref_allocator<native_array_element_type>>;
 
 
 class native_array : public native_array_base
@@ -96,6 +98,14 @@ public:
   reference at(size_type n) throw(corevm::types::out_of_range_error);
 
   const_reference at(size_type n) const throw(corevm::types::out_of_range_error);
+
+  /**
+   * Whether the elements of this array are ids of dynamic objects, in which
+   * case the garbage collector traces through them.
+   */
+  bool contains_object_refs() const noexcept;
+
+  void set_contains_object_refs(bool) noexcept;
 };
 
 
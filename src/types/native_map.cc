@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cstdint>
 #include <stdexcept>
+#include <utility>
 
 
 const size_t DEFAULT_NATIVE_MAP_INITIAL_CAPACITY = 10;
@@ -51,7 +52,7 @@ corevm::types::native_map::native_map(const native_map_base& other)
 
 corevm::types::native_map::native_map(native_map_base&& other)
   :
-  native_map_base(other)
+  native_map_base(std::move(other))
 {
 }
 
@@ -270,3 +271,21 @@ corevm::types::native_map::at(const key_type& k)
 }
 
 // -----------------------------------------------------------------------------
+
+bool
+corevm::types::native_map::contains_object_refs() const noexcept
+{
+  return get_allocator().contains_object_refs();
+}
+
+// -----------------------------------------------------------------------------
+
+void
+corevm::types::native_map::set_contains_object_refs(bool value) noexcept
+{
+  // The mark lives in the allocator, which is only replaced wholesale; the
+  // elements move over without being copied.
+  native_map_base::operator=(native_map_base(std::move(*this), allocator_type(value)));
+}
+
+// -----------------------------------------------------------------------------
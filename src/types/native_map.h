@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_NATIVE_MAP_H_
 
 #include "errors.h"
+#include "memory/payload_allocator.h"
 
 #include <cstdint>
 #include <unordered_map>
@@ -39,7 +40,12 @@ typedef uint64_t native_map_key_type;
 typedef uint64_t native_map_mapped_type;
 
 
-using native_map_base = typename std::unordered_map<native_map_key_type, native_map_mapped_type>;
+using native_map_base = typename std::unordered_map<
+  native_map_key_type,
+  native_map_mapped_type,
+  std::hash<native_map_key_type>,
+  std::equal_to<native_map_key_type>,
+  corevm::memory::object_ref_allocator<std::pair<const native_map_key_type, native_map_mapped_type>>>;
 
 
 class native_map : public native_map_base
@@ -102,6 +108,14 @@ public:
   native_map& operator>=(const native_map&) const;
 
   mapped_type& at(const key_type& k) throw(corevm::types::out_of_range_error);
+
+  /**
+   * Whether the mapped values of this map are ids of dynamic objects, in which
+   * case the garbage collector traces through them.
+   */
+  bool contains_object_refs() const noexcept;
+
+  void set_contains_object_refs(bool) noexcept;
 };
 
 
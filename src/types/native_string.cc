@@ -61,6 +61,21 @@ corevm::types::native_string::native_string(native_string_base&& str)
 
 // -----------------------------------------------------------------------------
 
+corevm::types::native_string::native_string(const std::string& str)
+  :
+  native_string_base(str.data(), str.size())
+{
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::types::native_string::operator std::string() const
+{
+  return std::string(data(), size());
+}
+
+// -----------------------------------------------------------------------------
+
 corevm::types::native_string::native_string(int8_t)
 {
   THROW(corevm::types::conversion_error("int8", "string"));
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_NATIVE_STRING_H_
 
 #include "errors.h"
+#include "memory/payload_allocator.h"
 
 #include <cstdint>
 #include <string>
@@ -35,7 +36,8 @@ namespace corevm {
 namespace types {
 
 
-typedef std::string native_string_base;
+typedef std::basic_string<
+  char, std::char_traits<char>, corevm::memory::payload_allocator<char>> native_string_base;
 
 
 class native_string : public native_string_base
@@ -49,6 +51,10 @@ public:
 
   native_string(native_string_base&& str);
 
+  native_string(const std::string& str);
+
+  operator std::string() const;
+
   native_string(int8_t);
 
   operator int8_t() const;
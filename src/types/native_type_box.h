@@ -0,0 +1,289 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_NATIVE_TYPE_BOX_H_
+#define COREVM_NATIVE_TYPE_BOX_H_
+
+#include "types.h"
+
+#include <boost/variant/recursive_wrapper.hpp>
+#include <boost/type_traits/is_nothrow_move_constructible.hpp>
+
+#include <utility>
+
+
+namespace corevm {
+
+
+namespace types {
+
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Owning pointer to a value that native type handles hold out of line.
+ * Copies copy the value, but moves only transfer the pointer. A moved-from
+ * box allocates a default value again if it is ever accessed.
+ */
+template<typename T>
+class native_type_box
+{
+public:
+  typedef T type;
+
+  native_type_box();
+
+  native_type_box(const T&);
+
+  native_type_box(T&&);
+
+  native_type_box(const native_type_box&);
+
+  native_type_box(native_type_box&&) noexcept;
+
+  ~native_type_box();
+
+  native_type_box& operator=(const native_type_box&);
+
+  native_type_box& operator=(native_type_box&&) noexcept;
+
+  native_type_box& operator=(const T&);
+
+  native_type_box& operator=(T&&);
+
+  void swap(native_type_box&) noexcept;
+
+  T& get();
+
+  const T& get() const;
+
+  T* get_pointer();
+
+  const T* get_pointer() const;
+
+private:
+  mutable T* m_ptr;
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::native_type_box()
+  :
+  m_ptr(new T())
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::native_type_box(const T& value)
+  :
+  m_ptr(new T(value))
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::native_type_box(T&& value)
+  :
+  m_ptr(new T(std::move(value)))
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::native_type_box(
+  const native_type_box& other)
+  :
+  m_ptr(new T(other.get()))
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::native_type_box(
+  native_type_box&& other) noexcept
+  :
+  m_ptr(other.m_ptr)
+{
+  other.m_ptr = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>::~native_type_box()
+{
+  delete m_ptr;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>&
+corevm::types::native_type_box<T>::operator=(const native_type_box& other)
+{
+  get() = other.get();
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>&
+corevm::types::native_type_box<T>::operator=(native_type_box&& other) noexcept
+{
+  swap(other);
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>&
+corevm::types::native_type_box<T>::operator=(const T& value)
+{
+  get() = value;
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_box<T>&
+corevm::types::native_type_box<T>::operator=(T&& value)
+{
+  get() = std::move(value);
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+void
+corevm::types::native_type_box<T>::swap(native_type_box& other) noexcept
+{
+  std::swap(m_ptr, other.m_ptr);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+T&
+corevm::types::native_type_box<T>::get()
+{
+  return *get_pointer();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+const T&
+corevm::types::native_type_box<T>::get() const
+{
+  return *get_pointer();
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+T*
+corevm::types::native_type_box<T>::get_pointer()
+{
+  if (!m_ptr)
+  {
+    m_ptr = new T();
+  }
+
+  return m_ptr;
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+const T*
+corevm::types::native_type_box<T>::get_pointer() const
+{
+  if (!m_ptr)
+  {
+    m_ptr = new T();
+  }
+
+  return m_ptr;
+}
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace types */
+
+
+} /* end namespace corevm */
+
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Native type handles hold strings, arrays and maps through
+ * `boost::recursive_wrapper`, so that `boost::get` and visitors see through
+ * the wrappers. Boost's wrapper allocates a new value on every move, so it
+ * is specialized here as a `native_type_box`, whose moves do not allocate.
+ */
+#define COREVM_NATIVE_TYPE_BOX_RECURSIVE_WRAPPER(T)                           \
+  template<>                                                                  \
+  class recursive_wrapper<T> : public corevm::types::native_type_box<T>       \
+  {                                                                           \
+  public:                                                                     \
+    using corevm::types::native_type_box<T>::native_type_box;                 \
+    using corevm::types::native_type_box<T>::operator=;                       \
+  };                                                                          \
+                                                                              \
+  template<>                                                                  \
+  struct is_nothrow_move_constructible<recursive_wrapper<T>> :                \
+    boost::true_type                                                          \
+  {                                                                           \
+  };
+
+
+namespace boost {
+
+
+COREVM_NATIVE_TYPE_BOX_RECURSIVE_WRAPPER(corevm::types::string)
+COREVM_NATIVE_TYPE_BOX_RECURSIVE_WRAPPER(corevm::types::array)
+COREVM_NATIVE_TYPE_BOX_RECURSIVE_WRAPPER(corevm::types::map)
+
+
+} /* end namespace boost */
+
+
+#undef COREVM_NATIVE_TYPE_BOX_RECURSIVE_WRAPPER
+
+
+#endif /* COREVM_NATIVE_TYPE_BOX_H_ */
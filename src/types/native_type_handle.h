@@ -23,12 +23,22 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef COREVM_NATIVE_TYPE_HANDLE_H_
 #define COREVM_NATIVE_TYPE_HANDLE_H_
 
+#include "native_type_box.h"
+#include "number_format.h"
 #include "operators.h"
 #include "types.h"
 
+#include <boost/variant/get.hpp>
+#include <boost/variant/recursive_wrapper.hpp>
 #include <boost/variant/static_visitor.hpp>
 #include <boost/variant/variant.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
 
 namespace corevm {
 
@@ -38,6 +48,12 @@ namespace types {
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Scalars are held inline, while strings, arrays and maps are held through
+ * a pointer, so that handles stay at 16 bytes regardless of the size of the
+ * containers. Visitors and `boost::get` see through the wrappers, which are
+ * `native_type_box`es and so do not allocate when handles are moved.
+ */
 using native_type_handle = typename boost::variant<
   corevm::types::int8,
   corevm::types::uint8,
@@ -50,11 +66,17 @@ using native_type_handle = typename boost::variant<
   corevm::types::boolean,
   corevm::types::decimal,
   corevm::types::decimal2,
-  corevm::types::string,
-  corevm::types::array,
-  corevm::types::map
+  boost::recursive_wrapper<corevm::types::string>,
+  boost::recursive_wrapper<corevm::types::array>,
+  boost::recursive_wrapper<corevm::types::map>
 >;
 
+static_assert(sizeof(native_type_handle) <= 16, "Native type handle too large");
+
+static_assert(
+  std::is_nothrow_move_constructible<native_type_handle>::value,
+  "Native type handle moves should not allocate");
+
 // -----------------------------------------------------------------------------
 
 template<class op>
@@ -96,6 +118,50 @@ public:
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Types involved in a binary operation between values of types `T` and `U`:
+ * the operation is performed in the larger of the two types, which is also
+ * the type of the result. Operations between two strings, arrays or maps
+ * produce booleans instead.
+ */
+template<typename T, typename U>
+struct native_type_promotion
+{
+  typedef typename std::conditional<
+    (sizeof(T) >= sizeof(U)), T, U>::type operand_type;
+
+  typedef operand_type result_type;
+};
+
+// -----------------------------------------------------------------------------
+
+template<>
+struct native_type_promotion<corevm::types::string, corevm::types::string>
+{
+  typedef corevm::types::string operand_type;
+  typedef corevm::types::boolean result_type;
+};
+
+// -----------------------------------------------------------------------------
+
+template<>
+struct native_type_promotion<corevm::types::array, corevm::types::array>
+{
+  typedef corevm::types::array operand_type;
+  typedef corevm::types::boolean result_type;
+};
+
+// -----------------------------------------------------------------------------
+
+template<>
+struct native_type_promotion<corevm::types::map, corevm::types::map>
+{
+  typedef corevm::types::map operand_type;
+  typedef corevm::types::boolean result_type;
+};
+
+// -----------------------------------------------------------------------------
+
 template<class op>
 class native_type_binary_visitor : public boost::static_visitor<native_type_handle>
 {
@@ -103,45 +169,73 @@ public:
   template<typename T, typename U>
   native_type_handle operator()(const T& lhs, const U& rhs) const
   {
-    if (sizeof(lhs) >= sizeof(rhs))
-    {
-      return T(op().template operator()<T>(lhs, rhs));
-    }
-    else
-    {
-      return U(op().template operator()<U>(lhs, rhs));
-    }
-  }
+    typedef native_type_promotion<T, U> promotion;
 
-  native_type_handle operator()(
-    const corevm::types::string& lhs, const corevm::types::string& rhs) const
-  {
-    return corevm::types::boolean(op().template operator()<corevm::types::string>(lhs, rhs));
+    return typename promotion::result_type(
+      op().template operator()<typename promotion::operand_type>(lhs, rhs));
   }
+};
 
-  native_type_handle operator()(
-    const corevm::types::array& lhs, const corevm::types::array& rhs) const
-  {
-    return corevm::types::boolean(op().template operator()<corevm::types::array>(lhs, rhs));
-  }
+// -----------------------------------------------------------------------------
 
-  native_type_handle operator()(
-    const corevm::types::map& lhs, const corevm::types::map& rhs) const
+template<typename T>
+class native_type_value_visitor : public boost::static_visitor<T>
+{
+public:
+  template<typename H>
+  T operator()(const H& handle) const
   {
-    return corevm::types::boolean(op().template operator()<corevm::types::map>(lhs, rhs));
+    return static_cast<T>(native_type_value(handle));
   }
 };
 
 // -----------------------------------------------------------------------------
 
-template<typename T>
-class native_type_value_visitor : public boost::static_visitor<T>
+/**
+ * Visitor that converts a value to a native string. Integers are written in
+ * decimal, and decimals with the fewest digits that read back as the same
+ * value. Other values convert as `native_type_value_visitor` converts them.
+ */
+class native_type_str_visitor : public boost::static_visitor<native_string>
 {
 public:
   template<typename H>
-  T operator()(const H& handle) const
+  native_string operator()(const H& handle) const
   {
-    return static_cast<T>(handle.value);
+    return convert(native_type_value(handle));
+  }
+
+private:
+  template<typename V>
+  static typename std::enable_if<
+    std::is_integral<V>::value && !std::is_same<V, bool>::value,
+    native_string>::type
+  convert(V value)
+  {
+    char buf[corevm::types::MAX_INTEGER_LENGTH];
+
+    size_t length = std::is_signed<V>::value ?
+      corevm::types::format_integer(static_cast<int64_t>(value), buf) :
+      corevm::types::format_integer(static_cast<uint64_t>(value), buf);
+
+    return native_string(std::string(buf, length));
+  }
+
+  template<typename V>
+  static typename std::enable_if<std::is_floating_point<V>::value,
+    native_string>::type
+  convert(V value)
+  {
+    return native_string(corevm::types::format_decimal_shortest(value));
+  }
+
+  template<typename V>
+  static typename std::enable_if<
+    !std::is_arithmetic<V>::value || std::is_same<V, bool>::value,
+    native_string>::type
+  convert(const V& value)
+  {
+    return static_cast<native_string>(value);
   }
 };
 
@@ -194,6 +288,259 @@ get_value_from_handle(corevm::types::native_type_handle& handle)
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Returns the value held by the handle if the handle is of the specified
+ * type, or `nullptr` otherwise. Unlike `get_value_from_handle()`, this
+ * neither visits the handle nor copies the value: it only compares the
+ * handle's type. The value is read-only, as interned strings share it with
+ * their intern table and cache its hash.
+ */
+template<typename T>
+const typename T::value_type*
+get_value_ptr_from_handle(const corevm::types::native_type_handle& handle)
+{
+  const T* wrapper = boost::get<T>(&handle);
+  return wrapper ? &native_type_value(*wrapper) : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Visitor that invokes a callable on every object id held by an array or map
+ * handle that is marked as containing object references.
+ */
+template<typename F>
+class native_type_object_refs_visitor : public boost::static_visitor<>
+{
+public:
+  explicit native_type_object_refs_visitor(F& f)
+    :
+    m_f(f)
+  {
+  }
+
+  template<typename T>
+  void operator()(const T&) const
+  {
+    // Do nothing here.
+  }
+
+  void operator()(const corevm::types::array& handle) const
+  {
+    if (handle.value.contains_object_refs())
+    {
+      for (const auto& element : handle.value)
+      {
+        m_f(element);
+      }
+    }
+  }
+
+  void operator()(const corevm::types::map& handle) const
+  {
+    if (handle.value.contains_object_refs())
+    {
+      for (const auto& pair : handle.value)
+      {
+        m_f(pair.second);
+      }
+    }
+  }
+
+private:
+  F& m_f;
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename F>
+void
+for_each_object_ref(const corevm::types::native_type_handle& handle, F f)
+{
+  boost::apply_visitor(
+    corevm::types::native_type_object_refs_visitor<F>(f), handle
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Whether the handle is an array or a map marked as holding object ids.
+ */
+inline bool
+holds_object_refs(const corevm::types::native_type_handle& handle)
+{
+  if (const corevm::types::array* value =
+        boost::get<corevm::types::array>(&handle))
+  {
+    return value->value.contains_object_refs();
+  }
+
+  if (const corevm::types::map* value =
+        boost::get<corevm::types::map>(&handle))
+  {
+    return value->value.contains_object_refs();
+  }
+
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Visitor that estimates the number of bytes a handle holds in
+ * `corevm::memory::payload_heap()`.
+ */
+class native_type_payload_size_visitor : public boost::static_visitor<uint64_t>
+{
+public:
+  template<typename T>
+  uint64_t operator()(const T&) const
+  {
+    return 0;
+  }
+
+  uint64_t operator()(const corevm::types::string& handle) const
+  {
+    // Interned strings share the value held by their intern table.
+    return handle.intern_key ? 0 : handle.value().capacity();
+  }
+
+  uint64_t operator()(const corevm::types::array& handle) const
+  {
+    return handle.value.capacity() * sizeof(corevm::types::native_array::value_type);
+  }
+
+  uint64_t operator()(const corevm::types::map& handle) const
+  {
+    return handle.value.size() * (
+      sizeof(corevm::types::native_map::value_type) + sizeof(void*)) +
+      handle.value.bucket_count() * sizeof(void*);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+inline
+uint64_t
+payload_size(const corevm::types::native_type_handle& handle)
+{
+  return boost::apply_visitor(
+    corevm::types::native_type_payload_size_visitor(), handle
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Visitor that packs the value of a scalar handle (an integer, a boolean or a
+ * decimal) into 64 bits. Returns `false` for strings, arrays and maps.
+ */
+class native_type_pack_visitor : public boost::static_visitor<bool>
+{
+public:
+  explicit native_type_pack_visitor(uint64_t& bits)
+    :
+    m_bits(bits)
+  {
+  }
+
+  template<typename T>
+  bool operator()(const T& handle) const
+  {
+    static_assert(sizeof(handle.value) <= sizeof(uint64_t),
+      "Scalar value does not fit in 64 bits");
+
+    m_bits = 0;
+    std::memcpy(&m_bits, &handle.value, sizeof(handle.value));
+    return true;
+  }
+
+  bool operator()(const corevm::types::string&) const
+  {
+    return false;
+  }
+
+  bool operator()(const corevm::types::array&) const
+  {
+    return false;
+  }
+
+  bool operator()(const corevm::types::map&) const
+  {
+    return false;
+  }
+
+private:
+  uint64_t& m_bits;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Packs a scalar handle into its value's bits, so that it can be held without
+ * allocating. Returns the handle's type, which is its position among the
+ * types of `native_type_handle` plus one, or 0 if the handle is not a scalar.
+ */
+inline uint8_t
+pack_scalar_handle(const corevm::types::native_type_handle& handle, uint64_t& bits)
+{
+  if (!boost::apply_visitor(corevm::types::native_type_pack_visitor(bits), handle))
+  {
+    return 0;
+  }
+
+  return static_cast<uint8_t>(handle.which() + 1);
+}
+
+// -----------------------------------------------------------------------------
+
+template<typename T>
+corevm::types::native_type_handle
+unpack_scalar_value(uint64_t bits)
+{
+  typename T::value_type value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return T(value);
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Inverse of `pack_scalar_handle()`. The type must not be 0.
+ */
+inline corevm::types::native_type_handle
+unpack_scalar_handle(uint8_t type, uint64_t bits)
+{
+  switch (type)
+  {
+    case 1:
+      return unpack_scalar_value<corevm::types::int8>(bits);
+    case 2:
+      return unpack_scalar_value<corevm::types::uint8>(bits);
+    case 3:
+      return unpack_scalar_value<corevm::types::int16>(bits);
+    case 4:
+      return unpack_scalar_value<corevm::types::uint16>(bits);
+    case 5:
+      return unpack_scalar_value<corevm::types::int32>(bits);
+    case 6:
+      return unpack_scalar_value<corevm::types::uint32>(bits);
+    case 7:
+      return unpack_scalar_value<corevm::types::int64>(bits);
+    case 8:
+      return unpack_scalar_value<corevm::types::uint64>(bits);
+    case 9:
+      return unpack_scalar_value<corevm::types::boolean>(bits);
+    case 10:
+      return unpack_scalar_value<corevm::types::decimal>(bits);
+    default:
+      return unpack_scalar_value<corevm::types::decimal2>(bits);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 template<class operator_visitor>
 corevm::types::native_type_handle
 apply_unary_visitor(corevm::types::native_type_handle& handle)
@@ -0,0 +1,90 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_NUMBER_FORMAT_H_
+#define COREVM_NUMBER_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace corevm {
+
+
+namespace types {
+
+
+// -----------------------------------------------------------------------------
+
+/** Maximum number of characters written by `format_integer()`. */
+const size_t MAX_INTEGER_LENGTH = 20;
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Writes the decimal digits of the value into the buffer, which must hold at
+ * least `MAX_INTEGER_LENGTH` characters, and returns the number of characters
+ * written. The buffer is not null-terminated.
+ */
+size_t format_integer(uint64_t value, char* buf);
+
+size_t format_integer(int64_t value, char* buf);
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Formats the value with the specified number of digits after the decimal
+ * point, with the same result as the `%.*f` conversion of `printf()`.
+ */
+std::string format_decimal(double value, uint32_t precision);
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Formats the value with the fewest significant digits that parse back as the
+ * same value. Integral values keep a trailing ".0", and large or small values
+ * are written with an exponent, as `%g` writes them.
+ */
+std::string format_decimal_shortest(double value);
+
+std::string format_decimal_shortest(float value);
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Parses a decimal number spanning the whole of the specified characters,
+ * with the same result as `strtod()`. Returns `false` if the characters do
+ * not form a number.
+ */
+bool parse_decimal(const char* str, size_t length, double& value);
+
+// -----------------------------------------------------------------------------
+
+
+} /* end namespace types */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_NUMBER_FORMAT_H_ */
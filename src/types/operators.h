@@ -24,13 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COREVM_OPERATORS_H_
 
 #include "errors.h"
+#include "number_format.h"
 #include "types.h"
 #include "corevm/macros.h"
 
 #include <cmath>
 #include <functional>
-#include <ios>
-#include <sstream>
+#include <string>
+#include <type_traits>
 
 
 namespace corevm {
@@ -57,7 +58,7 @@ public:
   template<typename R, typename T>
   typename R::value_type operator()(const T& handle)
   {
-    return static_cast<typename R::value_type>(+handle.value);
+    return static_cast<typename R::value_type>(+native_type_value(handle));
   }
 };
 
@@ -69,7 +70,7 @@ public:
   template<typename R, typename T>
   typename R::value_type operator()(const T& handle)
   {
-    return static_cast<typename R::value_type>(-handle.value);
+    return static_cast<typename R::value_type>(-native_type_value(handle));
   }
 };
 
@@ -88,6 +89,17 @@ public:
 
 // -----------------------------------------------------------------------------
 
+template<>
+inline
+typename corevm::types::string::value_type
+corevm::types::increment::operator()<corevm::types::string>(
+  const corevm::types::string&)
+{
+  THROW(corevm::types::invalid_operator_error("++", "string"));
+}
+
+// -----------------------------------------------------------------------------
+
 class decrement : public unary_op
 {
 public:
@@ -113,13 +125,24 @@ corevm::types::decrement::operator()<corevm::types::boolean>(
 
 // -----------------------------------------------------------------------------
 
+template<>
+inline
+typename corevm::types::string::value_type
+corevm::types::decrement::operator()<corevm::types::string>(
+  const corevm::types::string&)
+{
+  THROW(corevm::types::invalid_operator_error("--", "string"));
+}
+
+// -----------------------------------------------------------------------------
+
 class logical_not : public unary_op
 {
 public:
   template<typename R, typename T>
   typename R::value_type operator()(const T& handle)
   {
-    return static_cast<typename R::value_type>(!handle.value);
+    return static_cast<typename R::value_type>(!native_type_value(handle));
   }
 };
 
@@ -132,7 +155,8 @@ public:
   typename R::value_type operator()(const T& handle)
   {
     typename corevm::types::int64::value_type value =
-      static_cast<typename corevm::types::int64::value_type>(handle.value);
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(handle));
 
     return ~value;
   }
@@ -146,7 +170,8 @@ typename corevm::types::string::value_type
 corevm::types::bitwise_not::operator()<corevm::types::string>(
   const corevm::types::string& handle)
 {
-  return static_cast<typename corevm::types::string::value_type>(~handle.value);
+  return static_cast<typename corevm::types::string::value_type>(
+    ~handle.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -180,7 +205,8 @@ public:
   typename R::value_type operator()(const T& handle)
   {
     typename corevm::types::boolean::value_type value =
-      static_cast<typename corevm::types::boolean::value_type>(handle.value);
+      static_cast<typename corevm::types::boolean::value_type>(
+        native_type_value(handle));
 
     return value;
   }
@@ -194,7 +220,7 @@ typename corevm::types::boolean::value_type
 corevm::types::truthy::operator()<corevm::types::boolean>(
   const corevm::types::string& handle)
 {
-  return !handle.value.empty();
+  return !handle.value().empty();
 }
 
 // -----------------------------------------------------------------------------
@@ -224,16 +250,42 @@ corevm::types::truthy::operator()<corevm::types::boolean>(
 class repr: public unary_op
 {
 public:
+  /** Number of digits after the decimal point in the repr of decimals. */
+  static const uint32_t DECIMAL_PRECISION = 6;
+
   template<typename R, typename T>
   typename corevm::types::string::value_type operator()(const T& handle)
   {
-    // TODO: The current precision is not always accurate.
-    std::stringstream ss;
-    ss << std::fixed << handle.value;
+    return format(native_type_value(handle));
+  }
+
+private:
+  template<typename V>
+  static typename std::enable_if<std::is_integral<V>::value,
+    typename corevm::types::string::value_type>::type
+  format(V value)
+  {
+    char buf[corevm::types::MAX_INTEGER_LENGTH];
+
+    size_t length = std::is_signed<V>::value ?
+      corevm::types::format_integer(static_cast<int64_t>(value), buf) :
+      corevm::types::format_integer(static_cast<uint64_t>(value), buf);
 
-    typename corevm::types::string::value_type value =
-      static_cast<typename corevm::types::string::value_type>(ss.str());
+    return typename corevm::types::string::value_type(std::string(buf, length));
+  }
+
+  template<typename V>
+  static typename std::enable_if<std::is_floating_point<V>::value,
+    typename corevm::types::string::value_type>::type
+  format(V value)
+  {
+    return typename corevm::types::string::value_type(
+      corevm::types::format_decimal(value, DECIMAL_PRECISION));
+  }
 
+  static typename corevm::types::string::value_type
+  format(const typename corevm::types::string::value_type& value)
+  {
     return value;
   }
 };
@@ -272,6 +324,21 @@ public:
     typename corevm::types::int64::value_type value = hash_func(handle.value);
     return value;
   }
+
+  /**
+   * Returns the hash of a string value. `std::hash` is only specialized for
+   * strings using the default allocator, so strings hash as the equivalent
+   * `std::string` does, as they did before their payloads moved to the
+   * payload heap. The bytes are hashed in place, with the function and seed
+   * that libstdc++ uses for `std::hash<std::string>`.
+   */
+  static typename corevm::types::int64::value_type hash_string_value(
+    const corevm::types::native_string& value)
+  {
+    return static_cast<corevm::types::int64::value_type>(
+      std::_Hash_bytes(
+        value.data(), value.size(), static_cast<size_t>(0xc70f6907UL)));
+  }
 };
 
 // -----------------------------------------------------------------------------
@@ -282,13 +349,12 @@ typename corevm::types::int64::value_type
 corevm::types::hash::operator()<corevm::types::string>(
   const corevm::types::string& handle)
 {
-  uint64_t res = 0;
-
-  std::hash<corevm::types::native_string_base> hash_func;
-
-  res = hash_func(handle.value);
+  if (handle.intern_key)
+  {
+    return static_cast<corevm::types::int64::value_type>(handle.hash_value);
+  }
 
-  return static_cast<corevm::types::int64::value_type>(res);
+  return hash_string_value(handle.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -346,8 +412,8 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) +
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) +
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -361,7 +427,7 @@ corevm::types::addition::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value + rhs.value);
+    lhs.value() + rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -373,8 +439,8 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) -
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) -
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -387,10 +453,12 @@ public:
   template<typename R, typename T, typename U>
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
-    return (
-      static_cast<typename R::value_type>(lhs.value) *
-      static_cast<typename R::value_type>(rhs.value)
-    );
+    // Named so that the product of booleans is not converted in place.
+    const auto result =
+      static_cast<typename R::value_type>(native_type_value(lhs)) *
+      static_cast<typename R::value_type>(native_type_value(rhs));
+
+    return static_cast<typename R::value_type>(result);
   }
 };
 
@@ -403,8 +471,8 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) /
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) /
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -418,8 +486,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) %
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) %
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -433,7 +503,7 @@ corevm::types::modulus::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value % rhs.value);
+    lhs.value() % rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -487,8 +557,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return pow(
-      static_cast<typename corevm::types::decimal2::value_type>(lhs.value),
-      static_cast<typename corevm::types::decimal2::value_type>(rhs.value)
+      static_cast<typename corevm::types::decimal2::value_type>(
+        native_type_value(lhs)),
+      static_cast<typename corevm::types::decimal2::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -502,8 +574,8 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) &&
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) &&
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -517,8 +589,8 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) ||
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) ||
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -532,8 +604,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) &
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) &
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -547,7 +621,7 @@ corevm::types::bitwise_and::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value & rhs.value);
+    lhs.value() & rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -583,8 +657,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) |
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) |
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -598,7 +674,7 @@ corevm::types::bitwise_or::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value | rhs.value);
+    lhs.value() | rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -634,8 +710,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) ^
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) ^
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -649,7 +727,7 @@ corevm::types::bitwise_xor::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value ^ rhs.value);
+    lhs.value() ^ rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -684,10 +762,13 @@ public:
   template<typename R, typename T, typename U>
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
-    return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) <<
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
-    );
+    const typename corevm::types::int64::value_type result =
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) <<
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs));
+
+    return static_cast<typename R::value_type>(result);
   }
 };
 
@@ -700,7 +781,7 @@ corevm::types::bitwise_left_shift::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value << rhs.value);
+    lhs.value() << rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -736,8 +817,10 @@ public:
   typename R::value_type operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename corevm::types::int64::value_type>(lhs.value) >>
-      static_cast<typename corevm::types::int64::value_type>(rhs.value)
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(lhs)) >>
+      static_cast<typename corevm::types::int64::value_type>(
+        native_type_value(rhs))
     );
   }
 };
@@ -751,7 +834,7 @@ corevm::types::bitwise_right_shift::operator()<corevm::types::string>(
   const corevm::types::string& lhs, const corevm::types::string& rhs)
 {
   return static_cast<typename corevm::types::string::value_type>(
-    lhs.value >> rhs.value);
+    lhs.value() >> rhs.value());
 }
 
 // -----------------------------------------------------------------------------
@@ -787,14 +870,42 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) ==
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) ==
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Strings interned in the same table are equal only if they have the same
+ * key, and interned strings with different hashes are never equal, so most
+ * comparisons between interned strings do not look at their characters.
+ */
+template<>
+inline
+bool
+corevm::types::eq::operator()<corevm::types::string>(
+  const corevm::types::string& lhs, const corevm::types::string& rhs)
+{
+  if (lhs.intern_key && rhs.intern_key)
+  {
+    if (lhs.intern_key == rhs.intern_key)
+    {
+      return true;
+    }
+    else if (lhs.hash_value != rhs.hash_value)
+    {
+      return false;
+    }
+  }
+
+  return lhs.value() == rhs.value();
+}
+
+// -----------------------------------------------------------------------------
+
 class neq : public binary_op
 {
 public:
@@ -802,14 +913,25 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) !=
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) !=
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
 
 // -----------------------------------------------------------------------------
 
+template<>
+inline
+bool
+corevm::types::neq::operator()<corevm::types::string>(
+  const corevm::types::string& lhs, const corevm::types::string& rhs)
+{
+  return !corevm::types::eq().operator()<corevm::types::string>(lhs, rhs);
+}
+
+// -----------------------------------------------------------------------------
+
 class gt : public binary_op
 {
 public:
@@ -817,8 +939,8 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) >
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) >
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -832,8 +954,8 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) <
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) <
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -847,8 +969,8 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) >=
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) >=
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -862,8 +984,8 @@ public:
   bool operator()(const T& lhs, const U& rhs)
   {
     return (
-      static_cast<typename R::value_type>(lhs.value) <=
-      static_cast<typename R::value_type>(rhs.value)
+      static_cast<typename R::value_type>(native_type_value(lhs)) <=
+      static_cast<typename R::value_type>(native_type_value(rhs))
     );
   }
 };
@@ -0,0 +1,70 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "string_intern_table.h"
+
+#include "operators.h"
+
+
+// -----------------------------------------------------------------------------
+
+corevm::types::string_intern_table::string_intern_table()
+  :
+  m_strings()
+{
+  // Do nothing here.
+}
+
+// -----------------------------------------------------------------------------
+
+corevm::types::string
+corevm::types::string_intern_table::intern(
+  const corevm::types::native_string& value)
+{
+  const uint64_t hash_value = static_cast<uint64_t>(
+    corevm::types::hash::hash_string_value(value));
+
+  auto range = m_strings.equal_range(hash_value);
+
+  auto itr = range.first;
+  while (itr != range.second && itr->second != value)
+  {
+    ++itr;
+  }
+
+  if (itr == range.second)
+  {
+    itr = m_strings.emplace(hash_value, value);
+  }
+
+  return corevm::types::string(&itr->second, itr->first);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t
+corevm::types::string_intern_table::size() const
+{
+  return m_strings.size();
+}
+
+// -----------------------------------------------------------------------------
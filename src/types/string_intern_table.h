@@ -0,0 +1,75 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#ifndef COREVM_STRING_INTERN_TABLE_H_
+#define COREVM_STRING_INTERN_TABLE_H_
+
+#include "native_string.h"
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+
+namespace corevm {
+
+
+namespace types {
+
+
+/**
+ * Table holding one copy of every distinct string interned in it, together
+ * with its hash. Interned strings refer to that copy instead of holding their
+ * own. Strings are never removed from the table, which must outlive the
+ * strings interned in it.
+ */
+class string_intern_table
+{
+public:
+  string_intern_table();
+
+  /* Interned strings refer to the table, which therefore cannot be copied. */
+  string_intern_table(const string_intern_table&) = delete;
+  string_intern_table& operator=(const string_intern_table&) = delete;
+
+  /**
+   * Returns the interned string equal to the specified value, adding the
+   * value to the table if it is not already in it.
+   */
+  corevm::types::string intern(const corevm::types::native_string&);
+
+  size_t size() const;
+
+private:
+  /* Keyed by hash, so that interning a string hashes it only once. */
+  std::unordered_multimap<uint64_t, corevm::types::native_string> m_strings;
+};
+
+
+} /* end namespace types */
+
+
+} /* end namespace corevm */
+
+
+#endif /* COREVM_STRING_INTERN_TABLE_H_ */
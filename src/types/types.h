@@ -26,8 +26,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "native_array.h"
 #include "native_map.h"
 #include "native_string.h"
+#include "corevm/macros.h"
+#include "memory/payload_allocator.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <new>
+#include <utility>
 
 
 namespace corevm {
@@ -62,6 +67,34 @@ class native_type_wrapper {};
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Wrappers of the types that native type handles hold through a pointer.
+ * The wrappers themselves are allocated from the payload heap, alongside
+ * their payloads, rather than from the global heap.
+ */
+class native_boxed_type_wrapper : public native_type_wrapper
+{
+public:
+  static void* operator new(size_t size)
+  {
+    void* ptr = corevm::memory::payload_heap().allocate(size);
+
+    if (!ptr)
+    {
+      THROW(std::bad_alloc());
+    }
+
+    return ptr;
+  }
+
+  static void operator delete(void* ptr, size_t size) noexcept
+  {
+    corevm::memory::payload_heap().deallocate(ptr, size);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
 class int8 : public native_type_wrapper
 {
 public:
@@ -205,45 +238,90 @@ public:
 
 // -----------------------------------------------------------------------------
 
-class string : public native_type_wrapper
+class string : public native_boxed_type_wrapper
 {
 public:
   typedef corevm::types::native_string value_type;
 
-  string() {}
-  string(value_type value) : value(value) {}
-
-  value_type value;
+  string() : intern_key(nullptr), hash_value(0) {}
+  string(value_type value) : intern_key(nullptr), hash_value(0), m_value(std::move(value)) {}
+
+  /**
+   * Constructs a string interned in an intern table, which refers to the
+   * table's copy of the value instead of holding its own.
+   */
+  string(const value_type* intern_key, uint64_t hash_value) :
+    intern_key(intern_key), hash_value(hash_value) {}
+
+  const value_type& value() const
+  {
+    return intern_key ? *intern_key : m_value;
+  }
+
+  /**
+   * The copy of the value held by the intern table the string was interned
+   * in, or `nullptr` if the string is not interned. Interned strings with the
+   * same key are equal.
+   */
+  const value_type* intern_key;
+
+  /** The hash of the value, set only on interned strings. */
+  uint64_t hash_value;
+
+private:
+  value_type m_value;
 };
 
 // -----------------------------------------------------------------------------
 
-class array : public native_type_wrapper
+class array : public native_boxed_type_wrapper
 {
 public:
   typedef corevm::types::native_array value_type;
 
   array() {}
-  array(value_type value) : value(value) {}
+  array(value_type value) : value(std::move(value)) {}
 
   value_type value;
 };
 
 // -----------------------------------------------------------------------------
 
-class map : public native_type_wrapper
+class map : public native_boxed_type_wrapper
 {
 public:
   typedef corevm::types::native_map value_type;
 
   map() {}
-  map(value_type value) : value(value) {}
+  map(value_type value) : value(std::move(value)) {}
 
   value_type value;
 };
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Returns the value held by a native type wrapper. Unlike the other wrappers,
+ * strings hold their value behind an accessor, so generic code reads values
+ * through this function.
+ */
+template<typename T>
+inline const typename T::value_type&
+native_type_value(const T& wrapper)
+{
+  return wrapper.value;
+}
+
+// -----------------------------------------------------------------------------
+
+inline const corevm::types::string::value_type&
+native_type_value(const corevm::types::string& wrapper)
+{
+  return wrapper.value();
+}
+
+// -----------------------------------------------------------------------------
+
 
 } /* end namespace types */
 
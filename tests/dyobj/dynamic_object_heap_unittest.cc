@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <sneaker/testing/_unittest.h>
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <vector>
 
@@ -42,6 +44,7 @@ public:
   virtual void on_delattr() noexcept {}
   virtual void on_delete() noexcept {}
   virtual void on_exit() noexcept {}
+  virtual void on_putattr(corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id) noexcept {}
 };
 
 // -----------------------------------------------------------------------------
@@ -124,6 +127,40 @@ TEST_F(dynamic_object_heap_unittest, TestAllocationOverMaxSize)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(dynamic_object_heap_unittest, TestImmediateIds)
+{
+  corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+
+  ASSERT_FALSE(corevm::dyobj::is_immediate(id));
+
+  int64_t values[] {
+    0, -1, 42, corevm::dyobj::IMMEDIATE_INT_MIN, corevm::dyobj::IMMEDIATE_INT_MAX
+  };
+
+  for (auto value : values)
+  {
+    corevm::dyobj::dyobj_id immediate_id = corevm::dyobj::make_immediate(
+      corevm::dyobj::IMMEDIATE_INT, value);
+
+    ASSERT_TRUE(corevm::dyobj::is_immediate(immediate_id));
+    ASSERT_EQ(corevm::dyobj::IMMEDIATE_INT, corevm::dyobj::get_immediate_kind(immediate_id));
+    ASSERT_EQ(value, corevm::dyobj::get_immediate_value(immediate_id));
+
+    // Immediate values are never objects of the heap.
+    ASSERT_EQ(nullptr, m_heap.find(immediate_id));
+  }
+
+  corevm::dyobj::dyobj_id true_id = corevm::dyobj::make_immediate(
+    corevm::dyobj::IMMEDIATE_BOOL, 1);
+
+  ASSERT_EQ(corevm::dyobj::IMMEDIATE_BOOL, corevm::dyobj::get_immediate_kind(true_id));
+  ASSERT_EQ(1, corevm::dyobj::get_immediate_value(true_id));
+
+  m_heap.erase(id);
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(dynamic_object_heap_unittest, TestOutputStream)
 {
   corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
@@ -145,3 +182,306 @@ TEST_F(dynamic_object_heap_unittest, TestOutputStream)
 }
 
 // -----------------------------------------------------------------------------
+
+class dynamic_object_heap_handle_table_unittest : public ::testing::Test
+{
+protected:
+  typedef corevm::dyobj::dynamic_object_heap<dummy_dynamic_object_manager> heap_type;
+
+  dynamic_object_heap_handle_table_unittest()
+    :
+    m_heap(4096, 4096, 0, heap_type::HEAP_USE_HANDLE_TABLE)
+  {
+  }
+
+  heap_type m_heap;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_handle_table_unittest, TestCreateDyobj)
+{
+  ASSERT_EQ(true, m_heap.uses_handle_table());
+
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  ASSERT_EQ(1, id1);
+  ASSERT_EQ(2, id2);
+
+  ASSERT_EQ(id1, m_heap.at(id1).id());
+  ASSERT_EQ(id2, m_heap.at(id2).id());
+
+  m_heap.erase(id1);
+
+  ASSERT_THROW(m_heap.at(id1), corevm::dyobj::object_not_found_error);
+
+  // Freed handles are reused.
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+  ASSERT_EQ(id1, id3);
+  ASSERT_EQ(id3, m_heap.at(id3).id());
+
+  m_heap.erase(id2);
+  m_heap.erase(id3);
+
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_handle_table_unittest, TestAtOnNonExistentKeys)
+{
+  ASSERT_THROW(m_heap.at(0), corevm::dyobj::object_not_found_error);
+  ASSERT_THROW(m_heap.at(1), corevm::dyobj::object_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_handle_table_unittest, TestCompact)
+{
+  std::vector<corevm::dyobj::dyobj_id> ids;
+
+  for (auto i = 0; i < 8; ++i)
+  {
+    ids.push_back(m_heap.create_dyobj());
+  }
+
+  // Link every object to its successor, so that we can tell the content
+  // survived the move.
+  for (auto i = 0; i + 1 < ids.size(); ++i)
+  {
+    m_heap.at(ids[i]).putattr(static_cast<corevm::dyobj::attr_key>(i), ids[i + 1]);
+  }
+
+  auto* last_obj = &m_heap.at(ids.back());
+
+  // Free every other object, leaving holes at the bottom of the heap.
+  for (auto i = 0; i < ids.size() - 1; i += 2)
+  {
+    m_heap.erase(ids[i]);
+  }
+
+  ASSERT_LT(1, m_heap.stats().free_block_count);
+
+  auto moved_count = m_heap.compact();
+
+  ASSERT_LT(0, moved_count);
+  ASSERT_EQ(4, m_heap.size());
+  ASSERT_EQ(1, m_heap.stats().free_block_count);
+  ASSERT_NE(last_obj, &m_heap.at(ids.back()));
+
+  for (auto i = 1; i < ids.size(); i += 2)
+  {
+    auto& obj = m_heap.at(ids[i]);
+
+    ASSERT_EQ(ids[i], obj.id());
+
+    if (i + 1 < ids.size())
+    {
+      ASSERT_EQ(ids[i + 1], obj.getattr(static_cast<corevm::dyobj::attr_key>(i)));
+    }
+  }
+
+  // Compacting again has nothing left to move.
+  ASSERT_EQ(0, m_heap.compact());
+
+  for (auto i = 1; i < ids.size(); i += 2)
+  {
+    m_heap.erase(ids[i]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_handle_table_unittest, TestFreeze)
+{
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  m_heap.at(id1).putattr(1, id2);
+
+  auto* obj = &m_heap.at(id1);
+
+  m_heap.freeze(id1);
+  m_heap.freeze(id1);
+
+  // The object moved out of the heap, along with its content.
+  ASSERT_EQ(1, m_heap.size());
+  ASSERT_EQ(1, m_heap.frozen_size());
+  ASSERT_NE(obj, &m_heap.at(id1));
+  ASSERT_EQ(id1, m_heap.at(id1).id());
+  ASSERT_EQ(true, m_heap.at(id1).is_frozen());
+  ASSERT_EQ(id2, m_heap.at(id1).getattr(1));
+  ASSERT_EQ(&m_heap.at(id1), m_heap.find(id1));
+
+  ASSERT_THROW(m_heap.freeze(0), corevm::dyobj::object_not_found_error);
+
+  m_heap.erase(id2);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_unittest, TestFreezeWithoutHandleTable)
+{
+  corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+
+  auto* obj = &m_heap.at(id);
+
+  m_heap.freeze(id);
+
+  // The object is frozen in place.
+  ASSERT_EQ(1, m_heap.size());
+  ASSERT_EQ(1, m_heap.frozen_size());
+  ASSERT_EQ(obj, &m_heap.at(id));
+  ASSERT_EQ(true, obj->is_frozen());
+  ASSERT_EQ(false, obj->is_garbage_collectible());
+
+  m_heap.erase(id);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_unittest, TestCompactWithoutHandleTable)
+{
+  ASSERT_EQ(false, m_heap.uses_handle_table());
+
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  m_heap.erase(id1);
+
+  ASSERT_EQ(0, m_heap.compact());
+  ASSERT_EQ(id2, m_heap.at(id2).id());
+
+  m_heap.erase(id2);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_unittest, TestFind)
+{
+  corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+
+  ASSERT_EQ(&m_heap.at(id), m_heap.find(id));
+
+  m_heap.erase(id);
+
+  ASSERT_EQ(nullptr, m_heap.find(id));
+  ASSERT_EQ(nullptr, m_heap.find(0));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_unittest, TestNursery)
+{
+  typedef corevm::dyobj::dynamic_object_heap<dummy_dynamic_object_manager> heap_type;
+
+  ASSERT_EQ(false, m_heap.generational());
+
+  m_heap.erase(m_heap.create_dyobj());
+
+  ASSERT_EQ(true, m_heap.nursery().empty());
+
+  heap_type heap(4096, 4096, 0, heap_type::HEAP_GENERATIONAL);
+
+  ASSERT_EQ(true, heap.generational());
+
+  corevm::dyobj::dyobj_id id1 = heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = heap.create_dyobj();
+
+  std::vector<corevm::dyobj::dyobj_id> expected_nursery { id1, id2 };
+  ASSERT_EQ(expected_nursery, heap.nursery());
+
+  heap.clear_nursery();
+
+  ASSERT_EQ(true, heap.nursery().empty());
+
+  corevm::dyobj::dyobj_id id3 = heap.create_dyobj();
+
+  ASSERT_EQ(1, heap.nursery().size());
+  ASSERT_EQ(id3, heap.nursery().front());
+
+  heap.erase(id1);
+  heap.erase(id2);
+  heap.erase(id3);
+}
+
+// -----------------------------------------------------------------------------
+
+class dynamic_object_heap_compressed_ids_unittest : public ::testing::Test
+{
+protected:
+  typedef corevm::dyobj::dynamic_object_heap<
+    dummy_dynamic_object_manager, corevm::dyobj::compressed_id_scheme> heap_type;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_compressed_ids_unittest, TestCreateDyobj)
+{
+  heap_type heap(4096);
+
+  corevm::dyobj::dyobj_id id1 = heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = heap.create_dyobj();
+
+  ASSERT_EQ(1, id1);
+  ASSERT_LT(id1, id2);
+  ASSERT_LE(id2, std::numeric_limits<uint32_t>::max());
+
+  const uint64_t stride = static_cast<uint64_t>(id2 - id1) <<
+    corevm::dyobj::compressed_id_scheme::ALIGNMENT_SHIFT;
+
+  ASSERT_EQ(sizeof(heap_type::dynamic_object_type), stride);
+
+  ASSERT_EQ(id1, heap.at(id1).id());
+  ASSERT_EQ(id2, heap.at(id2).id());
+
+  heap.erase(id1);
+
+  ASSERT_EQ(nullptr, heap.find(id1));
+  ASSERT_EQ(nullptr, heap.find(0));
+  ASSERT_THROW(heap.at(id1), corevm::dyobj::object_not_found_error);
+
+  corevm::dyobj::dyobj_id id3 = heap.create_dyobj();
+
+  ASSERT_EQ(id1, id3);
+
+  heap.erase(id2);
+  heap.erase(id3);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_heap_compressed_ids_unittest, TestIterate)
+{
+  heap_type heap(4096);
+
+  std::vector<corevm::dyobj::dyobj_id> ids;
+
+  for (auto i = 0; i < 10; ++i)
+  {
+    ids.push_back(heap.create_dyobj());
+  }
+
+  std::vector<corevm::dyobj::dyobj_id> iterated_ids;
+
+  heap.iterate(
+    [&iterated_ids](corevm::dyobj::dyobj_id id, heap_type::dynamic_object_type& obj) {
+      ASSERT_EQ(id, obj.id());
+      iterated_ids.push_back(id);
+    }
+  );
+
+  std::sort(iterated_ids.begin(), iterated_ids.end());
+
+  ASSERT_EQ(ids, iterated_ids);
+
+  for (auto id : ids)
+  {
+    heap.erase(id);
+  }
+
+  ASSERT_EQ(0, heap.size());
+}
+
+// -----------------------------------------------------------------------------
@@ -26,9 +26,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sneaker/testing/_unittest.h>
 
 #include <map>
+#include <vector>
 
 
-class dummy_dynamic_object_manager {};
+class dummy_dynamic_object_manager
+{
+public:
+  void on_putattr(corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id) noexcept {}
+};
 
 // -----------------------------------------------------------------------------
 
@@ -210,6 +215,102 @@ TEST_F(dynamic_object_unittest, TestGetAndSetAttrs)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(dynamic_object_unittest, TestGetAndSetWeakAttrs)
+{
+  dynamic_object_type obj;
+
+  corevm::dyobj::attr_key key1 = 123;
+  corevm::dyobj::attr_key key2 = 456;
+
+  corevm::dyobj::dyobj_id attr_id1 = 321;
+  corevm::dyobj::dyobj_id attr_id2 = 654;
+
+  ASSERT_FALSE(obj.has_weak_refs());
+  ASSERT_FALSE(obj.hasweakattr(key1));
+  ASSERT_THROW(obj.getweakattr(key1), corevm::dyobj::object_attribute_not_found_error);
+
+  obj.putweakattr(key1, attr_id1);
+  obj.putweakattr(key2, attr_id2);
+
+  ASSERT_TRUE(obj.has_weak_refs());
+  ASSERT_EQ(2, obj.weakattr_count());
+  ASSERT_EQ(attr_id1, obj.getweakattr(key1));
+  ASSERT_EQ(attr_id2, obj.getweakattr(key2));
+
+  // Weak attributes are kept apart from the other attributes.
+  ASSERT_FALSE(obj.hasattr(key1));
+  ASSERT_EQ(0, obj.attr_count());
+
+  obj.delweakattr(key1);
+
+  ASSERT_FALSE(obj.hasweakattr(key1));
+  ASSERT_THROW(obj.delweakattr(key1), corevm::dyobj::object_attribute_not_found_error);
+
+  obj.clear_weak_refs(
+    [attr_id2](corevm::dyobj::dyobj_id id) { return id == attr_id2; },
+    [](corevm::dyobj::dyobj_id) {}
+  );
+
+  ASSERT_FALSE(obj.hasweakattr(key2));
+  ASSERT_FALSE(obj.has_weak_refs());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(dynamic_object_unittest, TestGetAndSetEphemerons)
+{
+  dynamic_object_type obj;
+
+  corevm::dyobj::dyobj_id key1 = 1;
+  corevm::dyobj::dyobj_id key2 = 2;
+
+  corevm::dyobj::dyobj_id value1 = 11;
+  corevm::dyobj::dyobj_id value2 = 22;
+
+  ASSERT_FALSE(obj.hasephemeron(key1));
+  ASSERT_THROW(obj.getephemeron(key1), corevm::dyobj::object_attribute_not_found_error);
+
+  obj.putephemeron(key1, value1);
+  obj.putephemeron(key2, value2);
+
+  ASSERT_TRUE(obj.has_weak_refs());
+  ASSERT_EQ(2, obj.ephemeron_count());
+  ASSERT_EQ(value1, obj.getephemeron(key1));
+  ASSERT_EQ(value2, obj.getephemeron(key2));
+
+  std::map<corevm::dyobj::dyobj_id, corevm::dyobj::dyobj_id> ephemerons;
+
+  obj.iterate_ephemerons(
+    [&ephemerons](corevm::dyobj::dyobj_id key, corevm::dyobj::dyobj_id value) {
+      ephemerons[key] = value;
+    }
+  );
+
+  ASSERT_EQ(2, ephemerons.size());
+  ASSERT_EQ(value1, ephemerons[key1]);
+  ASSERT_EQ(value2, ephemerons[key2]);
+
+  // Ephemerons are cleared by their keys, and hand back their values.
+  std::vector<corevm::dyobj::dyobj_id> released;
+
+  obj.clear_weak_refs(
+    [key1, value2](corevm::dyobj::dyobj_id id) { return id == key1 || id == value2; },
+    [&released](corevm::dyobj::dyobj_id value) { released.push_back(value); }
+  );
+
+  ASSERT_EQ(1, released.size());
+  ASSERT_EQ(value1, released.front());
+  ASSERT_FALSE(obj.hasephemeron(key1));
+  ASSERT_TRUE(obj.hasephemeron(key2));
+
+  obj.delephemeron(key2);
+
+  ASSERT_FALSE(obj.has_weak_refs());
+  ASSERT_THROW(obj.delephemeron(key2), corevm::dyobj::object_attribute_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(dynamic_object_unittest, TestSetAndGetClosureCtx)
 {
   dynamic_object_type obj;
@@ -234,6 +335,27 @@ TEST_F(dynamic_object_unittest, TestSetAndGetClosureCtx)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(dynamic_object_unittest, TestSetAndGetInlineNtvhndl)
+{
+  dynamic_object_type obj;
+
+  ASSERT_EQ(0, obj.inline_ntvhndl_type());
+  ASSERT_EQ(0, obj.inline_ntvhndl_bits());
+
+  obj.set_inline_ntvhndl(7, 123);
+
+  ASSERT_EQ(7, obj.inline_ntvhndl_type());
+  ASSERT_EQ(123, obj.inline_ntvhndl_bits());
+  ASSERT_EQ(corevm::dyobj::NONESET_NTVHNDL_KEY, obj.ntvhndl_key());
+
+  obj.clear_inline_ntvhndl();
+
+  ASSERT_EQ(0, obj.inline_ntvhndl_type());
+  ASSERT_EQ(0, obj.inline_ntvhndl_bits());
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(dynamic_object_unittest, TestCopyFrom)
 {
   dynamic_object_type obj;
@@ -263,6 +385,8 @@ TEST_F(dynamic_object_unittest, TestCopyFrom)
   obj.set_flag(flag1);
   obj.set_flag(flag2);
 
+  obj.set_inline_ntvhndl(7, 123);
+
   dynamic_object_type dst;
 
   dst.copy_from(obj);
@@ -275,6 +399,9 @@ TEST_F(dynamic_object_unittest, TestCopyFrom)
   ASSERT_EQ(obj.getattr(key3), dst.getattr(key3));
 
   ASSERT_EQ(obj.flags(), dst.flags());
+
+  ASSERT_EQ(obj.inline_ntvhndl_type(), dst.inline_ntvhndl_type());
+  ASSERT_EQ(obj.inline_ntvhndl_bits(), dst.inline_ntvhndl_bits());
 }
 
 // -----------------------------------------------------------------------------
@@ -51,7 +51,28 @@ protected:
       "{"
         "\"heap-alloc-size\": 2048,"
         "\"pool-alloc-size\": 1024,"
-        "\"gc-interval\": 100"
+        "\"gc-interval\": 100,"
+        "\"max-heap-alloc-size\": 8192,"
+        "\"max-pool-alloc-size\": 4096,"
+        "\"arena-huge-pages\": true,"
+        "\"arena-prefault\": true,"
+        "\"alloc-stats-output\": \"./alloc-stats.json\","
+        "\"alloc-trace-output\": \"./alloc\","
+        "\"heap-handle-table\": true,"
+        "\"gc-slice-budget\": 256,"
+        "\"gc-slice-interval\": 1000,"
+        "\"gc-stats-output\": \"./gc-stats.json\","
+        "\"gc-nursery-size\": 4096,"
+        "\"gc-mark-threads\": 4,"
+        "\"gc-sweep-chunk-size\": 64,"
+        "\"gc-flag\": 6,"
+        "\"gc-allocation-interval\": 500,"
+        "\"gc-log-output\": \"gc.log\","
+        "\"gc-heap-growth-percent\": 150,"
+        "\"gc-min-threshold\": 2048,"
+        "\"gc-target-cpu-percent\": 5,"
+        "\"gc-pause-budget-us\": 2000,"
+        "\"max-native-payload-size\": 1048576"
       "}"
     );
 
@@ -72,6 +93,27 @@ TEST_F(configuration_unittest, TestLoadSuccessful)
   ASSERT_EQ(2048, configuration.heap_alloc_size());
   ASSERT_EQ(1024, configuration.pool_alloc_size());
   ASSERT_EQ(100, configuration.gc_interval());
+  ASSERT_EQ(8192, configuration.max_heap_alloc_size());
+  ASSERT_EQ(4096, configuration.max_pool_alloc_size());
+  ASSERT_EQ(true, configuration.arena_huge_pages());
+  ASSERT_EQ(true, configuration.arena_prefault());
+  ASSERT_EQ("./alloc-stats.json", configuration.alloc_stats_output());
+  ASSERT_EQ("./alloc", configuration.alloc_trace_output());
+  ASSERT_EQ(true, configuration.heap_handle_table());
+  ASSERT_EQ(256, configuration.gc_slice_budget());
+  ASSERT_EQ(1000, configuration.gc_slice_interval());
+  ASSERT_EQ("./gc-stats.json", configuration.gc_stats_output());
+  ASSERT_EQ(4096, configuration.gc_nursery_size());
+  ASSERT_EQ(4, configuration.gc_mark_threads());
+  ASSERT_EQ(64, configuration.gc_sweep_chunk_size());
+  ASSERT_EQ(6, configuration.gc_flag());
+  ASSERT_EQ(500, configuration.gc_allocation_interval());
+  ASSERT_EQ("gc.log", configuration.gc_log_output());
+  ASSERT_EQ(150, configuration.gc_heap_growth_percent());
+  ASSERT_EQ(2048, configuration.gc_min_threshold());
+  ASSERT_EQ(5, configuration.gc_target_cpu_percent());
+  ASSERT_EQ(2000, configuration.gc_pause_budget());
+  ASSERT_EQ(1048576, configuration.max_native_payload_size());
 }
 
 // -----------------------------------------------------------------------------
@@ -107,6 +149,72 @@ TEST_F(configuration_unittest, TestGetAndSet)
   ASSERT_EQ(expected_heap_alloc_size, configuration.heap_alloc_size());
   ASSERT_EQ(expected_pool_alloc_size, configuration.pool_alloc_size());
   ASSERT_EQ(expected_gc_interval, configuration.gc_interval());
+
+  ASSERT_EQ(0, configuration.max_heap_alloc_size());
+  ASSERT_EQ(0, configuration.max_pool_alloc_size());
+  ASSERT_EQ(false, configuration.arena_huge_pages());
+  ASSERT_EQ(false, configuration.arena_prefault());
+  ASSERT_EQ(true, configuration.alloc_stats_output().empty());
+  ASSERT_EQ(true, configuration.alloc_trace_output().empty());
+  ASSERT_EQ(false, configuration.heap_handle_table());
+  ASSERT_EQ(0, configuration.gc_slice_budget());
+  ASSERT_EQ(0, configuration.gc_slice_interval());
+  ASSERT_EQ(true, configuration.gc_stats_output().empty());
+  ASSERT_EQ(0, configuration.gc_nursery_size());
+  ASSERT_EQ(0, configuration.gc_mark_threads());
+  ASSERT_EQ(0, configuration.gc_sweep_chunk_size());
+  ASSERT_EQ(0, configuration.gc_flag());
+  ASSERT_EQ(0, configuration.gc_allocation_interval());
+  ASSERT_EQ(true, configuration.gc_log_output().empty());
+  ASSERT_EQ(0, configuration.gc_heap_growth_percent());
+  ASSERT_EQ(0, configuration.gc_min_threshold());
+  ASSERT_EQ(0, configuration.gc_target_cpu_percent());
+  ASSERT_EQ(0, configuration.gc_pause_budget());
+  ASSERT_EQ(0, configuration.max_native_payload_size());
+
+  configuration.set_max_heap_alloc_size(expected_heap_alloc_size * 2);
+  configuration.set_max_pool_alloc_size(expected_pool_alloc_size * 2);
+  configuration.set_arena_huge_pages(true);
+  configuration.set_arena_prefault(true);
+  configuration.set_alloc_stats_output("./alloc-stats.json");
+  configuration.set_alloc_trace_output("./alloc");
+  configuration.set_heap_handle_table(true);
+  configuration.set_gc_slice_budget(256);
+  configuration.set_gc_slice_interval(1000);
+  configuration.set_gc_stats_output("./gc-stats.json");
+  configuration.set_gc_nursery_size(4096);
+  configuration.set_gc_mark_threads(4);
+  configuration.set_gc_sweep_chunk_size(64);
+  configuration.set_gc_flag(6);
+  configuration.set_gc_allocation_interval(500);
+  configuration.set_gc_log_output("gc.log");
+  configuration.set_gc_heap_growth_percent(150);
+  configuration.set_gc_min_threshold(2048);
+  configuration.set_gc_target_cpu_percent(5);
+  configuration.set_gc_pause_budget(2000);
+  configuration.set_max_native_payload_size(1048576);
+
+  ASSERT_EQ(expected_heap_alloc_size * 2, configuration.max_heap_alloc_size());
+  ASSERT_EQ(expected_pool_alloc_size * 2, configuration.max_pool_alloc_size());
+  ASSERT_EQ(true, configuration.arena_huge_pages());
+  ASSERT_EQ(true, configuration.arena_prefault());
+  ASSERT_EQ("./alloc-stats.json", configuration.alloc_stats_output());
+  ASSERT_EQ("./alloc", configuration.alloc_trace_output());
+  ASSERT_EQ(true, configuration.heap_handle_table());
+  ASSERT_EQ(256, configuration.gc_slice_budget());
+  ASSERT_EQ(1000, configuration.gc_slice_interval());
+  ASSERT_EQ("./gc-stats.json", configuration.gc_stats_output());
+  ASSERT_EQ(4096, configuration.gc_nursery_size());
+  ASSERT_EQ(4, configuration.gc_mark_threads());
+  ASSERT_EQ(64, configuration.gc_sweep_chunk_size());
+  ASSERT_EQ(6, configuration.gc_flag());
+  ASSERT_EQ(500, configuration.gc_allocation_interval());
+  ASSERT_EQ("gc.log", configuration.gc_log_output());
+  ASSERT_EQ(150, configuration.gc_heap_growth_percent());
+  ASSERT_EQ(2048, configuration.gc_min_threshold());
+  ASSERT_EQ(5, configuration.gc_target_cpu_percent());
+  ASSERT_EQ(2000, configuration.gc_pause_budget());
+  ASSERT_EQ(1048576, configuration.max_native_payload_size());
 }
 
 // -----------------------------------------------------------------------------
@@ -23,10 +23,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "dyobj/dynamic_object.h"
 #include "dyobj/dynamic_object_heap.h"
 #include "gc/garbage_collector.h"
+#include "gc/mark_and_sweep_garbage_collection_scheme.h"
 #include "gc/reference_count_garbage_collection_scheme.h"
 
 #include <sneaker/testing/_unittest.h>
 
+#include <thread>
+
 
 template<class GarbageCollectionScheme>
 class garbage_collection_unittest : public ::testing::Test
@@ -71,6 +74,23 @@ protected:
     dst_obj.manager().on_setattr();
   }
 
+  void help_setweakattr(
+    corevm::dyobj::dyobj_id src_id, corevm::dyobj::dyobj_id dst_id)
+  {
+    m_heap.at(src_id).putweakattr(dst_id, dst_id);
+    m_heap.add_weak_ref_holder(src_id);
+  }
+
+  void help_setephemeron(
+    corevm::dyobj::dyobj_id src_id,
+    corevm::dyobj::dyobj_id key_id,
+    corevm::dyobj::dyobj_id value_id)
+  {
+    m_heap.at(src_id).putephemeron(key_id, value_id);
+    m_heap.at(value_id).manager().on_setattr();
+    m_heap.add_weak_ref_holder(src_id);
+  }
+
   void help_set_as_non_garbage_collectible(corevm::dyobj::dyobj_id id)
   {
     auto& obj = m_heap.at(id);
@@ -84,7 +104,8 @@ protected:
 // -----------------------------------------------------------------------------
 
 typedef ::testing::Types<
-  corevm::gc::reference_count_garbage_collection_scheme
+  corevm::gc::reference_count_garbage_collection_scheme,
+  corevm::gc::mark_and_sweep_garbage_collection_scheme
 > GarbageCollectionSchemeTypes;
 
 // -----------------------------------------------------------------------------
@@ -639,3 +660,984 @@ TYPED_TEST(garbage_collection_unittest, TestSingleCycleWithNonGarbageCollectible
 }
 
 // -----------------------------------------------------------------------------
+
+TYPED_TEST(garbage_collection_unittest, TestWeakAttrs)
+{
+  /**
+   * Tests GC on the following object graph, with obj1 as the root, where
+   * weak attributes are drawn with dots:
+   *
+   * obj1 -> obj2
+   *   .       .
+   *   .......obj3
+   *
+   * will result in 2 objects left on the heap, and the weak attribute to
+   * obj3 cleared.
+   */
+  corevm::dyobj::dyobj_id id1 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id2 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id3 = this->help_create_obj();
+
+  this->help_setattr(id1, id2);
+  this->help_setweakattr(id1, id2);
+  this->help_setweakattr(id1, id3);
+
+  typename TestFixture::_GarbageCollectorType collector(this->m_heap);
+  collector.gc(nullptr, { id1 });
+
+  ASSERT_EQ(2, this->m_heap.size());
+  ASSERT_TRUE(this->m_heap.at(id1).hasweakattr(id2));
+  ASSERT_FALSE(this->m_heap.at(id1).hasweakattr(id3));
+  ASSERT_EQ(1, this->m_heap.weak_ref_holder_count());
+}
+
+// -----------------------------------------------------------------------------
+
+TYPED_TEST(garbage_collection_unittest, TestEphemerons)
+{
+  /**
+   * Tests GC on an ephemeron table obj1 mapping obj2 to obj3, and obj4 to
+   * obj5, where obj3 refers to obj4:
+   *
+   * obj1: { obj2 => obj3, obj4 => obj5 }      obj3 -> obj4
+   *
+   * With obj1 and obj2 as roots, obj4 is reached through obj3, so that all
+   * 5 objects are left on the heap. Once obj2 is no longer a root, both
+   * ephemerons are cleared, and only obj1 is left.
+   */
+  corevm::dyobj::dyobj_id id1 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id2 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id3 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id4 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id5 = this->help_create_obj();
+
+  this->help_setephemeron(id1, id2, id3);
+  this->help_setephemeron(id1, id4, id5);
+  this->help_setattr(id3, id4);
+
+  typename TestFixture::_GarbageCollectorType collector(this->m_heap);
+  collector.gc(nullptr, { id1, id2 });
+
+  ASSERT_EQ(5, this->m_heap.size());
+  ASSERT_EQ(2, this->m_heap.at(id1).ephemeron_count());
+
+  collector.gc(nullptr, { id1 });
+
+  ASSERT_EQ(1, this->m_heap.size());
+  ASSERT_EQ(0, this->m_heap.at(id1).ephemeron_count());
+}
+
+// -----------------------------------------------------------------------------
+
+TYPED_TEST(garbage_collection_unittest, TestFrozenObjects)
+{
+  /**
+   * Tests GC on the following object graph, where obj1 and obj2 are frozen:
+   *
+   * obj3 -> obj1 -> obj2
+   *
+   * will result in 2 objects left on the heap.
+   */
+  corevm::dyobj::dyobj_id id1 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id2 = this->help_create_obj();
+  corevm::dyobj::dyobj_id id3 = this->help_create_obj();
+
+  this->help_setattr(id1, id2);
+  this->help_setattr(id3, id1);
+
+  this->m_heap.freeze(id1);
+  this->m_heap.freeze(id2);
+
+  this->do_gc_and_check_results({ id1, id2 });
+}
+
+// -----------------------------------------------------------------------------
+
+TYPED_TEST(garbage_collection_unittest, TestCycleStats)
+{
+  corevm::dyobj::dyobj_id id = this->help_create_obj();
+  this->help_create_obj();
+  this->help_create_obj();
+
+  this->help_set_as_non_garbage_collectible(id);
+
+  corevm::gc::cycle_stats stats = corevm::gc::cycle_stats();
+
+  typename TestFixture::_GarbageCollectorType collector(this->m_heap);
+  collector.set_cycle_stats(&stats);
+  collector.gc();
+
+  ASSERT_EQ(1, this->m_heap.size());
+  ASSERT_EQ(2, stats.freed_object_count);
+
+  collector.gc();
+
+  ASSERT_EQ(2, stats.freed_object_count);
+}
+
+// -----------------------------------------------------------------------------
+
+class mark_and_sweep_garbage_collection_unittest : public ::testing::Test
+{
+protected:
+  using _GarbageCollectionSchemeType = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme;
+
+  using _GarbageCollectorType = typename
+    corevm::gc::garbage_collector<_GarbageCollectionSchemeType>;
+
+  void help_setattr(
+    corevm::dyobj::dyobj_id src_id, corevm::dyobj::dyobj_id dst_id)
+  {
+    m_heap.at(src_id).putattr(dst_id, dst_id);
+  }
+
+  corevm::dyobj::dynamic_object_heap<
+    _GarbageCollectionSchemeType::dynamic_object_manager> m_heap;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestCollectWithRoots)
+{
+  /**
+   * Tests GC on the following object graph, with obj1 and obj4 as roots:
+   *
+   * obj1 -> obj2      obj3 -> obj2
+   *
+   * obj4 -> obj5 -> obj4
+   *
+   * will result in 4 objects left on the heap.
+   */
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id5 = m_heap.create_dyobj();
+
+  help_setattr(id1, id2);
+  help_setattr(id3, id2);
+  help_setattr(id4, id5);
+  help_setattr(id5, id4);
+
+  _GarbageCollectorType::root_set_type roots { id1, id4 };
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, roots);
+
+  ASSERT_EQ(4, m_heap.size());
+  ASSERT_THROW(m_heap.at(id3), corevm::dyobj::object_not_found_error);
+
+  // Objects that survived are eligible again in the next cycle.
+  collector.gc(nullptr, { id4 });
+
+  ASSERT_EQ(2, m_heap.size());
+  ASSERT_NO_THROW(m_heap.at(id4));
+  ASSERT_NO_THROW(m_heap.at(id5));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestCollectDeepChain)
+{
+  const size_t CHAIN_LENGTH = 100000;
+
+  corevm::dyobj::dyobj_id head = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id prev = head;
+
+  for (size_t i = 1; i < CHAIN_LENGTH; ++i)
+  {
+    corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+    help_setattr(prev, id);
+    prev = id;
+  }
+
+  m_heap.create_dyobj();
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { head });
+
+  ASSERT_EQ(CHAIN_LENGTH, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestIncrementalCollection)
+{
+  /**
+   * Tests GC in slices of one object on the following object graph, with
+   * obj1 as the root:
+   *
+   * obj1 -> obj2 -> obj3      obj4
+   *
+   * will result in 3 objects left on the heap.
+   */
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+
+  help_setattr(id1, id2);
+  help_setattr(id2, id3);
+
+  _GarbageCollectorType::root_set_type roots { id1 };
+  _GarbageCollectionSchemeType::incremental_state state;
+
+  _GarbageCollectorType collector(m_heap);
+
+  size_t slice_count = 0;
+
+  while (!collector.gc_slice(nullptr, roots, 1, state))
+  {
+    ASSERT_EQ(true, state.in_progress());
+    ASSERT_EQ(&state, _GarbageCollectionSchemeType::incremental_state::active());
+    ASSERT_EQ(4, m_heap.size());
+    ++slice_count;
+  }
+
+  ASSERT_EQ(2, slice_count);
+  ASSERT_EQ(false, state.in_progress());
+  ASSERT_EQ(nullptr, _GarbageCollectionSchemeType::incremental_state::active());
+
+  ASSERT_EQ(3, m_heap.size());
+  ASSERT_THROW(m_heap.at(id4), corevm::dyobj::object_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestIncrementalCollectionAcrossThreads)
+{
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  help_setattr(id1, id2);
+
+  _GarbageCollectorType::root_set_type roots { id1 };
+  _GarbageCollectionSchemeType::incremental_state state;
+
+  _GarbageCollectorType collector(m_heap);
+
+  // The cycle starts on this thread.
+  ASSERT_EQ(false, collector.gc_slice(nullptr, roots, 1, state));
+  ASSERT_EQ(&state, _GarbageCollectionSchemeType::incremental_state::active());
+
+  bool active_on_other_thread = false;
+  bool completed = false;
+
+  // And completes on another one, which shares the state.
+  std::thread thread([&]() {
+    state.activate();
+    active_on_other_thread =
+      _GarbageCollectionSchemeType::incremental_state::active() == &state;
+    completed = collector.gc_slice(nullptr, roots, 16, state);
+  });
+
+  thread.join();
+
+  ASSERT_EQ(true, active_on_other_thread);
+  ASSERT_EQ(true, completed);
+
+  // The write barrier is over on this thread too.
+  ASSERT_EQ(false, state.in_progress());
+  ASSERT_EQ(nullptr, _GarbageCollectionSchemeType::incremental_state::active());
+  ASSERT_EQ(2, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestWriteBarrier)
+{
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  help_setattr(id1, id2);
+
+  _GarbageCollectorType::root_set_type roots { id1 };
+  _GarbageCollectionSchemeType::incremental_state state;
+
+  _GarbageCollectorType collector(m_heap);
+
+  // Marks obj1 only.
+  ASSERT_EQ(false, collector.gc_slice(nullptr, roots, 1, state));
+  ASSERT_EQ(true, m_heap.at(id1).manager().marked());
+
+  // Objects created in the middle of the cycle, and only reachable from an
+  // object that has already been marked.
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+
+  help_setattr(id1, id3);
+  help_setattr(id3, id4);
+
+  while (!collector.gc_slice(nullptr, roots, 1, state))
+  {
+  }
+
+  ASSERT_EQ(4, m_heap.size());
+  ASSERT_NO_THROW(m_heap.at(id3));
+  ASSERT_NO_THROW(m_heap.at(id4));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestParallelMark)
+{
+  const size_t OBJECT_COUNT = 10000;
+
+  std::vector<corevm::dyobj::dyobj_id> ids;
+
+  for (size_t i = 0; i < OBJECT_COUNT; ++i)
+  {
+    ids.push_back(m_heap.create_dyobj());
+  }
+
+  // Objects with an even index form a binary tree rooted at the first
+  // object, with every fourth one also referring back to its parent. Odd
+  // objects refer into the tree, but nothing refers to them.
+  for (size_t i = 2; i < OBJECT_COUNT; i += 2)
+  {
+    size_t parent = ((i / 2 - 1) / 2) * 2;
+    help_setattr(ids[parent], ids[i]);
+
+    if (i % 4 == 0)
+    {
+      help_setattr(ids[i], ids[parent]);
+    }
+
+    help_setattr(ids[i - 1], ids[i]);
+  }
+
+  _GarbageCollectorType collector(m_heap);
+  collector.set_mark_thread_count(4);
+  collector.gc(nullptr, { ids.front() });
+
+  ASSERT_EQ(OBJECT_COUNT / 2, m_heap.size());
+
+  for (size_t i = 0; i < OBJECT_COUNT; i += 2)
+  {
+    ASSERT_EQ(true, m_heap.at(ids[i]).manager().marked());
+  }
+
+  // Marking again, from nothing but a pinned subtree.
+  m_heap.at(ids[2]).set_flag(corevm::dyobj::flags::DYOBJ_IS_NOT_GARBAGE_COLLECTIBLE);
+  collector.gc(nullptr, {});
+
+  ASSERT_NO_THROW(m_heap.at(ids[2]));
+  ASSERT_NO_THROW(m_heap.at(ids[6]));
+  ASSERT_THROW(m_heap.at(ids[0]), corevm::dyobj::object_not_found_error);
+  ASSERT_THROW(m_heap.at(ids[4]), corevm::dyobj::object_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestRepeatedParallelMark)
+{
+  const size_t CHAIN_COUNT = 64;
+  const size_t CHAIN_LENGTH = 64;
+
+  // Short chains hanging off a single root keep every deque close to empty,
+  // so that owners and thieves keep racing for the last object.
+  corevm::dyobj::dyobj_id root = m_heap.create_dyobj();
+
+  for (size_t i = 0; i < CHAIN_COUNT; ++i)
+  {
+    corevm::dyobj::dyobj_id previous = root;
+
+    for (size_t j = 0; j < CHAIN_LENGTH; ++j)
+    {
+      corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+      help_setattr(previous, id);
+      previous = id;
+    }
+
+    // Unreachable.
+    m_heap.create_dyobj();
+  }
+
+  const size_t live_count = 1 + CHAIN_COUNT * CHAIN_LENGTH;
+
+  _GarbageCollectorType collector(m_heap);
+  collector.set_mark_thread_count(8);
+
+  for (size_t i = 0; i < 50; ++i)
+  {
+    collector.gc(nullptr, { root });
+    ASSERT_EQ(live_count, m_heap.size());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestTraceNtvhndl)
+{
+  /**
+   * Tests GC with obj1 as the root, where the native handle of obj1 refers
+   * to obj2 and obj3, and obj3 refers to obj4:
+   *
+   * obj1 => [obj2, obj3]      obj3 -> obj4      obj5
+   *
+   * will result in 4 objects left on the heap, marking serially and in
+   * parallel.
+   */
+  for (uint32_t mark_thread_count = 1; mark_thread_count <= 2; ++mark_thread_count)
+  {
+    corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+    corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+    corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+    corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+    corevm::dyobj::dyobj_id id5 = m_heap.create_dyobj();
+
+    const corevm::dyobj::ntvhndl_key ntvhndl_key = 7;
+    m_heap.at(id1).set_ntvhndl_key(ntvhndl_key);
+    help_setattr(id3, id4);
+
+    _GarbageCollectorType collector(m_heap);
+    collector.set_mark_thread_count(mark_thread_count);
+    collector.set_ntvhndl_tracer(
+      [&](corevm::dyobj::ntvhndl_key key,
+        _GarbageCollectorType::root_set_type& ids) {
+        ASSERT_EQ(ntvhndl_key, key);
+        ids.push_back(id2);
+        ids.push_back(id3);
+      }
+    );
+
+    collector.gc(nullptr, { id1 });
+
+    ASSERT_EQ(4, m_heap.size());
+    ASSERT_THROW(m_heap.at(id5), corevm::dyobj::object_not_found_error);
+
+    collector.gc(nullptr, {});
+
+    ASSERT_EQ(0, m_heap.size());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestParallelMarkWithInvalidRoot)
+{
+  m_heap.create_dyobj();
+
+  _GarbageCollectorType::root_set_type roots { 1 };
+
+  _GarbageCollectionSchemeType scheme;
+  scheme.set_mark_thread_count(4);
+
+  ASSERT_THROW(scheme.gc(m_heap, roots), corevm::dyobj::object_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_and_sweep_garbage_collection_unittest, TestLazySweep)
+{
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  m_heap.create_dyobj();
+  m_heap.create_dyobj();
+
+  _GarbageCollectorType::sweep_state state;
+
+  _GarbageCollectorType collector(m_heap);
+  collector.set_sweep_state(&state);
+  collector.gc(nullptr, { id1 });
+
+  // Garbage is left on the heap.
+  ASSERT_EQ(3, m_heap.size());
+  ASSERT_EQ(true, state.pending());
+
+  // Each step visits a single object.
+  size_t freed = collector.sweep(nullptr, 1);
+  ASSERT_GE(1, freed);
+  ASSERT_EQ(3 - freed, m_heap.size());
+  ASSERT_EQ(true, state.pending());
+
+  // Objects created in the meantime are not garbage.
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+  state.retain(m_heap.at(id4));
+
+  // The next collection reclaims the rest first.
+  collector.gc(nullptr, { id1, id4 });
+
+  ASSERT_EQ(2, m_heap.size());
+  ASSERT_EQ(true, state.pending());
+
+  ASSERT_EQ(0, collector.sweep(nullptr, 2));
+  ASSERT_EQ(false, state.pending());
+  ASSERT_NO_THROW(m_heap.at(id1));
+  ASSERT_NO_THROW(m_heap.at(id4));
+}
+
+// -----------------------------------------------------------------------------
+
+class generational_garbage_collection_unittest : public ::testing::Test
+{
+protected:
+  using _GarbageCollectionSchemeType = typename
+    corevm::gc::mark_and_sweep_garbage_collection_scheme;
+
+  using _GarbageCollectorType = typename
+    corevm::gc::garbage_collector<_GarbageCollectionSchemeType>;
+
+  using _DynamicObjectHeapType = typename
+    _GarbageCollectionSchemeType::dynamic_object_heap_type;
+
+  generational_garbage_collection_unittest()
+    :
+    m_heap(
+      corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+      corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+      0,
+      _DynamicObjectHeapType::HEAP_GENERATIONAL)
+  {
+  }
+
+  void help_setattr(
+    corevm::dyobj::dyobj_id src_id, corevm::dyobj::dyobj_id dst_id)
+  {
+    m_heap.at(src_id).putattr(dst_id, dst_id);
+  }
+
+  _DynamicObjectHeapType m_heap;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(generational_garbage_collection_unittest, TestMinorCollection)
+{
+  /**
+   * Tests a minor collection with obj1 as the root, after obj1 and obj2 are
+   * promoted by a full collection:
+   *
+   * obj1 -> obj3 -> obj4      obj2      obj5
+   *
+   * will free obj5 only, since obj2 is in the old generation.
+   */
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { id1, id2 });
+
+  ASSERT_EQ(true, m_heap.nursery().empty());
+
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id5 = m_heap.create_dyobj();
+
+  help_setattr(id3, id4);
+
+  // No generational state is active, so the old root is scanned for young
+  // objects instead.
+  help_setattr(id1, id3);
+
+  _GarbageCollectionSchemeType::generational_state state;
+
+  ASSERT_EQ(2, collector.minor_gc(nullptr, { id1 }, state));
+
+  ASSERT_EQ(4, m_heap.size());
+  ASSERT_EQ(true, m_heap.nursery().empty());
+  ASSERT_NO_THROW(m_heap.at(id2));
+  ASSERT_THROW(m_heap.at(id5), corevm::dyobj::object_not_found_error);
+
+  // Promoted objects are left to full collections.
+  ASSERT_EQ(0, collector.minor_gc(nullptr, {}, state));
+  ASSERT_EQ(4, m_heap.size());
+
+  collector.gc(nullptr, {});
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(generational_garbage_collection_unittest, TestRememberedSet)
+{
+  corevm::dyobj::dyobj_id id1 = m_heap.create_dyobj();
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { id1 });
+
+  _GarbageCollectionSchemeType::generational_state state;
+  state.activate();
+
+  ASSERT_EQ(&state, _GarbageCollectionSchemeType::generational_state::active());
+
+  // Young objects only reachable from an old object that is not a root.
+  corevm::dyobj::dyobj_id id2 = m_heap.create_dyobj();
+  corevm::dyobj::dyobj_id id3 = m_heap.create_dyobj();
+
+  help_setattr(id2, id3);
+  help_setattr(id1, id2);
+  help_setattr(id1, id3);
+
+  _GarbageCollectionSchemeType::root_set_type expected_remembered_set { id1 };
+  ASSERT_EQ(expected_remembered_set, state.remembered_set());
+  ASSERT_EQ(true, m_heap.at(id1).manager().remembered());
+
+  ASSERT_EQ(2, collector.minor_gc(nullptr, {}, state));
+
+  ASSERT_EQ(3, m_heap.size());
+  ASSERT_EQ(true, state.remembered_set().empty());
+  ASSERT_EQ(false, m_heap.at(id1).manager().remembered());
+
+  // Remembered objects freed by a full collection are skipped.
+  corevm::dyobj::dyobj_id id4 = m_heap.create_dyobj();
+  help_setattr(id1, id4);
+
+  collector.gc(nullptr, {});
+  ASSERT_EQ(0, m_heap.size());
+
+  ASSERT_EQ(0, collector.minor_gc(nullptr, {}, state));
+  ASSERT_EQ(true, state.remembered_set().empty());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(generational_garbage_collection_unittest, TestMinorCollectionWithReferenceCount)
+{
+  using _ReferenceCountSchemeType = typename
+    corevm::gc::reference_count_garbage_collection_scheme;
+
+  _ReferenceCountSchemeType::dynamic_object_heap_type heap(
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    0,
+    _ReferenceCountSchemeType::dynamic_object_heap_type::HEAP_GENERATIONAL);
+
+  heap.create_dyobj();
+
+  ASSERT_EQ(1, heap.nursery().size());
+
+  // Reference counting falls back to a full collection.
+  _ReferenceCountSchemeType::generational_state state;
+  corevm::gc::garbage_collector<_ReferenceCountSchemeType> collector(heap);
+
+  ASSERT_EQ(0, collector.minor_gc(nullptr, {}, state));
+  ASSERT_EQ(0, heap.size());
+  ASSERT_EQ(true, heap.nursery().empty());
+}
+
+// -----------------------------------------------------------------------------
+
+class reference_count_garbage_collection_unittest : public ::testing::Test
+{
+protected:
+  using _GarbageCollectionSchemeType = typename
+    corevm::gc::reference_count_garbage_collection_scheme;
+
+  using _GarbageCollectorType = typename
+    corevm::gc::garbage_collector<_GarbageCollectionSchemeType>;
+
+  corevm::dyobj::dyobj_id help_create_obj()
+  {
+    corevm::dyobj::dyobj_id id = m_heap.create_dyobj();
+    return id;
+  }
+
+  void help_setattr(
+    corevm::dyobj::dyobj_id src_id, corevm::dyobj::dyobj_id dst_id)
+  {
+    m_heap.at(src_id).putattr(dst_id, dst_id);
+    m_heap.at(dst_id).manager().on_setattr();
+  }
+
+  corevm::dyobj::dynamic_object_heap<
+    _GarbageCollectionSchemeType::dynamic_object_manager> m_heap;
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestReferencedCycleSurvives)
+{
+  /**
+   * Tests GC on the following object graph, where obj1 is also referenced
+   * by the process:
+   *
+   * obj1 -> obj2 -> obj3
+   *  ^               |
+   *  |_______________|
+   *
+   * will result in 3 objects left on the heap, with their counts intact,
+   * until the process no longer references obj1.
+   */
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  corevm::dyobj::dyobj_id id3 = help_create_obj();
+
+  help_setattr(id1, id2);
+  help_setattr(id2, id3);
+  help_setattr(id3, id1);
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { id1 });
+
+  ASSERT_EQ(3, m_heap.size());
+  ASSERT_EQ(1, m_heap.at(id1).manager().ref_count());
+  ASSERT_EQ(1, m_heap.at(id2).manager().ref_count());
+  ASSERT_EQ(1, m_heap.at(id3).manager().ref_count());
+  ASSERT_EQ(true, m_heap.at(id1).manager().rooted());
+  ASSERT_EQ(false, m_heap.at(id2).manager().buffered());
+
+  collector.gc();
+
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestReleaseCascadesToCycle)
+{
+  /**
+   * Tests GC on the following object graph, where obj1 is not referenced
+   * by the process, but obj4 is:
+   *
+   * obj1 -> obj2 -> obj3 -> obj4
+   *          ^       |
+   *          |_______|
+   *
+   * will result in 1 object left on the heap.
+   */
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  corevm::dyobj::dyobj_id id3 = help_create_obj();
+  corevm::dyobj::dyobj_id id4 = help_create_obj();
+
+  help_setattr(id1, id2);
+  help_setattr(id2, id3);
+  help_setattr(id3, id2);
+  help_setattr(id3, id4);
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { id1, id2, id3, id4 });
+
+  ASSERT_EQ(4, m_heap.size());
+
+  collector.gc(nullptr, { id4 });
+
+  // The reference from obj3 died with the cycle.
+  ASSERT_EQ(1, m_heap.size());
+  ASSERT_EQ(0, m_heap.at(id4).manager().ref_count());
+
+  collector.gc();
+
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestCycleWithExternalReference)
+{
+  /**
+   * Tests GC on the following object graph, where obj3 and obj4 are
+   * referenced by the process, and the reference from obj2 to obj4 is not
+   * counted:
+   *
+   * obj3 -> obj1 -> obj2 ~> obj4
+   *          ^       |
+   *          |_______|
+   *
+   * will leave every object with the count it had before.
+   */
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  corevm::dyobj::dyobj_id id3 = help_create_obj();
+  corevm::dyobj::dyobj_id id4 = help_create_obj();
+
+  help_setattr(id1, id2);
+  help_setattr(id2, id1);
+  help_setattr(id3, id1);
+  m_heap.at(id2).putattr(id4, id4);
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { id1, id2, id3, id4 });
+
+  ASSERT_EQ(4, m_heap.size());
+
+  // obj1 and obj2 become possible roots, and are scanned back to black
+  // through the reference from obj3.
+  collector.gc(nullptr, { id3, id4 });
+
+  ASSERT_EQ(4, m_heap.size());
+  ASSERT_EQ(2, m_heap.at(id1).manager().ref_count());
+  ASSERT_EQ(1, m_heap.at(id2).manager().ref_count());
+  ASSERT_EQ(0, m_heap.at(id3).manager().ref_count());
+  ASSERT_EQ(0, m_heap.at(id4).manager().ref_count());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestCollectDeepCycle)
+{
+  const size_t CYCLE_LENGTH = 10000;
+
+  corevm::dyobj::dyobj_id head = help_create_obj();
+  corevm::dyobj::dyobj_id prev = head;
+
+  for (size_t i = 1; i < CYCLE_LENGTH; ++i)
+  {
+    corevm::dyobj::dyobj_id id = help_create_obj();
+    help_setattr(prev, id);
+    prev = id;
+  }
+
+  help_setattr(prev, head);
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(nullptr, { head });
+
+  ASSERT_EQ(CYCLE_LENGTH, m_heap.size());
+
+  collector.gc();
+
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestTraceNtvhndl)
+{
+  /**
+   * Tests GC with obj1 as the root, where the native handle of obj1 refers
+   * to obj2, and obj2 refers to obj3:
+   *
+   * obj1 => [obj2]      obj2 -> obj3      obj4
+   *
+   * will result in 3 objects left on the heap, and in none once obj1 and
+   * its handle are gone. Only obj1 is recorded as a holder, so the handle
+   * of obj4 is never traced.
+   */
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  corevm::dyobj::dyobj_id id3 = help_create_obj();
+  corevm::dyobj::dyobj_id id4 = help_create_obj();
+
+  const corevm::dyobj::ntvhndl_key ntvhndl_key = 7;
+  m_heap.at(id1).set_ntvhndl_key(ntvhndl_key);
+  m_heap.at(id4).set_ntvhndl_key(ntvhndl_key + 1);
+  m_heap.add_ntvhndl_holder(id1);
+  help_setattr(id2, id3);
+
+  uint32_t trace_count = 0;
+
+  _GarbageCollectorType collector(m_heap);
+  collector.set_ntvhndl_tracer(
+    [&](corevm::dyobj::ntvhndl_key key,
+      _GarbageCollectorType::root_set_type& ids) {
+      ASSERT_EQ(ntvhndl_key, key);
+      ids.push_back(id2);
+      ++trace_count;
+    }
+  );
+
+  collector.gc(nullptr, { id1 });
+
+  ASSERT_EQ(1, trace_count);
+  ASSERT_EQ(3, m_heap.size());
+  ASSERT_THROW(m_heap.at(id4), corevm::dyobj::object_not_found_error);
+  ASSERT_EQ(true, m_heap.at(id2).manager().rooted());
+
+  collector.gc(nullptr, {});
+
+  // The handle held by obj1 is gone along with obj1.
+  ASSERT_EQ(2, m_heap.size());
+  ASSERT_THROW(m_heap.at(id1), corevm::dyobj::object_not_found_error);
+  ASSERT_EQ(0, m_heap.ntvhndl_holder_count());
+
+  collector.gc(nullptr, {});
+
+  ASSERT_EQ(0, m_heap.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestDeadObjects)
+{
+  /**
+   * Tests GC with obj1 as the root, on the following object graph:
+   *
+   * obj1      obj2      obj3 <-> obj4
+   *
+   * where obj2 and the cycle of obj3 and obj4 are reported as dead, and are
+   * the only objects the collector reclaims.
+   */
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  corevm::dyobj::dyobj_id id3 = help_create_obj();
+  corevm::dyobj::dyobj_id id4 = help_create_obj();
+
+  help_setattr(id3, id4);
+  help_setattr(id4, id3);
+
+  _GarbageCollectionSchemeType scheme;
+  scheme.gc(m_heap, { id1 });
+
+  _GarbageCollectionSchemeType::root_set_type dead_objects(
+    *scheme.dead_objects());
+  std::sort(dead_objects.begin(), dead_objects.end());
+
+  _GarbageCollectionSchemeType::root_set_type expected { id2, id3, id4 };
+  std::sort(expected.begin(), expected.end());
+
+  ASSERT_EQ(expected, dead_objects);
+  ASSERT_EQ(false, m_heap.at(id1).manager().dead());
+
+  class counting_callback : public _GarbageCollectorType::callback
+  {
+    public:
+      virtual void operator()(
+        const _GarbageCollectorType::dynamic_object_type&)
+      {
+        ++count;
+      }
+
+      size_t count = 0;
+  };
+
+  counting_callback callback;
+
+  _GarbageCollectorType collector(m_heap);
+  collector.gc(&callback, { id1 });
+
+  ASSERT_EQ(3, callback.count);
+  ASSERT_EQ(1, m_heap.size());
+  ASSERT_NO_THROW(m_heap.at(id1));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(reference_count_garbage_collection_unittest, TestZeroCountTable)
+{
+  _GarbageCollectionSchemeType::zero_count_table zero_count_table;
+
+  corevm::dyobj::dyobj_id id1 = help_create_obj();
+  zero_count_table.insert(id1);
+
+  corevm::dyobj::dyobj_id id2 = help_create_obj();
+  zero_count_table.insert(id2);
+
+  help_setattr(id1, id2);
+
+  _GarbageCollectorType collector(m_heap);
+  collector.set_zero_count_table(&zero_count_table);
+  collector.gc(nullptr, { id1 });
+
+  // Only obj1 still has a count of zero.
+  ASSERT_EQ(2, m_heap.size());
+  ASSERT_EQ(1, zero_count_table.size());
+
+  m_heap.at(id1).delattr(id2);
+  m_heap.at(id2).manager().on_delattr();
+  zero_count_table.insert(id2);
+
+  collector.gc(nullptr, { id1 });
+
+  ASSERT_EQ(1, m_heap.size());
+  ASSERT_NO_THROW(m_heap.at(id1));
+  ASSERT_EQ(1, zero_count_table.size());
+
+  collector.gc(nullptr, {});
+
+  ASSERT_EQ(0, m_heap.size());
+  ASSERT_EQ(0, zero_count_table.size());
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "gc/gc_stats.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <sstream>
+#include <string>
+
+
+class gc_stats_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_stats_unittest, TestInitialState)
+{
+  corevm::gc::gc_stats stats;
+
+  ASSERT_EQ(0, stats.cycle_count());
+  ASSERT_EQ(0, stats.minor_cycle_count());
+  ASSERT_EQ(0, stats.mark_time());
+  ASSERT_EQ(0, stats.sweep_time());
+  ASSERT_EQ(0, stats.freed_object_count());
+  ASSERT_EQ(0, stats.freed_ntvhndl_count());
+  ASSERT_EQ(0, stats.last_cycle().slice_count);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_stats_unittest, TestRecordCycles)
+{
+  corevm::gc::gc_stats stats;
+
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.slice_count = 3;
+  cycle.mark_time = 100;
+  cycle.sweep_time = 50;
+  cycle.freed_object_count = 10;
+  cycle.freed_ntvhndl_count = 4;
+
+  stats.record_cycle(cycle);
+
+  cycle.minor = true;
+  cycle.slice_count = 1;
+
+  stats.record_cycle(cycle);
+
+  stats.record_sweep(25, 5, 2);
+
+  ASSERT_EQ(1, stats.cycle_count());
+  ASSERT_EQ(1, stats.minor_cycle_count());
+  ASSERT_EQ(200, stats.mark_time());
+  ASSERT_EQ(125, stats.sweep_time());
+  ASSERT_EQ(25, stats.freed_object_count());
+  ASSERT_EQ(10, stats.freed_ntvhndl_count());
+  ASSERT_EQ(true, stats.last_cycle().minor);
+  ASSERT_EQ(1, stats.last_cycle().slice_count);
+
+  stats.clear();
+
+  ASSERT_EQ(0, stats.cycle_count());
+  ASSERT_EQ(0, stats.freed_object_count());
+  ASSERT_EQ(false, stats.last_cycle().minor);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_stats_unittest, TestOutputStream)
+{
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.start_time = 1000;
+  cycle.end_time = 2000;
+  cycle.slice_count = 1;
+  cycle.mark_time = 600;
+  cycle.sweep_time = 300;
+  cycle.freed_object_count = 2;
+  cycle.freed_ntvhndl_count = 1;
+  cycle.heap_size_before = 5;
+  cycle.heap_size_after = 3;
+  cycle.pool_size_before = 4;
+  cycle.pool_size_after = 3;
+
+  const std::string expected_cycle(
+    "{\"minor\": false, \"start-ns\": 1000, \"end-ns\": 2000, \"slices\": 1, "
+    "\"mark-ns\": 600, \"sweep-ns\": 300, \"freed-objects\": 2, "
+    "\"freed-ntvhndls\": 1, \"heap-size-before\": 5, \"heap-size-after\": 3, "
+    "\"pool-size-before\": 4, \"pool-size-after\": 3}");
+
+  std::stringstream cycle_ss;
+  cycle_ss << cycle;
+
+  ASSERT_EQ(expected_cycle, cycle_ss.str());
+
+  corevm::gc::gc_stats stats;
+  stats.record_cycle(cycle);
+
+  std::stringstream ss;
+  ss << stats;
+
+  ASSERT_EQ(
+    "{\"count\": 1, \"minor-count\": 0, \"mark-ns\": 600, \"sweep-ns\": 300, "
+    "\"freed-objects\": 2, \"freed-ntvhndls\": 1, \"last\": " + expected_cycle + "}",
+    ss.str());
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "gc/mark_worker_pool.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+class mark_worker_pool_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_worker_pool_unittest, TestRunInvokesEveryIndexOnce)
+{
+  corevm::gc::mark_worker_pool pool;
+
+  std::vector<std::atomic<uint32_t>> counts(4);
+  for (auto& count : counts)
+  {
+    count = 0;
+  }
+
+  const std::thread::id caller = std::this_thread::get_id();
+  std::thread::id first;
+
+  pool.run(counts.size(), [&](size_t index) {
+    ++counts[index];
+
+    if (index == 0)
+    {
+      first = std::this_thread::get_id();
+    }
+  });
+
+  for (size_t i = 0; i < counts.size(); ++i)
+  {
+    ASSERT_EQ(1, counts[i]);
+  }
+
+  ASSERT_EQ(caller, first);
+  ASSERT_EQ(3, pool.thread_count());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_worker_pool_unittest, TestThreadsAreReused)
+{
+  corevm::gc::mark_worker_pool pool;
+
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+
+  auto task = [&](size_t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_ids.insert(std::this_thread::get_id());
+  };
+
+  for (size_t i = 0; i < 100; ++i)
+  {
+    pool.run(4, task);
+  }
+
+  // Smaller runs leave the extra threads idle.
+  pool.run(2, task);
+  pool.run(1, task);
+
+  ASSERT_EQ(3, pool.thread_count());
+  ASSERT_EQ(4, thread_ids.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(mark_worker_pool_unittest, TestRunRethrows)
+{
+  corevm::gc::mark_worker_pool pool;
+
+  std::atomic<uint32_t> count(0);
+
+  ASSERT_THROW(
+    pool.run(3, [&](size_t index) {
+      ++count;
+
+      if (index == 2)
+      {
+        throw std::runtime_error("task failed");
+      }
+    }),
+    std::runtime_error
+  );
+
+  ASSERT_EQ(3, count);
+
+  // The pool remains usable.
+  count = 0;
+  pool.run(3, [&](size_t) { ++count; });
+  ASSERT_EQ(3, count);
+}
+
+// -----------------------------------------------------------------------------
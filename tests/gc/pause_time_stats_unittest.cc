@@ -0,0 +1,136 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "gc/pause_time_stats.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <sstream>
+#include <vector>
+
+
+class pause_time_stats_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(pause_time_stats_unittest, TestInitialState)
+{
+  corevm::gc::pause_time_stats stats;
+
+  ASSERT_EQ(0, stats.count());
+  ASSERT_EQ(0, stats.total());
+  ASSERT_EQ(0, stats.max());
+  ASSERT_EQ(0, stats.percentile(50));
+  ASSERT_EQ(true, stats.histogram().empty());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(pause_time_stats_unittest, TestPercentiles)
+{
+  corevm::gc::pause_time_stats stats;
+
+  // Record 100, 99, ..., 1.
+  for (uint64_t i = 100; i > 0; --i)
+  {
+    stats.record(i);
+  }
+
+  ASSERT_EQ(100, stats.count());
+  ASSERT_EQ(5050, stats.total());
+  ASSERT_EQ(100, stats.max());
+
+  ASSERT_EQ(1, stats.percentile(0));
+  ASSERT_EQ(50, stats.percentile(50));
+  ASSERT_EQ(90, stats.percentile(90));
+  ASSERT_EQ(99, stats.percentile(99));
+  ASSERT_EQ(100, stats.percentile(100));
+
+  stats.clear();
+
+  ASSERT_EQ(0, stats.count());
+  ASSERT_EQ(0, stats.max());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(pause_time_stats_unittest, TestPercentilesOfSampledPauses)
+{
+  corevm::gc::pause_time_stats stats;
+
+  const uint64_t count =
+    corevm::gc::pause_time_stats::SAMPLE_RESERVOIR_SIZE * 64;
+
+  for (uint64_t i = 1; i <= count; ++i)
+  {
+    stats.record(i);
+  }
+
+  ASSERT_EQ(count, stats.count());
+  ASSERT_EQ(count, stats.max());
+
+  // Sampled percentiles stay close to the exact ones.
+  ASSERT_NEAR(count * 0.5, stats.percentile(50), count * 0.05);
+  ASSERT_NEAR(count * 0.9, stats.percentile(90), count * 0.05);
+  ASSERT_NEAR(count * 0.99, stats.percentile(99), count * 0.05);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(pause_time_stats_unittest, TestOutputStream)
+{
+  corevm::gc::pause_time_stats stats;
+
+  stats.record(10);
+  stats.record(30);
+
+  std::stringstream ss;
+  ss << stats;
+
+  ASSERT_EQ(
+    "{\"count\": 2, \"total-ns\": 40, \"p50-ns\": 10, \"p90-ns\": 30, "
+    "\"p99-ns\": 30, \"max-ns\": 30, \"histogram-us\": {\"1\": 2}}",
+    ss.str());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(pause_time_stats_unittest, TestHistogram)
+{
+  corevm::gc::pause_time_stats stats;
+
+  stats.record(999);
+  stats.record(1000);
+  stats.record(1999);
+  stats.record(2000);
+  stats.record(7999);
+
+  const std::vector<uint64_t> expected_histogram { 1, 2, 1, 1 };
+
+  ASSERT_EQ(expected_histogram, stats.histogram());
+
+  stats.clear();
+
+  ASSERT_EQ(true, stats.histogram().empty());
+}
+
+// -----------------------------------------------------------------------------
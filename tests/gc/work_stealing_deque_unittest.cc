@@ -0,0 +1,162 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "gc/work_stealing_deque.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+class work_stealing_deque_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(work_stealing_deque_unittest, TestPushAndPop)
+{
+  corevm::gc::work_stealing_deque<uint64_t> deque;
+
+  ASSERT_EQ(true, deque.empty());
+
+  deque.push(1);
+  deque.push(2);
+  deque.push(3);
+
+  ASSERT_EQ(false, deque.empty());
+
+  uint64_t value = 0;
+
+  // Owners pop the most recent element, thieves the oldest.
+  ASSERT_EQ(true, deque.pop(&value));
+  ASSERT_EQ(3, value);
+
+  ASSERT_EQ(true, deque.steal(&value));
+  ASSERT_EQ(1, value);
+
+  ASSERT_EQ(true, deque.pop(&value));
+  ASSERT_EQ(2, value);
+
+  ASSERT_EQ(true, deque.empty());
+  ASSERT_EQ(false, deque.pop(&value));
+  ASSERT_EQ(false, deque.steal(&value));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(work_stealing_deque_unittest, TestGrowth)
+{
+  const uint64_t COUNT = 1000;
+
+  corevm::gc::work_stealing_deque<uint64_t> deque(4);
+
+  for (uint64_t i = 0; i < COUNT; ++i)
+  {
+    deque.push(i);
+  }
+
+  uint64_t value = 0;
+
+  for (uint64_t i = 0; i < COUNT / 2; ++i)
+  {
+    ASSERT_EQ(true, deque.steal(&value));
+    ASSERT_EQ(i, value);
+  }
+
+  for (uint64_t i = COUNT; i > COUNT / 2; --i)
+  {
+    ASSERT_EQ(true, deque.pop(&value));
+    ASSERT_EQ(i - 1, value);
+  }
+
+  ASSERT_EQ(true, deque.empty());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(work_stealing_deque_unittest, TestConcurrentSteals)
+{
+  const uint64_t COUNT = 200000;
+  const size_t THIEF_COUNT = 3;
+
+  corevm::gc::work_stealing_deque<uint64_t> deque(2);
+
+  // How many times each element was taken.
+  std::vector<std::atomic<uint32_t>> taken(COUNT);
+  for (auto& count : taken)
+  {
+    count = 0;
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+
+  for (size_t i = 0; i < THIEF_COUNT; ++i)
+  {
+    thieves.emplace_back([&]() {
+      uint64_t value = 0;
+
+      while (!done || !deque.empty())
+      {
+        if (deque.steal(&value))
+        {
+          ++taken[value];
+        }
+      }
+    });
+  }
+
+  // The owner pops every other push, so the deque keeps growing and
+  // shrinking while the thieves take from the other end.
+  uint64_t value = 0;
+
+  for (uint64_t i = 0; i < COUNT; ++i)
+  {
+    deque.push(i);
+
+    if (i % 2 && deque.pop(&value))
+    {
+      ++taken[value];
+    }
+  }
+
+  while (deque.pop(&value))
+  {
+    ++taken[value];
+  }
+
+  done = true;
+
+  for (auto itr = thieves.begin(); itr != thieves.end(); ++itr)
+  {
+    itr->join();
+  }
+
+  for (uint64_t i = 0; i < COUNT; ++i)
+  {
+    ASSERT_EQ(1, taken[i]);
+  }
+}
+
+// -----------------------------------------------------------------------------
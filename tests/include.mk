@@ -27,14 +27,21 @@ RUNTIME=runtime
 FRONTEND=frontend
 
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/allocation_policy_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/allocation_trace_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/allocator_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/arena_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/object_container_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(MEMORY)/size_class_allocator_unittest.cc
 
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(DYOBJ)/dynamic_object_heap_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(DYOBJ)/dynamic_object_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(DYOBJ)/heap_allocator_unittest.cc
 
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(GC)/garbage_collection_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(GC)/gc_stats_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(GC)/mark_worker_pool_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(GC)/pause_time_stats_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(GC)/work_stealing_deque_unittest.cc
 
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/interfaces_test.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/native_array_type_interfaces_test.cc
@@ -44,6 +51,8 @@ TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/native_map_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/native_string_type_interfaces_test.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/native_string_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/native_type_handle_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/number_format_unittest.cc
+TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(TYPES)/string_intern_table_unittest.cc
 
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(RUNTIME)/compartment_unittest.cc
 TEST_SOURCES += $(TOP_DIR)/$(TESTS)/$(RUNTIME)/frame_unittest.cc
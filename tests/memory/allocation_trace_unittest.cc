@@ -0,0 +1,239 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "memory/allocation_trace.h"
+#include "memory/allocator.h"
+#include "memory/sequential_allocation_scheme.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <unordered_map>
+
+
+class allocation_trace_unittest : public ::testing::Test
+{
+protected:
+  /**
+   * Checks that every deallocation in the trace matches an earlier
+   * allocation of the same size, and that nothing is left allocated.
+   */
+  void validate_balanced(const corevm::memory::allocation_trace& trace,
+    uint64_t min_size, uint64_t max_size)
+  {
+    std::unordered_map<uint64_t, uint64_t> live;
+
+    for (auto itr = trace.cbegin(); itr != trace.cend(); ++itr)
+    {
+      if (itr->type == corevm::memory::allocation_trace::ALLOCATE)
+      {
+        ASSERT_LE(min_size, itr->size);
+        ASSERT_GE(max_size, itr->size);
+        ASSERT_EQ(live.end(), live.find(itr->offset));
+        live[itr->offset] = itr->size;
+      }
+      else
+      {
+        ASSERT_EQ(corevm::memory::allocation_trace::DEALLOCATE, itr->type);
+        ASSERT_NE(live.end(), live.find(itr->offset));
+        ASSERT_EQ(live[itr->offset], itr->size);
+        live.erase(itr->offset);
+      }
+    }
+
+    ASSERT_EQ(true, live.empty());
+  }
+
+  static const char* PATH;
+};
+
+// -----------------------------------------------------------------------------
+
+const char* allocation_trace_unittest::PATH = "./allocation-trace-unittest.trace";
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestRecord)
+{
+  corevm::memory::allocation_trace trace;
+
+  ASSERT_EQ(0, trace.size());
+
+  trace.record(corevm::memory::allocation_trace::ALLOCATE, 16, 0);
+  trace.record(corevm::memory::allocation_trace::DEALLOCATE, 16, 0);
+
+  ASSERT_EQ(2, trace.size());
+  ASSERT_EQ(corevm::memory::allocation_trace::ALLOCATE, trace[0].type);
+  ASSERT_EQ(corevm::memory::allocation_trace::DEALLOCATE, trace[1].type);
+  ASSERT_EQ(16, trace[1].size);
+  ASSERT_LE(trace[0].timestamp, trace[1].timestamp);
+
+  trace.clear();
+
+  ASSERT_EQ(0, trace.size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestAllocatorRecordsTrace)
+{
+  corevm::memory::allocation_trace trace;
+  corevm::memory::allocator<corevm::memory::first_fit_allocation_scheme> allocator(1024);
+
+  allocator.set_trace(&trace);
+
+  void* p1 = allocator.allocate(100);
+  void* p2 = allocator.allocate(200);
+
+  ASSERT_NE(nullptr, p1);
+  ASSERT_NE(nullptr, p2);
+
+  allocator.deallocate(p1);
+
+  allocator.set_trace(nullptr);
+
+  allocator.deallocate(p2);
+
+  ASSERT_EQ(3, trace.size());
+
+  ASSERT_EQ(corevm::memory::allocation_trace::ALLOCATE, trace[0].type);
+  ASSERT_EQ(100, trace[0].size);
+  ASSERT_EQ(0, trace[0].offset);
+
+  ASSERT_EQ(corevm::memory::allocation_trace::ALLOCATE, trace[1].type);
+  ASSERT_EQ(200, trace[1].size);
+  ASSERT_EQ(100, trace[1].offset);
+
+  ASSERT_EQ(corevm::memory::allocation_trace::DEALLOCATE, trace[2].type);
+  ASSERT_EQ(100, trace[2].size);
+  ASSERT_EQ(0, trace[2].offset);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestSaveAndLoad)
+{
+  corevm::memory::allocation_trace trace;
+  corevm::memory::allocation_trace::generate_steady_state(trace, 100, 8, 64, 1);
+
+  trace.save(PATH);
+
+  corevm::memory::allocation_trace loaded_trace;
+  loaded_trace.load(PATH);
+
+  remove(PATH);
+
+  ASSERT_EQ(trace.size(), loaded_trace.size());
+
+  for (size_t i = 0; i < trace.size(); ++i)
+  {
+    ASSERT_EQ(trace[i].type, loaded_trace[i].type);
+    ASSERT_EQ(trace[i].size, loaded_trace[i].size);
+    ASSERT_EQ(trace[i].offset, loaded_trace[i].offset);
+    ASSERT_EQ(trace[i].timestamp, loaded_trace[i].timestamp);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestLoadFailsWithInvalidFile)
+{
+  corevm::memory::allocation_trace trace;
+
+  ASSERT_THROW(
+    {
+      trace.load("$%^some-invalid-path!@#");
+    },
+    corevm::memory::allocation_trace_error
+  );
+
+  std::ofstream f(PATH, std::ios::binary);
+  f << "not a trace";
+  f.close();
+
+  ASSERT_THROW(
+    {
+      trace.load(PATH);
+    },
+    corevm::memory::allocation_trace_error
+  );
+
+  remove(PATH);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestGenerateSteadyState)
+{
+  corevm::memory::allocation_trace trace;
+  corevm::memory::allocation_trace::generate_steady_state(trace, 1000, 8, 64, 1);
+
+  ASSERT_EQ(2000, trace.size());
+  validate_balanced(trace, 8, 64);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestGenerateBursty)
+{
+  corevm::memory::allocation_trace trace;
+  corevm::memory::allocation_trace::generate_bursty(trace, 1000, 8, 64, 1);
+
+  ASSERT_EQ(2000, trace.size());
+  validate_balanced(trace, 8, 64);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestGenerateLifetimeMix)
+{
+  corevm::memory::allocation_trace trace;
+  corevm::memory::allocation_trace::generate_lifetime_mix(trace, 1000, 8, 64, 1);
+
+  ASSERT_EQ(2000, trace.size());
+  validate_balanced(trace, 8, 64);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(allocation_trace_unittest, TestGeneratorsAreDeterministic)
+{
+  corevm::memory::allocation_trace trace1;
+  corevm::memory::allocation_trace trace2;
+
+  corevm::memory::allocation_trace::generate_bursty(trace1, 500, 8, 64, 7);
+  corevm::memory::allocation_trace::generate_bursty(trace2, 500, 8, 64, 7);
+
+  ASSERT_EQ(trace1.size(), trace2.size());
+
+  for (size_t i = 0; i < trace1.size(); ++i)
+  {
+    ASSERT_EQ(trace1[i].type, trace2[i].type);
+    ASSERT_EQ(trace1[i].size, trace2[i].size);
+    ASSERT_EQ(trace1[i].offset, trace2[i].offset);
+  }
+}
+
+// -----------------------------------------------------------------------------
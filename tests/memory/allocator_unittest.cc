@@ -20,7 +20,9 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
+#include "memory/allocation_stats.h"
 #include "memory/allocator.h"
+#include "memory/arena.h"
 #include "memory/sequential_allocation_scheme.h"
 
 #include <sneaker/testing/_unittest.h>
@@ -140,6 +142,56 @@ TYPED_TEST(allocator_unittest, TestMallocFreeOnFullSpaceCycleSuccessful)
 
 // -----------------------------------------------------------------------------
 
+TYPED_TEST(allocator_unittest, TestStats)
+{
+  corevm::memory::allocation_stats stats = this->m_allocator.stats();
+
+  ASSERT_EQ(0, stats.alloc_count);
+  ASSERT_EQ(0, stats.free_count);
+  ASSERT_EQ(0, stats.allocated_size);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST, stats.free_size);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST, stats.largest_free_block_size);
+
+  void* p1 = this->allocate(HEAP_STORAGE_FOR_TEST / 4);
+  ASSERT_NE(nullptr, p1);
+
+  void* p2 = this->allocate(HEAP_STORAGE_FOR_TEST / 4);
+  ASSERT_NE(nullptr, p2);
+
+  stats = this->m_allocator.stats();
+
+  ASSERT_EQ(2, stats.alloc_count);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST / 2, stats.allocated_size);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST / 2, stats.peak_allocated_size);
+  ASSERT_LT(0, stats.free_block_count);
+
+  ASSERT_EQ(1, this->deallocate(p1));
+
+  stats = this->m_allocator.stats();
+
+  ASSERT_EQ(1, stats.free_count);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST / 4, stats.allocated_size);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST / 2, stats.peak_allocated_size);
+  ASSERT_LE(stats.largest_free_block_size, stats.free_size);
+  ASSERT_LE(0.0, stats.fragmentation_ratio());
+  ASSERT_GT(1.0, stats.fragmentation_ratio());
+
+  ASSERT_EQ(1, this->deallocate(p2));
+
+  stats = this->m_allocator.stats();
+
+  ASSERT_EQ(0, stats.allocated_size);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST, stats.free_size);
+  ASSERT_EQ(0.0, stats.fragmentation_ratio());
+
+#if !COREVM_ALLOCATION_TIMING
+  ASSERT_EQ(0, stats.find_fit_time);
+  ASSERT_EQ(0, stats.combine_free_blocks_time);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
 template<typename AllocationSchemeType>
 class sequential_allocation_schemes_unittest :
   public allocator_unittest<AllocationSchemeType>
@@ -161,6 +213,51 @@ TYPED_TEST_CASE(sequential_allocation_schemes_unittest, ExtraAllocationSchemeTyp
 
 // -----------------------------------------------------------------------------
 
+TYPED_TEST(sequential_allocation_schemes_unittest, TestCompact)
+{
+  const size_t CHUNK_SIZE = HEAP_STORAGE_FOR_TEST / 8;
+
+  void* p1 = this->allocate(CHUNK_SIZE);
+  void* p2 = this->allocate(CHUNK_SIZE);
+  void* p3 = this->allocate(CHUNK_SIZE);
+
+  ASSERT_NE(nullptr, p1);
+  ASSERT_NE(nullptr, p2);
+  ASSERT_NE(nullptr, p3);
+
+  memset(p3, 3, CHUNK_SIZE);
+
+  ASSERT_EQ(1, this->deallocate(p1));
+  ASSERT_EQ(1, this->deallocate(p2));
+
+  std::vector<void*> moves;
+
+  bool res = this->m_allocator.compact(
+    [&moves](void* from, void* to, size_t size) {
+      memmove(to, from, size);
+      moves.push_back(from);
+      moves.push_back(to);
+    }
+  );
+
+  ASSERT_EQ(true, res);
+  ASSERT_EQ(2, moves.size());
+  ASSERT_EQ(p3, moves[0]);
+  ASSERT_EQ(p1, moves[1]);
+  ASSERT_EQ(3, static_cast<uint8_t*>(p1)[CHUNK_SIZE - 1]);
+
+  corevm::memory::allocation_stats stats = this->m_allocator.stats();
+
+  ASSERT_EQ(1, stats.free_block_count);
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST - CHUNK_SIZE, stats.largest_free_block_size);
+
+  ASSERT_EQ(1, this->deallocate(p1));
+}
+
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+
 TYPED_TEST(sequential_allocation_schemes_unittest, TestDoubleMallocAndFree)
 {
   size_t size1 = HEAP_STORAGE_FOR_TEST / 2;
@@ -293,6 +390,74 @@ TYPED_TEST(sequential_allocation_schemes_unittest, TestAllocationOverTotalSize)
 
 // -----------------------------------------------------------------------------
 
+TYPED_TEST(sequential_allocation_schemes_unittest, TestAllocationGrowsPastTotalSize)
+{
+  const uint64_t max_total_size = HEAP_STORAGE_FOR_TEST * 4;
+
+  corevm::memory::allocator<TypeParam> allocator(
+    HEAP_STORAGE_FOR_TEST, max_total_size);
+
+  ASSERT_EQ(HEAP_STORAGE_FOR_TEST, allocator.total_size());
+  ASSERT_EQ(max_total_size, allocator.max_total_size());
+
+  void* p1 = allocator.allocate(HEAP_STORAGE_FOR_TEST);
+  ASSERT_NE(nullptr, p1);
+
+  void* p2 = allocator.allocate(HEAP_STORAGE_FOR_TEST * 2);
+  ASSERT_NE(nullptr, p2);
+
+  ASSERT_LT(HEAP_STORAGE_FOR_TEST, allocator.total_size());
+  ASSERT_GE(max_total_size, allocator.total_size());
+
+  // Existing allocations never move.
+  memset(p1, 1, HEAP_STORAGE_FOR_TEST);
+  memset(p2, 2, HEAP_STORAGE_FOR_TEST * 2);
+
+  void* p3 = allocator.allocate(max_total_size);
+  ASSERT_EQ(nullptr, p3);
+
+  ASSERT_EQ(1, allocator.deallocate(p1));
+  ASSERT_EQ(1, allocator.deallocate(p2));
+}
+
+// -----------------------------------------------------------------------------
+
+TYPED_TEST(sequential_allocation_schemes_unittest, TestReleaseFreeMemory)
+{
+  const uint64_t page_size = corevm::memory::arena::page_size();
+  const uint64_t total_size = page_size * 8;
+
+  corevm::memory::allocator<TypeParam> allocator(total_size);
+
+  ASSERT_EQ(0, allocator.committed_size());
+
+  void* p1 = allocator.allocate(page_size * 4);
+  ASSERT_NE(nullptr, p1);
+
+  ASSERT_LE(page_size * 4, allocator.committed_size());
+
+  memset(p1, 1, page_size * 4);
+
+  ASSERT_EQ(0, allocator.reclaimable_size());
+
+  ASSERT_EQ(1, allocator.deallocate(p1));
+
+  ASSERT_EQ(page_size * 4, allocator.reclaimable_size());
+
+  ASSERT_LE(page_size * 4, allocator.release_free_memory());
+
+  ASSERT_EQ(0, allocator.reclaimable_size());
+
+  void* p2 = allocator.allocate(page_size * 4);
+  ASSERT_NE(nullptr, p2);
+
+  ASSERT_EQ(0, static_cast<uint8_t*>(p2)[0]);
+
+  ASSERT_EQ(1, allocator.deallocate(p2));
+}
+
+// -----------------------------------------------------------------------------
+
 const int BUDDY_ALLOCATION_SCHEME_TEST_HEAP_SIZE = 1024;
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "memory/arena.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <cstdint>
+#include <cstring>
+
+
+class arena_unittest : public ::testing::Test
+{
+protected:
+  static const uint64_t PAGE_SIZE;
+};
+
+// -----------------------------------------------------------------------------
+
+const uint64_t arena_unittest::PAGE_SIZE = corevm::memory::arena::page_size();
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestInitialization)
+{
+  corevm::memory::arena arena(PAGE_SIZE * 4);
+
+  ASSERT_NE(nullptr, arena.base());
+  ASSERT_EQ(PAGE_SIZE * 4, arena.reserved_size());
+  ASSERT_EQ(0, arena.committed_size());
+  ASSERT_EQ(0, arena.flags());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestReservedSizeRoundedToPageSize)
+{
+  corevm::memory::arena arena(PAGE_SIZE + 1);
+
+  ASSERT_EQ(PAGE_SIZE * 2, arena.reserved_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestCommit)
+{
+  corevm::memory::arena arena(PAGE_SIZE * 4);
+
+  ASSERT_EQ(true, arena.commit(1));
+  ASSERT_LE(PAGE_SIZE, arena.committed_size());
+  ASSERT_GE(arena.reserved_size(), arena.committed_size());
+
+  uint8_t* base = static_cast<uint8_t*>(arena.base());
+  memset(base, 1, PAGE_SIZE);
+
+  ASSERT_EQ(true, arena.commit(PAGE_SIZE * 4));
+  ASSERT_EQ(PAGE_SIZE * 4, arena.committed_size());
+
+  memset(base, 1, PAGE_SIZE * 4);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestCommitBeyondReservationFails)
+{
+  corevm::memory::arena arena(PAGE_SIZE);
+
+  ASSERT_EQ(false, arena.commit(PAGE_SIZE + 1));
+  ASSERT_EQ(0, arena.committed_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestRelease)
+{
+  corevm::memory::arena arena(PAGE_SIZE * 4);
+
+  ASSERT_EQ(true, arena.commit(PAGE_SIZE * 4));
+
+  uint8_t* base = static_cast<uint8_t*>(arena.base());
+  memset(base, 0, PAGE_SIZE * 4);
+
+  // Only whole pages within the range are released.
+  ASSERT_EQ(PAGE_SIZE * 2, arena.release(1, PAGE_SIZE * 3));
+  ASSERT_EQ(0, arena.release(1, PAGE_SIZE));
+
+  // Released pages stay accessible.
+  base[PAGE_SIZE] = 1;
+  ASSERT_EQ(1, base[PAGE_SIZE]);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestReleaseUncommittedMemory)
+{
+  corevm::memory::arena arena(PAGE_SIZE * 4);
+
+  ASSERT_EQ(0, arena.release(0, PAGE_SIZE * 4));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(arena_unittest, TestCommitWithFlags)
+{
+  corevm::memory::arena arena(
+    PAGE_SIZE * 4,
+    corevm::memory::arena::ARENA_USE_HUGE_PAGES | corevm::memory::arena::ARENA_PREFAULT);
+
+  ASSERT_EQ(true, arena.commit(PAGE_SIZE * 4));
+
+  uint8_t* base = static_cast<uint8_t*>(arena.base());
+  ASSERT_EQ(0, base[0]);
+  ASSERT_EQ(0, base[PAGE_SIZE * 4 - 1]);
+}
+
+// -----------------------------------------------------------------------------
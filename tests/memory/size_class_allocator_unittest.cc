@@ -0,0 +1,230 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "memory/payload_allocator.h"
+#include "memory/size_class_allocator.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+const uint64_t RESERVED_SIZE = 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+
+class size_class_allocator_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestInitialization)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  ASSERT_EQ(0, allocator.allocated_size());
+  ASSERT_EQ(0, allocator.used_size());
+  ASSERT_LE(RESERVED_SIZE, allocator.reserved_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestBlockSize)
+{
+  typedef corevm::memory::size_class_allocator allocator_type;
+
+  ASSERT_EQ(allocator_type::MIN_BLOCK_SIZE, allocator_type::block_size(1));
+  ASSERT_EQ(32, allocator_type::block_size(17));
+  ASSERT_EQ(1024, allocator_type::block_size(1024));
+  ASSERT_EQ(allocator_type::MAX_BLOCK_SIZE, allocator_type::block_size(allocator_type::MAX_BLOCK_SIZE));
+  ASSERT_LE(allocator_type::MAX_BLOCK_SIZE + 1, allocator_type::block_size(allocator_type::MAX_BLOCK_SIZE + 1));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestAllocateAndDeallocate)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  void* p1 = allocator.allocate(10);
+  ASSERT_NE(nullptr, p1);
+
+  void* p2 = allocator.allocate(100);
+  ASSERT_NE(nullptr, p2);
+
+  ASSERT_NE(p1, p2);
+
+  memset(p1, 1, 10);
+  memset(p2, 2, 100);
+
+  ASSERT_EQ(110, allocator.allocated_size());
+  ASSERT_EQ(16 + 128, allocator.used_size());
+
+  allocator.deallocate(p1, 10);
+  allocator.deallocate(p2, 100);
+
+  ASSERT_EQ(0, allocator.allocated_size());
+  ASSERT_EQ(0, allocator.used_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestFreedBlocksAreReused)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  void* p1 = allocator.allocate(24);
+  allocator.deallocate(p1, 24);
+
+  void* p2 = allocator.allocate(32);
+  ASSERT_EQ(p1, p2);
+
+  allocator.deallocate(p2, 32);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestLargeAllocation)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  const size_t size = corevm::memory::size_class_allocator::MAX_BLOCK_SIZE * 2;
+
+  void* p = allocator.allocate(size);
+  ASSERT_NE(nullptr, p);
+
+  memset(p, 1, size);
+
+  ASSERT_EQ(size, allocator.allocated_size());
+
+  allocator.deallocate(p, size);
+
+  ASSERT_EQ(0, allocator.allocated_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestAllocationBeyondReservedSize)
+{
+  corevm::memory::size_class_allocator allocator(
+    corevm::memory::size_class_allocator::MAX_BLOCK_SIZE);
+
+  const size_t size = corevm::memory::size_class_allocator::MAX_BLOCK_SIZE;
+
+  void* p1 = allocator.allocate(size);
+  ASSERT_NE(nullptr, p1);
+
+  // Falls back to the global heap.
+  void* p2 = allocator.allocate(size);
+  ASSERT_NE(nullptr, p2);
+
+  memset(p2, 1, size);
+
+  allocator.deallocate(p1, size);
+  allocator.deallocate(p2, size);
+
+  ASSERT_EQ(0, allocator.allocated_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestReleaseFreeMemory)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  const size_t size = corevm::memory::size_class_allocator::MAX_BLOCK_SIZE;
+
+  void* p = allocator.allocate(size);
+  memset(p, 1, size);
+  allocator.deallocate(p, size);
+
+  ASSERT_EQ(size, allocator.release_free_memory());
+
+  // Released blocks can be handed out again.
+  void* p2 = allocator.allocate(size);
+  ASSERT_EQ(p, p2);
+
+  memset(p2, 1, size);
+
+  allocator.deallocate(p2, size);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(size_class_allocator_unittest, TestReleaseFreeMemoryOfPageSizedBlocks)
+{
+  corevm::memory::size_class_allocator allocator(RESERVED_SIZE);
+
+  const size_t page_size = corevm::memory::arena::page_size();
+
+  // A small block first, so that the arena offset is not page-aligned.
+  void* small = allocator.allocate(1);
+
+  void* p1 = allocator.allocate(page_size);
+  void* p2 = allocator.allocate(page_size);
+
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p1) % page_size);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p2) % page_size);
+
+  memset(p1, 1, page_size);
+  memset(p2, 1, page_size);
+
+  allocator.deallocate(p1, page_size);
+  allocator.deallocate(p2, page_size);
+
+  // Whole blocks are released, and only once.
+  ASSERT_EQ(page_size * 2, allocator.release_free_memory());
+  ASSERT_EQ(0, allocator.release_free_memory());
+
+  void* p3 = allocator.allocate(page_size);
+  memset(p3, 1, page_size);
+  allocator.deallocate(p3, page_size);
+
+  ASSERT_EQ(page_size, allocator.release_free_memory());
+
+  allocator.deallocate(small, 1);
+}
+
+// -----------------------------------------------------------------------------
+
+class payload_allocator_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(payload_allocator_unittest, TestPayloadAccounting)
+{
+  uint64_t allocated_size = corevm::memory::payload_heap().allocated_size();
+
+  {
+    std::vector<uint64_t, corevm::memory::payload_allocator<uint64_t>> vec(100);
+
+    ASSERT_EQ(
+      allocated_size + 100 * sizeof(uint64_t),
+      corevm::memory::payload_heap().allocated_size());
+  }
+
+  ASSERT_EQ(allocated_size, corevm::memory::payload_heap().allocated_size());
+}
+
+// -----------------------------------------------------------------------------
@@ -328,6 +328,284 @@ TEST_F(instrs_obj_unittest, TestInstrDELATTR)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_obj_unittest, TestInstrGETATTRW)
+{
+  corevm::runtime::compartment_id compartment_id = 0;
+  corevm::runtime::compartment compartment(DUMMY_PATH);
+
+  uint64_t attr_str_key = 333;
+  const std::string attr_str = "Hello world";
+
+  corevm::runtime::encoding_map encoding_table {
+    { attr_str_key, attr_str }
+  };
+
+  compartment.set_encoding_map(encoding_table);
+  m_process.insert_compartment(compartment);
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = compartment_id,
+    .closure_id = corevm::runtime::NONESET_CLOSURE_ID,
+  };
+  m_process.emplace_frame(ctx);
+
+  corevm::runtime::instr instr { .code=0, .oprd1=attr_str_key, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id1 = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id id2 = process::adapter(m_process).help_create_dyobj();
+
+  auto &obj = process::adapter(m_process).help_get_dyobj(id1);
+  corevm::dyobj::attr_key attr_key = corevm::dyobj::hash_attr_str(attr_str);
+  obj.putweakattr(attr_key, id2);
+  m_process.push_stack(id1);
+
+  execute_instr<corevm::runtime::instr_handler_getattrw>(instr, 1);
+
+  ASSERT_EQ(id2, m_process.top_stack());
+
+  // Strong attributes are not visible as weak ones.
+  m_process.pop_stack();
+  obj.delweakattr(attr_key);
+  obj.putattr(attr_key, id2);
+  m_process.push_stack(id1);
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_getattrw>(instr, 0);
+    },
+    corevm::dyobj::object_attribute_not_found_error
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrSETATTRW)
+{
+  corevm::runtime::compartment_id compartment_id = 0;
+  corevm::runtime::compartment compartment(DUMMY_PATH);
+
+  uint64_t attr_str_key = 333;
+  const std::string attr_str = "Hello world";
+
+  corevm::runtime::encoding_map encoding_table {
+    { attr_str_key, attr_str }
+  };
+
+  compartment.set_encoding_map(encoding_table);
+  m_process.insert_compartment(compartment);
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = compartment_id,
+    .closure_id = corevm::runtime::NONESET_CLOSURE_ID,
+  };
+
+  m_process.emplace_frame(ctx);
+
+  corevm::runtime::instr instr { .code=0, .oprd1=attr_str_key, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id1 = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id id2 = process::adapter(m_process).help_create_dyobj();
+
+  m_process.push_stack(id1);
+  m_process.push_stack(id2);
+
+  execute_instr<corevm::runtime::instr_handler_setattrw>(instr, 1);
+
+  ASSERT_EQ(id1, m_process.top_stack());
+
+  auto &obj = process::adapter(m_process).help_get_dyobj(id1);
+
+  corevm::dyobj::attr_key attr_key = corevm::dyobj::hash_attr_str(attr_str);
+
+  ASSERT_FALSE(obj.hasattr(attr_key));
+  ASSERT_TRUE(obj.hasweakattr(attr_key));
+  ASSERT_EQ(id2, obj.getweakattr(attr_key));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrDELATTRW)
+{
+  corevm::dyobj::attr_key attr_key = 777;
+  corevm::runtime::instr instr { .code=0, .oprd1=attr_key, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id attr_id = process::adapter(m_process).help_create_dyobj();
+
+  auto& obj = process::adapter(m_process).help_get_dyobj(id);
+  obj.putweakattr(attr_key, attr_id);
+
+  m_process.push_stack(id);
+
+  execute_instr<corevm::runtime::instr_handler_delattrw>(instr, 1);
+
+  ASSERT_EQ(id, m_process.top_stack());
+  ASSERT_FALSE(obj.hasweakattr(attr_key));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrSETEPHAndGETEPH)
+{
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id key_id = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id value_id = process::adapter(m_process).help_create_dyobj();
+
+  m_process.push_stack(id);
+  m_process.push_stack(key_id);
+  m_process.push_stack(value_id);
+
+  execute_instr<corevm::runtime::instr_handler_seteph>(instr, 1);
+
+  ASSERT_EQ(id, m_process.top_stack());
+
+  auto& obj = process::adapter(m_process).help_get_dyobj(id);
+
+  ASSERT_EQ(1, obj.ephemeron_count());
+  ASSERT_EQ(value_id, obj.getephemeron(key_id));
+
+  m_process.push_stack(key_id);
+
+  execute_instr<corevm::runtime::instr_handler_geteph>(instr, 1);
+
+  ASSERT_EQ(value_id, m_process.top_stack());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrDELEPH)
+{
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id key_id = process::adapter(m_process).help_create_dyobj();
+  corevm::dyobj::dyobj_id value_id = process::adapter(m_process).help_create_dyobj();
+
+  auto& obj = process::adapter(m_process).help_get_dyobj(id);
+  obj.putephemeron(key_id, value_id);
+
+  m_process.push_stack(id);
+  m_process.push_stack(key_id);
+
+  execute_instr<corevm::runtime::instr_handler_deleph>(instr, 1);
+
+  ASSERT_EQ(id, m_process.top_stack());
+  ASSERT_FALSE(obj.hasephemeron(key_id));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrFREEZE)
+{
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  auto& obj = process::adapter(m_process).help_get_dyobj(id);
+
+  m_process.push_stack(id);
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_freeze>(instr, 1);
+    },
+    corevm::runtime::invalid_operation_error
+  );
+
+  obj.set_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE);
+
+  execute_instr<corevm::runtime::instr_handler_freeze>(instr, 1);
+
+  ASSERT_EQ(id, m_process.top_stack());
+  ASSERT_TRUE(obj.is_frozen());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrNEWIMM)
+{
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  corevm::runtime::frame frame(m_ctx);
+  m_process.push_frame(frame);
+
+  size_t heap_size = m_process.heap_size();
+
+  corevm::types::native_type_handle hndl = corevm::types::int64(123);
+  m_process.top_frame().push_eval_stack(hndl);
+
+  execute_instr<corevm::runtime::instr_handler_newimm>(instr, 1);
+
+  ASSERT_TRUE(corevm::dyobj::is_immediate(m_process.top_stack()));
+  ASSERT_EQ(heap_size, m_process.heap_size());
+
+  execute_instr<corevm::runtime::instr_handler_gethndl>(instr, 1);
+
+  corevm::types::native_type_handle result = m_process.top_frame().pop_eval_stack();
+  ASSERT_EQ(123, corevm::types::get_value_from_handle<int64_t>(result));
+
+  // Immediates cannot be given another handle.
+  corevm::types::native_type_handle hndl3 = corevm::types::int64(456);
+  m_process.top_frame().push_eval_stack(hndl3);
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_sethndl>(instr, 1);
+    },
+    corevm::runtime::invalid_operation_error
+  );
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_clrhndl>(instr, 1);
+    },
+    corevm::runtime::invalid_operation_error
+  );
+
+  // Values that do not fit are held by objects.
+  corevm::types::native_type_handle hndl2 = corevm::types::int64(
+    std::numeric_limits<int64_t>::max());
+  m_process.top_frame().push_eval_stack(hndl2);
+
+  execute_instr<corevm::runtime::instr_handler_newimm>(instr, 2);
+
+  ASSERT_FALSE(corevm::dyobj::is_immediate(m_process.top_stack()));
+  ASSERT_EQ(heap_size + 1, m_process.heap_size());
+
+  execute_instr<corevm::runtime::instr_handler_gethndl>(instr, 2);
+
+  corevm::types::native_type_handle result2 = m_process.top_frame().pop_eval_stack();
+  ASSERT_EQ(std::numeric_limits<int64_t>::max(),
+    corevm::types::get_value_from_handle<int64_t>(result2));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrNEWNONE)
+{
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  corevm::runtime::frame frame(m_ctx);
+  m_process.push_frame(frame);
+
+  execute_instr<corevm::runtime::instr_handler_newnone>(instr, 1);
+
+  corevm::dyobj::dyobj_id id = m_process.top_stack();
+
+  ASSERT_TRUE(corevm::dyobj::is_immediate(id));
+  ASSERT_EQ(corevm::dyobj::IMMEDIATE_NONE, corevm::dyobj::get_immediate_kind(id));
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_gethndl>(instr, 1);
+    },
+    corevm::runtime::native_type_handle_not_found_error
+  );
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(instrs_obj_unittest, TestInstrPOP)
 {
   corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
@@ -528,7 +806,54 @@ TEST_F(instrs_obj_unittest, TestInstrSETHNDL)
 
   auto &obj = process::adapter(m_process).help_get_dyobj(id);
 
+  // Scalars are held inline instead of in the native types pool.
+  ASSERT_EQ(corevm::dyobj::NONESET_NTVHNDL_KEY, obj.ntvhndl_key());
+  ASSERT_NE(0, obj.inline_ntvhndl_type());
+  ASSERT_EQ(0, m_process.ntvhndl_pool_size());
+
+  corevm::types::native_type_handle actual_handle = m_process.get_ntvhndl(obj);
+
+  ASSERT_EQ(expected_value,
+    corevm::types::get_value_from_handle<uint32_t>(actual_handle));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_obj_unittest, TestInstrSETHNDLWithNonScalarValue)
+{
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  m_process.push_stack(id);
+
+  corevm::runtime::frame frame(m_ctx);
+  corevm::types::native_type_handle hndl = corevm::types::string("Hello world");
+  frame.push_eval_stack(hndl);
+  m_process.push_frame(frame);
+
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+  execute_instr<corevm::runtime::instr_handler_sethndl>(instr, 1);
+
+  auto &obj = process::adapter(m_process).help_get_dyobj(id);
+
   ASSERT_NE(corevm::dyobj::NONESET_NTVHNDL_KEY, obj.ntvhndl_key());
+  ASSERT_EQ(0, obj.inline_ntvhndl_type());
+  ASSERT_EQ(1, m_process.ntvhndl_pool_size());
+
+  // Replacing the string with a scalar releases the pooled handle.
+  corevm::types::native_type_handle hndl2 = corevm::types::int64(-1);
+  m_process.top_frame().push_eval_stack(hndl2);
+
+  execute_instr<corevm::runtime::instr_handler_sethndl>(instr, 1);
+
+  ASSERT_EQ(corevm::dyobj::NONESET_NTVHNDL_KEY, obj.ntvhndl_key());
+  ASSERT_NE(0, obj.inline_ntvhndl_type());
+  ASSERT_EQ(0, m_process.ntvhndl_pool_size());
+
+  execute_instr<corevm::runtime::instr_handler_gethndl>(instr, 1);
+
+  corevm::types::native_type_handle actual_handle =
+    m_process.top_frame().pop_eval_stack();
+
+  ASSERT_EQ(-1, corevm::types::get_value_from_handle<int64_t>(actual_handle));
 }
 
 // -----------------------------------------------------------------------------
@@ -555,6 +880,33 @@ TEST_F(instrs_obj_unittest, TestInstrCLRHNDL)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_obj_unittest, TestInstrCLRHNDLOnInlineHandle)
+{
+  corevm::dyobj::dyobj_id id = process::adapter(m_process).help_create_dyobj();
+  m_process.push_stack(id);
+
+  auto &obj = process::adapter(m_process).help_get_dyobj(id);
+
+  corevm::types::native_type_handle hndl = corevm::types::boolean(true);
+  m_process.set_ntvhndl(obj, hndl);
+
+  ASSERT_TRUE(m_process.has_ntvhndl(obj));
+
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+  execute_instr<corevm::runtime::instr_handler_clrhndl>(instr, 1);
+
+  ASSERT_FALSE(m_process.has_ntvhndl(obj));
+
+  ASSERT_THROW(
+    {
+      execute_instr<corevm::runtime::instr_handler_clrhndl>(instr, 1);
+    },
+    corevm::runtime::native_type_handle_deletion_error
+  );
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(instrs_obj_unittest, TestInstrOBJEQ)
 {
   corevm::dyobj::dyobj_id id1 = 1;
@@ -1252,6 +1604,9 @@ TEST_F(instrs_functions_instrs_test, TestInstrGETARGS)
   corevm::runtime::frame& actual_frame = m_process.top_frame();
   corevm::types::native_type_handle hndl = actual_frame.pop_eval_stack();
 
+  ASSERT_EQ(true,
+    corevm::types::get_value_from_handle<corevm::types::native_array>(hndl).contains_object_refs());
+
   corevm::types::native_type_handle result_handle1;
   corevm::types::native_type_handle result_handle2;
   corevm::types::native_type_handle result_handle3;
@@ -1306,6 +1661,9 @@ TEST_F(instrs_functions_instrs_test, TestInstrGETKWARGS)
   corevm::runtime::frame& actual_frame = m_process.top_frame();
   corevm::types::native_type_handle hndl = actual_frame.pop_eval_stack();
 
+  ASSERT_EQ(true,
+    corevm::types::get_value_from_handle<corevm::types::native_map>(hndl).contains_object_refs());
+
   corevm::types::native_type_handle key_handle1 = corevm::types::uint64(key1);
   corevm::types::native_type_handle key_handle2 = corevm::types::uint64(key2);
   corevm::types::native_type_handle key_handle3 = corevm::types::uint64(key3);
@@ -2297,6 +2655,52 @@ TEST_F(instrs_native_type_creation_instrs_test, TestInstrSTR)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_native_type_creation_instrs_test, TestInstrSTRWithLiteral)
+{
+  corevm::runtime::compartment compartment(DUMMY_PATH);
+
+  uint64_t str_key = 333;
+  const std::string str = "Hello world";
+
+  corevm::runtime::encoding_map encoding_table {
+    { str_key, str }
+  };
+
+  compartment.set_encoding_map(encoding_table);
+
+  corevm::runtime::compartment_id compartment_id =
+    m_process.insert_compartment(compartment);
+
+  ASSERT_EQ(1, m_process.interned_string_count());
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = compartment_id,
+    .closure_id = corevm::runtime::NONESET_CLOSURE_ID,
+  };
+  m_process.emplace_frame(ctx);
+
+  corevm::runtime::instr instr { .code=0, .oprd1=str_key, .oprd2=0 };
+  corevm::runtime::instr_handler_str instr_handler;
+
+  corevm::runtime::frame& frame = m_process.top_frame();
+
+  instr_handler.execute(instr, m_process);
+  corevm::types::native_type_handle result1 = frame.pop_eval_stack();
+
+  instr_handler.execute(instr, m_process);
+  corevm::types::native_type_handle result2 = frame.pop_eval_stack();
+
+  const corevm::types::string& str1 = boost::get<corevm::types::string>(result1);
+  const corevm::types::string& str2 = boost::get<corevm::types::string>(result2);
+
+  ASSERT_EQ(corevm::types::native_string(str), str1.value());
+  ASSERT_NE(nullptr, str1.intern_key);
+  ASSERT_EQ(str1.intern_key, str2.intern_key);
+  ASSERT_EQ(1, m_process.interned_string_count());
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(instrs_native_type_creation_instrs_test, TestInstrARY)
 {
   corevm::types::native_array expected_result;
@@ -2315,6 +2719,36 @@ TEST_F(instrs_native_type_creation_instrs_test, TestInstrMAP)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_native_type_creation_instrs_test, TestInstrARYAndMAPWithObjectRefs)
+{
+  corevm::runtime::frame& frame = m_process.top_frame();
+
+  // A zero operand, as in bytecode predating the operand, leaves the
+  // containers unmarked.
+  for (corevm::runtime::instr_oprd oprd1 = 0; oprd1 <= 1; ++oprd1)
+  {
+    corevm::runtime::instr ary_instr {
+      .code = corevm::runtime::instr_enum::ARY, .oprd1 = oprd1, .oprd2 = 0 };
+    corevm::runtime::instr map_instr {
+      .code = corevm::runtime::instr_enum::MAP, .oprd1 = oprd1, .oprd2 = 0 };
+
+    corevm::runtime::instr_handler_ary().execute(ary_instr, m_process);
+    corevm::runtime::instr_handler_map().execute(map_instr, m_process);
+
+    corevm::types::native_type_handle map_hndl = frame.pop_eval_stack();
+    corevm::types::native_type_handle ary_hndl = frame.pop_eval_stack();
+
+    ASSERT_EQ(static_cast<bool>(oprd1),
+      corevm::types::get_value_from_handle<corevm::types::native_map>(
+        map_hndl).contains_object_refs());
+    ASSERT_EQ(static_cast<bool>(oprd1),
+      corevm::types::get_value_from_handle<corevm::types::native_array>(
+        ary_hndl).contains_object_refs());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 class instrs_native_type_conversion_instrs_test : public instrs_native_types_instrs_test
 {
 public:
@@ -2430,18 +2864,41 @@ TEST_F(instrs_native_type_conversion_instrs_test, TestInstr2DEC2)
 
 TEST_F(instrs_native_type_conversion_instrs_test, TestInstr2STR)
 {
-  /* Lambda defined to avoid compilation error on the `ASSERT_THROW` macro.
-   * (Somehow calling a templated function wrapped in a code block makes
-   * `ASSERT_THROW` thinks it's getting an initializer list)
-   **/
-  auto test = [&]() {
-    execute_instr_and_assert_result<
-      corevm::runtime::instr_handler_2str, corevm::types::string>();
-  };
+  corevm::runtime::instr_handler_2str instr_handler;
+
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+
+  instr_handler.execute(instr, m_process);
+
+  corevm::runtime::frame& frame = m_process.top_frame();
+
+  ASSERT_EQ(m_expected_eval_stack_size, frame.eval_stack_size());
+
+  corevm::types::native_type_handle result_handle = frame.pop_eval_stack();
+
+  ASSERT_EQ(
+    corevm::types::native_string("255"),
+    corevm::types::get_value_from_handle<corevm::types::native_string>(
+      result_handle));
+
+  corevm::types::native_type_handle decimal_handle = corevm::types::decimal2(0.1);
+  frame.push_eval_stack(decimal_handle);
+
+  instr_handler.execute(instr, m_process);
+
+  result_handle = frame.pop_eval_stack();
+
+  ASSERT_EQ(
+    corevm::types::native_string("0.1"),
+    corevm::types::get_value_from_handle<corevm::types::native_string>(
+      result_handle));
+
+  corevm::types::native_type_handle boolean_handle = corevm::types::boolean(true);
+  frame.push_eval_stack(boolean_handle);
 
   ASSERT_THROW(
     {
-      test();
+      instr_handler.execute(instr, m_process);
     },
     corevm::types::conversion_error
   );
@@ -2617,6 +3074,38 @@ TEST_F(instrs_native_type_manipulation_instrs_test, TestInstrREPR_06)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_native_type_manipulation_instrs_test, TestInstrREPR_07)
+{
+  auto& frame = m_process.top_frame();
+
+  corevm::types::native_type_handle hndl = corevm::types::int8(-5);
+
+  frame.push_eval_stack(hndl);
+
+  corevm::types::native_string expected_value("-5");
+
+  execute_instr_and_assert_result<
+    corevm::runtime::instr_handler_repr, corevm::types::string>(expected_value);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(instrs_native_type_manipulation_instrs_test, TestInstrREPR_08)
+{
+  auto& frame = m_process.top_frame();
+
+  corevm::types::native_type_handle hndl = corevm::types::decimal2(-1234.5);
+
+  frame.push_eval_stack(hndl);
+
+  corevm::types::native_string expected_value("-1234.500000");
+
+  execute_instr_and_assert_result<
+    corevm::runtime::instr_handler_repr, corevm::types::string>(expected_value);
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(instrs_native_type_manipulation_instrs_test, TestInstrHASH)
 {
   auto& frame = m_process.top_frame();
@@ -2931,6 +3420,45 @@ TEST_F(instrs_native_string_type_complex_instrs_test, TestInstrRFND2)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(instrs_native_string_type_complex_instrs_test, TestInstrSTRINTRN)
+{
+  corevm::types::native_string hello_world = "Hello world";
+
+  corevm::types::native_type_handle oprd1 = hello_world;
+  corevm::types::native_type_handle oprd2 = hello_world;
+
+  push_eval_stack_and_frame(eval_oprds_list{oprd1, oprd2});
+
+  corevm::runtime::instr instr { .code=0, .oprd1=0, .oprd2=0 };
+  corevm::runtime::instr_handler_strintrn instr_handler;
+
+  corevm::runtime::frame& frame = m_process.top_frame();
+
+  instr_handler.execute(instr, m_process);
+  corevm::types::native_type_handle result1 = frame.pop_eval_stack();
+
+  instr_handler.execute(instr, m_process);
+  corevm::types::native_type_handle result2 = frame.pop_eval_stack();
+
+  const corevm::types::string& str1 = boost::get<corevm::types::string>(result1);
+  const corevm::types::string& str2 = boost::get<corevm::types::string>(result2);
+
+  ASSERT_EQ(hello_world, str1.value());
+  ASSERT_NE(nullptr, str1.intern_key);
+  ASSERT_EQ(str1.intern_key, str2.intern_key);
+  ASSERT_EQ(1, m_process.interned_string_count());
+
+  // Interning an interned string gives back the same string.
+  frame.push_eval_stack(result1);
+  instr_handler.execute(instr, m_process);
+  corevm::types::native_type_handle result3 = frame.pop_eval_stack();
+
+  ASSERT_EQ(
+    str1.intern_key, boost::get<corevm::types::string>(result3).intern_key);
+}
+
+// -----------------------------------------------------------------------------
+
 class instrs_native_array_type_complex_instrs_test : public instrs_native_type_complex_instrs_test {};
 
 // -----------------------------------------------------------------------------
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cstdint>
 #include <sstream>
+#include <vector>
 
 
 class native_types_pool_unittest : public ::testing::Test {};
@@ -114,6 +115,29 @@ TEST_F(native_types_pool_unittest, TestCreateAndErase)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(native_types_pool_unittest, TestEraseInBatch)
+{
+  corevm::runtime::native_types_pool pool;
+
+  auto key1 = pool.create();
+  auto key2 = pool.create();
+  auto key3 = pool.create();
+
+  ASSERT_EQ(3, pool.size());
+
+  // Repeated and unknown keys are skipped.
+  std::vector<corevm::dyobj::ntvhndl_key> keys { key3, key1, key3, 1 };
+
+  ASSERT_EQ(2, pool.erase(keys));
+  ASSERT_EQ(1, pool.size());
+  ASSERT_NO_THROW(pool.at(key2));
+  ASSERT_THROW(pool.at(key1), corevm::runtime::native_type_handle_not_found_error);
+
+  ASSERT_EQ(0, pool.erase(keys));
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(native_types_pool_unittest, TestOutputStream)
 {
   corevm::runtime::native_types_pool pool;
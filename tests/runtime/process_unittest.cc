@@ -20,26 +20,55 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
+#include "dyobj/flags.h"
 #include "runtime/closure.h"
 #include "runtime/closure_ctx.h"
 #include "runtime/common.h"
+#include "runtime/errors.h"
 #include "runtime/gc_rule.h"
 #include "runtime/process.h"
 #include "runtime/process_runner.h"
 #include "runtime/sighandler_registrar.h"
 #include "runtime/vector.h"
+#include "types/interfaces.h"
 #include "types/native_type_handle.h"
 #include "types/types.h"
 
 #include <sneaker/testing/_unittest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <iterator>
 #include <sstream>
+#include <string>
+#include <thread>
 
 
-class process_unittest : public ::testing::Test {};
+class process_unittest : public ::testing::Test
+{
+protected:
+  /**
+   * Loads a program that creates and pops the specified number of objects.
+   */
+  void load_allocating_program(corevm::runtime::process& process, size_t count)
+  {
+    corevm::runtime::closure closure;
+    closure.id = 0;
+    closure.parent_id = corevm::runtime::NONESET_CLOSURE_ID;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      closure.vector.push_back({ .code=corevm::runtime::instr_enum::NEW, .oprd1=0, .oprd2=0 });
+      closure.vector.push_back({ .code=corevm::runtime::instr_enum::POP, .oprd1=0, .oprd2=0 });
+    }
+
+    corevm::runtime::compartment compartment("./example.core");
+    compartment.set_closure_table({ closure });
+
+    process.insert_compartment(compartment);
+  }
+};
 
 // -----------------------------------------------------------------------------
 
@@ -75,6 +104,60 @@ TEST_F(process_unittest, TestDefaultAndMaxSizes)
 
   ASSERT_LT(0, process.max_heap_size());
   ASSERT_LT(0, process.max_ntvhndl_pool_size());
+  ASSERT_LT(0, process.max_native_payload_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestNativePayloadSize)
+{
+  corevm::runtime::process process;
+
+  ASSERT_EQ(0, process.native_payload_size());
+
+  // Payloads outside of the process are not charged to it.
+  corevm::types::native_string str(std::string(1024, 'a'));
+  ASSERT_EQ(0, process.native_payload_size());
+
+  corevm::types::native_type_handle hndl = corevm::types::string(str);
+  corevm::dyobj::ntvhndl_key key = process.insert_ntvhndl(hndl);
+
+  ASSERT_LE(1024, process.native_payload_size());
+
+  process.erase_ntvhndl(key);
+
+  ASSERT_EQ(0, process.native_payload_size());
+
+  process.set_max_native_payload_size(4096);
+  ASSERT_EQ(4096, process.max_native_payload_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestAllocationStats)
+{
+  corevm::runtime::process process;
+
+  ASSERT_EQ(0, process.heap_stats().alloc_count);
+  ASSERT_EQ(0, process.ntvhndl_pool_stats().alloc_count);
+
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  corevm::types::native_type_handle hndl = corevm::types::int8(1);
+  process.insert_ntvhndl(hndl);
+
+  ASSERT_EQ(1, process.heap_stats().alloc_count);
+  ASSERT_EQ(1, process.ntvhndl_pool_stats().alloc_count);
+  ASSERT_LT(0, process.heap_stats().allocated_size);
+  ASSERT_LT(0, process.ntvhndl_pool_stats().allocated_size);
+
+  std::stringstream ss;
+  process.dump_allocation_stats(ss);
+
+  const std::string output = ss.str();
+
+  ASSERT_NE(std::string::npos, output.find("\"heap\": {\"alloc-count\": 1, "));
+  ASSERT_NE(std::string::npos, output.find("\"native-types-pool\": {\"alloc-count\": 1, "));
 }
 
 // -----------------------------------------------------------------------------
@@ -357,6 +440,420 @@ TEST_F(process_unittest, TestEmplaceFrame)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(process_unittest, TestGetGcRoots)
+{
+  corevm::runtime::process process;
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = 0,
+    .closure_id = 0,
+  };
+
+  process.emplace_frame(ctx);
+
+  auto& frame = process.top_frame();
+  frame.set_visible_var(1, 11);
+  frame.set_invisible_var(2, 12);
+  frame.set_exc_obj(13);
+
+  corevm::types::native_array array { 17 };
+  array.set_contains_object_refs(true);
+  corevm::types::native_type_handle hndl = array;
+  frame.push_eval_stack(hndl);
+
+  corevm::types::native_type_handle unmarked_hndl =
+    corevm::types::native_array { 18 };
+  frame.push_eval_stack(unmarked_hndl);
+
+  corevm::dyobj::dyobj_id stack_obj = 14;
+  process.push_stack(stack_obj);
+
+  process.emplace_invocation_ctx(ctx);
+
+  auto& invk_ctx = process.top_invocation_ctx();
+  invk_ctx.put_param(15);
+  invk_ctx.put_param_value_pair(3, 16);
+
+  corevm::runtime::process::garbage_collection_scheme::root_set_type roots;
+  process.get_gc_roots(roots);
+
+  std::sort(roots.begin(), roots.end());
+
+  corevm::runtime::process::garbage_collection_scheme::root_set_type expected_roots {
+    11, 12, 13, 14, 15, 16, 17
+  };
+
+  ASSERT_EQ(expected_roots, roots);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestGcWithUncountedReferences)
+{
+  corevm::runtime::process process;
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = 0,
+    .closure_id = 0,
+  };
+
+  process.emplace_frame(ctx);
+
+  // References held by frames are not counted, but keep objects alive.
+  corevm::dyobj::dyobj_id id =
+    corevm::runtime::process::adapter(process).help_create_dyobj();
+  process.top_frame().set_visible_var(1, id);
+
+  process.do_gc();
+
+  ASSERT_NO_THROW(corevm::runtime::process::adapter(process).help_get_dyobj(id));
+
+  process.top_frame().pop_visible_var(1);
+  process.do_gc();
+
+  ASSERT_THROW(
+    corevm::runtime::process::adapter(process).help_get_dyobj(id),
+    corevm::dyobj::object_not_found_error
+  );
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestGcAfterSwappingMarkedContainers)
+{
+  corevm::runtime::process process;
+  corevm::runtime::process::adapter adapter(process);
+
+  corevm::runtime::closure_ctx ctx {
+    .compartment_id = 0,
+    .closure_id = 0,
+  };
+
+  process.emplace_frame(ctx);
+
+  corevm::dyobj::dyobj_id id1 = adapter.help_create_dyobj();
+  corevm::dyobj::dyobj_id id2 = adapter.help_create_dyobj();
+
+  corevm::types::native_array marked_array { id1 };
+  marked_array.set_contains_object_refs(true);
+
+  corevm::types::native_map marked_map { { 1, id2 } };
+  marked_map.set_contains_object_refs(true);
+
+  corevm::types::native_type_handle array_hndl = corevm::types::native_array();
+  corevm::types::native_type_handle other_array_hndl = marked_array;
+  corevm::types::native_type_handle swapped_array_hndl;
+
+  corevm::types::native_type_handle map_hndl = corevm::types::native_map();
+  corevm::types::native_type_handle other_map_hndl = marked_map;
+  corevm::types::native_type_handle swapped_map_hndl;
+
+  // The mark moves along with the swapped contents.
+  corevm::types::interface_array_swap(
+    array_hndl, other_array_hndl, swapped_array_hndl);
+  corevm::types::interface_map_swap(
+    map_hndl, other_map_hndl, swapped_map_hndl);
+
+  process.top_frame().push_eval_stack(swapped_array_hndl);
+  process.top_frame().push_eval_stack(swapped_map_hndl);
+
+  process.do_gc();
+
+  ASSERT_NO_THROW(adapter.help_get_dyobj(id1));
+  ASSERT_NO_THROW(adapter.help_get_dyobj(id2));
+
+  process.top_frame().pop_eval_stack();
+  process.top_frame().pop_eval_stack();
+
+  process.do_gc();
+
+  ASSERT_THROW(adapter.help_get_dyobj(id1), corevm::dyobj::object_not_found_error);
+  ASSERT_THROW(adapter.help_get_dyobj(id2), corevm::dyobj::object_not_found_error);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestFreeze)
+{
+  corevm::runtime::process process;
+  corevm::runtime::process::adapter adapter(process);
+
+  corevm::dyobj::dyobj_id id1 = adapter.help_create_dyobj();
+  corevm::dyobj::dyobj_id id2 = adapter.help_create_dyobj();
+
+  adapter.help_get_dyobj(id1).putattr(1, id2);
+  adapter.help_get_dyobj(id2).manager().on_setattr();
+  adapter.help_get_dyobj(id1).set_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE);
+
+  // Every object reached has to be immutable.
+  ASSERT_THROW(process.freeze(id1), corevm::runtime::invalid_operation_error);
+  ASSERT_EQ(false, adapter.help_get_dyobj(id1).is_frozen());
+
+  adapter.help_get_dyobj(id2).set_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE);
+
+  process.freeze(id1);
+
+  ASSERT_EQ(true, adapter.help_get_dyobj(id1).is_frozen());
+  ASSERT_EQ(true, adapter.help_get_dyobj(id2).is_frozen());
+
+  // Frozen objects survive without being referenced.
+  process.do_gc();
+
+  ASSERT_NO_THROW(adapter.help_get_dyobj(id1));
+  ASSERT_NO_THROW(adapter.help_get_dyobj(id2));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestImmediateValues)
+{
+  corevm::runtime::process process;
+  corevm::runtime::process::adapter adapter(process);
+
+  corevm::types::native_type_handle hndl = corevm::types::int64(-42);
+  corevm::dyobj::dyobj_id immediate_id = process.make_immediate(hndl);
+
+  ASSERT_TRUE(corevm::dyobj::is_immediate(immediate_id));
+
+  corevm::types::native_type_handle result =
+    corevm::runtime::process::get_immediate_ntvhndl(immediate_id);
+
+  ASSERT_EQ(-42, corevm::types::get_value_from_handle<int64_t>(result));
+
+  corevm::dyobj::dyobj_id id = adapter.help_create_dyobj();
+  adapter.help_get_dyobj(id).putattr(1, immediate_id);
+  process.push_stack(id);
+  process.push_stack(immediate_id);
+
+  size_t heap_size = process.heap_size();
+
+  // Collectors skip immediate values held by objects and by the process.
+  process.do_gc();
+
+  ASSERT_NO_THROW(adapter.help_get_dyobj(id));
+  ASSERT_EQ(immediate_id, adapter.help_get_dyobj(id).getattr(1));
+  ASSERT_EQ(heap_size, process.heap_size());
+
+  // Objects are only created for immediate values that need one, once.
+  auto& box = adapter.help_get_dyobj(immediate_id);
+
+  ASSERT_EQ(&box, &adapter.help_get_dyobj(immediate_id));
+  ASSERT_TRUE(box.get_flag(corevm::dyobj::flags::DYOBJ_IS_IMMUTABLE));
+  ASSERT_EQ(heap_size + 1, process.heap_size());
+
+  corevm::types::native_type_handle box_hndl = process.get_ntvhndl(box);
+
+  ASSERT_EQ(-42, corevm::types::get_value_from_handle<int64_t>(box_hndl));
+
+  // Boxes last until the end of the collection cycle.
+  for (int64_t i = 0; i < 100; ++i)
+  {
+    corevm::types::native_type_handle value_hndl = corevm::types::int64(i);
+    adapter.help_get_dyobj(process.make_immediate(value_hndl));
+  }
+
+  ASSERT_EQ(heap_size + 101, process.heap_size());
+
+  process.do_gc();
+
+  ASSERT_EQ(heap_size, process.heap_size());
+
+  box_hndl = process.get_ntvhndl(adapter.help_get_dyobj(immediate_id));
+
+  ASSERT_EQ(-42, corevm::types::get_value_from_handle<int64_t>(box_hndl));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestGcPauseStats)
+{
+  corevm::runtime::process process;
+
+  ASSERT_EQ(0, process.gc_pause_stats().count());
+
+  process.do_gc();
+  process.do_gc();
+
+  ASSERT_EQ(2, process.gc_pause_stats().count());
+  ASSERT_LE(process.gc_pause_stats().percentile(50), process.gc_pause_stats().max());
+
+  std::stringstream ss;
+  process.dump_gc_stats(ss);
+
+  ASSERT_EQ(0, ss.str().find("{\"pauses\": {\"count\": 2, "));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestGcStats)
+{
+  corevm::runtime::process process;
+
+  std::stringstream log;
+  process.set_gc_log(&log);
+
+  corevm::dyobj::dyobj_id id =
+    corevm::runtime::process::adapter(process).help_create_dyobj();
+  corevm::runtime::process::adapter(process).help_get_dyobj(id).manager().on_create();
+  process.push_stack(id);
+
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  process.do_gc();
+
+  ASSERT_EQ(1, process.gc_stats().cycle_count());
+  ASSERT_EQ(2, process.gc_stats().freed_object_count());
+  ASSERT_EQ(1, process.gc_stats().last_cycle().slice_count);
+  ASSERT_EQ(3, process.gc_stats().last_cycle().heap_size_before);
+  ASSERT_EQ(1, process.gc_stats().last_cycle().heap_size_after);
+  ASSERT_LE(
+    process.gc_stats().last_cycle().start_time,
+    process.gc_stats().last_cycle().end_time);
+
+  process.do_gc();
+
+  ASSERT_EQ(2, process.gc_stats().cycle_count());
+  ASSERT_EQ(2, process.gc_stats().freed_object_count());
+
+  std::string line;
+  size_t line_count = 0;
+
+  while (std::getline(log, line))
+  {
+    ASSERT_EQ(0, line.find("{\"minor\": false, "));
+    ++line_count;
+  }
+
+  ASSERT_EQ(2, line_count);
+
+  std::stringstream ss;
+  process.dump_gc_stats(ss);
+
+  ASSERT_NE(std::string::npos, ss.str().find("\"cycles\": {\"count\": 2, "));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestLazySweep)
+{
+  corevm::runtime::process process;
+  process.set_gc_sweep_chunk_size(1);
+
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  process.do_gc();
+
+  ASSERT_EQ(true, process.has_pending_sweep());
+
+  // Every object creation reclaims one garbage object.
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  ASSERT_EQ(true, process.has_pending_sweep());
+
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  ASSERT_EQ(false, process.has_pending_sweep());
+
+  process.do_gc();
+  process.set_gc_sweep_chunk_size(0);
+
+  // Garbage left over is still reclaimed once lazy sweeping is disabled.
+  process.do_gc();
+
+  ASSERT_EQ(false, process.has_pending_sweep());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestMinorGc)
+{
+  corevm::runtime::process process(
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    corevm::runtime::COREVM_DEFAULT_NATIVE_TYPES_POOL_SIZE,
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    corevm::runtime::COREVM_DEFAULT_NATIVE_TYPES_POOL_SIZE,
+    0,
+    corevm::runtime::process::dynamic_object_heap_type::HEAP_GENERATIONAL);
+
+  process.set_gc_nursery_size(2);
+
+  corevm::dyobj::dyobj_id id =
+    corevm::runtime::process::adapter(process).help_create_dyobj();
+  corevm::runtime::process::adapter(process).help_get_dyobj(id).manager().on_create();
+  process.push_stack(id);
+
+  corevm::runtime::process::adapter(process).help_create_dyobj();
+
+  process.do_minor_gc();
+
+  ASSERT_EQ(1, process.gc_minor_pause_stats().count());
+  ASSERT_LE(0, process.gc_promotion_rate());
+  ASSERT_GE(1, process.gc_promotion_rate());
+  ASSERT_NO_THROW(corevm::runtime::process::adapter(process).help_get_dyobj(id));
+
+  std::stringstream ss;
+  process.dump_gc_stats(ss);
+
+  ASSERT_NE(std::string::npos, ss.str().find("\"minor-pauses\": {\"count\": 1, "));
+  ASSERT_NE(std::string::npos, ss.str().find("\"promotion-rate\": "));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestPauseAndResumeExec)
+{
+  const size_t count = 10000;
+
+  corevm::runtime::process process;
+  load_allocating_program(process, count);
+
+  // Pausing a process that is not executing returns right away.
+  process.pause_exec();
+  process.resume_exec();
+
+  std::thread thread([&process]() { process.start(); });
+
+  bool stopped = true;
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    process.pause_exec();
+
+    auto pc = process.pc();
+    auto heap_size = process.heap_size();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    stopped = stopped && pc == process.pc() && heap_size == process.heap_size();
+
+    process.resume_exec();
+  }
+
+  thread.join();
+
+  ASSERT_EQ(true, stopped);
+  ASSERT_EQ(count, process.heap_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_unittest, TestAllocationTriggeredGc)
+{
+  corevm::runtime::process process;
+  load_allocating_program(process, 1000);
+
+  process.set_gc_flag(1 << (corevm::runtime::gc_rule_meta::GC_ALWAYS - 1));
+  process.set_gc_allocation_interval(100);
+
+  process.start();
+
+  ASSERT_EQ(10, process.gc_pause_stats().count());
+}
+
+// -----------------------------------------------------------------------------
+
 TEST_F(process_unittest, TestInsertAndAccessNativeTypeHandle)
 {
   corevm::runtime::process process;
@@ -577,6 +1074,127 @@ TEST_F(process_gc_rule_unittest, Test_gc_rule_by_ntvhndl_pool_size)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(process_gc_rule_unittest, Test_gc_rule_by_native_payload_size)
+{
+  corevm::runtime::gc_rule_by_native_payload_size gc_rule;
+  ASSERT_EQ(false, gc_rule.should_gc(_process));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(process_gc_rule_unittest, Test_gc_rule_adaptive)
+{
+  corevm::runtime::gc_rule_adaptive gc_rule;
+  ASSERT_EQ(false, gc_rule.should_gc(_process));
+
+  corevm::runtime::gc_threshold_policy policy;
+  policy.set_min_threshold(1);
+  _process.set_gc_threshold_policy(policy);
+
+  ASSERT_EQ(1, _process.gc_threshold());
+
+  corevm::runtime::process::adapter(_process).help_create_dyobj();
+  ASSERT_EQ(false, gc_rule.should_gc(_process));
+
+  corevm::runtime::process::adapter(_process).help_create_dyobj();
+  ASSERT_EQ(true, gc_rule.should_gc(_process));
+
+  // Collecting both objects sets the threshold back to the minimum.
+  _process.do_gc();
+
+  ASSERT_EQ(1, _process.gc_threshold());
+  ASSERT_EQ(false, gc_rule.should_gc(_process));
+}
+
+// -----------------------------------------------------------------------------
+
+class gc_threshold_policy_unittest : public ::testing::Test {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_threshold_policy_unittest, TestGrowthFactor)
+{
+  corevm::runtime::gc_threshold_policy policy;
+
+  ASSERT_EQ(
+    corevm::runtime::gc_threshold_policy::DEFAULT_MIN_THRESHOLD, policy.threshold());
+
+  policy.set_min_threshold(10);
+  policy.set_growth_factor(1.5);
+
+  ASSERT_EQ(10, policy.threshold());
+
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.end_time = 1000;
+  cycle.slice_count = 1;
+  cycle.heap_size_before = 2000;
+  cycle.heap_size_after = 1000;
+
+  policy.update(cycle);
+
+  ASSERT_EQ(1500, policy.threshold());
+
+  cycle.end_time = 2000;
+  cycle.heap_size_after = 4;
+
+  policy.update(cycle);
+
+  ASSERT_EQ(10, policy.threshold());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_threshold_policy_unittest, TestTargetCpuFraction)
+{
+  corevm::runtime::gc_threshold_policy policy;
+  policy.set_min_threshold(1);
+  policy.set_growth_factor(2);
+  policy.set_target_cpu_fraction(0.1);
+
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.end_time = 1000;
+  cycle.slice_count = 1;
+  cycle.heap_size_after = 100;
+
+  policy.update(cycle);
+
+  ASSERT_EQ(200, policy.threshold());
+
+  // Collecting took 40% of the time since the last cycle, 4 times the target.
+  cycle.end_time = 2000;
+  cycle.mark_time = 300;
+  cycle.sweep_time = 100;
+
+  policy.update(cycle);
+
+  ASSERT_EQ(800, policy.threshold());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(gc_threshold_policy_unittest, TestPauseBudget)
+{
+  corevm::runtime::gc_threshold_policy policy;
+  policy.set_min_threshold(1);
+  policy.set_growth_factor(2);
+  policy.set_pause_budget(500);
+
+  corevm::gc::cycle_stats cycle = corevm::gc::cycle_stats();
+  cycle.end_time = 1000;
+  cycle.slice_count = 2;
+  cycle.mark_time = 1500;
+  cycle.sweep_time = 500;
+  cycle.heap_size_before = 1000;
+  cycle.heap_size_after = 800;
+
+  policy.update(cycle);
+
+  // Slices took 1000ns each, twice the budget.
+  ASSERT_EQ(500, policy.threshold());
+}
+
+// -----------------------------------------------------------------------------
+
 class process_find_frame_by_ctx_unittest : public process_unittest {};
 
 // -----------------------------------------------------------------------------
@@ -164,6 +164,40 @@ TEST_F(native_array_unittest, TestEqualityBetweenIdenticalArrays)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(native_array_unittest, TestContainsObjectRefs)
+{
+  corevm::types::native_array array { fixture_element1 };
+
+  ASSERT_EQ(false, array.contains_object_refs());
+
+  array.set_contains_object_refs(true);
+
+  ASSERT_EQ(true, array.contains_object_refs());
+
+  // Copies, conversions from the base type and swaps keep the mark with the
+  // elements.
+  const corevm::types::native_array copy = array;
+  ASSERT_EQ(true, copy.contains_object_refs());
+
+  const corevm::types::native_array converted(
+    static_cast<const corevm::types::native_array_base&>(array));
+  ASSERT_EQ(true, converted.contains_object_refs());
+
+  corevm::types::native_array other;
+  other.swap(array);
+
+  ASSERT_EQ(true, other.contains_object_refs());
+  ASSERT_EQ(false, array.contains_object_refs());
+  ASSERT_EQ(fixture_element1, other[0]);
+
+  other.set_contains_object_refs(false);
+
+  ASSERT_EQ(false, other.contains_object_refs());
+  ASSERT_EQ(fixture_element1, other[0]);
+}
+
+// -----------------------------------------------------------------------------
+
 class native_array_functionality_unittest : public native_array_unittest {};
 
 // -----------------------------------------------------------------------------
@@ -158,6 +158,35 @@ TEST_F(native_map_unittest, TestEqualityBetweenIdenticalInstances)
 
 // -----------------------------------------------------------------------------
 
+TEST_F(native_map_unittest, TestContainsObjectRefs)
+{
+  corevm::types::native_map map { { 1, 1 } };
+
+  ASSERT_EQ(false, map.contains_object_refs());
+
+  map.set_contains_object_refs(true);
+
+  ASSERT_EQ(true, map.contains_object_refs());
+
+  // Copies, conversions from the base type and swaps keep the mark with the
+  // elements.
+  const corevm::types::native_map copy = map;
+  ASSERT_EQ(true, copy.contains_object_refs());
+
+  const corevm::types::native_map converted(
+    static_cast<const corevm::types::native_map_base&>(map));
+  ASSERT_EQ(true, converted.contains_object_refs());
+
+  corevm::types::native_map other;
+  other.swap(map);
+
+  ASSERT_EQ(true, other.contains_object_refs());
+  ASSERT_EQ(false, map.contains_object_refs());
+  ASSERT_EQ(1, other.at(1));
+}
+
+// -----------------------------------------------------------------------------
+
 class native_map_functionality_unittest : public native_map_unittest {};
 
 // -----------------------------------------------------------------------------
@@ -20,12 +20,17 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
+#include "memory/payload_allocator.h"
+#include "types/errors.h"
 #include "types/native_type_handle.h"
 
 #include <sneaker/testing/_unittest.h>
 
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 
 class native_type_handle_unittest : public ::testing::Test
@@ -3147,3 +3152,176 @@ TEST_F(native_type_handle_lte_unittest, TestBetweenIncompatibleTypes)
 }
 
 // -----------------------------------------------------------------------------
+
+class native_type_handle_pack_unittest : public native_type_handle_unittest {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_pack_unittest, TestPackAndUnpackScalars)
+{
+  std::vector<corevm::types::native_type_handle> handles {
+    corevm::types::int8(-8),
+    corevm::types::uint16(16),
+    corevm::types::int32(-32),
+    corevm::types::int64(-64),
+    corevm::types::uint64(std::numeric_limits<uint64_t>::max()),
+    corevm::types::boolean(true),
+    corevm::types::decimal(-1.5),
+    corevm::types::decimal2(3.25)
+  };
+
+  for (auto itr = handles.begin(); itr != handles.end(); ++itr)
+  {
+    uint64_t bits = 0;
+    uint8_t type = corevm::types::pack_scalar_handle(*itr, bits);
+
+    ASSERT_EQ(itr->which() + 1, type);
+
+    corevm::types::native_type_handle result =
+      corevm::types::unpack_scalar_handle(type, bits);
+
+    ASSERT_EQ(itr->which(), result.which());
+
+    ASSERT_EQ(
+      corevm::types::get_value_from_handle<double>(*itr),
+      corevm::types::get_value_from_handle<double>(result));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_pack_unittest, TestPackNonScalars)
+{
+  std::vector<corevm::types::native_type_handle> handles {
+    corevm::types::string("Hello world"),
+    corevm::types::array(),
+    corevm::types::map()
+  };
+
+  for (auto itr = handles.begin(); itr != handles.end(); ++itr)
+  {
+    uint64_t bits = 0;
+    ASSERT_EQ(0, corevm::types::pack_scalar_handle(*itr, bits));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+class native_type_handle_value_ptr_unittest : public native_type_handle_unittest {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_value_ptr_unittest, TestHandleSize)
+{
+  ASSERT_LE(sizeof(corevm::types::native_type_handle), 16);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_value_ptr_unittest, TestBoxedValuesUsePayloadHeap)
+{
+  const uint64_t allocated_size =
+    corevm::memory::payload_heap().allocated_size();
+
+  {
+    corevm::types::native_type_handle handle = corevm::types::array();
+
+    ASSERT_EQ(
+      allocated_size + sizeof(corevm::types::array),
+      corevm::memory::payload_heap().allocated_size());
+
+    corevm::types::native_type_handle copy = handle;
+
+    ASSERT_EQ(
+      allocated_size + sizeof(corevm::types::array) * 2,
+      corevm::memory::payload_heap().allocated_size());
+  }
+
+  ASSERT_EQ(allocated_size, corevm::memory::payload_heap().allocated_size());
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_value_ptr_unittest, TestMovesDoNotAllocate)
+{
+  corevm::types::native_type_handle handle = corevm::types::string("Hello");
+
+  const uint64_t allocated_size =
+    corevm::memory::payload_heap().allocated_size();
+
+  corevm::types::native_type_handle moved(std::move(handle));
+
+  corevm::types::native_type_handle assigned = corevm::types::int32(1);
+  assigned = std::move(moved);
+
+  ASSERT_EQ(allocated_size, corevm::memory::payload_heap().allocated_size());
+
+  corevm::types::native_string actual_value =
+    corevm::types::get_value_from_handle<corevm::types::native_string>(
+      assigned);
+
+  ASSERT_EQ("Hello", actual_value);
+
+  // Moved-from handles can still be assigned to.
+  handle = corevm::types::string("World");
+
+  actual_value =
+    corevm::types::get_value_from_handle<corevm::types::native_string>(handle);
+
+  ASSERT_EQ("World", actual_value);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_value_ptr_unittest, TestGetValuePtrFromHandle)
+{
+  corevm::types::native_type_handle handle = corevm::types::string("Hello");
+
+  const corevm::types::native_string* value =
+    corevm::types::get_value_ptr_from_handle<corevm::types::string>(handle);
+
+  ASSERT_NE(nullptr, value);
+  ASSERT_EQ("Hello", *value);
+  ASSERT_EQ(value, corevm::types::get_value_ptr_from_handle<corevm::types::string>(handle));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_value_ptr_unittest, TestGetValuePtrFromMismatchedHandle)
+{
+  corevm::types::native_type_handle handle = corevm::types::int32(5);
+
+  ASSERT_EQ(
+    nullptr,
+    corevm::types::get_value_ptr_from_handle<corevm::types::array>(handle));
+  ASSERT_EQ(
+    nullptr,
+    corevm::types::get_value_ptr_from_handle<corevm::types::string>(handle));
+}
+
+// -----------------------------------------------------------------------------
+
+class native_type_handle_promotion_unittest : public native_type_handle_unittest {};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(native_type_handle_promotion_unittest, TestBinaryOperatorPromotion)
+{
+  ASSERT_TRUE((std::is_same<corevm::types::int64,
+    corevm::types::native_type_promotion<
+      corevm::types::int8, corevm::types::int64>::result_type>::value));
+
+  ASSERT_TRUE((std::is_same<corevm::types::decimal2,
+    corevm::types::native_type_promotion<
+      corevm::types::decimal2, corevm::types::uint8>::result_type>::value));
+
+  ASSERT_TRUE((std::is_same<corevm::types::string,
+    corevm::types::native_type_promotion<
+      corevm::types::string, corevm::types::string>::operand_type>::value));
+
+  ASSERT_TRUE((std::is_same<corevm::types::boolean,
+    corevm::types::native_type_promotion<
+      corevm::types::string, corevm::types::string>::result_type>::value));
+}
+
+// -----------------------------------------------------------------------------
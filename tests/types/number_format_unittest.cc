@@ -0,0 +1,310 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "types/number_format.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+class number_format_unittest : public ::testing::Test
+{
+protected:
+  static std::string format_integer(int64_t value)
+  {
+    char buf[corevm::types::MAX_INTEGER_LENGTH];
+    return std::string(buf, corevm::types::format_integer(value, buf));
+  }
+
+  static std::string format_integer(uint64_t value)
+  {
+    char buf[corevm::types::MAX_INTEGER_LENGTH];
+    return std::string(buf, corevm::types::format_integer(value, buf));
+  }
+
+  static std::string printf_decimal(double value, uint32_t precision)
+  {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(precision), value);
+    return std::string(buf);
+  }
+
+  static bool reads_back(const char* str, double value)
+  {
+    return strtod(str, nullptr) == value;
+  }
+
+  static bool reads_back(const char* str, float value)
+  {
+    return strtof(str, nullptr) == value;
+  }
+
+  /** Tries every number of significant digits from one up. */
+  template<typename V>
+  static int search_shortest_digits(V value)
+  {
+    char buf[64];
+
+    for (int digits = 1; ; ++digits)
+    {
+      snprintf(buf, sizeof(buf), "%.*g", digits, static_cast<double>(value));
+
+      if (reads_back(buf, value))
+      {
+        return digits;
+      }
+    }
+  }
+
+  /** Significant digits in a formatted value, ignoring zero padding. */
+  static int significant_digits(const std::string& str)
+  {
+    std::string digits;
+
+    for (auto itr = str.begin(); itr != str.end() && *itr != 'e'; ++itr)
+    {
+      if (*itr >= '0' && *itr <= '9')
+      {
+        digits.push_back(*itr);
+      }
+    }
+
+    const size_t first = digits.find_first_not_of('0');
+
+    if (first == std::string::npos)
+    {
+      return 1;
+    }
+
+    return static_cast<int>(digits.find_last_not_of('0') - first + 1);
+  }
+
+  template<typename V>
+  static void assert_shortest(V value)
+  {
+    const std::string str = corevm::types::format_decimal_shortest(value);
+
+    ASSERT_EQ(true, reads_back(str.c_str(), value));
+    ASSERT_EQ(search_shortest_digits(value), significant_digits(str));
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatInteger)
+{
+  ASSERT_EQ("0", format_integer(static_cast<int64_t>(0)));
+  ASSERT_EQ("7", format_integer(static_cast<int64_t>(7)));
+  ASSERT_EQ("-7", format_integer(static_cast<int64_t>(-7)));
+  ASSERT_EQ("10", format_integer(static_cast<int64_t>(10)));
+  ASSERT_EQ("12345", format_integer(static_cast<int64_t>(12345)));
+  ASSERT_EQ("-100000", format_integer(static_cast<int64_t>(-100000)));
+
+  ASSERT_EQ(
+    std::to_string(std::numeric_limits<int64_t>::max()),
+    format_integer(std::numeric_limits<int64_t>::max()));
+
+  ASSERT_EQ(
+    std::to_string(std::numeric_limits<int64_t>::min()),
+    format_integer(std::numeric_limits<int64_t>::min()));
+
+  ASSERT_EQ(
+    std::to_string(std::numeric_limits<uint64_t>::max()),
+    format_integer(std::numeric_limits<uint64_t>::max()));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatIntegerAgainstToString)
+{
+  std::mt19937_64 engine(0);
+
+  for (uint32_t i = 0; i < 10000; ++i)
+  {
+    uint64_t value = engine() >> (i % 64);
+
+    ASSERT_EQ(std::to_string(value), format_integer(value));
+    ASSERT_EQ(
+      std::to_string(static_cast<int64_t>(value)),
+      format_integer(static_cast<int64_t>(value)));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatDecimal)
+{
+  ASSERT_EQ("3.141592", corevm::types::format_decimal(3.141592, 6));
+  ASSERT_EQ("0.000000", corevm::types::format_decimal(0.0, 6));
+  ASSERT_EQ("-0.000000", corevm::types::format_decimal(-0.0, 6));
+  ASSERT_EQ("-1.500000", corevm::types::format_decimal(-1.5, 6));
+  ASSERT_EQ("2", corevm::types::format_decimal(1.5, 0));
+  ASSERT_EQ("100.00", corevm::types::format_decimal(99.999, 2));
+
+  ASSERT_EQ(printf_decimal(1e300, 6), corevm::types::format_decimal(1e300, 6));
+  ASSERT_EQ(
+    printf_decimal(std::numeric_limits<double>::infinity(), 6),
+    corevm::types::format_decimal(std::numeric_limits<double>::infinity(), 6));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatDecimalAgainstPrintf)
+{
+  std::mt19937_64 engine(0);
+  std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+
+  for (uint32_t i = 0; i < 10000; ++i)
+  {
+    double value = distribution(engine);
+    uint32_t precision = i % 10;
+
+    ASSERT_EQ(
+      printf_decimal(value, precision),
+      corevm::types::format_decimal(value, precision));
+
+    // Values that are exactly half way between two results.
+    double halfway = std::floor(value) + 0.5;
+
+    ASSERT_EQ(
+      printf_decimal(halfway, 0), corevm::types::format_decimal(halfway, 0));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatDecimalShortest)
+{
+  ASSERT_EQ("0.1", corevm::types::format_decimal_shortest(0.1));
+  ASSERT_EQ(
+    "0.30000000000000004", corevm::types::format_decimal_shortest(0.1 + 0.2));
+  ASSERT_EQ("1.0", corevm::types::format_decimal_shortest(1.0));
+  ASSERT_EQ("-2.5", corevm::types::format_decimal_shortest(-2.5));
+  ASSERT_EQ("0.0", corevm::types::format_decimal_shortest(0.0));
+  ASSERT_EQ("-0.0", corevm::types::format_decimal_shortest(-0.0));
+  ASSERT_EQ("1e+20", corevm::types::format_decimal_shortest(1e20));
+  ASSERT_EQ("1e-07", corevm::types::format_decimal_shortest(1e-7));
+  ASSERT_EQ("5e-324", corevm::types::format_decimal_shortest(5e-324));
+  ASSERT_EQ(
+    "1.7976931348623157e+308",
+    corevm::types::format_decimal_shortest(std::numeric_limits<double>::max()));
+  ASSERT_EQ("inf", corevm::types::format_decimal_shortest(
+    std::numeric_limits<double>::infinity()));
+
+  // The rounding interval of a power of two is narrower below it, so the
+  // shortest digits are not always the correctly rounded ones.
+  ASSERT_EQ(
+    "7.120236347223045e-307",
+    corevm::types::format_decimal_shortest(std::ldexp(1.0, -1017)));
+
+  ASSERT_EQ("0.1", corevm::types::format_decimal_shortest(0.1f));
+  ASSERT_EQ("3.1415927", corevm::types::format_decimal_shortest(3.14159265f));
+  ASSERT_EQ("16777216.0", corevm::types::format_decimal_shortest(16777216.0f));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestFormatDecimalShortestAgainstSearch)
+{
+  std::mt19937_64 engine(0);
+
+  for (uint32_t i = 0; i < 10000; ++i)
+  {
+    uint64_t bits = engine();
+
+    double value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    float float_value = 0;
+    std::memcpy(&float_value, &bits, sizeof(float_value));
+
+    if (std::isfinite(value))
+    {
+      assert_shortest(value);
+    }
+
+    if (std::isfinite(float_value))
+    {
+      assert_shortest(float_value);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestParseDecimal)
+{
+  const std::vector<std::string> inputs {
+    "0", "-0", "3.141592", "0.05", ".5", "5.", "-123.456", "1e10", "2.5E-3",
+    "0.1", "123456789012345678", "1.7976931348623157e308", "4.9e-324",
+    "0.000000000000000000000001", "9007199254740993", "1.5e+3", "-25e-1"
+  };
+
+  for (auto itr = inputs.begin(); itr != inputs.end(); ++itr)
+  {
+    double value = 0;
+
+    ASSERT_EQ(true, corevm::types::parse_decimal(itr->data(), itr->size(), value));
+    ASSERT_EQ(strtod(itr->c_str(), nullptr), value);
+    ASSERT_EQ(std::signbit(strtod(itr->c_str(), nullptr)), std::signbit(value));
+  }
+
+  double value = 0;
+
+  ASSERT_EQ(false, corevm::types::parse_decimal("", 0, value));
+  ASSERT_EQ(false, corevm::types::parse_decimal(".", 1, value));
+  ASSERT_EQ(false, corevm::types::parse_decimal("1.5x", 4, value));
+  ASSERT_EQ(false, corevm::types::parse_decimal("1e", 2, value));
+  ASSERT_EQ(false, corevm::types::parse_decimal("1e+", 3, value));
+  ASSERT_EQ(false, corevm::types::parse_decimal("1e1.5", 5, value));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(number_format_unittest, TestParseDecimalAgainstStrtod)
+{
+  std::mt19937_64 engine(0);
+  std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+
+  for (uint32_t i = 0; i < 10000; ++i)
+  {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*g", static_cast<int>(i % 17 + 1),
+      distribution(engine));
+
+    double value = 0;
+
+    ASSERT_EQ(true, corevm::types::parse_decimal(buf, strlen(buf), value));
+    ASSERT_EQ(strtod(buf, nullptr), value);
+  }
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "types/native_type_handle.h"
+#include "types/string_intern_table.h"
+#include "types/types.h"
+
+#include <sneaker/testing/_unittest.h>
+
+#include <functional>
+#include <string>
+
+
+class string_intern_table_unittest : public ::testing::Test
+{
+protected:
+  static bool apply_eq(
+    const corevm::types::string& lhs, const corevm::types::string& rhs)
+  {
+    corevm::types::native_type_handle lhs_handle = lhs;
+    corevm::types::native_type_handle rhs_handle = rhs;
+
+    corevm::types::native_type_handle result =
+      corevm::types::apply_binary_visitor<corevm::types::native_type_eq_visitor>(
+        lhs_handle, rhs_handle);
+
+    corevm::types::native_type_handle neq_result =
+      corevm::types::apply_binary_visitor<corevm::types::native_type_neq_visitor>(
+        lhs_handle, rhs_handle);
+
+    bool eq = corevm::types::get_value_from_handle<bool>(result);
+
+    EXPECT_NE(eq, corevm::types::get_value_from_handle<bool>(neq_result));
+
+    return eq;
+  }
+
+  static int64_t apply_hash(const corevm::types::string& str)
+  {
+    corevm::types::native_type_handle handle = str;
+
+    corevm::types::native_type_handle result =
+      corevm::types::apply_unary_visitor<corevm::types::native_type_hash_visitor>(handle);
+
+    return corevm::types::get_value_from_handle<int64_t>(result);
+  }
+};
+
+// -----------------------------------------------------------------------------
+
+TEST_F(string_intern_table_unittest, TestIntern)
+{
+  corevm::types::string_intern_table table;
+
+  ASSERT_EQ(0, table.size());
+
+  corevm::types::string str1 = table.intern("Hello world");
+  corevm::types::string str2 = table.intern("Hello world");
+  corevm::types::string str3 = table.intern("Hello");
+
+  ASSERT_EQ(2, table.size());
+
+  ASSERT_EQ("Hello world", str1.value());
+  ASSERT_EQ("Hello", str3.value());
+
+  ASSERT_NE(nullptr, str1.intern_key);
+  ASSERT_EQ(str1.intern_key, str2.intern_key);
+  ASSERT_NE(str1.intern_key, str3.intern_key);
+
+  ASSERT_EQ(str1.hash_value, str2.hash_value);
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(string_intern_table_unittest, TestInternedStringsShareValue)
+{
+  corevm::types::string_intern_table table;
+
+  corevm::types::string str1 = table.intern("Hello world");
+  corevm::types::string str2 = table.intern("Hello world");
+
+  ASSERT_EQ(str1.intern_key, &str1.value());
+  ASSERT_EQ(&str1.value(), &str2.value());
+
+  corevm::types::native_type_handle handle = str1;
+  corevm::types::native_type_handle handle_copy = handle;
+
+  ASSERT_EQ(&str1.value(),
+    corevm::types::get_value_ptr_from_handle<corevm::types::string>(handle_copy));
+  ASSERT_EQ(0, corevm::types::payload_size(handle_copy));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(string_intern_table_unittest, TestHashOfInternedString)
+{
+  corevm::types::string_intern_table table;
+
+  corevm::types::string interned = table.intern("Hello world");
+  corevm::types::string str(corevm::types::native_string("Hello world"));
+
+  ASSERT_EQ(nullptr, str.intern_key);
+  ASSERT_EQ(apply_hash(str), apply_hash(interned));
+  ASSERT_EQ(static_cast<int64_t>(interned.hash_value), apply_hash(interned));
+
+  // Strings hash as the equivalent `std::string` does.
+  ASSERT_EQ(
+    static_cast<int64_t>(std::hash<std::string>()("Hello world")), apply_hash(str));
+}
+
+// -----------------------------------------------------------------------------
+
+TEST_F(string_intern_table_unittest, TestEqualityOfInternedStrings)
+{
+  corevm::types::string_intern_table table;
+  corevm::types::string_intern_table other_table;
+
+  corevm::types::string hello_world = table.intern("Hello world");
+  corevm::types::string hello = table.intern("Hello");
+  corevm::types::string other_hello_world = other_table.intern("Hello world");
+  corevm::types::string str(corevm::types::native_string("Hello world"));
+
+  ASSERT_EQ(true, apply_eq(hello_world, table.intern("Hello world")));
+  ASSERT_EQ(false, apply_eq(hello_world, hello));
+  ASSERT_EQ(true, apply_eq(hello_world, other_hello_world));
+  ASSERT_EQ(true, apply_eq(hello_world, str));
+  ASSERT_EQ(true, apply_eq(str, hello_world));
+  ASSERT_EQ(false, apply_eq(str, hello));
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,347 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "memory/allocation_trace.h"
+#include "memory/allocator.h"
+#include "memory/sequential_allocation_scheme.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+
+/**
+ * Replays an allocation trace against every sequential allocation scheme, and
+ * reports the throughput, peak footprint and fragmentation of each.
+ *
+ * The trace is either loaded from a file recorded through the
+ * "alloc-trace-output" configuration, or produced by one of the synthetic
+ * generators.
+ */
+class allocation_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  allocation_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  bool generate_trace(corevm::memory::allocation_trace&) const;
+
+  uint64_t default_heap_size(const corevm::memory::allocation_trace&) const;
+
+  std::string m_input;
+  std::string m_output;
+  std::string m_generator;
+  uint64_t m_count;
+  uint64_t m_min_size;
+  uint64_t m_max_size;
+  uint32_t m_seed;
+  uint64_t m_heap_size;
+};
+
+
+// -----------------------------------------------------------------------------
+
+/* Fragmentation is sampled once every this many records. */
+const uint64_t FRAGMENTATION_SAMPLE_INTERVAL = 1024;
+
+const uint64_t MIN_HEAP_SIZE = 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+
+typedef struct replay_result
+{
+  uint64_t op_count;
+  uint64_t failed_alloc_count;
+  uint64_t elapsed_time;
+  uint64_t peak_allocated_size;
+  uint64_t peak_committed_size;
+  double avg_fragmentation_ratio;
+  double max_fragmentation_ratio;
+} replay_result;
+
+// -----------------------------------------------------------------------------
+
+template<class allocation_scheme>
+static replay_result
+replay(const corevm::memory::allocation_trace& trace, uint64_t heap_size)
+{
+  corevm::memory::allocator<allocation_scheme> allocator(heap_size);
+
+  /* Maps the offsets in the trace to the addresses handed out in the replay. */
+  std::unordered_map<uint64_t, void*> live;
+
+  replay_result result { 0, 0, 0, 0, 0, 0.0, 0.0 };
+
+  uint64_t sample_count = 0;
+  double fragmentation_ratio_sum = 0.0;
+
+  for (auto itr = trace.cbegin(); itr != trace.cend(); ++itr)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    if (itr->type == corevm::memory::allocation_trace::ALLOCATE)
+    {
+      void* ptr = allocator.allocate(itr->size);
+
+      if (ptr)
+      {
+        live[itr->offset] = ptr;
+      }
+      else
+      {
+        ++result.failed_alloc_count;
+      }
+    }
+    else
+    {
+      auto live_itr = live.find(itr->offset);
+
+      if (live_itr != live.end())
+      {
+        allocator.deallocate(live_itr->second);
+        live.erase(live_itr);
+      }
+    }
+
+    result.elapsed_time += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    ++result.op_count;
+
+    if (result.op_count % FRAGMENTATION_SAMPLE_INTERVAL == 0)
+    {
+      double fragmentation_ratio = allocator.stats().fragmentation_ratio();
+      fragmentation_ratio_sum += fragmentation_ratio;
+      result.max_fragmentation_ratio = std::max(
+        result.max_fragmentation_ratio, fragmentation_ratio);
+      ++sample_count;
+    }
+  }
+
+  result.peak_allocated_size = allocator.stats().peak_allocated_size;
+  result.peak_committed_size = allocator.committed_size();
+
+  if (sample_count)
+  {
+    result.avg_fragmentation_ratio = fragmentation_ratio_sum / sample_count;
+  }
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+print_result(const std::string& name, const replay_result& result)
+{
+  double ops_per_sec = result.elapsed_time ?
+    result.op_count * 1e9 / result.elapsed_time : 0;
+
+  std::cout << std::left << std::setw(12) << name << std::right
+    << std::setw(14) << static_cast<uint64_t>(ops_per_sec)
+    << std::setw(10) << result.failed_alloc_count
+    << std::setw(16) << result.peak_allocated_size
+    << std::setw(16) << result.peak_committed_size
+    << std::setw(10) << std::fixed << std::setprecision(4)
+    << result.avg_fragmentation_ratio
+    << std::setw(10) << result.max_fragmentation_ratio
+    << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+allocation_benchmark::allocation_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM allocation scheme benchmark"),
+  m_input(),
+  m_output(),
+  m_generator("steady"),
+  m_count(100000),
+  m_min_size(16),
+  m_max_size(512),
+  m_seed(0),
+  m_heap_size(0)
+{
+  add_string_parameter("input", "Allocation trace file to replay", &m_input);
+  add_string_parameter("output", "File to save the replayed trace to", &m_output);
+  add_string_parameter("generator", "Synthetic trace: steady, bursty or mixed", &m_generator);
+  add_uint64_parameter("count", "Number of allocations to generate", &m_count);
+  add_uint64_parameter("min-size", "Minimum generated allocation size (bytes)", &m_min_size);
+  add_uint64_parameter("max-size", "Maximum generated allocation size (bytes)", &m_max_size);
+  add_uint32_parameter("seed", "Generator seed", &m_seed);
+  add_uint64_parameter("heap-size", "Heap size for each scheme (bytes)", &m_heap_size);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+allocation_benchmark::check_parameters() const
+{
+  return m_min_size > 0 && m_min_size <= m_max_size;
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+allocation_benchmark::generate_trace(
+  corevm::memory::allocation_trace& trace) const
+{
+  if (m_generator == "steady")
+  {
+    corevm::memory::allocation_trace::generate_steady_state(
+      trace, m_count, m_min_size, m_max_size, m_seed);
+  }
+  else if (m_generator == "bursty")
+  {
+    corevm::memory::allocation_trace::generate_bursty(
+      trace, m_count, m_min_size, m_max_size, m_seed);
+  }
+  else if (m_generator == "mixed")
+  {
+    corevm::memory::allocation_trace::generate_lifetime_mix(
+      trace, m_count, m_min_size, m_max_size, m_seed);
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t
+allocation_benchmark::default_heap_size(
+  const corevm::memory::allocation_trace& trace) const
+{
+  std::unordered_map<uint64_t, uint64_t> live;
+  uint64_t live_size = 0;
+  uint64_t peak_live_size = 0;
+
+  for (auto itr = trace.cbegin(); itr != trace.cend(); ++itr)
+  {
+    if (itr->type == corevm::memory::allocation_trace::ALLOCATE)
+    {
+      live[itr->offset] = itr->size;
+      live_size += itr->size;
+      peak_live_size = std::max(peak_live_size, live_size);
+    }
+    else if (live.find(itr->offset) != live.end())
+    {
+      live_size -= live[itr->offset];
+      live.erase(itr->offset);
+    }
+  }
+
+  /* Twice the peak live size, rounded up to a power of two for the buddy
+   * allocation scheme. */
+  uint64_t heap_size = MIN_HEAP_SIZE;
+
+  while (heap_size < peak_live_size * 2)
+  {
+    heap_size <<= 1;
+  }
+
+  return heap_size;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+allocation_benchmark::do_run()
+{
+  corevm::memory::allocation_trace trace;
+
+  try
+  {
+    if (!m_input.empty())
+    {
+      trace.load(m_input);
+    }
+    else if (!generate_trace(trace))
+    {
+      std::cerr << "Unknown generator " << m_generator << std::endl;
+      return -1;
+    }
+
+    if (!m_output.empty())
+    {
+      trace.save(m_output);
+    }
+  }
+  catch (const corevm::memory::allocation_trace_error& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return -1;
+  }
+
+  uint64_t heap_size = m_heap_size ? m_heap_size : default_heap_size(trace);
+
+  std::cout << "Records: " << trace.size() << std::endl;
+  std::cout << "Heap size: " << heap_size << " bytes" << std::endl;
+  std::cout << std::endl;
+
+  std::cout << std::left << std::setw(12) << "Scheme" << std::right
+    << std::setw(14) << "Ops/s"
+    << std::setw(10) << "Failed"
+    << std::setw(16) << "Peak alloc"
+    << std::setw(16) << "Peak commit"
+    << std::setw(10) << "Avg frag"
+    << std::setw(10) << "Max frag"
+    << std::endl;
+
+  print_result("first-fit",
+    replay<corevm::memory::first_fit_allocation_scheme>(trace, heap_size));
+  print_result("best-fit",
+    replay<corevm::memory::best_fit_allocation_scheme>(trace, heap_size));
+  print_result("worst-fit",
+    replay<corevm::memory::worst_fit_allocation_scheme>(trace, heap_size));
+  print_result("next-fit",
+    replay<corevm::memory::next_fit_allocation_scheme>(trace, heap_size));
+  print_result("buddy",
+    replay<corevm::memory::buddy_allocation_scheme>(trace, heap_size));
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  allocation_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
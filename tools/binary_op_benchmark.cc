@@ -0,0 +1,202 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "types/errors.h"
+#include "types/native_type_handle.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+ * Measures binary operators applied to every pair of native types.
+ */
+class binary_op_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  binary_op_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  uint32_t m_rounds;
+};
+
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+
+static std::vector<corevm::types::native_type_handle>
+operands()
+{
+  return std::vector<corevm::types::native_type_handle> {
+    corevm::types::int8(3),
+    corevm::types::uint8(5),
+    corevm::types::int16(7),
+    corevm::types::uint16(11),
+    corevm::types::int32(13),
+    corevm::types::uint32(17),
+    corevm::types::int64(19),
+    corevm::types::uint64(23),
+    corevm::types::boolean(true),
+    corevm::types::decimal(1.5),
+    corevm::types::decimal2(2.25),
+    corevm::types::string("Hello"),
+    corevm::types::array(),
+    corevm::types::map()
+  };
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Applies the operator to every pair of operands for which it succeeds, and
+ * returns the number of operations performed. The time taken is added to the
+ * specified total.
+ */
+template<typename F>
+static uint64_t
+run_pairs(const std::vector<corevm::types::native_type_handle>& handles,
+  uint32_t rounds, F f, uint64_t& total_time)
+{
+  uint64_t count = 0;
+
+  for (auto lhs = handles.begin(); lhs != handles.end(); ++lhs)
+  {
+    for (auto rhs = handles.begin(); rhs != handles.end(); ++rhs)
+    {
+      try
+      {
+        f(*lhs, *rhs);
+      }
+      catch (const corevm::types::runtime_error&)
+      {
+        continue;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+
+      for (uint32_t round = 0; round < rounds; ++round)
+      {
+        f(*lhs, *rhs);
+      }
+
+      total_time += elapsed_time(start);
+      count += rounds;
+    }
+  }
+
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+
+template<class visitor_type>
+static void
+run_benchmark(const std::string& name, uint32_t rounds)
+{
+  const std::vector<corevm::types::native_type_handle> handles = operands();
+
+  uint64_t checksum = 0;
+
+  uint64_t time = 0;
+  uint64_t count = run_pairs(handles, rounds,
+    [&checksum](const corevm::types::native_type_handle& lhs,
+      const corevm::types::native_type_handle& rhs) {
+      checksum += boost::apply_visitor(visitor_type(), lhs, rhs).which();
+    },
+    time);
+
+  std::cout << std::left << std::setw(14) << name << std::right
+    << std::fixed << std::setprecision(2)
+    << "  " << std::setw(8)
+    << (count ? static_cast<double>(time) / count : 0)
+    << " ns/op"
+    << "  (checksum " << checksum << ")" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+binary_op_benchmark::binary_op_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM binary operator dispatch benchmark"),
+  m_rounds(10000)
+{
+  add_uint32_parameter("rounds", "Number of operations per pair of types", &m_rounds);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+binary_op_benchmark::check_parameters() const
+{
+  return m_rounds > 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+binary_op_benchmark::do_run()
+{
+  std::cout << operands().size() << " x "
+    << operands().size() << " type pairs, "
+    << m_rounds << " operations per pair" << std::endl << std::endl;
+
+  run_benchmark<corevm::types::native_type_addition_visitor>("addition", m_rounds);
+  run_benchmark<corevm::types::native_type_subtraction_visitor>("subtraction", m_rounds);
+  run_benchmark<corevm::types::native_type_multiplication_visitor>("multiplication", m_rounds);
+  run_benchmark<corevm::types::native_type_modulus_visitor>("modulus", m_rounds);
+  run_benchmark<corevm::types::native_type_bitwise_and_visitor>("bitwise_and", m_rounds);
+  run_benchmark<corevm::types::native_type_bitwise_xor_visitor>("bitwise_xor", m_rounds);
+  run_benchmark<corevm::types::native_type_eq_visitor>("eq", m_rounds);
+  run_benchmark<corevm::types::native_type_lt_visitor>("lt", m_rounds);
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  binary_op_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,285 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "dyobj/dyobj_id.h"
+#include "dyobj/dynamic_object_heap.h"
+#include "gc/reference_count_garbage_collection_scheme.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * Measures the memory taken by references held as 64-bit address ids against
+ * 32-bit compressed ids, and what decoding compressed ids costs when
+ * traversing an object graph.
+ */
+class compressed_refs_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  compressed_refs_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  uint64_t m_count;
+  uint32_t m_refs;
+  uint32_t m_rounds;
+  uint32_t m_seed;
+};
+
+
+// -----------------------------------------------------------------------------
+
+typedef corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_manager
+  dynamic_object_manager;
+
+// -----------------------------------------------------------------------------
+
+const uint64_t HEAP_SIZE = 1024 * 1024 * 64;
+
+const uint64_t MAX_HEAP_SIZE = 1024 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Allocator that tallies the bytes held by the container using it, so that
+ * the footprint of hash table nodes can be compared.
+ */
+template<typename T>
+class counting_allocator : public std::allocator<T>
+{
+public:
+  template<typename U>
+  struct rebind
+  {
+    typedef counting_allocator<U> other;
+  };
+
+  explicit counting_allocator(uint64_t* bytes)
+    :
+    std::allocator<T>(),
+    m_bytes(bytes)
+  {
+  }
+
+  template<typename U>
+  counting_allocator(const counting_allocator<U>& other)
+    :
+    std::allocator<T>(),
+    m_bytes(other.m_bytes)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    *m_bytes += n * sizeof(T);
+    return std::allocator<T>::allocate(n);
+  }
+
+  void deallocate(T* p, size_t n)
+  {
+    *m_bytes -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  uint64_t* m_bytes;
+};
+
+// -----------------------------------------------------------------------------
+
+/**
+ * Holds every object's references twice: in a flat array, as native arrays
+ * do, and in a hash table keyed by attribute, as attributes are.
+ */
+template<typename ref_type>
+struct reference_store
+{
+  typedef counting_allocator<std::pair<const uint32_t, ref_type>> attr_allocator_type;
+  typedef std::unordered_map<uint32_t, ref_type, std::hash<uint32_t>,
+    std::equal_to<uint32_t>, attr_allocator_type> attr_map_type;
+
+  reference_store()
+    :
+    attr_bytes(0),
+    refs(),
+    attrs()
+  {
+  }
+
+  uint64_t attr_bytes;
+  std::vector<ref_type> refs;
+  std::vector<attr_map_type> attrs;
+};
+
+// -----------------------------------------------------------------------------
+
+template<typename id_scheme, typename ref_type>
+static void
+run_benchmark(const std::string& name,
+  uint64_t count, uint32_t refs_per_object, uint32_t rounds, uint32_t seed)
+{
+  typedef corevm::dyobj::dynamic_object_heap<dynamic_object_manager, id_scheme> heap_type;
+
+  heap_type heap(HEAP_SIZE, MAX_HEAP_SIZE, 0);
+
+  std::vector<corevm::dyobj::dyobj_id> ids;
+  ids.reserve(count);
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    ids.push_back(heap.create_dyobj());
+  }
+
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<uint64_t> distribution(0, count - 1);
+
+  reference_store<ref_type> store;
+  store.refs.reserve(count * refs_per_object);
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    store.attrs.emplace_back(0, std::hash<uint32_t>(), std::equal_to<uint32_t>(),
+      typename reference_store<ref_type>::attr_allocator_type(&store.attr_bytes));
+
+    for (uint32_t j = 0; j < refs_per_object; ++j)
+    {
+      ref_type ref = static_cast<ref_type>(ids[distribution(engine)]);
+      store.refs.push_back(ref);
+      store.attrs.back()[j] = ref;
+    }
+  }
+
+  uint64_t array_bytes = store.refs.size() * sizeof(ref_type);
+
+  // Follow every reference back to its object.
+  auto start = std::chrono::steady_clock::now();
+
+  uint64_t checksum = 0;
+
+  for (uint32_t round = 0; round < rounds; ++round)
+  {
+    for (auto itr = store.refs.begin(); itr != store.refs.end(); ++itr)
+    {
+      checksum += heap.find(*itr)->attr_count();
+    }
+  }
+
+  uint64_t traversal_time = elapsed_time(start);
+  uint64_t traversal_count = static_cast<uint64_t>(rounds) * store.refs.size();
+
+  std::cout << name << std::endl;
+
+  std::cout << "  bytes/ref: " << sizeof(ref_type)
+    << "  reference arrays: " << array_bytes << " bytes"
+    << "  attribute tables: " << store.attr_bytes << " bytes"
+    << std::endl;
+
+  std::cout << "  derefs: " << traversal_count
+    << "  ns/deref: " << std::fixed << std::setprecision(2)
+    << (traversal_count ? static_cast<double>(traversal_time) / traversal_count : 0)
+    << "  (checksum " << checksum << ")" << std::endl;
+
+  std::cout << std::endl;
+
+  for (auto itr = ids.begin(); itr != ids.end(); ++itr)
+  {
+    heap.erase(*itr);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+compressed_refs_benchmark::compressed_refs_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM compressed references benchmark"),
+  m_count(20000),
+  m_refs(8),
+  m_rounds(20),
+  m_seed(0)
+{
+  add_uint64_parameter("count", "Number of objects to create", &m_count);
+  add_uint32_parameter("refs", "Number of references held by each object", &m_refs);
+  add_uint32_parameter("rounds", "Number of passes over the references", &m_rounds);
+  add_uint32_parameter("seed", "Random seed", &m_seed);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+compressed_refs_benchmark::check_parameters() const
+{
+  return m_count > 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+compressed_refs_benchmark::do_run()
+{
+  std::cout << "dyobj_id: " << sizeof(corevm::dyobj::dyobj_id) * 8 << " bits"
+    << std::endl << std::endl;
+
+#if !COREVM_COMPRESSED_REFS
+  run_benchmark<corevm::dyobj::address_id_scheme, uint64_t>(
+    "address ids", m_count, m_refs, m_rounds, m_seed);
+#endif
+
+  run_benchmark<corevm::dyobj::compressed_id_scheme, uint32_t>(
+    "compressed ids", m_count, m_refs, m_rounds, m_seed);
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  compressed_refs_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,319 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "dyobj/common.h"
+#include "dyobj/dynamic_object_heap.h"
+#include "gc/garbage_collector.h"
+#include "gc/mark_and_sweep_garbage_collection_scheme.h"
+#include "gc/pause_time_stats.h"
+#include "gc/reference_count_garbage_collection_scheme.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/**
+ * Compares the garbage collection schemes on an allocation heavy workload
+ * that mimics a running program: objects are created, linked to a bounded set
+ * of live objects, and dropped from it in random order.
+ */
+class gc_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  gc_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  uint64_t m_count;
+  uint32_t m_live_count;
+  uint32_t m_gc_interval;
+  uint32_t m_cycle_ratio;
+  uint32_t m_slice_budget;
+  uint32_t m_slice_interval;
+  uint32_t m_nursery_size;
+  uint32_t m_sweep_chunk_size;
+  uint32_t m_seed;
+};
+
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+
+template<class garbage_collection_scheme>
+static void
+run_benchmark(const std::string& name, uint64_t count, uint32_t live_count,
+  uint32_t gc_interval, uint32_t cycle_ratio, uint32_t slice_budget,
+  uint32_t slice_interval, uint32_t nursery_size, uint32_t sweep_chunk_size,
+  uint32_t seed)
+{
+  typedef corevm::gc::garbage_collector<garbage_collection_scheme> garbage_collector_type;
+  typedef typename garbage_collector_type::dynamic_object_heap_type heap_type;
+
+  heap_type heap(
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    corevm::dyobj::COREVM_DEFAULT_HEAP_SIZE,
+    0,
+    nursery_size ?
+      static_cast<uint32_t>(heap_type::HEAP_GENERATIONAL) :
+      static_cast<uint32_t>(0));
+
+  garbage_collector_type collector(heap);
+
+  typename garbage_collector_type::sweep_state sweep_state;
+
+  if (sweep_chunk_size)
+  {
+    collector.set_sweep_state(&sweep_state);
+  }
+
+  std::mt19937 engine(seed);
+  std::uniform_int_distribution<uint32_t> distribution;
+
+  // The objects held by the mutator, as a frame would hold its variables.
+  typename garbage_collector_type::root_set_type roots;
+  roots.reserve(live_count);
+
+  typename garbage_collector_type::incremental_state_type state;
+
+  typename garbage_collector_type::generational_state_type generations;
+  generations.activate();
+
+  // Stop-the-world collections run in a single slice.
+  const size_t budget = slice_budget ? slice_budget : std::numeric_limits<size_t>::max();
+
+  bool collecting = false;
+  uint64_t gc_count = 0;
+  uint64_t collected_count = 0;
+  corevm::gc::pause_time_stats pause_stats;
+
+  uint64_t young_count = 0;
+  uint64_t promoted_count = 0;
+  corevm::gc::pause_time_stats minor_pause_stats;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    // Allocation reclaims garbage left by lazy sweeping.
+    collected_count += collector.sweep(nullptr, sweep_chunk_size);
+
+    corevm::dyobj::dyobj_id id = heap.create_dyobj();
+    heap.at(id).manager().on_create();
+    sweep_state.retain(heap.at(id));
+
+    if (!roots.empty() && distribution(engine) % 2 == 0)
+    {
+      corevm::dyobj::dyobj_id parent_id = roots[distribution(engine) % roots.size()];
+
+      heap.at(parent_id).putattr(i, id);
+      heap.at(id).manager().on_setattr();
+
+      // Occasionally point back to the parent to form a cycle.
+      if (cycle_ratio && distribution(engine) % cycle_ratio == 0)
+      {
+        heap.at(id).putattr(i, parent_id);
+        heap.at(parent_id).manager().on_setattr();
+      }
+    }
+
+    if (roots.size() < live_count)
+    {
+      roots.push_back(id);
+    }
+    else
+    {
+      size_t index = distribution(engine) % roots.size();
+      heap.at(roots[index]).manager().on_exit();
+      roots[index] = id;
+    }
+
+    if ((i + 1) % gc_interval == 0)
+    {
+      collecting = true;
+    }
+
+    if (collecting && (!slice_budget || i % slice_interval == 0))
+    {
+      auto gc_start = std::chrono::steady_clock::now();
+
+      size_t size_before = heap.size();
+      collecting = !collector.gc_slice(nullptr, roots, budget, state);
+
+      pause_stats.record(elapsed_time(gc_start));
+
+      // Garbage left to sweep lazily is counted once it is reclaimed.
+      collected_count += size_before - heap.size();
+
+      if (!collecting)
+      {
+        ++gc_count;
+      }
+    }
+
+    // Minor collections cannot overlap with an incremental one.
+    if (nursery_size && !collecting && heap.nursery().size() >= nursery_size)
+    {
+      auto gc_start = std::chrono::steady_clock::now();
+
+      young_count += heap.nursery().size();
+      promoted_count += collector.minor_gc(nullptr, roots, generations);
+
+      minor_pause_stats.record(elapsed_time(gc_start));
+    }
+  }
+
+  uint64_t total_time = elapsed_time(start);
+
+  // Drop every live object; whatever survives is garbage the scheme missed.
+  for (auto itr = roots.begin(); itr != roots.end(); ++itr)
+  {
+    heap.at(*itr).manager().on_exit();
+  }
+
+  roots.clear();
+
+  while (!collector.gc_slice(nullptr, roots, budget, state))
+  {
+  }
+
+  collector.gc(nullptr, roots);
+
+  std::cout << name << std::endl;
+
+  std::cout << "  total time: " << total_time / 1000000 << " ms"
+    << "  collections: " << gc_count
+    << "  collected: " << collected_count << std::endl;
+
+  std::cout << "  pauses: " << pause_stats.count()
+    << "  p50: " << pause_stats.percentile(50) / 1000 << " us"
+    << "  p99: " << pause_stats.percentile(99) / 1000 << " us"
+    << "  max: " << pause_stats.max() / 1000 << " us"
+    << "  leaked: " << heap.size() << std::endl;
+
+  if (minor_pause_stats.count())
+  {
+    std::cout << "  minor pauses: " << minor_pause_stats.count()
+      << "  p50: " << minor_pause_stats.percentile(50) / 1000 << " us"
+      << "  p99: " << minor_pause_stats.percentile(99) / 1000 << " us"
+      << "  max: " << minor_pause_stats.max() / 1000 << " us"
+      << "  promoted: " << std::fixed << std::setprecision(1)
+      << 100.0 * promoted_count / young_count << "%" << std::endl;
+  }
+
+  std::cout << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+gc_benchmark::gc_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM garbage collection benchmark"),
+  m_count(50000),
+  m_live_count(1000),
+  m_gc_interval(5000),
+  m_cycle_ratio(8),
+  m_slice_budget(1000),
+  m_slice_interval(100),
+  m_nursery_size(1000),
+  m_sweep_chunk_size(16),
+  m_seed(0)
+{
+  add_uint64_parameter("count", "Number of objects to create", &m_count);
+  add_uint32_parameter("live-count", "Number of objects held by the mutator", &m_live_count);
+  add_uint32_parameter("gc-interval", "Number of objects created between collections", &m_gc_interval);
+  add_uint32_parameter("cycle-ratio", "One in this many linked objects refers back to its parent (0 for none)", &m_cycle_ratio);
+  add_uint32_parameter("slice-budget", "Objects traced per incremental slice", &m_slice_budget);
+  add_uint32_parameter("slice-interval", "Number of objects created between incremental slices", &m_slice_interval);
+  add_uint32_parameter("nursery-size", "Number of young objects that triggers a minor collection", &m_nursery_size);
+  add_uint32_parameter("sweep-chunk-size", "Objects swept per allocation when sweeping lazily", &m_sweep_chunk_size);
+  add_uint32_parameter("seed", "Random seed", &m_seed);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+gc_benchmark::check_parameters() const
+{
+  return m_count > 0 && m_live_count > 0 && m_gc_interval > 0 && m_slice_interval > 0 &&
+    m_nursery_size > 0 && m_sweep_chunk_size > 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+gc_benchmark::do_run()
+{
+  run_benchmark<corevm::gc::reference_count_garbage_collection_scheme>(
+    "reference count", m_count, m_live_count, m_gc_interval, m_cycle_ratio,
+    0, m_slice_interval, 0, 0, m_seed);
+
+  run_benchmark<corevm::gc::mark_and_sweep_garbage_collection_scheme>(
+    "mark and sweep", m_count, m_live_count, m_gc_interval, m_cycle_ratio,
+    0, m_slice_interval, 0, 0, m_seed);
+
+  run_benchmark<corevm::gc::mark_and_sweep_garbage_collection_scheme>(
+    "incremental mark and sweep", m_count, m_live_count, m_gc_interval,
+    m_cycle_ratio, m_slice_budget, m_slice_interval, 0, 0, m_seed);
+
+  run_benchmark<corevm::gc::mark_and_sweep_garbage_collection_scheme>(
+    "generational mark and sweep", m_count, m_live_count, m_gc_interval,
+    m_cycle_ratio, 0, m_slice_interval, m_nursery_size, 0, m_seed);
+
+  run_benchmark<corevm::gc::mark_and_sweep_garbage_collection_scheme>(
+    "incremental mark and lazy sweep", m_count, m_live_count, m_gc_interval,
+    m_cycle_ratio, m_slice_budget, m_slice_interval, 0, m_sweep_chunk_size,
+    m_seed);
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  gc_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
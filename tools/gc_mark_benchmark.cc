@@ -0,0 +1,206 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "dyobj/dynamic_object_heap.h"
+#include "gc/mark_and_sweep_garbage_collection_scheme.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Measures how the mark phase of the mark-and-sweep scheme scales with the
+ * number of marking threads, on a random object graph that is entirely
+ * reachable from a single root.
+ */
+class gc_mark_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  gc_mark_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  uint64_t m_count;
+  uint32_t m_degree;
+  uint32_t m_max_threads;
+  uint32_t m_rounds;
+  uint32_t m_seed;
+};
+
+
+// -----------------------------------------------------------------------------
+
+typedef corevm::gc::mark_and_sweep_garbage_collection_scheme scheme_type;
+
+typedef scheme_type::dynamic_object_heap_type heap_type;
+
+// -----------------------------------------------------------------------------
+
+const uint64_t HEAP_SIZE = 1024 * 1024 * 64;
+
+const uint64_t MAX_HEAP_SIZE = 1024ULL * 1024 * 1024 * 4;
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+build_graph(heap_type& heap, uint64_t count, uint32_t degree, uint32_t seed,
+  scheme_type::root_set_type& roots)
+{
+  std::mt19937 engine(seed);
+  std::vector<corevm::dyobj::dyobj_id> ids;
+  ids.reserve(count);
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    ids.push_back(heap.create_dyobj());
+  }
+
+  // Every object is referred to by an earlier one, which makes the graph
+  // reachable from the first object, and refers to random others.
+  for (uint64_t i = 1; i < count; ++i)
+  {
+    std::uniform_int_distribution<uint64_t> parent_distribution(0, i - 1);
+    heap.at(ids[parent_distribution(engine)]).putattr(i, ids[i]);
+  }
+
+  std::uniform_int_distribution<uint64_t> distribution(0, count - 1);
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    for (uint32_t j = 1; j < degree; ++j)
+    {
+      heap.at(ids[i]).putattr(count + j, ids[distribution(engine)]);
+    }
+  }
+
+  roots.push_back(ids.front());
+}
+
+// -----------------------------------------------------------------------------
+
+gc_mark_benchmark::gc_mark_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM parallel marking benchmark"),
+  m_count(50000),
+  m_degree(4),
+  m_max_threads(8),
+  m_rounds(3),
+  m_seed(0)
+{
+  add_uint64_parameter("count", "Number of objects on the heap", &m_count);
+  add_uint32_parameter("degree", "Number of attributes of every object", &m_degree);
+  add_uint32_parameter("max-threads", "Largest number of marking threads", &m_max_threads);
+  add_uint32_parameter("rounds", "Number of marks timed per thread count", &m_rounds);
+  add_uint32_parameter("seed", "Random seed", &m_seed);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+gc_mark_benchmark::check_parameters() const
+{
+  return m_count > 0 && m_degree > 0 && m_max_threads > 0 && m_rounds > 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+gc_mark_benchmark::do_run()
+{
+  heap_type heap(HEAP_SIZE, MAX_HEAP_SIZE, 0, heap_type::HEAP_USE_HANDLE_TABLE);
+  scheme_type::root_set_type roots;
+
+  auto start = std::chrono::steady_clock::now();
+
+  build_graph(heap, m_count, m_degree, m_seed, roots);
+
+  std::cout << "objects: " << heap.size()
+    << "  attributes per object: " << m_degree
+    << "  hardware threads: " << std::thread::hardware_concurrency()
+    << "  setup time: " << elapsed_time(start) / 1000000 << " ms"
+    << std::endl << std::endl;
+
+  uint64_t baseline_time = 0;
+
+  for (uint32_t thread_count = 1; thread_count <= m_max_threads; thread_count *= 2)
+  {
+    scheme_type scheme;
+    scheme.set_mark_thread_count(thread_count);
+
+    uint64_t best_time = std::numeric_limits<uint64_t>::max();
+
+    for (uint32_t round = 0; round < m_rounds; ++round)
+    {
+      start = std::chrono::steady_clock::now();
+
+      scheme.gc(heap, roots);
+
+      best_time = std::min(best_time, elapsed_time(start));
+    }
+
+    if (thread_count == 1)
+    {
+      baseline_time = best_time;
+    }
+
+    std::cout << "  threads: " << std::setw(3) << thread_count
+      << "  mark time: " << std::setw(8) << best_time / 1000 << " us"
+      << "  speedup: " << std::fixed << std::setprecision(2)
+      << static_cast<double>(baseline_time) / best_time << "x"
+      << std::endl;
+  }
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  gc_mark_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------
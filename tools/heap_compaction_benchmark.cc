@@ -0,0 +1,208 @@
+/*******************************************************************************
+The MIT License (MIT)
+
+Copyright (c) 2015 Yanzheng Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include "dyobj/dynamic_object_heap.h"
+#include "gc/reference_count_garbage_collection_scheme.h"
+
+#include <sneaker/utility/cmdline_program.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/**
+ * Measures the cost of looking objects up through the handle table against
+ * direct ids, and what compaction recovers from a fragmented heap.
+ */
+class heap_compaction_benchmark : public sneaker::utility::cmdline_program
+{
+public:
+  heap_compaction_benchmark();
+
+protected:
+  virtual int do_run();
+
+  virtual bool check_parameters() const;
+
+private:
+  uint64_t m_count;
+  uint32_t m_lookup_rounds;
+  uint32_t m_seed;
+};
+
+
+// -----------------------------------------------------------------------------
+
+typedef corevm::dyobj::dynamic_object_heap<
+  corevm::gc::reference_count_garbage_collection_scheme::dynamic_object_manager> heap_type;
+
+// -----------------------------------------------------------------------------
+
+const uint64_t HEAP_SIZE = 1024 * 1024 * 64;
+
+const uint64_t MAX_HEAP_SIZE = 1024 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+
+static uint64_t
+elapsed_time(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+print_stats(const std::string& label, heap_type& heap)
+{
+  corevm::memory::allocation_stats stats = heap.stats();
+
+  std::cout << "  " << std::left << std::setw(20) << label << std::right
+    << "free blocks: " << std::setw(10) << stats.free_block_count
+    << "  largest free: " << std::setw(12) << stats.largest_free_block_size
+    << "  fragmentation: " << std::fixed << std::setprecision(4)
+    << stats.fragmentation_ratio()
+    << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+static void
+run_benchmark(const std::string& name, uint32_t heap_flags,
+  uint64_t count, uint32_t lookup_rounds, uint32_t seed)
+{
+  heap_type heap(HEAP_SIZE, MAX_HEAP_SIZE, 0, heap_flags);
+
+  std::mt19937 engine(seed);
+  std::vector<corevm::dyobj::dyobj_id> ids;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    ids.push_back(heap.create_dyobj());
+  }
+
+  // Free half of the objects at random to fragment the heap.
+  std::shuffle(ids.begin(), ids.end(), engine);
+
+  for (uint64_t i = count / 2; i < ids.size(); ++i)
+  {
+    heap.erase(ids[i]);
+  }
+
+  ids.resize(count / 2);
+
+  std::cout << name << std::endl;
+
+  print_stats("before compaction", heap);
+
+  auto start = std::chrono::steady_clock::now();
+
+  uint64_t checksum = 0;
+
+  for (uint32_t round = 0; round < lookup_rounds; ++round)
+  {
+    for (auto itr = ids.begin(); itr != ids.end(); ++itr)
+    {
+      checksum += heap.at(*itr).attr_count();
+    }
+  }
+
+  uint64_t lookup_time = elapsed_time(start);
+  uint64_t lookup_count = static_cast<uint64_t>(lookup_rounds) * ids.size();
+
+  start = std::chrono::steady_clock::now();
+
+  heap_type::size_type moved_count = heap.compact();
+
+  uint64_t compaction_time = elapsed_time(start);
+
+  uint64_t released_size = heap.release_free_memory();
+
+  print_stats("after compaction", heap);
+
+  std::cout << "  lookups: " << lookup_count
+    << "  ns/lookup: " << std::setprecision(2)
+    << (lookup_count ? static_cast<double>(lookup_time) / lookup_count : 0)
+    << "  (checksum " << checksum << ")" << std::endl;
+
+  std::cout << "  moved: " << moved_count
+    << "  compaction time: " << compaction_time / 1000 << " us"
+    << "  released: " << released_size << " bytes" << std::endl;
+
+  std::cout << std::endl;
+
+  for (auto itr = ids.begin(); itr != ids.end(); ++itr)
+  {
+    heap.erase(*itr);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+heap_compaction_benchmark::heap_compaction_benchmark()
+  :
+  sneaker::utility::cmdline_program("coreVM heap compaction benchmark"),
+  m_count(20000),
+  m_lookup_rounds(100),
+  m_seed(0)
+{
+  add_uint64_parameter("count", "Number of objects to create", &m_count);
+  add_uint32_parameter("lookup-rounds", "Number of passes over the live objects", &m_lookup_rounds);
+  add_uint32_parameter("seed", "Random seed", &m_seed);
+}
+
+// -----------------------------------------------------------------------------
+
+bool
+heap_compaction_benchmark::check_parameters() const
+{
+  return m_count > 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int
+heap_compaction_benchmark::do_run()
+{
+  run_benchmark("direct ids", 0, m_count, m_lookup_rounds, m_seed);
+  run_benchmark("handle table", heap_type::HEAP_USE_HANDLE_TABLE, m_count, m_lookup_rounds, m_seed);
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  heap_compaction_benchmark program;
+  return program.run(argc, argv);
+}
+
+// -----------------------------------------------------------------------------